@@ -8,6 +8,19 @@ cd "$SCRIPT_DIR"
 # 统一安装目录
 INSTALL_DIR="$SCRIPT_DIR/install"
 
+# 编译期日志级别（0=DEBUG 1=INFO 2=WARN 3=ERROR），低于该级别的 LOG_* 语句不会编译进二进制
+if [ -n "$SIMPLE_LOG_MIN_LEVEL" ]; then
+    export CXXFLAGS="$CXXFLAGS -DSIMPLE_LOG_MIN_LEVEL=$SIMPLE_LOG_MIN_LEVEL"
+fi
+# 热路径剖析开关（SIMPLE_ENABLE_PROFILING=0 时 PROFILE_SCOPE 编译为空）
+if [ -n "$SIMPLE_ENABLE_PROFILING" ]; then
+    export CXXFLAGS="$CXXFLAGS -DSIMPLE_ENABLE_PROFILING=$SIMPLE_ENABLE_PROFILING"
+fi
+# 堆分配计数（SIMPLE_TRACK_ALLOCATIONS=1 时 simple_middleware 替换全局 operator new/delete）
+if [ -n "$SIMPLE_TRACK_ALLOCATIONS" ]; then
+    export CXXFLAGS="$CXXFLAGS -DSIMPLE_TRACK_ALLOCATIONS=$SIMPLE_TRACK_ALLOCATIONS"
+fi
+
 echo "=== 0. 清理旧构建 ==="
 "$SCRIPT_DIR/scripts/clean.sh"
 
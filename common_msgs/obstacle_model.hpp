@@ -0,0 +1,34 @@
+/*
+ * @Desc: 障碍物 3D 框尺寸 - 仿真真值没有设置长宽高时的缺省值，相机渲染、LiDAR 仿真和感知核对共用同一套尺寸
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include <string>
+#include <common_msgs/visualizer_data.pb.h>
+
+namespace obstacle_model {
+
+// 按类型的缺省高度（米）
+inline double DefaultHeight(const std::string& type) {
+    if (type == "pedestrian") return 1.7;
+    if (type == "cone") return 0.7;
+    return 1.5;
+}
+
+// 3D 框尺寸（米）：字段未设置（<= 0）时长宽取 1m，高度按类型取缺省值
+inline double Length(const senseauto::demo::Obstacle& obs) {
+    return obs.length() > 0 ? obs.length() : 1.0;
+}
+
+inline double Width(const senseauto::demo::Obstacle& obs) {
+    return obs.width() > 0 ? obs.width() : 1.0;
+}
+
+inline double Height(const senseauto::demo::Obstacle& obs) {
+    return obs.height() > 0 ? obs.height() : DefaultHeight(obs.type());
+}
+
+}  // namespace obstacle_model
@@ -0,0 +1,160 @@
+/*
+ * @Desc: 参数化预测轨迹编解码与求值 - PredictionArray 的量化打包 / 解包，根据运动模型计算任意时刻的位置和置信度
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <common_msgs/visualizer_data.pb.h>
+
+namespace prediction_model {
+
+using Model = senseauto::demo::PredictionArray::Model;
+
+// 单个障碍物的预测参数（解码后，单位：米、米/秒）
+struct PredictedObstacle {
+    int32_t id = 0;
+    Model model = senseauto::demo::PredictionArray::STATIC;
+    double x = 0.0;                 // 当前位置（世界坐标）
+    double y = 0.0;
+    double vx = 0.0;                // 速度
+    double vy = 0.0;
+    double confidence = 1.0;        // t = 0 时的置信度
+    double confidence_decay = 0.0;  // 置信度每秒下降量
+    double min_confidence = 0.0;    // 置信度下限
+};
+
+// 预测轨迹点
+struct PredictedPoint {
+    double x = 0.0;
+    double y = 0.0;
+    double confidence = 0.0;   // 预测置信度（0-1）
+    double time_offset = 0.0;  // 相对预测时间戳的时间偏移（秒）
+};
+
+namespace detail {
+
+inline int32_t ToCentimeters(double meters) {
+    double cm = std::round(meters * 100.0);
+    cm = std::clamp(cm, static_cast<double>(std::numeric_limits<int32_t>::min()),
+                    static_cast<double>(std::numeric_limits<int32_t>::max()));
+    return static_cast<int32_t>(cm);
+}
+
+}  // namespace detail
+
+/**
+ * @brief 把障碍物预测量化打包进 PredictionArray
+ * @details 位置相对参考点按厘米、速度按厘米/秒、置信度按 1/255 量化；ID 按差分编码，调用方须按 ID 升序 Append()。
+ *          匀速模型的置信度衰减规律（confidence_decay / min_confidence）由调用方写在 PredictionArray 上，所有障碍物共用。
+ */
+class Encoder {
+public:
+    /**
+     * @param out 输出消息，清空已有的障碍物（保留已分配的容量）
+     * @param origin_x 位置参考点（取障碍物附近的点，例如自车位置，相对坐标越小编码越短）
+     */
+    Encoder(senseauto::demo::PredictionArray* out, double origin_x, double origin_y) : out_(out) {
+        out_->clear_id_delta();
+        out_->clear_x_cm();
+        out_->clear_y_cm();
+        out_->clear_vx_cm_s();
+        out_->clear_vy_cm_s();
+        out_->mutable_models()->clear();
+        out_->mutable_confidence()->clear();
+        out_->set_origin_x(origin_x);
+        out_->set_origin_y(origin_y);
+    }
+
+    void Append(int32_t id, Model model, double x, double y, double vx, double vy, double confidence) {
+        out_->add_id_delta(id - last_id_);
+        last_id_ = id;
+        out_->add_x_cm(detail::ToCentimeters(x - out_->origin_x()));
+        out_->add_y_cm(detail::ToCentimeters(y - out_->origin_y()));
+        const bool moving = model == senseauto::demo::PredictionArray::CONSTANT_VELOCITY;
+        out_->add_vx_cm_s(moving ? detail::ToCentimeters(vx) : 0);
+        out_->add_vy_cm_s(moving ? detail::ToCentimeters(vy) : 0);
+        out_->mutable_models()->push_back(static_cast<char>(model));
+        out_->mutable_confidence()->push_back(
+            static_cast<char>(static_cast<uint8_t>(std::lround(std::clamp(confidence, 0.0, 1.0) * 255.0))));
+    }
+
+private:
+    senseauto::demo::PredictionArray* out_;
+    int32_t last_id_ = 0;
+};
+
+/**
+ * @brief 解包 PredictionArray
+ * @param out 输出（调整大小，容量跨帧复用）
+ * @return 各并行数组长度不一致时返回 false（out 被清空）
+ */
+inline bool Decode(const senseauto::demo::PredictionArray& in, std::vector<PredictedObstacle>* out) {
+    const int count = in.id_delta_size();
+    out->clear();
+    if (in.x_cm_size() != count || in.y_cm_size() != count || in.vx_cm_s_size() != count
+        || in.vy_cm_s_size() != count || static_cast<int>(in.models().size()) != count
+        || static_cast<int>(in.confidence().size()) != count) {
+        return false;
+    }
+    out->resize(count);
+    int32_t id = 0;
+    for (int i = 0; i < count; ++i) {
+        PredictedObstacle& obs = (*out)[i];
+        id += in.id_delta(i);
+        obs.id = id;
+        obs.model = static_cast<uint8_t>(in.models()[i]) == senseauto::demo::PredictionArray::CONSTANT_VELOCITY
+            ? senseauto::demo::PredictionArray::CONSTANT_VELOCITY : senseauto::demo::PredictionArray::STATIC;
+        obs.x = in.origin_x() + in.x_cm(i) / 100.0;
+        obs.y = in.origin_y() + in.y_cm(i) / 100.0;
+        obs.vx = in.vx_cm_s(i) / 100.0;
+        obs.vy = in.vy_cm_s(i) / 100.0;
+        obs.confidence = static_cast<uint8_t>(in.confidence()[i]) / 255.0;
+        if (obs.model == senseauto::demo::PredictionArray::CONSTANT_VELOCITY) {
+            obs.confidence_decay = in.confidence_decay();
+            obs.min_confidence = in.min_confidence();
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 计算障碍物在 time_offset 秒后的位置和置信度
+ */
+inline PredictedPoint Evaluate(const PredictedObstacle& obs, double time_offset) {
+    PredictedPoint pt;
+    pt.time_offset = time_offset;
+    pt.x = obs.x;
+    pt.y = obs.y;
+    if (obs.model == senseauto::demo::PredictionArray::CONSTANT_VELOCITY) {
+        pt.x += obs.vx * time_offset;
+        pt.y += obs.vy * time_offset;
+    }
+    pt.confidence = std::max(obs.min_confidence, obs.confidence - obs.confidence_decay * time_offset);
+    return pt;
+}
+
+/**
+ * @brief 按固定步长采样 (0, horizon] 内的轨迹点（第一个点在 time_step 处）
+ */
+inline std::vector<PredictedPoint> Sample(const PredictedObstacle& obs, double horizon, double time_step) {
+    std::vector<PredictedPoint> points;
+    if (time_step <= 0.0 || horizon <= 0.0) {
+        return points;
+    }
+    // 用整数步数避免浮点累加误差导致丢掉最后一个点
+    int steps = static_cast<int>(horizon / time_step + 1e-6);
+    points.reserve(steps);
+    for (int i = 1; i <= steps; ++i) {
+        points.push_back(Evaluate(obs, i * time_step));
+    }
+    return points;
+}
+
+}  // namespace prediction_model
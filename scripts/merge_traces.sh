@@ -0,0 +1,31 @@
+#!/bin/bash
+# 合并各节点导出的 trace 文件（设置 SIMPLE_PROFILE_DIR 后由 PROFILE_SCOPE 记录，
+# 收到 SIGUSR2 或进程退出时写出），得到一个可以在 Perfetto / chrome://tracing 中打开的文件。
+# 各节点的时间戳都取自系统单调时钟，合并后在同一条时间轴上显示。
+#
+# 用法: scripts/merge_traces.sh [trace 目录，默认 profiles] [输出文件，默认 <目录>/merged.json]
+set -e
+
+DIR="${1:-profiles}"
+OUT="${2:-$DIR/merged.json}"
+
+shopt -s nullglob
+FILES=("$DIR"/*.trace.json)
+if [ ${#FILES[@]} -eq 0 ]; then
+    echo "No *.trace.json found in $DIR"
+    exit 1
+fi
+
+# 每个文件第一行是 JSON 头、最后一行是结尾，中间每行一个事件
+{
+    echo '{"displayTimeUnit":"ns","traceEvents":['
+    SEP=""
+    for f in "${FILES[@]}"; do
+        printf '%s' "$SEP"
+        sed '1d;$d' "$f"
+        SEP=","
+    done
+    echo ']}'
+} > "$OUT"
+
+echo "Merged ${#FILES[@]} trace files into $OUT"
@@ -1,18 +1,17 @@
 #include "control_component.hpp"
 #include <simple_middleware/logger.hpp> // Add logger include
+#include <simple_middleware/profiler.hpp>
 #include <google/protobuf/util/json_util.h>
-#include <json11.hpp>
+#include <simple_middleware/json_reader.hpp>
 #include <simple_middleware/config_manager.hpp>
 #include <iostream>
 #include <chrono>
 #include <cmath>
 #include <algorithm>
-#include <arpa/inet.h> // for ntohl
-
-using namespace json11;
 
 ControlComponent::ControlComponent() : running_(false) {
     status_reporter_ = std::make_unique<simple_middleware::StatusReporter>("ControlNode");
+    control_loop_ = status_reporter_->RegisterLoop("control", std::chrono::milliseconds(100));
     
     // Load config
     auto& config = simple_middleware::ConfigManager::GetInstance();
@@ -41,35 +40,24 @@ void ControlComponent::Start() {
     
     // 订阅控制指令
     auto& middleware = simple_middleware::PubSubMiddleware::getInstance();
-    middleware.subscribe("visualizer/control", [this](const simple_middleware::Message& msg) {
+    middleware.subscribe(simple_middleware::topics::kVisualizerControl, [this](const simple_middleware::Message& msg) {
         this->OnControlMessage(msg);
     });
     
-    // 订阅模拟器真值 (作为反馈)
-    middleware.subscribe("visualizer/data", [this](const simple_middleware::Message& msg) {
-        this->OnSimulatorState(msg);
+    // 订阅自车状态 (作为反馈，100Hz，不含障碍物)
+    middleware.subscribe(simple_middleware::topics::kEgoState, [this](const senseauto::demo::EgoState& ego) {
+        this->OnEgoState(ego);
     });
 
-    // 订阅规划轨迹（完整消息）
-    int64_t traj_sub_id = middleware.subscribe("planning/trajectory", [this](const simple_middleware::Message& msg) {
-        simple_middleware::Logger::Info("Control: Received planning/trajectory message, size=" + std::to_string(msg.data.size()));
-        this->OnPlanningTrajectory(msg);
+    // 订阅规划轨迹
+    int64_t traj_sub_id = middleware.subscribe(simple_middleware::topics::kPlanningTrajectory, [this](const senseauto::demo::Trajectory& traj) {
+        this->OnPlanningTrajectory(traj);
     });
     if (traj_sub_id >= 0) {
         simple_middleware::Logger::Info("Control: Subscribed to planning/trajectory (ID: " + std::to_string(traj_sub_id) + ")");
     } else {
         simple_middleware::Logger::Error("Control: Failed to subscribe to planning/trajectory");
     }
-    
-    // 订阅规划轨迹分片
-    int64_t chunk_sub_id = middleware.subscribe("planning/trajectory/chunk", [this](const simple_middleware::Message& msg) {
-        this->OnPlanningTrajectoryChunk(msg);
-    });
-    if (chunk_sub_id >= 0) {
-        simple_middleware::Logger::Info("Control: Subscribed to planning/trajectory/chunk (ID: " + std::to_string(chunk_sub_id) + ")");
-    } else {
-        simple_middleware::Logger::Error("Control: Failed to subscribe to planning/trajectory/chunk");
-    }
 
     thread_ = std::thread(&ControlComponent::RunLoop, this);
     status_reporter_->Start();
@@ -167,6 +155,7 @@ void ControlComponent::UpdateLookaheadPoint() {
 }
 
 void ControlComponent::ComputePurePursuitSteering(double dt) {
+    PROFILE_SCOPE("Control::ComputePurePursuitSteering");
     // 如果是手动控制模式，不执行自动控制算法
     if (manual_control_mode_) {
         return;
@@ -237,22 +226,19 @@ void ControlComponent::ComputePurePursuitSteering(double dt) {
 void ControlComponent::RunLoop() {
     const double dt = 0.1; // 100ms
     auto& middleware = simple_middleware::PubSubMiddleware::getInstance();
-    static int log_counter = 0;
-
+    simple_middleware::Profiler::SetThreadName("Control::RunLoop");
     while (running_) {
         // 1. 计算控制量
         {
+            simple_middleware::LoopCycle cycle(control_loop_);
             std::lock_guard<std::mutex> lock(state_mutex_);
             ComputePurePursuitSteering(dt);
             
             // 调试日志：每 50 次循环（5秒）输出一次状态
-            if (log_counter++ % 50 == 0) {
-                simple_middleware::Logger::Debug(
-                    "Control Loop: speed=" + std::to_string(current_car_state_.speed()) +
-                    ", steering=" + std::to_string(current_car_state_.steering_angle()) +
-                    ", manual_mode=" + std::string(manual_control_mode_ ? "true" : "false") +
-                    ", target_active=" + std::string(target_point_.active ? "true" : "false"));
-            }
+            LOG_EVERY_N(DEBUG, "Control", 50) << "Loop: speed=" << current_car_state_.speed()
+                << ", steering=" << current_car_state_.steering_angle()
+                << ", manual_mode=" << (manual_control_mode_ ? "true" : "false")
+                << ", target_active=" << (target_point_.active ? "true" : "false");
             
             // 2. 发送控制指令给 Simulator
             senseauto::demo::ControlCommand cmd;
@@ -261,10 +247,14 @@ void ControlComponent::RunLoop() {
             // 这是为了复用现有 Proto 结构的 hack
             cmd.set_value(current_car_state_.speed()); 
             cmd.mutable_target()->set_x(current_car_state_.steering_angle());
+
+            // 链路追踪：控制指令沿用当前跟踪轨迹的上下文
+            if (trajectory_trace_.trace_id() != 0) {
+                cmd.mutable_trace()->CopyFrom(trajectory_trace_);
+                simple_middleware::TraceStampStage(cmd.mutable_trace(), "control");
+            }
             
-            std::string payload;
-            cmd.SerializeToString(&payload);
-            middleware.publish("control/command", payload);
+            middleware.publish(simple_middleware::topics::kControlCommand, cmd);
         }
 
         // 3. Control 不再负责发布 visualizer/data
@@ -273,57 +263,62 @@ void ControlComponent::RunLoop() {
     }
 }
 
-void ControlComponent::OnSimulatorState(const simple_middleware::Message& msg) {
-    senseauto::demo::FrameData frame;
-    if (frame.ParseFromString(msg.data)) {
-        std::lock_guard<std::mutex> lock(state_mutex_);
-        if (frame.has_car_state()) {
-            // 更新本地反馈
-            // 注意：不要覆盖 speed/steering，因为那是我们的控制目标
-            // 我们只更新位置信息作为反馈
-            auto* pos = current_car_state_.mutable_position();
-            pos->set_x(frame.car_state().position().x());
-            pos->set_y(frame.car_state().position().y());
-            current_car_state_.set_heading(frame.car_state().heading());
-            
-            // 实际上这里的 speed 应该是测量速度，但我们的 PID 简单，先混用
-        }
+void ControlComponent::OnEgoState(const senseauto::demo::EgoState& ego) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    if (ego.has_car_state()) {
+        // 更新本地反馈
+        // 注意：不要覆盖 speed/steering，因为那是我们的控制目标
+        // 我们只更新位置信息作为反馈
+        auto* pos = current_car_state_.mutable_position();
+        pos->set_x(ego.car_state().position().x());
+        pos->set_y(ego.car_state().position().y());
+        current_car_state_.set_heading(ego.car_state().heading());
+
+        // 实际上这里的 speed 应该是测量速度，但我们的 PID 简单，先混用
     }
 }
 
 void ControlComponent::OnControlMessage(const simple_middleware::Message& msg) {
-    std::string err;
-    Json json = Json::parse(msg.data, err);
-    if (!err.empty()) {
-        simple_middleware::Logger::Warn("Failed to parse control message: " + err);
+    // 只取需要的字段，不构建 DOM
+    std::string cmd;
+    std::string type;
+    double x = 0.0;
+    double y = 0.0;
+    double value = 0.0;
+    simple_middleware::JsonReader reader(msg.data);
+    bool parsed = reader.forEachMember([&](std::string_view key) {
+        if (key == "cmd") reader.readString(&cmd);
+        else if (key == "type") reader.readString(&type);
+        else if (key == "x") reader.readNumber(&x);
+        else if (key == "y") reader.readNumber(&y);
+        else if (key == "value") reader.readNumber(&value);
+    });
+    if (!parsed) {
+        simple_middleware::Logger::Warn("Failed to parse control message: " + reader.error());
         return;
     }
     
     // 支持两种格式：前端可能发送 "cmd" 或 "type"
-    std::string cmd = json["cmd"].string_value();
     if (cmd.empty()) {
-        cmd = json["type"].string_value();
+        cmd = type;
     }
     
     if (cmd == "set_target") {
-        double x = json["x"].number_value();
-        double y = json["y"].number_value();
         SetTarget(x, y);
         manual_control_mode_ = false; // 设置目标点后切换到自动模式
         // 【修复1】清空当前轨迹，设置等待标志，等待 Planning 生成新轨迹
         {
             std::lock_guard<std::mutex> lock(state_mutex_);
             current_trajectory_.clear();
+            trajectory_trace_.Clear();
             waiting_for_trajectory_ = true; // 设置等待标志
         }
         simple_middleware::Logger::Info("Received set_target: (" + std::to_string(x) + ", " + std::to_string(y) + "), waiting for planning trajectory...");
     } else if (cmd == "set_speed") {
-        double speed = json["value"].number_value();
-        SetSpeed(speed);
+        SetSpeed(value);
         manual_control_mode_ = true; // 手动设置速度后切换到手动模式
     } else if (cmd == "set_steer") {
-        double angle = json["value"].number_value();
-        SetSteering(angle);
+        SetSteering(value);
         manual_control_mode_ = true; // 手动设置转向后切换到手动模式
     } else if (cmd == "reset") {
         Reset();
@@ -346,142 +341,34 @@ void ControlComponent::OnControlMessage(const simple_middleware::Message& msg) {
 // 删除 GetSerializedData 和 OnPerceptionObstacles
 
 
-void ControlComponent::OnPlanningTrajectory(const simple_middleware::Message& msg) {
-    simple_middleware::Logger::Info("Control: OnPlanningTrajectory called, data_size=" + std::to_string(msg.data.size()));
+void ControlComponent::OnPlanningTrajectory(const senseauto::demo::Trajectory& traj) {
+    LOG_DEBUG("Control") << "OnPlanningTrajectory called, points=" << traj.points_size();
     
-    std::string err;
-    Json json = Json::parse(msg.data, err);
-    if (!err.empty()) {
-        simple_middleware::Logger::Error("Control: Failed to parse planning/trajectory JSON: " + err);
-        return;
-    }
-    
-    simple_middleware::Logger::Info("Control: Parsed JSON successfully, checking trajectory array...");
-    
-    // 解析 planning/trajectory 消息 (FrameData 结构)
-    // 注意：planning 发送的也是 FrameData 结构的 JSON
-    if (json["trajectory"].is_array()) {
-        simple_middleware::Logger::Info("Control: Found trajectory array with " + std::to_string(json["trajectory"].array_items().size()) + " points");
-        std::lock_guard<std::mutex> lock(state_mutex_);
-        current_trajectory_.clear();
-        double target_v = -1.0;
-
-        for (const auto& pt : json["trajectory"].array_items()) {
-            current_trajectory_.push_back({pt["x"].number_value(), pt["y"].number_value()});
-            if (target_v < 0 && pt["speed"].is_number()) {
-                target_v = pt["speed"].number_value();
-            }
-        }
-        
-#include <simple_middleware/logger.hpp> // Add logger include
-
-// ...
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    current_trajectory_.clear();
+    current_trajectory_.reserve(traj.points_size());
+    trajectory_trace_ = traj.trace();
+    // 规划在每个点上都填写 speed（ACC 逻辑给出的目标速度），取第一个点作为当前目标速度
+    double target_v = traj.points_size() > 0 ? traj.points(0).speed() : -1.0;
 
-        if (!current_trajectory_.empty()) {
-            // 收到新轨迹，清除等待标志，激活自动驾驶模式
-            waiting_for_trajectory_ = false; // 收到轨迹后，清除等待标志
-            if (target_v >= 0) {
-                // 如果轨迹中包含速度信息 (来自 Planning 的 ACC 逻辑)，直接应用
-                current_car_state_.set_speed(target_v);
-            } else {
-                // 兼容旧逻辑：如果车没速度，给一个默认启动速度
-                if (current_car_state_.speed() < 1.0) {
-                     current_car_state_.set_speed(auto_engage_speed_);
-                }
-            }
-            // 使用 Logger
-            simple_middleware::Logger::Info("Received trajectory with " + std::to_string(current_trajectory_.size()) + " points. Target V: " + std::to_string(target_v));
-        }
+    for (const auto& pt : traj.points()) {
+        current_trajectory_.push_back({pt.x(), pt.y()});
     }
-}
 
-void ControlComponent::OnPlanningTrajectoryChunk(const simple_middleware::Message& msg) {
-    if (msg.data.size() < 16) {
-        static int error_count = 0;
-        if (error_count++ % 100 == 0) {
-            simple_middleware::Logger::Warn("Control: Trajectory chunk too small: " + std::to_string(msg.data.size()) + " bytes");
-        }
-        return;
-    }
-    
-    const uint32_t* header = reinterpret_cast<const uint32_t*>(msg.data.data());
-    uint32_t frame_id = ntohl(header[0]);
-    uint32_t chunk_id = ntohl(header[1]);
-    uint32_t total_chunks = ntohl(header[2]);
-    uint32_t chunk_size = ntohl(header[3]);
-    
-    if (msg.data.size() != 16 + chunk_size) {
-        static int error_count = 0;
-        if (error_count++ % 100 == 0) {
-            simple_middleware::Logger::Warn("Control: Trajectory chunk size mismatch: expected " + std::to_string(16 + chunk_size) 
-                + ", got " + std::to_string(msg.data.size()));
-        }
-        return;
-    }
-    
-    // 提取分片数据
-    std::string chunk_data = msg.data.substr(16, chunk_size);
-    
-    bool should_process = false;
-    std::string full_data;
-    
-    {
-        std::lock_guard<std::mutex> lock(trajectory_chunk_mutex_);
-        
-        // 获取或创建分片缓冲区
-        auto& buffer = trajectory_chunk_buffers_[frame_id];
-        buffer.frame_id = frame_id;
-        buffer.total_chunks = total_chunks;
-        buffer.last_update = std::chrono::steady_clock::now();
-        
-        // 确保 chunks 数组大小足够
-        if (buffer.chunks.size() < total_chunks) {
-            buffer.chunks.resize(total_chunks);
-        }
-        
-        // 存储分片数据
-        if (chunk_id < total_chunks) {
-            buffer.chunks[chunk_id] = chunk_data;
-        }
-        
-        // 检查是否所有分片都已收到
-        bool all_received = true;
-        for (size_t i = 0; i < total_chunks; ++i) {
-            if (buffer.chunks[i].empty()) {
-                all_received = false;
-                break;
-            }
-        }
-        
-        if (all_received) {
-            // 重组完整数据
-            full_data.reserve(total_chunks * chunk_data.size());
-            for (const auto& chunk : buffer.chunks) {
-                full_data += chunk;
-            }
-            
-            should_process = true;
-            trajectory_chunk_buffers_.erase(frame_id);
-        }
-        
-        // 清理超时的分片缓冲区（1秒超时）
-        auto now = std::chrono::steady_clock::now();
-        for (auto it = trajectory_chunk_buffers_.begin(); it != trajectory_chunk_buffers_.end();) {
-            if (now - it->second.last_update > std::chrono::seconds(1)) {
-                simple_middleware::Logger::Warn("Control: Trajectory chunk timeout for frame " + std::to_string(it->first));
-                it = trajectory_chunk_buffers_.erase(it);
-            } else {
-                ++it;
+    if (!current_trajectory_.empty()) {
+        // 收到新轨迹，清除等待标志，激活自动驾驶模式
+        waiting_for_trajectory_ = false; // 收到轨迹后，清除等待标志
+        if (target_v >= 0) {
+            // 如果轨迹中包含速度信息 (来自 Planning 的 ACC 逻辑)，直接应用
+            current_car_state_.set_speed(target_v);
+        } else {
+            // 兼容旧逻辑：如果车没速度，给一个默认启动速度
+            if (current_car_state_.speed() < 1.0) {
+                 current_car_state_.set_speed(auto_engage_speed_);
             }
         }
-    }
-    
-    // 在锁外处理完整数据
-    if (should_process) {
-        simple_middleware::Logger::Info("Control: Reassembled trajectory from " + std::to_string(total_chunks) + " chunks");
-        // 构造完整的 Message 并调用 OnPlanningTrajectory
-        simple_middleware::Message full_msg("planning/trajectory", full_data);
-        full_msg.timestamp = msg.timestamp;
-        OnPlanningTrajectory(full_msg);
+        // 规划以 10Hz 下发轨迹，INFO 级别每秒最多输出一次
+        LOG_EVERY_MS(INFO, "Control", 1000) << "Received trajectory with " << current_trajectory_.size()
+            << " points. Target V: " << target_v;
     }
 }
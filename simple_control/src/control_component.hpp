@@ -2,14 +2,15 @@
 
 #include <common_msgs/visualizer_data.pb.h>
 #include <simple_middleware/pub_sub_middleware.hpp>
+#include <simple_middleware/topics.hpp>
 #include <simple_middleware/status_reporter.hpp>
+#include <simple_middleware/trace.hpp>
 #include <thread>
 #include <atomic>
 #include <mutex>
 #include <string>
 #include <memory>
 #include <vector>
-#include <unordered_map>
 #include <chrono>
 
 class ControlComponent {
@@ -29,9 +30,8 @@ public:
 private:
     void RunLoop();
     void OnControlMessage(const simple_middleware::Message& msg);
-    void OnPlanningTrajectory(const simple_middleware::Message& msg);
-    void OnPlanningTrajectoryChunk(const simple_middleware::Message& msg);
-    void OnSimulatorState(const simple_middleware::Message& msg); // New
+    void OnPlanningTrajectory(const senseauto::demo::Trajectory& traj);
+    void OnEgoState(const senseauto::demo::EgoState& ego);
     
     // 纯追踪算法 (Pure Pursuit)
     void ComputePurePursuitSteering(double dt);
@@ -57,20 +57,12 @@ private:
 
     // 接收到的规划轨迹
     std::vector<std::pair<double, double>> current_trajectory_;
+    // 当前轨迹的链路追踪上下文，发布控制指令时沿用
+    senseauto::demo::TraceContext trajectory_trace_;
     
     // 手动控制模式标志
     bool manual_control_mode_ = false;
     
-    // 轨迹分片重组缓冲区
-    struct TrajectoryChunkBuffer {
-        uint32_t frame_id = 0;
-        uint32_t total_chunks = 0;
-        std::vector<std::string> chunks;
-        std::chrono::steady_clock::time_point last_update;
-    };
-    std::unordered_map<uint32_t, TrajectoryChunkBuffer> trajectory_chunk_buffers_;
-    std::mutex trajectory_chunk_mutex_;
-    
     // 等待规划轨迹标志（收到 set_target 后，等待 Planning 生成轨迹）
     bool waiting_for_trajectory_ = false;
     
@@ -83,4 +75,5 @@ private:
     double auto_engage_speed_ = 5.0;
 
     std::unique_ptr<simple_middleware::StatusReporter> status_reporter_;
+    simple_middleware::LoopMonitor* control_loop_ = nullptr;  // 10Hz 控制循环的时序统计
 };
@@ -56,7 +56,7 @@ void DaemonServer::Init() {
     auto& middleware = simple_middleware::PubSubMiddleware::getInstance();
     
     // 订阅控制指令
-    middleware.subscribe("system/command", 
+    middleware.subscribe(simple_middleware::topics::kSystemCommand, 
         [this](const simple_middleware::Message& msg) {
             this->OnCommand(msg);
         });
@@ -183,11 +183,8 @@ void DaemonServer::SendResponse(const std::string& request_id, bool success, con
     resp.set_success(success);
     resp.set_message(message);
 
-    std::string payload;
-    resp.SerializeToString(&payload);
-    
     auto& middleware = simple_middleware::PubSubMiddleware::getInstance();
-    middleware.publish("system/response", payload);
+    middleware.publish(simple_middleware::topics::kSystemResponse, resp);
 }
 
 void DaemonServer::MonitorLoop() {
@@ -227,9 +224,7 @@ void DaemonServer::MonitorLoop() {
             }
         }
         
-        std::string payload;
-        status_msg.SerializeToString(&payload);
-        middleware.publish("system/status", payload);
+        middleware.publish(simple_middleware::topics::kSystemStatus, status_msg);
 
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <simple_middleware/pub_sub_middleware.hpp>
+#include <simple_middleware/topics.hpp>
 #include <common_msgs/daemon.pb.h>
 #include <map>
 #include <string>
@@ -2,15 +2,14 @@
 #include <iostream>
 #include <chrono>
 #include <cmath>
-#include "json11.hpp"
+#include <string_view>
 #include <simple_middleware/logger.hpp>
+#include <simple_middleware/json_writer.hpp>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-using namespace json11;
-
 MapComponent::MapComponent() : running_(false) {
     status_reporter_ = std::make_unique<simple_middleware::StatusReporter>("MapNode");
 }
@@ -41,62 +40,46 @@ void MapComponent::Stop() {
 
 void MapComponent::RunLoop() {
     auto& middleware = simple_middleware::PubSubMiddleware::getInstance();
+    std::string json_string;  // 序列化缓冲区，各周期复用
     
     while (running_) {
         // 低频发布地图数据 (1Hz)
         {
             std::lock_guard<std::mutex> lock(state_mutex_);
             
-            std::vector<Json> lanes_json;
-            for (const auto& lane : map_data_.lanes()) {
-                // 中心线
-                std::vector<Json> center_line_json;
-                for (const auto& p : lane.center_line()) {
-                    center_line_json.push_back(Json::object {
-                        { "x", p.x() },
-                        { "y", p.y() },
-                        { "z", p.z() }
-                    });
+            json_string.clear();
+            simple_middleware::JsonWriter w(&json_string);
+            auto write_points = [&w](const char* name, const auto& points) {
+                w.key(name);
+                w.beginArray();
+                for (const auto& p : points) {
+                    w.beginObject();
+                    w.field("x", p.x());
+                    w.field("y", p.y());
+                    w.field("z", p.z());
+                    w.endObject();
                 }
-                
-                // 左边界
-                std::vector<Json> left_boundary_json;
-                for (const auto& p : lane.left_boundary()) {
-                    left_boundary_json.push_back(Json::object {
-                        { "x", p.x() },
-                        { "y", p.y() },
-                        { "z", p.z() }
-                    });
-                }
-                
-                // 右边界
-                std::vector<Json> right_boundary_json;
-                for (const auto& p : lane.right_boundary()) {
-                    right_boundary_json.push_back(Json::object {
-                        { "x", p.x() },
-                        { "y", p.y() },
-                        { "z", p.z() }
-                    });
-                }
-                
-                lanes_json.push_back(Json::object {
-                    { "id", (int)lane.id() },
-                    { "center_line", Json(center_line_json) },
-                    { "left_boundary", Json(left_boundary_json) },
-                    { "right_boundary", Json(right_boundary_json) },
-                    { "width", lane.width() },
-                    { "left_lane_id", lane.left_lane_id() },
-                    { "right_lane_id", lane.right_lane_id() },
-                    { "type", lane.type() }
-                });
-            }
-
-            Json map_json = Json::object {
-                { "lanes", Json(lanes_json) },
-                { "type", "map_data" }
+                w.endArray();
             };
-
-            std::string json_string = map_json.dump();
+            
+            w.beginObject();
+            w.key("lanes");
+            w.beginArray();
+            for (const auto& lane : map_data_.lanes()) {
+                w.beginObject();
+                w.field("id", static_cast<int>(lane.id()));
+                write_points("center_line", lane.center_line());       // 中心线
+                write_points("left_boundary", lane.left_boundary());   // 左边界
+                write_points("right_boundary", lane.right_boundary()); // 右边界
+                w.field("width", lane.width());
+                w.field("left_lane_id", lane.left_lane_id());
+                w.field("right_lane_id", lane.right_lane_id());
+                w.field("type", lane.type());
+                w.endObject();
+            }
+            w.endArray();
+            w.field("type", "map_data");
+            w.endObject();
             
             // 【修复】UDP 包大小限制：MTU 通常是 1500 字节，减去 IP/UDP 头约 100 字节，实际可用约 1400 字节
             // 但为了安全，我们使用 1200 字节作为分片大小
@@ -108,7 +91,7 @@ void MapComponent::RunLoop() {
             bool published = false;
             if (json_string.size() <= effective_chunk_size) {
                 // 数据包足够小，直接发送
-                published = middleware.publish("visualizer/map", json_string);
+                published = middleware.publishSerialized(simple_middleware::topics::kMap, json_string);
             } else {
                 // 数据包太大，需要分片发送
                 // 使用二进制分片协议：frame_id(4) + chunk_id(4) + total_chunks(4) + chunk_size(4) + chunk_data
@@ -135,7 +118,7 @@ void MapComponent::RunLoop() {
                     // 写入数据
                     std::memcpy(&chunk_packet[16], json_string.data() + chunk_start, chunk_size);
                     
-                    bool chunk_published = middleware.publish("visualizer/map/chunk", chunk_packet);
+                    bool chunk_published = middleware.publish(simple_middleware::topics::kMapChunk, chunk_packet);
                     if (chunk_id == 0) {
                         published = chunk_published; // 使用第一个分片的发布结果
                     }
@@ -146,24 +129,21 @@ void MapComponent::RunLoop() {
                     }
                 }
                 
-                static int chunk_count = 0;
-                if (chunk_count++ % 10 == 0 || chunk_count == 1) {
-                    simple_middleware::Logger::Info("Map: Published map data in " + std::to_string(total_chunks) 
-                        + " chunks, total_size=" + std::to_string(json_string.size()) + " bytes");
-                }
+                LOG_EVERY_N(INFO, "Map", 10) << "Published map data in " << total_chunks
+                    << " chunks, total_size=" << json_string.size() << " bytes";
             }
             
-            static int pub_count = 0;
-            if (pub_count++ % 10 == 0 || pub_count == 1) {
-                simple_middleware::Logger::Info("Map: Published map data: " + std::to_string(map_data_.lanes_size()) 
-                    + " lanes, size=" + std::to_string(json_string.size()) + " bytes, result=" 
-                    + (published ? "success" : "failed"));
-                // 打印JSON的前100个字符用于调试
-                if (pub_count == 1 && json_string.size() > 0) {
-                    std::string preview = json_string.substr(0, std::min(100UL, json_string.size()));
-                    simple_middleware::Logger::Debug("Map: JSON preview: " + preview + "...");
-                }
-            }
+            LOG_EVERY_N(INFO, "Map", 10) << "Published map data: " << map_data_.lanes_size() << " lanes, size="
+                << json_string.size() << " bytes, result=" << (published ? "success" : "failed");
+            // 第一次发布时打印 JSON 的前 100 个字符用于调试
+            LOG_FIRST_N(DEBUG, "Map", 1) << "JSON preview: "
+                << std::string_view(json_string).substr(0, 100) << "...";
+
+            // protobuf 版本（map/data），供 Sensor 等需要车道几何的节点使用
+            bool proto_published = map_publisher_.publish(simple_middleware::topics::kMapData,
+                simple_middleware::topics::kMapDataChunk, map_serialized_);
+            LOG_EVERY_N(DEBUG, "Map", 10) << "Published map/data: " << map_serialized_.size() << " bytes, "
+                << map_publisher_.lastChunkCount() << " chunks, result=" << (proto_published ? "success" : "failed");
         }
         
         std::this_thread::sleep_for(std::chrono::seconds(1));
@@ -270,5 +250,6 @@ void MapComponent::GenerateLaneData() {
         right->set_z(0);
     }
     
+    map_data_.SerializeToString(&map_serialized_);
     simple_middleware::Logger::Info("Map: Generated " + std::to_string(map_data_.lanes_size()) + " lanes with boundaries.");
 }
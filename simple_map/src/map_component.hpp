@@ -3,7 +3,9 @@
 #include <common_msgs/map_data.pb.h>
 #include <common_msgs/visualizer_data.pb.h>
 #include <simple_middleware/pub_sub_middleware.hpp>
+#include <simple_middleware/topics.hpp>
 #include <simple_middleware/status_reporter.hpp>
+#include <simple_middleware/chunked_transport.hpp>
 #include <thread>
 #include <atomic>
 #include <mutex>
@@ -29,6 +31,8 @@ private:
     std::mutex state_mutex_;
 
     senseauto::demo::MapData map_data_;
+    std::string map_serialized_;                           // map_data_ 的 protobuf 编码（静态地图，生成时编码一次）
+    simple_middleware::ChunkedPublisher map_publisher_;    // map/data 分片发布
 
     std::unique_ptr<simple_middleware::StatusReporter> status_reporter_;
 };
@@ -0,0 +1,122 @@
+#include "alloc_tracker.hpp"
+#include <cstdlib>
+#include <new>
+
+namespace simple_middleware {
+
+#if SIMPLE_TRACK_ALLOCATIONS
+
+namespace {
+
+// 必须是平凡类型：operator new 可能在线程初始化/退出阶段被调用，不能依赖 TLS 构造函数
+thread_local AllocCounters t_alloc_counters;
+
+inline void CountAlloc(size_t size) {
+    ++t_alloc_counters.allocs;
+    t_alloc_counters.bytes += size;
+}
+
+inline void CountFree(void* ptr) {
+    if (ptr) ++t_alloc_counters.frees;
+}
+
+void* AllocOrThrow(size_t size) {
+    CountAlloc(size);
+    // malloc(0) 可能返回 nullptr，operator new 要求返回唯一的非空指针
+    void* ptr = std::malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* AlignedAllocOrThrow(size_t size, std::align_val_t align) {
+    CountAlloc(size);
+    void* ptr = nullptr;
+    size_t alignment = static_cast<size_t>(align);
+    if (alignment < sizeof(void*)) alignment = sizeof(void*);
+    if (posix_memalign(&ptr, alignment, size ? size : 1) != 0) throw std::bad_alloc();
+    return ptr;
+}
+
+}  // namespace
+
+bool AllocTracker::IsEnabled() {
+    return true;
+}
+
+AllocCounters AllocTracker::ThreadCounters() {
+    return t_alloc_counters;
+}
+
+#else
+
+bool AllocTracker::IsEnabled() {
+    return false;
+}
+
+AllocCounters AllocTracker::ThreadCounters() {
+    return AllocCounters();
+}
+
+#endif  // SIMPLE_TRACK_ALLOCATIONS
+
+}  // namespace simple_middleware
+
+#if SIMPLE_TRACK_ALLOCATIONS
+
+// ---------------- 全局 operator new / delete 替换 ----------------
+// 定义在共享库中即可覆盖 libstdc++ 的默认实现（动态链接时先于 libstdc++ 解析）
+
+using simple_middleware::AllocOrThrow;
+using simple_middleware::AlignedAllocOrThrow;
+using simple_middleware::CountFree;
+
+void* operator new(size_t size) { return AllocOrThrow(size); }
+void* operator new[](size_t size) { return AllocOrThrow(size); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return AllocOrThrow(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return AllocOrThrow(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(size_t size, std::align_val_t align) { return AlignedAllocOrThrow(size, align); }
+void* operator new[](size_t size, std::align_val_t align) { return AlignedAllocOrThrow(size, align); }
+
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    try {
+        return AlignedAllocOrThrow(size, align);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    try {
+        return AlignedAllocOrThrow(size, align);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* ptr) noexcept { CountFree(ptr); std::free(ptr); }
+void operator delete[](void* ptr) noexcept { CountFree(ptr); std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { CountFree(ptr); std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { CountFree(ptr); std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { CountFree(ptr); std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { CountFree(ptr); std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { CountFree(ptr); std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { CountFree(ptr); std::free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { CountFree(ptr); std::free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { CountFree(ptr); std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { CountFree(ptr); std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { CountFree(ptr); std::free(ptr); }
+
+#endif  // SIMPLE_TRACK_ALLOCATIONS
@@ -0,0 +1,50 @@
+/*
+ * @Desc: 堆分配计数 - 统计每个线程的 new/delete 次数和字节数，归属到剖析作用域 / 循环周期
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief 编译期开关：以 -DSIMPLE_TRACK_ALLOCATIONS=1 编译 simple_middleware 时，
+ *        库内替换全局 operator new / delete，在线程本地计数器上累加（不加锁、无原子操作）。
+ *        默认关闭，关闭时不替换 operator new，下面的接口返回全 0。
+ *        开关只影响 simple_middleware 库本身的编译，使用方头文件不需要定义该宏
+ */
+#ifndef SIMPLE_TRACK_ALLOCATIONS
+#define SIMPLE_TRACK_ALLOCATIONS 0
+#endif
+
+namespace simple_middleware {
+
+/**
+ * @brief 线程自启动以来的分配计数
+ */
+struct AllocCounters {
+    uint64_t allocs = 0;  // operator new 调用次数
+    uint64_t frees = 0;   // operator delete 调用次数（不含 nullptr）
+    uint64_t bytes = 0;   // 申请的字节数（不扣除释放）
+};
+
+/**
+ * @brief 分配计数查询
+ * @details 计数按线程独立累加，取两次快照的差即可得到一段代码内的分配次数：
+ *          PROFILE_SCOPE 会把差值写入 trace 事件的 args，LoopMonitor 按循环周期统计并随 system/loop_stats 上报
+ */
+class AllocTracker {
+public:
+    /**
+     * @brief simple_middleware 是否以 SIMPLE_TRACK_ALLOCATIONS=1 编译
+     */
+    static bool IsEnabled();
+
+    /**
+     * @brief 当前线程的计数快照
+     */
+    static AllocCounters ThreadCounters();
+};
+
+}  // namespace simple_middleware
@@ -0,0 +1,274 @@
+/*
+ * @Desc: protobuf Arena 基准测试 - 每帧消息在堆上构造 vs 在复用的 MessageArena 上构造
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ *
+ * 以真值帧 FrameData（车辆状态 + 障碍物列表）为负载，覆盖各节点每个周期的三种典型操作：
+ *   parse：收到真值后解码（Visualizer / Perception / Prediction 等订阅者）
+ *   copy ：拷贝一份最新真值再处理（Sensor::RunLoop）
+ *   build：构造消息并序列化发布（Perception 的 ObstacleArray / Detection2DArray）
+ * 每种操作分别用栈上的新消息（改造前的写法，每个 Obstacle / Point3D 单独分配）和 MessageArena
+ * （每次 reset() 后 create()）实现，比较耗时（p50/p99）和每次操作的堆分配次数
+ * （需以 SIMPLE_TRACK_ALLOCATIONS=1 编译库）。
+ *
+ * 使用方法：
+ *   ./arena_bench [--obstacles 1,100,10000] [--iterations 2000] [--out arena_bench.json]
+ *
+ * 每个用例的迭代次数按障碍物数缩减（总元素数约为 iterations * 100），保证大负载用例耗时可控。
+ */
+
+#include "message_arena.hpp"
+#include "alloc_tracker.hpp"
+#include "json_writer.hpp"
+#include "latency_histogram.hpp"
+#include "logger.hpp"
+#include <common_msgs/visualizer_data.pb.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace simple_middleware;
+
+namespace {
+
+struct BenchOptions {
+    std::vector<int> obstacles{1, 100, 10000};
+    uint64_t iterations = 2000;  // 100 个障碍物时的迭代次数
+    std::string out = "arena_bench.json";
+};
+
+struct CaseResult {
+    std::string name;       // parse_frame_data / copy_frame_data / build_frame_data
+    std::string allocator;  // heap / arena
+    int obstacles = 0;
+    uint64_t iterations = 0;
+    size_t bytes = 0;       // 序列化后的消息大小
+    LatencySummary latency;
+    double allocs_per_op = -1.0;  // 未开启分配计数时为 -1
+};
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 填充一帧真值，与 SimulatorCore 发布的字段一致
+void FillFrame(senseauto::demo::FrameData* frame, int obstacle_count, int frame_id) {
+    frame->set_frame_id(frame_id);
+    frame->set_timestamp(1766100000000LL + frame_id);
+    auto* car = frame->mutable_car_state();
+    car->mutable_position()->set_x(123.456789);
+    car->mutable_position()->set_y(-45.678912);
+    car->set_heading(0.785398);
+    car->set_speed(12.5);
+    car->set_steering_angle(-0.0523);
+    const char* types[] = {"car", "pedestrian", "cone"};
+    for (int i = 0; i < obstacle_count; ++i) {
+        auto* obs = frame->add_obstacles();
+        obs->set_id(i);
+        obs->set_type(types[i % 3]);
+        obs->mutable_position()->set_x(100.0 + i * 0.731);
+        obs->mutable_position()->set_y(-20.0 + (i % 17) * 1.37);
+        obs->set_length(4.5);
+        obs->set_width(1.8);
+        obs->set_height(1.5);
+        obs->set_heading((i % 360) * 0.0174533);
+    }
+}
+
+template <typename Fn>
+CaseResult RunCase(const std::string& name, const std::string& allocator, int obstacles, uint64_t iterations,
+                   Fn&& op) {
+    CaseResult r;
+    r.name = name;
+    r.allocator = allocator;
+    r.obstacles = obstacles;
+    r.iterations = iterations;
+
+    // 热身：让 Arena 初始块长到稳定大小，避免首轮分配计入统计
+    for (int i = 0; i < 3; ++i) r.bytes = op(i);
+
+    LatencyHistogram histogram;
+    AllocCounters before = AllocTracker::ThreadCounters();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        int64_t t0 = NowNs();
+        r.bytes = op(static_cast<int>(i));
+        histogram.record(static_cast<uint64_t>(NowNs() - t0));
+    }
+    AllocCounters after = AllocTracker::ThreadCounters();
+
+    r.latency = histogram.summary();
+    if (AllocTracker::IsEnabled()) {
+        r.allocs_per_op = static_cast<double>(after.allocs - before.allocs) / iterations;
+    }
+    return r;
+}
+
+std::vector<int> ParseIntList(const std::string& value) {
+    std::vector<int> out;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(std::stoi(item));
+    }
+    return out;
+}
+
+void PrintUsage() {
+    std::cerr << "Usage: arena_bench [--obstacles 1,100,10000] [--iterations N] [--out FILE|-]\n";
+}
+
+bool ParseArgs(int argc, char* argv[], BenchOptions* options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--obstacles") {
+            options->obstacles = ParseIntList(value);
+        } else if (arg == "--iterations") {
+            options->iterations = std::stoull(value);
+        } else if (arg == "--out") {
+            options->out = value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void WriteResult(JsonWriter& w, const CaseResult& r) {
+    w.beginObject();
+    w.field("case", r.name);
+    w.field("allocator", r.allocator);
+    w.field("obstacles", r.obstacles);
+    w.field("iterations", r.iterations);
+    w.field("bytes", r.bytes);
+    w.field("p50_ns", r.latency.p50);
+    w.field("p99_ns", r.latency.p99);
+    w.field("max_ns", r.latency.max);
+    if (r.allocs_per_op >= 0) {
+        w.field("allocs_per_op", r.allocs_per_op);
+    }
+    w.endObject();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!ParseArgs(argc, argv, &options)) {
+        PrintUsage();
+        return 1;
+    }
+    if (!AllocTracker::IsEnabled()) {
+        LOG_INFO("ArenaBench") << "库未以 SIMPLE_TRACK_ALLOCATIONS=1 编译，不统计堆分配次数";
+    }
+
+    std::vector<CaseResult> results;
+    auto report = [&](const CaseResult& heap, const CaseResult& arena) {
+        for (const CaseResult* r : {&heap, &arena}) {
+            LOG_INFO("ArenaBench") << r->name << " obstacles=" << r->obstacles << " " << r->allocator
+                << ": p50=" << r->latency.p50 / 1000.0 << "us p99=" << r->latency.p99 / 1000.0 << "us, "
+                << r->bytes << " bytes"
+                << (r->allocs_per_op >= 0 ? ", allocs/op=" + std::to_string(r->allocs_per_op) : std::string());
+            results.push_back(*r);
+        }
+        LOG_INFO("ArenaBench") << heap.name << " obstacles=" << heap.obstacles << " speedup(p50)="
+            << static_cast<double>(heap.latency.p50) / std::max<uint64_t>(arena.latency.p50, 1) << "x";
+    };
+
+    for (int obstacles : options.obstacles) {
+        uint64_t iterations = std::max<uint64_t>(10, options.iterations * 100 / std::max(obstacles, 100));
+
+        senseauto::demo::FrameData source;
+        FillFrame(&source, obstacles, 0);
+        std::string wire;
+        source.SerializeToString(&wire);
+
+        MessageArena arena;
+        std::string out;
+
+        // parse：每次收到真值都解码成一个新消息
+        CaseResult heap = RunCase("parse_frame_data", "heap", obstacles, iterations, [&](int) {
+            senseauto::demo::FrameData frame;
+            frame.ParseFromString(wire);
+            return frame.obstacles_size() == source.obstacles_size() ? wire.size() : 0;
+        });
+        CaseResult fast = RunCase("parse_frame_data", "arena", obstacles, iterations, [&](int) {
+            arena.reset();
+            auto* frame = arena.create<senseauto::demo::FrameData>();
+            frame->ParseFromString(wire);
+            return frame->obstacles_size() == source.obstacles_size() ? wire.size() : 0;
+        });
+        if (heap.bytes != wire.size() || fast.bytes != wire.size()) {
+            LOG_ERROR("ArenaBench") << "obstacles=" << obstacles << ": 解码结果不完整";
+            return 1;
+        }
+        report(heap, fast);
+
+        // copy：拷贝一份最新真值
+        heap = RunCase("copy_frame_data", "heap", obstacles, iterations, [&](int) {
+            senseauto::demo::FrameData frame = source;
+            return frame.ByteSizeLong();
+        });
+        fast = RunCase("copy_frame_data", "arena", obstacles, iterations, [&](int) {
+            arena.reset();
+            auto* frame = arena.create<senseauto::demo::FrameData>();
+            *frame = source;
+            return frame->ByteSizeLong();
+        });
+        report(heap, fast);
+
+        // build：构造新消息并序列化到复用的缓冲区
+        heap = RunCase("build_frame_data", "heap", obstacles, iterations, [&](int frame_id) {
+            senseauto::demo::FrameData frame;
+            FillFrame(&frame, obstacles, frame_id);
+            frame.SerializeToString(&out);
+            return out.size();
+        });
+        fast = RunCase("build_frame_data", "arena", obstacles, iterations, [&](int frame_id) {
+            arena.reset();
+            auto* frame = arena.create<senseauto::demo::FrameData>();
+            FillFrame(frame, obstacles, frame_id);
+            frame->SerializeToString(&out);
+            return out.size();
+        });
+        report(heap, fast);
+        LOG_INFO("ArenaBench") << "obstacles=" << obstacles << " arena block=" << arena.blockSize() << " bytes";
+    }
+
+    std::string report_json;
+    JsonWriter w(&report_json);
+    w.beginObject();
+    w.field("benchmark", "arena_bench");
+    w.field("timestamp", static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count()));
+    w.field("alloc_tracking", AllocTracker::IsEnabled());
+    w.key("results");
+    w.beginArray();
+    for (const auto& r : results) {
+        WriteResult(w, r);
+    }
+    w.endArray();
+    w.endObject();
+
+    if (options.out == "-") {
+        std::cout << report_json << std::endl;
+    } else {
+        std::ofstream out_file(options.out);
+        if (!out_file) {
+            LOG_ERROR("ArenaBench") << "无法写入结果文件: " << options.out;
+            return 1;
+        }
+        out_file << report_json << std::endl;
+        LOG_INFO("ArenaBench") << "结果已写入 " << options.out << "（" << results.size() << " 个用例）";
+    }
+    return 0;
+}
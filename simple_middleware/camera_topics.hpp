@@ -0,0 +1,61 @@
+/*
+ * @Desc: 多相机话题 - 每路相机的话题名在运行期按相机名拼出，发布端 (Sensor) 和订阅端 (Perception / Visualizer) 共用
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include "topic.hpp"
+#include "json11.hpp"
+#include "common_msgs/sensor_data.pb.h"
+
+#include <string>
+#include <vector>
+
+namespace simple_middleware {
+
+/**
+ * @brief 一路相机的话题：sensor/camera/<name>，压缩后仍超过单包的帧走 sensor/camera/<name>/chunk
+ * @details 前视相机即 topics::kCameraFront / kCameraFrontChunk。话题描述符只引用成员里的名字，
+ *          CameraTopics 本身不可拷贝/移动（需要放进容器时用 unique_ptr 持有）
+ */
+struct CameraTopics {
+    explicit CameraTopics(std::string camera_name)
+        : name(std::move(camera_name)),
+          topic_name("sensor/camera/" + name),
+          chunk_topic_name(topic_name + "/chunk") {}
+
+    CameraTopics(const CameraTopics&) = delete;
+    CameraTopics& operator=(const CameraTopics&) = delete;
+
+    Topic<senseauto::demo::CameraFrame> topic() const { return {topic_name, kPriorityBestEffort}; }
+    Topic<std::string> chunk_topic() const { return {chunk_topic_name, kPriorityBestEffort}; }
+
+    const std::string name;
+    const std::string topic_name;        // sensor/camera/<name>
+    const std::string chunk_topic_name;  // sensor/camera/<name>/chunk
+};
+
+/**
+ * @brief Sensor 配置（config/sensor.json）中启用的相机名，顺序与 cameras 数组一致
+ * @details 规则与 Sensor 加载相机配置相同：没有 cameras 数组时只有顶层参数描述的 "front"，
+ *          enabled 为 false 的跳过，没写 name 的按启用顺序命名为 camera<N>
+ */
+inline std::vector<std::string> EnabledCameraNames(const json11::Json& sensor_config) {
+    const json11::Json& cameras = sensor_config["cameras"];
+    if (!cameras.is_array()) {
+        return {"front"};
+    }
+    std::vector<std::string> names;
+    for (const auto& item : cameras.array_items()) {
+        if (item["enabled"].is_bool() && !item["enabled"].bool_value()) {
+            continue;
+        }
+        names.push_back(item["name"].is_string() ? item["name"].string_value()
+                                                 : "camera" + std::to_string(names.size()));
+    }
+    return names;
+}
+
+}  // namespace simple_middleware
@@ -0,0 +1,139 @@
+/*
+ * @Desc: 大消息分片收发实现
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#include "chunked_transport.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+#include <thread>
+
+namespace simple_middleware {
+
+namespace {
+
+// 单帧分片数上限（约 1GB），超过视为格式错误，避免按错误的 total_chunks 分配内存
+constexpr uint32_t kMaxTotalChunks = 1u << 20;
+
+void WriteHeader(char* dst, uint32_t frame_id, uint32_t chunk_id, uint32_t total_chunks, uint32_t chunk_size) {
+    uint32_t header[4] = {htonl(frame_id), htonl(chunk_id), htonl(total_chunks), htonl(chunk_size)};
+    std::memcpy(dst, header, sizeof(header));
+}
+
+}  // namespace
+
+ChunkedPublisher::ChunkedPublisher(size_t chunks_per_burst, std::chrono::microseconds burst_interval)
+    : chunks_per_burst_(std::max<size_t>(chunks_per_burst, 1)), burst_interval_(burst_interval) {
+    packet_.reserve(kHeaderSize + kMaxChunkPayload);
+}
+
+bool ChunkedPublisher::publishChunks(const Topic<std::string>& chunk_topic, std::string_view data) {
+    auto& middleware = PubSubMiddleware::getInstance();
+    size_t total_chunks = std::max<size_t>(1, (data.size() + kMaxChunkPayload - 1) / kMaxChunkPayload);
+    uint32_t frame_id = ++frame_id_counter_;
+    last_chunk_count_ = total_chunks;
+
+    bool first_result = false;
+    for (size_t chunk_id = 0; chunk_id < total_chunks; ++chunk_id) {
+        size_t chunk_start = chunk_id * kMaxChunkPayload;
+        size_t chunk_size = std::min(kMaxChunkPayload, data.size() - chunk_start);
+
+        // 分片包：header + data（resize 不超过已预留的容量，不重新分配）
+        packet_.resize(kHeaderSize + chunk_size);
+        WriteHeader(&packet_[0], frame_id, static_cast<uint32_t>(chunk_id), static_cast<uint32_t>(total_chunks),
+                    static_cast<uint32_t>(chunk_size));
+        std::memcpy(&packet_[kHeaderSize], data.data() + chunk_start, chunk_size);
+
+        bool result = middleware.publish(chunk_topic, packet_);
+        if (chunk_id == 0) {
+            first_result = result;
+        }
+
+        // 每批分片之间暂停，让其他数据有机会发送
+        if ((chunk_id + 1) % chunks_per_burst_ == 0 && chunk_id + 1 < total_chunks
+            && burst_interval_.count() > 0) {
+            std::this_thread::sleep_for(burst_interval_);
+        }
+    }
+    return first_result;
+}
+
+ChunkAssembler::ChunkAssembler(std::chrono::milliseconds timeout) : timeout_(timeout) {}
+
+bool ChunkAssembler::add(std::string_view packet, std::string* out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    dropExpired(now);
+
+    if (packet.size() < ChunkedPublisher::kHeaderSize) {
+        ++malformed_packets_;
+        return false;
+    }
+    uint32_t header[4];
+    std::memcpy(header, packet.data(), sizeof(header));
+    uint32_t frame_id = ntohl(header[0]);
+    uint32_t chunk_id = ntohl(header[1]);
+    uint32_t total_chunks = ntohl(header[2]);
+    uint32_t chunk_size = ntohl(header[3]);
+    if (packet.size() != ChunkedPublisher::kHeaderSize + chunk_size || total_chunks == 0
+        || total_chunks > kMaxTotalChunks || chunk_id >= total_chunks) {
+        ++malformed_packets_;
+        return false;
+    }
+
+    auto& frame = pending_[frame_id];
+    if (frame.total_chunks != total_chunks) {
+        // 新帧（或发布端重启后复用了 frame_id）：重新开始收集
+        frame.total_chunks = total_chunks;
+        frame.received = 0;
+        frame.chunks.assign(total_chunks, std::string());
+        frame.has_chunk.assign(total_chunks, false);
+    }
+    frame.last_update = now;
+    if (!frame.has_chunk[chunk_id]) {
+        frame.chunks[chunk_id].assign(packet.data() + ChunkedPublisher::kHeaderSize, chunk_size);
+        frame.has_chunk[chunk_id] = true;
+        ++frame.received;
+    }
+    if (frame.received < frame.total_chunks) {
+        return false;
+    }
+
+    size_t total_size = 0;
+    for (const auto& chunk : frame.chunks) {
+        total_size += chunk.size();
+    }
+    out->clear();
+    out->reserve(total_size);
+    for (const auto& chunk : frame.chunks) {
+        out->append(chunk);
+    }
+    pending_.erase(frame_id);
+    return true;
+}
+
+void ChunkAssembler::dropExpired(std::chrono::steady_clock::time_point now) {
+    for (auto it = pending_.begin(); it != pending_.end();) {
+        if (now - it->second.last_update > timeout_) {
+            ++dropped_frames_;
+            it = pending_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+uint64_t ChunkAssembler::droppedFrames() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_frames_;
+}
+
+uint64_t ChunkAssembler::malformedPackets() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return malformed_packets_;
+}
+
+}  // namespace simple_middleware
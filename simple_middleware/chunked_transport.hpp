@@ -0,0 +1,138 @@
+/*
+ * @Desc: 大消息分片收发 - 超过单个 UDP 包上限的消息按分片协议拆包发布、按帧重组
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include "pub_sub_middleware.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace simple_middleware {
+
+/**
+ * @brief 分片发布器
+ * @details 分片协议（与相机、地图分片话题一致）：
+ *          frame_id(4) + chunk_id(4) + total_chunks(4) + chunk_size(4)，均为大端序，后接 chunk_size 字节数据。
+ *
+ *          消息不超过单包上限时直接发布到消息话题，否则拆成分片发布到分片话题。
+ *          每发出 chunks_per_burst 个分片暂停 burst_interval，避免瞬间塞满接收端的 socket 缓冲区、
+ *          挤掉其他节点的关键数据（如自车状态）。
+ *
+ *          非线程安全；分片包缓冲区在多次发布之间复用。
+ *
+ * @code
+ *   ChunkedPublisher publisher;  // 每个分片后暂停 1ms
+ *   publisher.publish(topics::kMapData, topics::kMapDataChunk, serialized);
+ * @endcode
+ */
+class ChunkedPublisher {
+public:
+    static constexpr size_t kHeaderSize = 16;
+    // MTU 约 1500 字节，留出 IP/UDP 头后按 1200 字节一个包；再减去话题名、分隔符和分片头
+    static constexpr size_t kMaxPacketSize = 1200;
+    static constexpr size_t kTopicOverhead = 50;
+    static constexpr size_t kMaxChunkPayload = kMaxPacketSize - kTopicOverhead - kHeaderSize;
+
+    /**
+     * @param chunks_per_burst 每批连续发送的分片数
+     * @param burst_interval 两批之间的暂停时间
+     */
+    explicit ChunkedPublisher(size_t chunks_per_burst = 1,
+                              std::chrono::microseconds burst_interval = std::chrono::milliseconds(1));
+
+    /**
+     * @brief 发布一条已序列化的消息，必要时分片
+     * @return 直接发布的结果，或第一个分片的发布结果
+     */
+    template <typename T>
+    bool publish(const Topic<T>& topic, const Topic<std::string>& chunk_topic, const std::string& data) {
+        if (data.size() <= kMaxChunkPayload) {
+            last_chunk_count_ = 0;
+            return PubSubMiddleware::getInstance().publishSerialized(topic, data);
+        }
+        return publishChunks(chunk_topic, data);
+    }
+
+    /**
+     * @brief 把数据拆成分片发布到分片话题（不论大小）
+     * @return 第一个分片的发布结果
+     */
+    bool publishChunks(const Topic<std::string>& chunk_topic, std::string_view data);
+
+    /**
+     * @brief 上一次发布拆出的分片数（直接发布时为 0）
+     */
+    size_t lastChunkCount() const { return last_chunk_count_; }
+
+private:
+    size_t chunks_per_burst_;
+    std::chrono::microseconds burst_interval_;
+    uint32_t frame_id_counter_ = 0;
+    size_t last_chunk_count_ = 0;
+    std::string packet_;  // 分片包缓冲区（复用）
+};
+
+/**
+ * @brief 分片重组器
+ * @details 按 frame_id 收集分片，集齐后按 chunk_id 顺序拼出完整数据。
+ *          分片可以乱序、重复到达；超过 timeout 没有收到新分片的帧被丢弃（丢包时不会无限累积）。
+ *          线程安全，可以直接在订阅回调中调用。
+ *
+ * @code
+ *   // 成员：simple_middleware::ChunkAssembler map_chunks_;
+ *   middleware.subscribe(topics::kMapDataChunk, [this](const Message& msg) {
+ *       std::string full;
+ *       if (map_chunks_.add(msg.data, &full)) OnMapData(full);
+ *   });
+ * @endcode
+ */
+class ChunkAssembler {
+public:
+    explicit ChunkAssembler(std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+
+    /**
+     * @brief 收到一个分片包
+     * @param packet 分片头 + 分片数据
+     * @param out 集齐一帧时写入完整数据
+     * @return 是否集齐了一帧
+     */
+    bool add(std::string_view packet, std::string* out);
+
+    /**
+     * @brief 因超时被丢弃的不完整帧数
+     */
+    uint64_t droppedFrames() const;
+
+    /**
+     * @brief 格式错误被忽略的分片包数
+     */
+    uint64_t malformedPackets() const;
+
+private:
+    struct PendingFrame {
+        uint32_t total_chunks = 0;
+        uint32_t received = 0;
+        std::vector<std::string> chunks;
+        std::vector<bool> has_chunk;
+        std::chrono::steady_clock::time_point last_update;
+    };
+
+    void dropExpired(std::chrono::steady_clock::time_point now);
+
+    std::chrono::milliseconds timeout_;
+    mutable std::mutex mutex_;
+    std::unordered_map<uint32_t, PendingFrame> pending_;  // frame_id -> 收集中的帧
+    uint64_t dropped_frames_ = 0;
+    uint64_t malformed_packets_ = 0;
+};
+
+}  // namespace simple_middleware
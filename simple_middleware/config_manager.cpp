@@ -1,4 +1,7 @@
 #include "config_manager.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <fstream>
 #include <sstream>
 
@@ -9,8 +12,14 @@ ConfigManager& ConfigManager::GetInstance() {
     return instance;
 }
 
-bool ConfigManager::Load(const std::string& module_name, const std::string& config_file_path) {
+bool ConfigManager::Load(const std::string& module_name, const std::string& default_file_path) {
     std::lock_guard<std::mutex> lock(mutex_);
+
+    std::string env_name = "SIMPLE_" + module_name + "_CONFIG";
+    std::transform(env_name.begin(), env_name.end(), env_name.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    const char* env_path = std::getenv(env_name.c_str());
+    const std::string config_file_path = env_path != nullptr && env_path[0] != '\0' ? env_path : default_file_path;
     
     std::ifstream file(config_file_path);
     if (!file.is_open()) {
@@ -29,7 +38,8 @@ bool ConfigManager::Load(const std::string& module_name, const std::string& conf
     }
 
     configs_[module_name] = json;
-    std::cout << "[ConfigManager] Loaded config for module: " << module_name << std::endl;
+    std::cout << "[ConfigManager] Loaded config for module: " << module_name << " (" << config_file_path << ")"
+              << std::endl;
     return true;
 }
 
@@ -14,7 +14,9 @@ public:
     
     // 加载指定模块的配置文件 (例如 "control" -> 加载 config/control.json)
     // base_path 可以指定配置文件所在的目录，默认为 "../config" (相对于 build/bin)
-    bool Load(const std::string& module_name, const std::string& config_file_path);
+    // 环境变量 SIMPLE_<MODULE>_CONFIG（如 SIMPLE_SENSOR_CONFIG）非空时改为加载它指定的文件，
+    // 读同一模块配置的各节点（例如 Sensor / Perception / Visualizer 读 sensor）一起切换
+    bool Load(const std::string& module_name, const std::string& default_file_path);
     
     // 获取整个配置对象
     json11::Json GetConfig(const std::string& module_name);
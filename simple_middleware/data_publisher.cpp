@@ -8,18 +8,72 @@
 #include <chrono>
 #include <sstream>
 #include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include <unistd.h>
 #include "logger.hpp"
 
 namespace simple_middleware {
 
-DataPublisher::DataPublisher(const std::string& topic, int interval_ms)
-    : topic_(topic)
-    , interval_ms_(interval_ms)
+namespace {
+
+int64_t SteadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 精确等待到绝对时刻：先粗睡到截止前 100us（内核调度精度有限），再让出 CPU 自旋到截止时刻
+void WaitUntilNs(int64_t deadline_ns, const std::atomic<bool>& running) {
+    constexpr int64_t kSpinWindowNs = 100000;
+    int64_t remaining = deadline_ns - SteadyNowNs();
+    if (remaining > 2 * kSpinWindowNs) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(remaining - kSpinWindowNs));
+    }
+    while (running && SteadyNowNs() < deadline_ns) {
+        std::this_thread::yield();
+    }
+}
+
+}  // namespace
+
+DataPublisher::DataPublisher(const std::string& topic, int interval_ms, PubSubMiddleware& middleware)
+    : middleware_(middleware)
+    , rate_hz_(interval_ms > 0 ? 1000.0 / interval_ms : 1.0)
+    , running_(false)
+    , finished_(false)
+    , message_count_(0) {
+    profile_.topics = {topic};
+    profile_.rate_hz = rate_hz_;
+    profile_.binary = false;
+    profile_.report_interval_ms = 0;
+    std::random_device rd;
+    publisher_id_ = rd() ^ static_cast<uint32_t>(getpid());
+    rng_.seed(publisher_id_);
+    LOG_DEBUG("DataPublisher") << "创建DataPublisher，主题: " << topic
+                               << ", 间隔: " << interval_ms << "ms";
+}
+
+DataPublisher::DataPublisher(const LoadProfile& profile, PubSubMiddleware& middleware)
+    : middleware_(middleware)
+    , profile_(profile)
+    , rate_hz_(profile.rate_hz)
     , running_(false)
-    , message_count_(0)
-    , sequence_(0) {
-    LOG_DEBUG("DataPublisher") << "创建DataPublisher，主题: " << topic_ 
-                               << ", 间隔: " << interval_ms_ << "ms";
+    , finished_(false)
+    , message_count_(0) {
+    if (profile_.topics.empty()) {
+        profile_.topics = {"test/load"};
+    }
+    profile_.burst_size = std::max<uint32_t>(profile_.burst_size, 1);
+    profile_.payload_pool_size = std::max<size_t>(profile_.payload_pool_size, 1);
+    profile_.size.min_bytes = std::max(profile_.size.min_bytes, LoadTestHeader::kSize);
+    profile_.size.max_bytes = std::max(profile_.size.max_bytes, profile_.size.min_bytes);
+    std::random_device rd;
+    publisher_id_ = rd() ^ static_cast<uint32_t>(getpid());
+    rng_.seed(publisher_id_);
+    LOG_DEBUG("DataPublisher") << "创建压测 DataPublisher，话题数: " << profile_.topics.size()
+                               << ", 速率: " << profile_.rate_hz << " Hz"
+                               << ", 负载: " << profile_.size.min_bytes << "~" << profile_.size.max_bytes << " B"
+                               << ", 突发: " << profile_.burst_size;
 }
 
 DataPublisher::~DataPublisher() {
@@ -33,12 +87,23 @@ bool DataPublisher::start() {
     }
 
     running_ = true;
+    finished_ = false;
     message_count_ = 0;
-    sequence_ = 0;
+    bytes_ = 0;
+    failures_ = 0;
+    late_ticks_ = 0;
+    max_lateness_ns_ = 0;
+    sequences_.assign(profile_.topics.size(), 0);
+    pool_cursor_ = 0;
+    if (profile_.binary) {
+        // 负载在启动前一次性生成好，发送路径上不做任何分配和格式化
+        buildPayloadPool();
+    }
 
     thread_ = std::make_unique<std::thread>(&DataPublisher::publishThread, this);
-    
-    LOG_INFO("DataPublisher") << "DataPublisher启动成功，主题: " << topic_;
+
+    LOG_INFO("DataPublisher") << "DataPublisher启动成功，主题: " << profile_.topics.front()
+                              << (profile_.topics.size() > 1 ? " 等 " + std::to_string(profile_.topics.size()) + " 个" : "");
     return true;
 }
 
@@ -48,63 +113,240 @@ void DataPublisher::stop() {
     }
 
     running_ = false;
-    
+
     if (thread_ && thread_->joinable()) {
         thread_->join();
     }
-    
+
     thread_.reset();
-    
-    LOG_INFO("DataPublisher") << "DataPublisher已停止，主题: " << topic_ 
-                              << ", 总共发布: " << message_count_ << " 条消息";
+
+    PublisherStats stats = getStats();
+    LOG_INFO("DataPublisher") << "DataPublisher已停止，主题: " << profile_.topics.front()
+                              << ", 总共发布: " << message_count_ << " 条消息"
+                              << ", 实测速率: " << stats.measured_rate_hz << " Hz";
 }
 
-void DataPublisher::publishThread() {
-    LOG_DEBUG("DataPublisher") << "发布线程启动，主题: " << topic_;
+void DataPublisher::setInterval(int interval_ms) {
+    if (interval_ms > 0) {
+        setRate(1000.0 / interval_ms);
+    }
+}
 
-    while (running_) {
-        // 生成测试数据
-        std::string data = generateTestData();
-        
-        // 发布消息
-        bool success = PubSubMiddleware::getInstance().publish(topic_, data);
-        
+int DataPublisher::getInterval() const {
+    double rate = rate_hz_;
+    return rate > 0 ? static_cast<int>(1000.0 / rate) : 0;
+}
+
+void DataPublisher::setRate(double rate_hz) {
+    rate_hz_ = rate_hz;
+}
+
+PublisherStats DataPublisher::getStats() const {
+    PublisherStats stats;
+    stats.messages = message_count_;
+    stats.bytes = bytes_;
+    stats.failures = failures_;
+    stats.late_ticks = late_ticks_;
+    stats.max_lateness_ns = max_lateness_ns_;
+    int64_t start_ns = start_ns_;
+    if (start_ns != 0) {
+        stats.elapsed_s = (SteadyNowNs() - start_ns) / 1e9;
+    }
+    if (stats.elapsed_s > 0) {
+        stats.measured_rate_hz = stats.messages / stats.elapsed_s;
+        stats.measured_mbps = stats.bytes / stats.elapsed_s / (1024.0 * 1024.0);
+    }
+    stats.window_rate_hz = window_rate_hz_;
+    return stats;
+}
+
+size_t DataPublisher::drawPayloadSize() {
+    const auto& dist = profile_.size;
+    switch (dist.kind) {
+        case PayloadSizeDistribution::kUniform:
+            return std::uniform_int_distribution<size_t>(dist.min_bytes, dist.max_bytes)(rng_);
+        case PayloadSizeDistribution::kLogUniform: {
+            double lo = std::log(static_cast<double>(dist.min_bytes));
+            double hi = std::log(static_cast<double>(dist.max_bytes));
+            double v = std::exp(std::uniform_real_distribution<double>(lo, hi)(rng_));
+            return std::clamp(static_cast<size_t>(v), dist.min_bytes, dist.max_bytes);
+        }
+        case PayloadSizeDistribution::kBimodal:
+            return std::bernoulli_distribution(dist.large_ratio)(rng_) ? dist.max_bytes : dist.min_bytes;
+        case PayloadSizeDistribution::kFixed:
+        default:
+            return dist.min_bytes;
+    }
+}
+
+void DataPublisher::buildPayloadPool() {
+    payload_pool_.clear();
+    payload_pool_.reserve(profile_.payload_pool_size);
+    std::uniform_int_distribution<int> byte_dist(0, 255);
+    for (size_t i = 0; i < profile_.payload_pool_size; ++i) {
+        std::string payload(drawPayloadSize(), '\0');
+        // 随机填充，避免负载可被压缩或被某些路径"优化"掉
+        for (size_t j = LoadTestHeader::kSize; j < payload.size(); ++j) {
+            payload[j] = static_cast<char>(byte_dist(rng_));
+        }
+        payload_pool_.push_back(std::move(payload));
+    }
+}
+
+void DataPublisher::publishOne(size_t topic_index) {
+    const std::string& topic = profile_.topics[topic_index];
+    uint64_t sequence = ++sequences_[topic_index];
+    int64_t send_ns = SteadyNowNs();
+
+    bool success = false;
+    size_t size = 0;
+    if (profile_.binary) {
+        std::string& payload = payload_pool_[pool_cursor_];
+        pool_cursor_ = (pool_cursor_ + 1) % payload_pool_.size();
+
+        LoadTestHeader header;
+        header.publisher_id = publisher_id_;
+        header.sequence = sequence;
+        header.send_ns = send_ns;
+        header.topic_index = static_cast<uint16_t>(topic_index);
+        header.payload_size = static_cast<uint32_t>(payload.size());
+        EncodeLoadTestHeader(header, &payload[0]);
+
+        size = payload.size();
+        success = middleware_.publish(topic, payload);
+    } else {
+        std::string data = generateTestData(topic, sequence, send_ns);
+        size = data.size();
+        success = middleware_.publish(topic, data);
         if (success) {
-            message_count_++;
-            LOG_DEBUG("DataPublisher") << "发布消息 #" << sequence_ 
-                                       << " 到主题 " << topic_ 
+            LOG_DEBUG("DataPublisher") << "发布消息 #" << sequence
+                                       << " 到主题 " << topic
                                        << ", 数据: " << data;
-        } else {
-            LOG_WARN("DataPublisher") << "发布消息失败，主题: " << topic_;
+        }
+    }
+
+    if (success) {
+        message_count_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(size, std::memory_order_relaxed);
+    } else {
+        failures_.fetch_add(1, std::memory_order_relaxed);
+        uint64_t failures = failures_.load(std::memory_order_relaxed);
+        if (failures <= 3 || failures % 1000 == 0) {
+            LOG_WARN("DataPublisher") << "发布消息失败，主题: " << topic << " (count=" << failures << ")";
+        }
+    }
+}
+
+void DataPublisher::reportRate(int64_t now_ns) {
+    // 每秒更新一次窗口速率
+    if (now_ns - window_start_ns_ >= 1000000000LL) {
+        uint64_t count = message_count_.load(std::memory_order_relaxed);
+        window_rate_hz_ = (count - window_start_count_) * 1e9 / static_cast<double>(now_ns - window_start_ns_);
+        window_start_ns_ = now_ns;
+        window_start_count_ = count;
+    }
+
+    if (profile_.report_interval_ms == 0 ||
+        now_ns - last_report_ns_ < static_cast<int64_t>(profile_.report_interval_ms) * 1000000LL) {
+        return;
+    }
+    last_report_ns_ = now_ns;
+    PublisherStats stats = getStats();
+    LOG_INFO("DataPublisher") << "目标 " << rate_hz_.load() << " Hz, 实测 " << stats.window_rate_hz
+                              << " Hz (平均 " << stats.measured_rate_hz << " Hz, " << stats.measured_mbps << " MB/s)"
+                              << ", 已发布 " << stats.messages << ", 失败 " << stats.failures
+                              << ", 滞后 " << stats.late_ticks << " 次 (最大 " << stats.max_lateness_ns / 1000 << " us)";
+}
+
+void DataPublisher::publishThread() {
+    LOG_DEBUG("DataPublisher") << "发布线程启动，主题: " << profile_.topics.front();
+
+    const int64_t start_ns = SteadyNowNs();
+    start_ns_ = start_ns;
+    window_start_ns_ = start_ns;
+    window_start_count_ = 0;
+    last_report_ns_ = start_ns;
+
+    const int64_t cycle_ns = static_cast<int64_t>(profile_.on_ms + profile_.off_ms) * 1000000LL;
+    const int64_t on_ns = static_cast<int64_t>(profile_.on_ms) * 1000000LL;
+    int64_t next_ns = start_ns;
+    size_t topic_cursor = 0;
+
+    while (running_) {
+        double rate = rate_hz_;
+        if (rate <= 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            next_ns = SteadyNowNs();
+            continue;
+        }
+        // 每个发送时刻发 burst_size 条，时刻间隔按平均速率拉长
+        const int64_t period_ns = static_cast<int64_t>(1e9 * profile_.burst_size / rate);
+
+        // 占空比：处于静默段时直接跳到下一个发送段的起点
+        if (on_ns > 0 && cycle_ns > on_ns) {
+            int64_t phase = (next_ns - start_ns) % cycle_ns;
+            if (phase >= on_ns) {
+                next_ns += cycle_ns - phase;
+            }
         }
 
-        // 等待指定间隔
-        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms_));
+        WaitUntilNs(next_ns, running_);
+        if (!running_) {
+            break;
+        }
+
+        int64_t now_ns = SteadyNowNs();
+        int64_t lateness = now_ns - next_ns;
+        if (lateness > period_ns) {
+            late_ticks_.fetch_add(1, std::memory_order_relaxed);
+            if (lateness > max_lateness_ns_) {
+                max_lateness_ns_ = lateness;
+            }
+            // 落后超过 1 秒说明本线程根本跟不上目标速率，放弃积压，避免恢复后瞬间狂发
+            if (lateness > 1000000000LL) {
+                next_ns = now_ns;
+            }
+        }
+
+        for (uint32_t i = 0; i < profile_.burst_size && running_; ++i) {
+            publishOne(topic_cursor);
+            topic_cursor = (topic_cursor + 1) % profile_.topics.size();
+            if (profile_.max_messages && message_count_ + failures_ >= profile_.max_messages) {
+                finished_ = true;
+                break;
+            }
+        }
+        if (finished_) {
+            break;
+        }
+
+        next_ns += period_ns;
+        reportRate(now_ns);
     }
 
-    LOG_DEBUG("DataPublisher") << "发布线程退出，主题: " << topic_;
+    LOG_DEBUG("DataPublisher") << "发布线程退出，主题: " << profile_.topics.front();
 }
 
-std::string DataPublisher::generateTestData() {
-    sequence_++;
-    
+std::string DataPublisher::generateTestData(const std::string& topic, uint64_t sequence, int64_t send_ns) {
     // 获取当前时间戳
     auto now = std::chrono::system_clock::now();
     auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
         now.time_since_epoch()).count();
-    
-    // 生成JSON格式的测试数据
+
+    // 生成JSON格式的测试数据（send_ns/publisher_id 供 TestSubscriber 统计延迟和丢包）
     std::ostringstream oss;
     oss << "{"
-        << "\"sequence\":" << sequence_ << ","
+        << "\"sequence\":" << sequence << ","
         << "\"timestamp\":" << timestamp << ","
-        << "\"topic\":\"" << topic_ << "\","
+        << "\"send_ns\":" << send_ns << ","
+        << "\"publisher_id\":" << publisher_id_ << ","
+        << "\"topic\":\"" << topic << "\","
         << "\"data\":{"
-        << "\"value\":" << (sequence_ % 100) << ","
-        << "\"status\":\"" << (sequence_ % 2 == 0 ? "ok" : "warning") << "\""
+        << "\"value\":" << (sequence % 100) << ","
+        << "\"status\":\"" << (sequence % 2 == 0 ? "ok" : "warning") << "\""
         << "}"
         << "}";
-    
+
     return oss.str();
 }
 
@@ -1,5 +1,5 @@
 /*
- * @Desc: 数据发布模块 - 定时发送测试数据
+ * @Desc: 数据发布模块 - 定时发送测试数据 / 压测流量生成
  * @Author: JacksonZhou
  * @Date: 2025/12/19
  */
@@ -7,25 +7,90 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <thread>
 #include <atomic>
 #include <memory>
+#include <random>
 #include "pub_sub_middleware.hpp"
+#include "load_test.hpp"
 
 namespace simple_middleware {
 
+/**
+ * @brief 负载大小分布
+ */
+struct PayloadSizeDistribution {
+    enum Kind {
+        kFixed,       // 固定 min_bytes
+        kUniform,     // [min_bytes, max_bytes] 均匀分布
+        kLogUniform,  // [min_bytes, max_bytes] 对数均匀分布（小包多、大包少）
+        kBimodal,     // 大部分为 min_bytes，large_ratio 比例为 max_bytes（如控制指令 + 偶发图像）
+    };
+
+    Kind kind = kFixed;
+    size_t min_bytes = 64;
+    size_t max_bytes = 64;
+    double large_ratio = 0.1;  // 仅 kBimodal 使用
+};
+
+/**
+ * @brief 压测流量配置
+ * @details 平均速率 rate_hz 由绝对截止时间保证：每个发送时刻 = 起始时刻 + n * 周期，
+ *          单次睡过头不会累积漂移，因此支持亚毫秒间隔（rate_hz > 1000）。
+ *          突发模式下每个时刻连续发送 burst_size 条，时刻间隔相应拉长，平均速率不变；
+ *          on_ms/off_ms 可以再叠加一个"发送 on_ms、静默 off_ms"的占空比。
+ */
+struct LoadProfile {
+    std::vector<std::string> topics;      // 轮流发布的话题（至少一个）
+    double rate_hz = 1.0;                 // 发送期间的平均速率（条/秒，所有话题合计）
+    PayloadSizeDistribution size;         // 负载大小分布（binary 模式有效）
+    uint32_t burst_size = 1;              // 每个发送时刻连续发送的条数
+    uint32_t on_ms = 0;                   // 占空比：发送时长，0 表示一直发送
+    uint32_t off_ms = 0;                  // 占空比：静默时长
+    size_t payload_pool_size = 64;        // 预生成的负载个数，发送时只改写消息头
+    uint64_t max_messages = 0;            // 发送条数上限，0 表示不限
+    bool binary = true;                   // true: LoadTestHeader + 填充；false: 兼容旧版的 JSON 文本
+    uint32_t report_interval_ms = 5000;   // 周期性输出实测速率，0 表示不输出
+};
+
+/**
+ * @brief 发布统计（实测值）
+ */
+struct PublisherStats {
+    uint64_t messages = 0;        // 发布成功的消息数
+    uint64_t bytes = 0;           // 发布成功的字节数
+    uint64_t failures = 0;        // 发布失败次数
+    uint64_t late_ticks = 0;      // 发送时刻已过期超过一个周期的次数（线程跟不上目标速率）
+    int64_t max_lateness_ns = 0;  // 最大滞后
+    double elapsed_s = 0.0;       // 自启动以来的时长
+    double measured_rate_hz = 0.0;    // 自启动以来的平均速率
+    double window_rate_hz = 0.0;      // 最近一个统计窗口的速率
+    double measured_mbps = 0.0;       // 自启动以来的平均带宽（MB/s）
+};
+
 /**
  * @brief 数据发布器
- * @details 定时向中间件发布测试数据
+ * @details 定时向中间件发布测试数据；配置 LoadProfile 后作为压测流量生成器使用
  */
 class DataPublisher {
 public:
     /**
-     * @brief 构造函数
+     * @brief 构造函数（兼容旧用法：单话题、固定间隔、JSON 文本）
      * @param topic 发布主题
      * @param interval_ms 发布间隔（毫秒），默认1000ms
+     * @param middleware 使用的中间件实例，默认全局单例
      */
-    DataPublisher(const std::string& topic, int interval_ms = 1000);
+    DataPublisher(const std::string& topic, int interval_ms = 1000,
+                  PubSubMiddleware& middleware = PubSubMiddleware::getInstance());
+
+    /**
+     * @brief 构造函数（压测流量生成）
+     * @param profile 流量配置
+     * @param middleware 使用的中间件实例，默认全局单例
+     */
+    explicit DataPublisher(const LoadProfile& profile,
+                           PubSubMiddleware& middleware = PubSubMiddleware::getInstance());
 
     /**
      * @brief 析构函数
@@ -44,26 +109,43 @@ public:
     void stop();
 
     /**
-     * @brief 是否正在运行
+     * @brief 是否正在运行（达到 max_messages 后发布线程自行退出）
      */
-    bool isRunning() const { return running_; }
+    bool isRunning() const { return running_ && !finished_; }
 
     /**
-     * @brief 设置发布间隔
+     * @brief 设置发布间隔（运行中修改在下一个发送时刻生效）
      * @param interval_ms 间隔（毫秒）
      */
-    void setInterval(int interval_ms) { interval_ms_ = interval_ms; }
+    void setInterval(int interval_ms);
 
     /**
-     * @brief 获取发布间隔
+     * @brief 获取发布间隔（毫秒，亚毫秒速率时为 0）
      */
-    int getInterval() const { return interval_ms_; }
+    int getInterval() const;
+
+    /**
+     * @brief 设置目标速率（条/秒）
+     */
+    void setRate(double rate_hz);
 
     /**
      * @brief 获取发布的消息计数
      */
     uint64_t getMessageCount() const { return message_count_; }
 
+    /**
+     * @brief 获取实测统计
+     */
+    PublisherStats getStats() const;
+
+    /**
+     * @brief 发布者实例ID（写入 LoadTestHeader，用于订阅端区分数据流）
+     */
+    uint32_t getPublisherId() const { return publisher_id_; }
+
+    const LoadProfile& getProfile() const { return profile_; }
+
 private:
     /**
      * @brief 发布线程函数
@@ -74,14 +156,46 @@ private:
      * @brief 生成测试数据
      * @return 测试数据字符串（JSON格式）
      */
-    std::string generateTestData();
+    std::string generateTestData(const std::string& topic, uint64_t sequence, int64_t send_ns);
 
-    std::string topic_;              // 发布主题
-    int interval_ms_;                // 发布间隔（毫秒）
+    /**
+     * @brief 按大小分布预生成负载池
+     */
+    void buildPayloadPool();
+    size_t drawPayloadSize();
+
+    /**
+     * @brief 发布一条消息并更新统计
+     */
+    void publishOne(size_t topic_index);
+
+    void reportRate(int64_t now_ns);
+
+    PubSubMiddleware& middleware_;   // 中间件实例
+    LoadProfile profile_;            // 流量配置
+    std::atomic<double> rate_hz_;    // 当前目标速率
     std::atomic<bool> running_;      // 运行标志
+    std::atomic<bool> finished_;     // 已达到 max_messages
     std::atomic<uint64_t> message_count_;  // 消息计数
     std::unique_ptr<std::thread> thread_;   // 发布线程
-    uint64_t sequence_;              // 序列号
+    uint32_t publisher_id_;          // 发布者实例ID
+
+    // 以下仅发布线程访问
+    std::vector<std::string> payload_pool_;
+    size_t pool_cursor_ = 0;
+    std::vector<uint64_t> sequences_;      // 每个话题独立的序号
+    std::mt19937_64 rng_;
+
+    // 统计（发布线程写，其他线程读）
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> failures_{0};
+    std::atomic<uint64_t> late_ticks_{0};
+    std::atomic<int64_t> max_lateness_ns_{0};
+    std::atomic<int64_t> start_ns_{0};
+    std::atomic<double> window_rate_hz_{0.0};
+    int64_t window_start_ns_ = 0;
+    uint64_t window_start_count_ = 0;
+    int64_t last_report_ns_ = 0;
 };
 
 }  // namespace simple_middleware
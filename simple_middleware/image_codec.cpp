@@ -0,0 +1,307 @@
+/*
+ * @Desc: 无损图像编解码实现
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#include "image_codec.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace simple_middleware {
+
+namespace {
+
+constexpr char kMagic[4] = {'D', 'R', 'L', '1'};
+constexpr size_t kHeaderSize = 12;
+constexpr int kMaxTokenPixels = 128;
+constexpr uint8_t kLiteralToken = 0x80;  // >= 0x80 为字面量，否则为游程
+
+void PutU32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v >> 16);
+    p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+uint32_t GetU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16)
+        | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// 第 j 个像素的差分（没有上一行时即像素本身）
+inline void PixelDelta(const uint8_t* cur, const uint8_t* up, int j, uint8_t* delta) {
+    const size_t offset = static_cast<size_t>(j) * 3;
+    for (int k = 0; k < 3; ++k) {
+        delta[k] = static_cast<uint8_t>(cur[offset + k] - (up ? up[offset + k] : 0));
+    }
+}
+
+inline bool SamePixel(const uint8_t* a, const uint8_t* b) {
+    return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+}
+
+#if defined(__SSE2__)
+// SIMD 块：16 像素 = 48 字节 = 3 个 128 位寄存器，3 字节的像素在块内总是对齐的
+constexpr int kBlockPixels = 16;
+constexpr uint64_t kBlockAllBytes = (1ULL << 48) - 1;
+constexpr uint64_t kBlockPixelBits = 0x249249249249ULL;  // 每个像素的首字节：第 0, 3, 6, ..., 45 位
+
+struct Block {
+    __m128i v[3];
+};
+
+inline Block LoadDelta(const uint8_t* cur, const uint8_t* up, size_t offset) {
+    Block block;
+    for (int k = 0; k < 3; ++k) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + offset + 16 * k));
+        block.v[k] = up ? _mm_sub_epi8(c, _mm_loadu_si128(reinterpret_cast<const __m128i*>(up + offset + 16 * k)))
+                        : c;
+    }
+    return block;
+}
+
+inline Block PixelPattern(const uint8_t* pixel) {
+    alignas(16) uint8_t bytes[kBlockPixels * 3];
+    for (int i = 0; i < kBlockPixels; ++i) {
+        std::memcpy(bytes + i * 3, pixel, 3);
+    }
+    Block block;
+    for (int k = 0; k < 3; ++k) {
+        block.v[k] = _mm_load_si128(reinterpret_cast<const __m128i*>(bytes + 16 * k));
+    }
+    return block;
+}
+
+// 48 字节逐字节比较，第 i 位为 1 表示第 i 个字节相等
+inline uint64_t EqualMask(const Block& a, const Block& b) {
+    uint64_t mask = 0;
+    for (int k = 0; k < 3; ++k) {
+        uint16_t bits = static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a.v[k], b.v[k])));
+        mask |= static_cast<uint64_t>(bits) << (16 * k);
+    }
+    return mask;
+}
+
+// dst[i] = base[i] + add[i]（逐字节模 256），48 字节
+inline void AddBlock(const uint8_t* base, const Block& add, uint8_t* dst) {
+    for (int k = 0; k < 3; ++k) {
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + 16 * k));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16 * k), _mm_add_epi8(b, add.v[k]));
+    }
+}
+
+inline int FirstSetBit(uint64_t bits) {
+    return __builtin_ctzll(bits);
+}
+#endif
+
+// 从第 j 个像素起与 pixel 相同的差分像素个数（调用方保证第 j 个相同）
+int RunLength(const uint8_t* cur, const uint8_t* up, int j, int width, const uint8_t* pixel) {
+    int n = 1;
+#if defined(__SSE2__)
+    const Block pattern = PixelPattern(pixel);
+    while (j + n + kBlockPixels <= width) {
+        uint64_t equal = EqualMask(LoadDelta(cur, up, static_cast<size_t>(j + n) * 3), pattern);
+        if (equal != kBlockAllBytes) {
+            return n + FirstSetBit(~equal) / 3;
+        }
+        n += kBlockPixels;
+    }
+#endif
+    uint8_t delta[3];
+    while (j + n < width) {
+        PixelDelta(cur, up, j + n, delta);
+        if (!SamePixel(delta, pixel)) break;
+        ++n;
+    }
+    return n;
+}
+
+// 从第 j 个像素起的字面量长度（调用方保证第 j 个与前一个差分像素不同），差分像素依次写到 dst；
+// 遇到与前一个差分像素相同的像素时停止（交给游程），最多 max_pixels 个
+int LiteralLength(const uint8_t* cur, const uint8_t* up, int j, int max_pixels, uint8_t* dst) {
+    PixelDelta(cur, up, j, dst);
+    int n = 1;
+#if defined(__SSE2__)
+    while (n + kBlockPixels <= max_pixels) {
+        const size_t offset = static_cast<size_t>(j + n) * 3;
+        Block delta = LoadDelta(cur, up, offset);
+        for (int k = 0; k < 3; ++k) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + n * 3 + 16 * k), delta.v[k]);
+        }
+        // 与左移一个像素的差分比较：三个字节都相等的像素即可以开始游程
+        uint64_t equal = EqualMask(delta, LoadDelta(cur, up, offset - 3));
+        uint64_t same = equal & (equal >> 1) & (equal >> 2) & kBlockPixelBits;
+        if (same != 0) {
+            return n + FirstSetBit(same) / 3;
+        }
+        n += kBlockPixels;
+    }
+#endif
+    while (n < max_pixels) {
+        PixelDelta(cur, up, j + n, dst + n * 3);
+        if (SamePixel(dst + n * 3, dst + (n - 1) * 3)) break;
+        ++n;
+    }
+    return n;
+}
+
+uint8_t* EncodeRow(const uint8_t* cur, const uint8_t* up, int width, uint8_t* out) {
+    uint8_t prev[3] = {0, 0, 0};  // 上一个差分像素
+    uint8_t* literal = nullptr;   // 当前字面量 token 的位置（还能继续追加时非空）
+    int literal_count = 0;
+    uint8_t delta[3];
+    int j = 0;
+    while (j < width) {
+        PixelDelta(cur, up, j, delta);
+        if (SamePixel(delta, prev)) {
+            int run = RunLength(cur, up, j, width, prev);
+            j += run;
+            literal = nullptr;
+            while (run > 0) {
+                int n = std::min(run, kMaxTokenPixels);
+                *out++ = static_cast<uint8_t>(n - 1);
+                run -= n;
+            }
+            continue;
+        }
+
+        if (!literal) {
+            literal = out++;
+            literal_count = 0;
+        }
+        int n = LiteralLength(cur, up, j, std::min(kMaxTokenPixels - literal_count, width - j), out);
+        out += n * 3;
+        j += n;
+        literal_count += n;
+        *literal = static_cast<uint8_t>(kLiteralToken + literal_count - 1);
+        std::memcpy(prev, out - 3, 3);
+        if (literal_count == kMaxTokenPixels) {
+            literal = nullptr;
+        }
+    }
+    return out;
+}
+
+// row[j, j + n) = up + pixel
+void FillRun(const uint8_t* up, uint8_t* row, int j, int n, const uint8_t* pixel) {
+    int k = 0;
+#if defined(__SSE2__)
+    if (n >= kBlockPixels) {
+        const Block pattern = PixelPattern(pixel);
+        for (; k + kBlockPixels <= n; k += kBlockPixels) {
+            const size_t offset = static_cast<size_t>(j + k) * 3;
+            AddBlock(up + offset, pattern, row + offset);
+        }
+    }
+#endif
+    for (; k < n; ++k) {
+        const size_t offset = static_cast<size_t>(j + k) * 3;
+        for (int c = 0; c < 3; ++c) {
+            row[offset + c] = static_cast<uint8_t>(up[offset + c] + pixel[c]);
+        }
+    }
+}
+
+// row[j, j + n) = up + deltas
+void AddLiteral(const uint8_t* up, uint8_t* row, int j, int n, const uint8_t* deltas) {
+    int k = 0;
+#if defined(__SSE2__)
+    for (; k + kBlockPixels <= n; k += kBlockPixels) {
+        const size_t offset = static_cast<size_t>(j + k) * 3;
+        Block delta;
+        for (int c = 0; c < 3; ++c) {
+            delta.v[c] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas + k * 3 + 16 * c));
+        }
+        AddBlock(up + offset, delta, row + offset);
+    }
+#endif
+    for (; k < n; ++k) {
+        const size_t offset = static_cast<size_t>(j + k) * 3;
+        for (int c = 0; c < 3; ++c) {
+            row[offset + c] = static_cast<uint8_t>(up[offset + c] + deltas[k * 3 + c]);
+        }
+    }
+}
+
+bool DecodeRow(const uint8_t*& p, const uint8_t* end, const uint8_t* up, uint8_t* row, int width) {
+    uint8_t prev[3] = {0, 0, 0};
+    int j = 0;
+    while (j < width) {
+        if (p >= end) return false;
+        const uint8_t token = *p++;
+        int n;
+        if (token < kLiteralToken) {
+            n = token + 1;
+            if (n > width - j) return false;
+            FillRun(up, row, j, n, prev);
+        } else {
+            n = token - kLiteralToken + 1;
+            if (n > width - j || static_cast<size_t>(end - p) < static_cast<size_t>(n) * 3) return false;
+            AddLiteral(up, row, j, n, p);
+            std::memcpy(prev, p + (n - 1) * 3, 3);
+            p += static_cast<size_t>(n) * 3;
+        }
+        j += n;
+    }
+    return true;
+}
+
+}  // namespace
+
+size_t ImageEncodedBound(int width, int height) {
+    if (width <= 0 || height <= 0) return kHeaderSize;
+    // 每行最坏情况：全部是字面量（每 128 像素一个 token），再加行尾的一个游程 token
+    const size_t row_bound = static_cast<size_t>(width) * 3 + width / kMaxTokenPixels + 2;
+    return kHeaderSize + row_bound * height;
+}
+
+size_t ImageEncode(const uint8_t* rgb, int width, int height, uint8_t* dst) {
+    std::memcpy(dst, kMagic, sizeof(kMagic));
+    PutU32(dst + 4, static_cast<uint32_t>(std::max(width, 0)));
+    PutU32(dst + 8, static_cast<uint32_t>(std::max(height, 0)));
+    uint8_t* out = dst + kHeaderSize;
+    const size_t stride = static_cast<size_t>(std::max(width, 0)) * 3;
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = rgb + stride * y;
+        out = EncodeRow(row, y > 0 ? row - stride : nullptr, width, out);
+    }
+    return static_cast<size_t>(out - dst);
+}
+
+void ImageEncode(const uint8_t* rgb, int width, int height, std::string* out) {
+    out->resize(ImageEncodedBound(width, height));
+    size_t size = ImageEncode(rgb, width, height, reinterpret_cast<uint8_t*>(&(*out)[0]));
+    out->resize(size);
+}
+
+bool ImageDecode(std::string_view data, int width, int height, std::string* out) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data.data());
+    const uint8_t* end = p + data.size();
+    if (width <= 0 || height <= 0 || data.size() < kHeaderSize || std::memcmp(p, kMagic, sizeof(kMagic)) != 0
+        || GetU32(p + 4) != static_cast<uint32_t>(width) || GetU32(p + 8) != static_cast<uint32_t>(height)) {
+        return false;
+    }
+    p += kHeaderSize;
+
+    const size_t stride = static_cast<size_t>(width) * 3;
+    out->resize(stride * height);
+    uint8_t* dst = reinterpret_cast<uint8_t*>(&(*out)[0]);
+    // 第一行的“上一行”为全 0：先清零再原地解码（每个字节先读后写，不会互相覆盖）
+    std::memset(dst, 0, stride);
+    for (int y = 0; y < height; ++y) {
+        uint8_t* row = dst + stride * y;
+        if (!DecodeRow(p, end, y > 0 ? row - stride : row, row, width)) {
+            return false;
+        }
+    }
+    return p == end;
+}
+
+}  // namespace simple_middleware
@@ -0,0 +1,59 @@
+/*
+ * @Desc: 无损图像编解码（RGB888，上一行差分 + 游程编码），无第三方依赖，x86 上用 SSE2 加速
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace simple_middleware {
+
+/**
+ * @brief CameraFrame.image_format 的取值
+ * @details kImageFormatRaw 为原始 RGB888（历史原因标记为 "ppm"，但不含 PPM 头），
+ *          kImageFormatDeltaRle 为本文件的无损压缩格式
+ */
+inline constexpr const char* kImageFormatRaw = "ppm";
+inline constexpr const char* kImageFormatDeltaRle = "rgb_delta_rle";
+
+/**
+ * @brief 编码后的最大字节数（dst 缓冲区至少需要这么大）
+ */
+size_t ImageEncodedBound(int width, int height);
+
+/**
+ * @brief 编码一帧 RGB888 图像
+ * @details 格式：12 字节头（"DRL1" + 宽 + 高，uint32 小端），之后逐行编码。
+ *          每个像素先减去上一行同位置的像素（逐字节模 256，第一行减 0），得到差分像素；
+ *          每行的差分像素再按 token 序列存放（token 不跨行）：
+ *            0x00-0x7F：重复上一个差分像素 n+1 次（行首时上一个差分像素为 0）
+ *            0x80-0xFF：后跟 n-0x7F 个差分像素（每个 3 字节）
+ *          渲染图像大面积是纯色或逐行渐变，差分后几乎整行都是同一个像素，一行只需几个字节。
+ *          解码没有行内串行依赖（每个像素只依赖上一行），编解码都按 16 像素（48 字节）一块做 SIMD。
+ * @param rgb 图像数据，width * height * 3 字节，行优先
+ * @param dst 输出缓冲区，至少 ImageEncodedBound(width, height) 字节
+ * @return 编码后的字节数
+ */
+size_t ImageEncode(const uint8_t* rgb, int width, int height, uint8_t* dst);
+
+/**
+ * @brief 编码到 string（调整大小后写入，容量跨帧复用）
+ */
+void ImageEncode(const uint8_t* rgb, int width, int height, std::string* out);
+
+/**
+ * @brief 解码
+ * @param data 编码数据
+ * @param width 期望的宽度（与头中的宽度不一致时失败）
+ * @param height 期望的高度
+ * @param out 输出 RGB888，调整为 width * height * 3 字节（容量跨帧复用）
+ * @return 数据完整且尺寸匹配时返回 true
+ */
+bool ImageDecode(std::string_view data, int width, int height, std::string* out);
+
+}  // namespace simple_middleware
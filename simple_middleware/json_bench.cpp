@@ -0,0 +1,502 @@
+/*
+ * @Desc: JSON 编解码基准测试 - JsonWriter / JsonReader 对比 json11
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ *
+ * write：用 Visualizer 推给前端的 frame_data 消息（车辆状态 + 障碍物列表）作为负载，
+ *        分别用 json11（构建 DOM 后 dump）和 JsonWriter（流式追加到复用缓冲区）序列化。
+ * parse：对几类有代表性的入站消息（visualizer/control 指令、前端系统控制指令、压测 JSON 消息、frame_data），
+ *        分别用 json11（解析出完整 DOM 再取字段）和 JsonReader（只取需要的字段）提取处理函数实际使用的字段。
+ * 比较每次操作的耗时（p50/p99）、吞吐以及堆分配次数（需以 SIMPLE_TRACK_ALLOCATIONS=1 编译库）。
+ *
+ * 使用方法：
+ *   ./json_bench [--cases write,parse] [--obstacles 1,100,10000] [--iterations 2000] [--out json_bench.json]
+ *
+ * 每个用例的迭代次数按负载大小缩减，保证大负载用例耗时可控。
+ */
+
+#include "json_writer.hpp"
+#include "json_reader.hpp"
+#include "alloc_tracker.hpp"
+#include "latency_histogram.hpp"
+#include "logger.hpp"
+#include "json11.hpp"
+#include <common_msgs/visualizer_data.pb.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace simple_middleware;
+
+namespace {
+
+struct BenchOptions {
+    std::vector<std::string> cases{"write", "parse"};
+    std::vector<int> obstacles{1, 100, 10000};
+    uint64_t iterations = 2000;  // 100 个障碍物时的迭代次数
+    std::string out = "json_bench.json";
+};
+
+struct CaseResult {
+    std::string name;          // 用例，例如 write_frame_data / parse_control_set_target
+    std::string encoder;       // json11 / json_writer / json_reader
+    int obstacles = -1;        // 仅 frame_data 用例有效
+    uint64_t iterations = 0;
+    size_t bytes = 0;
+    LatencySummary latency;
+    double mb_per_sec = 0.0;
+    double allocs_per_op = -1.0;  // 未开启分配计数时为 -1
+};
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+senseauto::demo::FrameData MakeFrame(int obstacle_count) {
+    senseauto::demo::FrameData frame;
+    auto* car = frame.mutable_car_state();
+    car->mutable_position()->set_x(123.456789);
+    car->mutable_position()->set_y(-45.678912);
+    car->set_heading(0.785398);
+    car->set_speed(12.5);
+    car->set_steering_angle(-0.0523);
+    const char* types[] = {"car", "pedestrian", "cone"};
+    for (int i = 0; i < obstacle_count; ++i) {
+        auto* obs = frame.add_obstacles();
+        obs->set_id(i);
+        obs->set_type(types[i % 3]);
+        obs->mutable_position()->set_x(100.0 + i * 0.731);
+        obs->mutable_position()->set_y(-20.0 + (i % 17) * 1.37);
+        obs->set_length(4.5);
+        obs->set_width(1.8);
+        obs->set_heading((i % 360) * 0.0174533);
+    }
+    return frame;
+}
+
+// 与 VisualizerComponent 改造前的实现一致
+std::string EncodeJson11(const senseauto::demo::FrameData& frame, int frame_id) {
+    json11::Json::array obstacles_json;
+    for (const auto& obs : frame.obstacles()) {
+        obstacles_json.push_back(json11::Json::object{
+            {"id", obs.id()},
+            {"type", obs.type()},
+            {"position", json11::Json::object{{"x", obs.position().x()}, {"y", obs.position().y()}}},
+            {"length", obs.length()},
+            {"width", obs.width()},
+            {"heading", obs.heading()}
+        });
+    }
+    json11::Json final_json = json11::Json::object{
+        {"type", "frame_data"},
+        {"frame_id", frame_id},
+        {"timestamp", 1766100000},
+        {"car_state", json11::Json::object{
+            {"speed", frame.car_state().speed()},
+            {"heading", frame.car_state().heading()},
+            {"steering_angle", frame.car_state().steering_angle()},
+            {"position", json11::Json::object{
+                {"x", frame.car_state().position().x()},
+                {"y", frame.car_state().position().y()}
+            }}
+        }},
+        {"obstacles", obstacles_json}
+    };
+    return final_json.dump();
+}
+
+// 与 VisualizerComponent::GetSerializedData 的实现一致
+void EncodeWriter(const senseauto::demo::FrameData& frame, int frame_id, std::string* out) {
+    out->clear();
+    JsonWriter w(out);
+    w.beginObject();
+    w.field("type", "frame_data");
+    w.field("frame_id", frame_id);
+    w.field("timestamp", 1766100000);
+    w.key("car_state");
+    w.beginObject();
+    w.field("speed", frame.car_state().speed());
+    w.field("heading", frame.car_state().heading());
+    w.field("steering_angle", frame.car_state().steering_angle());
+    w.key("position");
+    w.beginObject();
+    w.field("x", frame.car_state().position().x());
+    w.field("y", frame.car_state().position().y());
+    w.endObject();
+    w.endObject();
+    w.key("obstacles");
+    w.beginArray();
+    for (const auto& obs : frame.obstacles()) {
+        w.beginObject();
+        w.field("id", obs.id());
+        w.field("type", obs.type());
+        w.key("position");
+        w.beginObject();
+        w.field("x", obs.position().x());
+        w.field("y", obs.position().y());
+        w.endObject();
+        w.field("length", obs.length());
+        w.field("width", obs.width());
+        w.field("heading", obs.heading());
+        w.endObject();
+    }
+    w.endArray();
+    w.endObject();
+}
+
+// 两种编码解析回来应当结构一致（浮点按 JsonWriter 的 6 位小数比较）
+bool SameDocument(const json11::Json& a, const json11::Json& b) {
+    if (a.type() != b.type()) return false;
+    switch (a.type()) {
+        case json11::Json::NUMBER:
+            return std::abs(a.number_value() - b.number_value()) <= 1e-6 * std::max(1.0, std::abs(a.number_value()));
+        case json11::Json::ARRAY: {
+            if (a.array_items().size() != b.array_items().size()) return false;
+            for (size_t i = 0; i < a.array_items().size(); ++i) {
+                if (!SameDocument(a.array_items()[i], b.array_items()[i])) return false;
+            }
+            return true;
+        }
+        case json11::Json::OBJECT: {
+            if (a.object_items().size() != b.object_items().size()) return false;
+            for (const auto& kv : a.object_items()) {
+                if (!SameDocument(kv.second, b[kv.first])) return false;
+            }
+            return true;
+        }
+        default:
+            return a == b;
+    }
+}
+
+template <typename Fn>
+CaseResult RunCase(const std::string& name, const std::string& encoder, int obstacles, uint64_t iterations,
+                   Fn&& encode) {
+    CaseResult r;
+    r.name = name;
+    r.encoder = encoder;
+    r.obstacles = obstacles;
+    r.iterations = iterations;
+
+    // 热身：让复用缓冲区长到稳定容量，避免首轮分配计入统计
+    for (int i = 0; i < 3; ++i) r.bytes = encode(i);
+
+    LatencyHistogram histogram;
+    AllocCounters before = AllocTracker::ThreadCounters();
+    int64_t start = NowNs();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        int64_t t0 = NowNs();
+        r.bytes = encode(static_cast<int>(i));
+        histogram.record(static_cast<uint64_t>(NowNs() - t0));
+    }
+    double seconds = (NowNs() - start) / 1e9;
+    AllocCounters after = AllocTracker::ThreadCounters();
+
+    r.latency = histogram.summary();
+    r.mb_per_sec = seconds > 0 ? r.bytes * iterations / seconds / 1e6 : 0.0;
+    if (AllocTracker::IsEnabled()) {
+        r.allocs_per_op = static_cast<double>(after.allocs - before.allocs) / iterations;
+    }
+    return r;
+}
+
+// ---------------------------------------------------------------------------
+// parse 用例：从消息中提取处理函数实际使用的字段，两种实现提取结果必须一致
+// ---------------------------------------------------------------------------
+
+struct Extracted {
+    std::string text;      // 字符串字段拼接（cmd/type/action/node 等）
+    double sum = 0.0;      // 数值字段之和
+    int count = 0;         // 命中的字段数
+
+    bool operator==(const Extracted& o) const {
+        return text == o.text && count == o.count && std::abs(sum - o.sum) <= 1e-9 * std::max(1.0, std::abs(sum));
+    }
+};
+
+struct ParseCase {
+    std::string name;
+    std::string json;
+    std::vector<std::string> string_keys;  // 顶层字符串字段
+    std::vector<std::string> number_keys;  // 顶层数值字段
+    bool car_state = false;                // 额外读取 car_state.speed / position.x / position.y（frame_data）
+};
+
+bool Contains(const std::vector<std::string>& keys, std::string_view key) {
+    for (const auto& k : keys) {
+        if (k == key) return true;
+    }
+    return false;
+}
+
+// 与各组件改造前的写法一致：先解析出完整 DOM，再按键取值
+Extracted ExtractJson11(const ParseCase& c) {
+    Extracted r;
+    std::string err;
+    json11::Json doc = json11::Json::parse(c.json, err);
+    if (!err.empty()) return r;
+    for (const auto& k : c.string_keys) {
+        if (doc[k].is_string()) {
+            r.text += doc[k].string_value();
+            ++r.count;
+        }
+    }
+    for (const auto& k : c.number_keys) {
+        if (doc[k].is_number()) {
+            r.sum += doc[k].number_value();
+            ++r.count;
+        }
+    }
+    if (c.car_state) {
+        const auto& car = doc["car_state"];
+        r.sum += car["speed"].number_value() + car["position"]["x"].number_value()
+            + car["position"]["y"].number_value();
+        r.count += 3;
+    }
+    return r;
+}
+
+// 与各组件当前的写法一致：顺序扫描，只读取关心的字段，其余跳过；字符串字段拼接到复用的 text 中
+Extracted ExtractReader(const ParseCase& c, std::string* text) {
+    Extracted r;
+    text->clear();
+    JsonReader reader(c.json);
+    std::string_view sv;
+    double d = 0.0;
+    reader.forEachMember([&](std::string_view key) {
+        if (Contains(c.string_keys, key)) {
+            if (reader.readString(&sv)) {
+                text->append(sv.data(), sv.size());
+                ++r.count;
+            }
+        } else if (Contains(c.number_keys, key)) {
+            if (reader.readNumber(&d)) {
+                r.sum += d;
+                ++r.count;
+            }
+        } else if (c.car_state && key == "car_state") {
+            reader.forEachMember([&](std::string_view car_key) {
+                if (car_key == "speed") {
+                    if (reader.readNumber(&d)) r.sum += d;
+                    ++r.count;
+                } else if (car_key == "position") {
+                    reader.forEachMember([&](std::string_view pos_key) {
+                        if ((pos_key == "x" || pos_key == "y") && reader.readNumber(&d)) {
+                            r.sum += d;
+                            ++r.count;
+                        }
+                    });
+                }
+            });
+        }
+    });
+    return r;
+}
+
+std::vector<ParseCase> MakeParseCases(const std::string& frame_json) {
+    std::vector<ParseCase> cases;
+    // ControlComponent / PlanningComponent::OnControlMessage
+    cases.push_back({"parse_control_set_target", R"({"cmd":"set_target","x":200.0,"y":35.5})",
+                     {"cmd"}, {"x", "y"}, false});
+    // VisualizerServer::HandleClientCommand
+    cases.push_back({"parse_system_control",
+                     R"({"type":"system_control","action":"restart","node":"simple_planning"})",
+                     {"type", "action", "node"}, {}, false});
+    // TestSubscriber：DataPublisher 的 JSON 压测消息（格式见 DataPublisher::generateTestData）
+    cases.push_back({"parse_load_test",
+                     R"({"sequence":123456,"timestamp":1766100000123,"send_ns":987654321012345,)"
+                     R"("publisher_id":3735928559,"topic":"test_topic","data":{"value":56,"status":"ok"}})",
+                     {}, {"send_ns", "sequence", "publisher_id"}, false});
+    // 大消息：只取车辆状态，跳过整个障碍物数组
+    cases.push_back({"parse_frame_data", frame_json, {"type"}, {"frame_id"}, true});
+    return cases;
+}
+
+std::vector<std::string> ParseList(const std::string& value) {
+    std::vector<std::string> out;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(item);
+    }
+    return out;
+}
+
+std::vector<int> ParseIntList(const std::string& value) {
+    std::vector<int> out;
+    for (const auto& item : ParseList(value)) {
+        out.push_back(std::stoi(item));
+    }
+    return out;
+}
+
+void PrintUsage() {
+    std::cerr << "Usage: json_bench [--cases write,parse] [--obstacles 1,100,10000] [--iterations N] [--out FILE|-]\n";
+}
+
+bool ParseArgs(int argc, char* argv[], BenchOptions* options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--cases") {
+            options->cases = ParseList(value);
+        } else if (arg == "--obstacles") {
+            options->obstacles = ParseIntList(value);
+        } else if (arg == "--iterations") {
+            options->iterations = std::stoull(value);
+        } else if (arg == "--out") {
+            options->out = value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void WriteResult(JsonWriter& w, const CaseResult& r) {
+    w.beginObject();
+    w.field("case", r.name);
+    w.field("encoder", r.encoder);
+    if (r.obstacles >= 0) {
+        w.field("obstacles", r.obstacles);
+    }
+    w.field("iterations", r.iterations);
+    w.field("bytes", r.bytes);
+    w.field("p50_ns", r.latency.p50);
+    w.field("p99_ns", r.latency.p99);
+    w.field("max_ns", r.latency.max);
+    w.field("mb_per_sec", r.mb_per_sec);
+    if (r.allocs_per_op >= 0) {
+        w.field("allocs_per_op", r.allocs_per_op);
+    }
+    w.endObject();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!ParseArgs(argc, argv, &options)) {
+        PrintUsage();
+        return 1;
+    }
+    if (!AllocTracker::IsEnabled()) {
+        LOG_INFO("JsonBench") << "库未以 SIMPLE_TRACK_ALLOCATIONS=1 编译，不统计堆分配次数";
+    }
+
+    std::vector<CaseResult> results;
+    auto wants = [&](const char* name) {
+        return std::find(options.cases.begin(), options.cases.end(), name) != options.cases.end();
+    };
+    auto report_case = [&](const std::string& label, const CaseResult& r) {
+        LOG_INFO("JsonBench") << label << " " << r.encoder
+            << ": p50=" << r.latency.p50 / 1000.0 << "us p99=" << r.latency.p99 / 1000.0 << "us "
+            << static_cast<uint64_t>(r.mb_per_sec) << " MB/s, " << r.bytes << " bytes"
+            << (r.allocs_per_op >= 0 ? ", allocs/op=" + std::to_string(r.allocs_per_op) : std::string());
+        results.push_back(r);
+    };
+    auto report_speedup = [](const std::string& label, const CaseResult& base, const CaseResult& fast) {
+        LOG_INFO("JsonBench") << label << " speedup(p50)="
+            << static_cast<double>(base.latency.p50) / std::max<uint64_t>(fast.latency.p50, 1) << "x";
+    };
+
+    for (int obstacles : wants("write") ? options.obstacles : std::vector<int>{}) {
+        senseauto::demo::FrameData frame = MakeFrame(obstacles);
+        uint64_t iterations = std::max<uint64_t>(10, options.iterations * 100 / std::max(obstacles, 100));
+
+        std::string json11_out = EncodeJson11(frame, 0);
+        std::string writer_out;
+        EncodeWriter(frame, 0, &writer_out);
+        std::string err1, err2;
+        if (!SameDocument(json11::Json::parse(json11_out, err1), json11::Json::parse(writer_out, err2))
+            || !err1.empty() || !err2.empty()) {
+            LOG_ERROR("JsonBench") << "obstacles=" << obstacles << ": JsonWriter 输出与 json11 不一致" << err2;
+            return 1;
+        }
+
+        CaseResult base = RunCase("write_frame_data", "json11", obstacles, iterations, [&](int frame_id) {
+            return EncodeJson11(frame, frame_id).size();
+        });
+        std::string buffer;
+        CaseResult fast = RunCase("write_frame_data", "json_writer", obstacles, iterations, [&](int frame_id) {
+            EncodeWriter(frame, frame_id, &buffer);
+            return buffer.size();
+        });
+
+        std::string label = "write_frame_data obstacles=" + std::to_string(obstacles);
+        report_case(label, base);
+        report_case(label, fast);
+        report_speedup(label, base, fast);
+    }
+
+    if (wants("parse")) {
+        std::string frame_json;
+        EncodeWriter(MakeFrame(100), 42, &frame_json);
+        for (const ParseCase& c : MakeParseCases(frame_json)) {
+            std::string text;
+            Extracted expected = ExtractJson11(c);
+            Extracted actual = ExtractReader(c, &text);
+            actual.text = text;
+            if (expected.count == 0 || !(expected == actual)) {
+                LOG_ERROR("JsonBench") << c.name << ": JsonReader 提取结果与 json11 不一致";
+                return 1;
+            }
+
+            // 小消息单次只有几百纳秒，按消息大小放大迭代次数
+            uint64_t iterations = std::max<uint64_t>(
+                10, options.iterations * 100 * 100 / std::max<size_t>(c.json.size(), 100));
+            volatile int sink = 0;
+            CaseResult base = RunCase(c.name, "json11", -1, iterations, [&](int) {
+                sink = sink + ExtractJson11(c).count;
+                return c.json.size();
+            });
+            CaseResult fast = RunCase(c.name, "json_reader", -1, iterations, [&](int) {
+                sink = sink + ExtractReader(c, &text).count;
+                return c.json.size();
+            });
+
+            report_case(c.name, base);
+            report_case(c.name, fast);
+            report_speedup(c.name, base, fast);
+        }
+    }
+
+    std::string report;
+    JsonWriter w(&report);
+    w.beginObject();
+    w.field("benchmark", "json_bench");
+    w.field("timestamp", static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count()));
+    w.field("alloc_tracking", AllocTracker::IsEnabled());
+    w.key("results");
+    w.beginArray();
+    for (const auto& r : results) {
+        WriteResult(w, r);
+    }
+    w.endArray();
+    w.endObject();
+
+    if (options.out == "-") {
+        std::cout << report << std::endl;
+    } else {
+        std::ofstream out(options.out);
+        if (!out) {
+            LOG_ERROR("JsonBench") << "无法写入结果文件: " << options.out;
+            return 1;
+        }
+        out << report << std::endl;
+        LOG_INFO("JsonBench") << "结果已写入 " << options.out << "（" << results.size() << " 个用例）";
+    }
+    return 0;
+}
@@ -0,0 +1,340 @@
+/*
+ * @Desc: 拉取式 JSON 解析器实现
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#include "json_reader.hpp"
+#include <charconv>
+#include <cmath>
+
+namespace simple_middleware {
+
+namespace {
+
+// 防止恶意输入的深层嵌套耗尽栈（skipValue 按嵌套层数递归）
+constexpr int kMaxNesting = 256;
+
+bool IsNumberChar(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void AppendUtf8(std::string* out, uint32_t cp) {
+    if (cp < 0x80) {
+        out->push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out->push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out->push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out->push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+}  // namespace
+
+bool JsonReader::fail(const char* what) {
+    if (error_ == nullptr) {
+        error_ = what;
+        error_pos_ = pos_;
+    }
+    return false;
+}
+
+std::string JsonReader::error() const {
+    if (error_ == nullptr) return std::string();
+    return std::string(error_) + " at offset " + std::to_string(error_pos_);
+}
+
+void JsonReader::skipWhitespace() {
+    while (pos_ < input_.size()) {
+        char c = input_[pos_];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+        ++pos_;
+    }
+}
+
+JsonReader::Type JsonReader::peek() {
+    if (error_ != nullptr) return Type::kInvalid;
+    skipWhitespace();
+    if (pos_ >= input_.size()) return Type::kInvalid;
+    char c = input_[pos_];
+    switch (c) {
+        case '{': return Type::kObject;
+        case '[': return Type::kArray;
+        case '"': return Type::kString;
+        case 't':
+        case 'f': return Type::kBool;
+        case 'n': return Type::kNull;
+        default:
+            return (c == '-' || (c >= '0' && c <= '9')) ? Type::kNumber : Type::kInvalid;
+    }
+}
+
+bool JsonReader::enterContainer(char open) {
+    if (error_ != nullptr) return false;
+    skipWhitespace();
+    if (pos_ >= input_.size() || input_[pos_] != open) {
+        return fail(open == '{' ? "expected object" : "expected array");
+    }
+    if (++depth_ > kMaxNesting) {
+        return fail("nesting too deep");
+    }
+    ++pos_;
+    return true;
+}
+
+bool JsonReader::nextMember(std::string_view* key, bool* first) {
+    if (error_ != nullptr) return false;
+    skipWhitespace();
+    if (pos_ < input_.size() && input_[pos_] == '}') {
+        ++pos_;
+        --depth_;
+        return false;
+    }
+    if (!*first) {
+        if (pos_ >= input_.size() || input_[pos_] != ',') return fail("expected ',' or '}'");
+        ++pos_;
+        skipWhitespace();
+    }
+    *first = false;
+    // 每层嵌套一个键缓冲区：回调里遍历内层对象不会覆盖外层含转义的键（deque 扩容不移动已有元素）
+    if (key_scratch_.size() <= static_cast<size_t>(depth_)) {
+        key_scratch_.resize(depth_ + 1);
+    }
+    if (!parseString(key, &key_scratch_[depth_])) {
+        return fail("expected object key");
+    }
+    skipWhitespace();
+    if (pos_ >= input_.size() || input_[pos_] != ':') return fail("expected ':'");
+    ++pos_;
+    // 游标停在值的第一个字符上：回调只 peek() 时游标不变，forEachMember 能据此自动跳过该值
+    skipWhitespace();
+    return true;
+}
+
+bool JsonReader::nextElement(bool* first) {
+    if (error_ != nullptr) return false;
+    skipWhitespace();
+    if (pos_ < input_.size() && input_[pos_] == ']') {
+        ++pos_;
+        --depth_;
+        return false;
+    }
+    if (!*first) {
+        if (pos_ >= input_.size() || input_[pos_] != ',') return fail("expected ',' or ']'");
+        ++pos_;
+    }
+    *first = false;
+    skipWhitespace();
+    return true;
+}
+
+bool JsonReader::parseString(std::string_view* out, std::string* scratch) {
+    skipWhitespace();
+    if (pos_ >= input_.size() || input_[pos_] != '"') return fail("expected string");
+    size_t start = ++pos_;
+
+    // 快速路径：没有转义字符时直接返回输入缓冲区上的视图
+    while (pos_ < input_.size()) {
+        char c = input_[pos_];
+        if (c == '"') {
+            if (out) *out = input_.substr(start, pos_ - start);
+            ++pos_;
+            return true;
+        }
+        if (c == '\\') break;
+        if (static_cast<unsigned char>(c) < 0x20) return fail("control character in string");
+        ++pos_;
+    }
+    if (pos_ >= input_.size()) return fail("unterminated string");
+
+    // 含转义：解码到 scratch
+    scratch->assign(input_.data() + start, pos_ - start);
+    while (pos_ < input_.size()) {
+        char c = input_[pos_++];
+        if (c == '"') {
+            if (out) *out = *scratch;
+            return true;
+        }
+        if (static_cast<unsigned char>(c) < 0x20) return fail("control character in string");
+        if (c != '\\') {
+            scratch->push_back(c);
+            continue;
+        }
+        if (pos_ >= input_.size()) break;
+        char e = input_[pos_++];
+        switch (e) {
+            case '"': scratch->push_back('"'); break;
+            case '\\': scratch->push_back('\\'); break;
+            case '/': scratch->push_back('/'); break;
+            case 'b': scratch->push_back('\b'); break;
+            case 'f': scratch->push_back('\f'); break;
+            case 'n': scratch->push_back('\n'); break;
+            case 'r': scratch->push_back('\r'); break;
+            case 't': scratch->push_back('\t'); break;
+            case 'u': {
+                auto read_hex4 = [this](uint32_t* cp) {
+                    if (pos_ + 4 > input_.size()) return false;
+                    uint32_t v = 0;
+                    for (int i = 0; i < 4; ++i) {
+                        int h = HexValue(input_[pos_ + i]);
+                        if (h < 0) return false;
+                        v = (v << 4) | static_cast<uint32_t>(h);
+                    }
+                    pos_ += 4;
+                    *cp = v;
+                    return true;
+                };
+                uint32_t cp = 0;
+                if (!read_hex4(&cp)) return fail("invalid \\u escape");
+                // UTF-16 代理对
+                if (cp >= 0xD800 && cp <= 0xDBFF && pos_ + 1 < input_.size()
+                    && input_[pos_] == '\\' && input_[pos_ + 1] == 'u') {
+                    size_t saved = pos_;
+                    pos_ += 2;
+                    uint32_t low = 0;
+                    if (read_hex4(&low) && low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    } else {
+                        pos_ = saved;
+                    }
+                }
+                AppendUtf8(scratch, cp);
+                break;
+            }
+            default:
+                return fail("invalid escape");
+        }
+    }
+    return fail("unterminated string");
+}
+
+bool JsonReader::scanNumber(std::string_view* out) {
+    size_t start = pos_;
+    while (pos_ < input_.size() && IsNumberChar(input_[pos_])) {
+        ++pos_;
+    }
+    if (pos_ == start) return fail("expected number");
+    *out = input_.substr(start, pos_ - start);
+    return true;
+}
+
+bool JsonReader::skipLiteral(std::string_view literal) {
+    if (input_.substr(pos_, literal.size()) != literal) return fail("invalid literal");
+    pos_ += literal.size();
+    return true;
+}
+
+bool JsonReader::skipValue() {
+    switch (peek()) {
+        case Type::kObject:
+            return forEachMember([](std::string_view) {});
+        case Type::kArray:
+            return forEachElement([](size_t) {});
+        case Type::kString:
+            return parseString(nullptr, &scratch_);
+        case Type::kNumber: {
+            std::string_view text;
+            return scanNumber(&text);
+        }
+        case Type::kBool:
+            return skipLiteral(input_[pos_] == 't' ? "true" : "false");
+        case Type::kNull:
+            return skipLiteral("null");
+        case Type::kInvalid:
+        default:
+            return fail("expected value");
+    }
+}
+
+bool JsonReader::readString(std::string_view* out) {
+    if (peek() != Type::kString) {
+        skipValue();
+        return false;
+    }
+    return parseString(out, &scratch_);
+}
+
+bool JsonReader::readString(std::string* out) {
+    std::string_view view;
+    if (!readString(&view)) return false;
+    out->assign(view.data(), view.size());
+    return true;
+}
+
+bool JsonReader::readNumber(double* out) {
+    if (peek() != Type::kNumber) {
+        skipValue();
+        return false;
+    }
+    std::string_view text;
+    if (!scanNumber(&text)) return false;
+    double value = 0.0;
+    auto res = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (res.ec != std::errc() || res.ptr != text.data() + text.size()) {
+        return fail("invalid number");
+    }
+    *out = value;
+    return true;
+}
+
+bool JsonReader::readInt(int64_t* out) {
+    if (peek() != Type::kNumber) {
+        skipValue();
+        return false;
+    }
+    std::string_view text;
+    if (!scanNumber(&text)) return false;
+    int64_t value = 0;
+    auto res = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (res.ec == std::errc() && res.ptr == text.data() + text.size()) {
+        *out = value;
+        return true;
+    }
+    double d = 0.0;
+    auto dres = std::from_chars(text.data(), text.data() + text.size(), d);
+    if (dres.ec != std::errc() || dres.ptr != text.data() + text.size()) {
+        return fail("invalid number");
+    }
+    // 超出 int64 的值（含超长的整数形式）转换是未定义行为：[-2^63, 2^63) 以外按错误处理
+    constexpr double kInt64Bound = 9223372036854775808.0;
+    if (!std::isfinite(d) || d < -kInt64Bound || d >= kInt64Bound) {
+        return fail("integer out of range");
+    }
+    *out = static_cast<int64_t>(d);
+    return true;
+}
+
+bool JsonReader::readBool(bool* out) {
+    if (peek() != Type::kBool) {
+        skipValue();
+        return false;
+    }
+    bool value = input_[pos_] == 't';
+    if (!skipLiteral(value ? "true" : "false")) return false;
+    *out = value;
+    return true;
+}
+
+bool JsonReader::finish() {
+    if (error_ != nullptr) return false;
+    skipWhitespace();
+    if (pos_ != input_.size()) return fail("trailing characters");
+    return true;
+}
+
+}  // namespace simple_middleware
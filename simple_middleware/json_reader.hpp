@@ -0,0 +1,135 @@
+/*
+ * @Desc: 拉取式 JSON 解析器 - 顺序扫描输入，只取需要的字段，不构建 DOM
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+
+namespace simple_middleware {
+
+/**
+ * @brief 拉取式（pull/SAX 风格）JSON 解析器
+ * @details 在输入上顺序移动游标：forEachMember() 逐个回调对象的键，回调里用 readNumber()/readString() 等
+ *          读取关心的值；回调没有读取的值会被自动跳过（只做语法扫描，不分配内存、不拷贝字符串）。
+ *          字符串以 std::string_view 返回，直接指向输入缓冲区；含转义字符时解码到内部缓冲区，
+ *          该视图在下一次读取字符串之前有效（键按嵌套层数使用单独的缓冲区，
+ *          回调期间一直有效，即使回调里又遍历了内层对象）。
+ *
+ *          readXxx() 遇到类型不符的值时跳过该值并返回 false，不算语法错误（与 json11 取值时返回默认值的行为一致）；
+ *          语法错误会让后续所有调用返回 false，通过 error() 查看原因和位置。
+ *          输入缓冲区必须在解析期间保持有效。
+ *
+ * @code
+ *   JsonReader reader(msg.data);
+ *   std::string cmd;
+ *   double x = 0.0;
+ *   bool ok = reader.forEachMember([&](std::string_view key) {
+ *       if (key == "cmd") reader.readString(&cmd);
+ *       else if (key == "x") reader.readNumber(&x);
+ *   });
+ * @endcode
+ */
+class JsonReader {
+public:
+    enum class Type { kNull, kBool, kNumber, kString, kArray, kObject, kInvalid };
+
+    explicit JsonReader(std::string_view input) : input_(input) {}
+
+    JsonReader(const JsonReader&) = delete;
+    JsonReader& operator=(const JsonReader&) = delete;
+
+    /**
+     * @brief 下一个值的类型（不移动游标）
+     */
+    Type peek();
+
+    bool readString(std::string_view* out);
+    bool readString(std::string* out);
+    bool readNumber(double* out);
+
+    /**
+     * @brief 读取整数；整数形式的数字按 int64 精确解析，带小数/指数时按 double 截断
+     * @details 超出 int64 范围（如 1e300）视为语法错误，返回 false 并设置 error()
+     */
+    bool readInt(int64_t* out);
+    bool readBool(bool* out);
+
+    /**
+     * @brief 跳过下一个值（包括整个对象或数组）
+     */
+    bool skipValue();
+
+    /**
+     * @brief 遍历对象成员，对每个键调用 on_member(std::string_view key)
+     * @return 下一个值不是对象或有语法错误时返回 false
+     */
+    template <typename Fn>
+    bool forEachMember(Fn&& on_member) {
+        if (!enterContainer('{')) return false;
+        std::string_view key;
+        bool first = true;
+        while (nextMember(&key, &first)) {
+            size_t before = pos_;
+            on_member(key);
+            if (error_ != nullptr) return false;
+            if (pos_ == before && !skipValue()) return false;
+        }
+        return error_ == nullptr;
+    }
+
+    /**
+     * @brief 遍历数组元素，对每个元素调用 on_element(size_t index)
+     */
+    template <typename Fn>
+    bool forEachElement(Fn&& on_element) {
+        if (!enterContainer('[')) return false;
+        bool first = true;
+        size_t index = 0;
+        while (nextElement(&first)) {
+            size_t before = pos_;
+            on_element(index++);
+            if (error_ != nullptr) return false;
+            if (pos_ == before && !skipValue()) return false;
+        }
+        return error_ == nullptr;
+    }
+
+    /**
+     * @brief 确认输入只剩空白字符
+     */
+    bool finish();
+
+    bool ok() const { return error_ == nullptr; }
+
+    /**
+     * @brief 错误描述（含出错位置），没有错误时为空
+     */
+    std::string error() const;
+
+private:
+    bool enterContainer(char open);
+    bool nextMember(std::string_view* key, bool* first);
+    bool nextElement(bool* first);
+    bool parseString(std::string_view* out, std::string* scratch);
+    bool scanNumber(std::string_view* out);
+    bool skipLiteral(std::string_view literal);
+    void skipWhitespace();
+    bool fail(const char* what);
+
+    std::string_view input_;
+    size_t pos_ = 0;
+    int depth_ = 0;
+    const char* error_ = nullptr;
+    size_t error_pos_ = 0;
+    std::string scratch_;      // 含转义的字符串值
+    std::deque<std::string> key_scratch_;  // 含转义的键，每层嵌套一个
+};
+
+}  // namespace simple_middleware
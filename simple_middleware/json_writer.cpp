@@ -0,0 +1,180 @@
+/*
+ * @Desc: 流式 JSON 写入器实现
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#include "json_writer.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+namespace simple_middleware {
+
+namespace {
+
+constexpr int64_t kPow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+// 缩放后超过该值时 int64 放不下（或精度已经没有意义），改用 %.17g
+constexpr double kMaxScaled = 9.0e18;
+
+}  // namespace
+
+JsonWriter::JsonWriter(std::string* out, int precision)
+    : out_(out),
+      precision_(precision < 0 ? 0 : (precision > kMaxPrecision ? kMaxPrecision : precision)) {
+    first_[0] = true;
+}
+
+void JsonWriter::separator() {
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+    if (first_[depth_]) {
+        first_[depth_] = false;
+    } else if (depth_ > 0) {
+        out_->push_back(',');
+    }
+}
+
+void JsonWriter::beginObject() {
+    separator();
+    out_->push_back('{');
+    if (depth_ < kMaxDepth) ++depth_;
+    first_[depth_] = true;
+}
+
+void JsonWriter::endObject() {
+    out_->push_back('}');
+    if (depth_ > 0) --depth_;
+}
+
+void JsonWriter::beginArray() {
+    separator();
+    out_->push_back('[');
+    if (depth_ < kMaxDepth) ++depth_;
+    first_[depth_] = true;
+}
+
+void JsonWriter::endArray() {
+    out_->push_back(']');
+    if (depth_ > 0) --depth_;
+}
+
+void JsonWriter::key(std::string_view name) {
+    separator();
+    appendEscaped(name);
+    out_->push_back(':');
+    after_key_ = true;
+}
+
+void JsonWriter::value(std::string_view str) {
+    separator();
+    appendEscaped(str);
+}
+
+void JsonWriter::value(bool b) {
+    separator();
+    out_->append(b ? "true" : "false");
+}
+
+void JsonWriter::value(long long v) {
+    separator();
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    out_->append(buf, res.ptr);
+}
+
+void JsonWriter::value(unsigned long long v) {
+    separator();
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    out_->append(buf, res.ptr);
+}
+
+void JsonWriter::value(double v) {
+    separator();
+    if (!std::isfinite(v)) {
+        out_->append("null");
+        return;
+    }
+
+    const int64_t scale = kPow10[precision_];
+    double scaled = v * static_cast<double>(scale);
+    if (std::fabs(scaled) >= kMaxScaled) {
+        char buf[32];
+        int n = std::snprintf(buf, sizeof(buf), "%.17g", v);
+        out_->append(buf, n);
+        return;
+    }
+
+    // 四舍五入到固定小数位后按整数输出：整数部分 + 去掉末尾 0 的小数部分
+    int64_t rounded = static_cast<int64_t>(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+    if (rounded < 0) {
+        out_->push_back('-');
+        rounded = -rounded;
+    }
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), rounded / scale);
+    out_->append(buf, res.ptr);
+
+    int64_t frac = rounded % scale;
+    if (frac != 0) {
+        int digits = precision_;
+        while (frac % 10 == 0) {
+            frac /= 10;
+            --digits;
+        }
+        char* end = buf + 1 + digits;
+        buf[0] = '.';
+        for (char* p = end - 1; p > buf; --p) {
+            *p = static_cast<char>('0' + frac % 10);
+            frac /= 10;
+        }
+        out_->append(buf, end);
+    }
+}
+
+void JsonWriter::null() {
+    separator();
+    out_->append("null");
+}
+
+void JsonWriter::raw(std::string_view json) {
+    separator();
+    out_->append(json.data(), json.size());
+}
+
+void JsonWriter::appendEscaped(std::string_view str) {
+    static const char kHex[] = "0123456789abcdef";
+    out_->push_back('"');
+    size_t run_start = 0;
+    for (size_t i = 0; i < str.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(str[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        // 连续的普通字符整段拷贝
+        out_->append(str.data() + run_start, i - run_start);
+        run_start = i + 1;
+        switch (c) {
+            case '"': out_->append("\\\""); break;
+            case '\\': out_->append("\\\\"); break;
+            case '\b': out_->append("\\b"); break;
+            case '\f': out_->append("\\f"); break;
+            case '\n': out_->append("\\n"); break;
+            case '\r': out_->append("\\r"); break;
+            case '\t': out_->append("\\t"); break;
+            default: {
+                char esc[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+                out_->append(esc, sizeof(esc));
+                break;
+            }
+        }
+    }
+    out_->append(str.data() + run_start, str.size() - run_start);
+    out_->push_back('"');
+}
+
+}  // namespace simple_middleware
@@ -0,0 +1,98 @@
+/*
+ * @Desc: 流式 JSON 写入器 - 直接追加到复用的字符串缓冲区，不构建 DOM
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace simple_middleware {
+
+/**
+ * @brief 流式 JSON 写入器
+ * @details 按顺序调用 beginObject()/key()/value()/endObject() 等接口，结果直接追加到调用方提供的缓冲区，
+ *          逗号和冒号由写入器自动处理。缓冲区在多次序列化之间复用（clear() 保留容量），
+ *          热身之后一次序列化不产生堆分配。
+ *
+ *          浮点数按固定小数位输出（默认 6 位，去掉末尾的 0），走整数格式化路径，
+ *          比 json11 使用的 snprintf("%.17g") 快得多；绝对值过大时退回 "%.17g"，非有限值输出 null（与 json11 一致）。
+ *
+ *          写入器不校验调用顺序（例如对象内连续两次 value()），调用方负责写出合法结构；嵌套深度上限 kMaxDepth。
+ *
+ * @code
+ *   std::string buf;
+ *   JsonWriter w(&buf);
+ *   w.beginObject();
+ *   w.field("type", "frame_data");
+ *   w.key("position"); w.beginObject(); w.field("x", 1.5); w.field("y", -2.0); w.endObject();
+ *   w.endObject();   // buf == {"type":"frame_data","position":{"x":1.5,"y":-2}}
+ * @endcode
+ */
+class JsonWriter {
+public:
+    static constexpr int kMaxDepth = 64;
+    static constexpr int kMaxPrecision = 9;
+
+    /**
+     * @param out 输出缓冲区，内容追加在已有数据之后（不会清空）
+     * @param precision 浮点数的小数位数（0-9）
+     */
+    explicit JsonWriter(std::string* out, int precision = 6);
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    /**
+     * @brief 写入对象的键，下一次 value()/beginObject()/beginArray() 作为它的值
+     */
+    void key(std::string_view name);
+
+    void value(std::string_view str);
+    void value(const char* str) { value(std::string_view(str)); }
+    void value(const std::string& str) { value(std::string_view(str)); }
+    void value(bool b);
+    void value(int v) { value(static_cast<long long>(v)); }
+    void value(long v) { value(static_cast<long long>(v)); }
+    void value(long long v);
+    void value(unsigned v) { value(static_cast<unsigned long long>(v)); }
+    void value(unsigned long v) { value(static_cast<unsigned long long>(v)); }
+    void value(unsigned long long v);
+    void value(double v);
+    void null();
+
+    /**
+     * @brief 写入已经序列化好的 JSON 片段（原样拷贝，不做校验）
+     */
+    void raw(std::string_view json);
+
+    /**
+     * @brief key(name) + value(v) 的简写
+     */
+    template <typename T>
+    void field(std::string_view name, const T& v) {
+        key(name);
+        value(v);
+    }
+
+    std::string* buffer() const { return out_; }
+
+private:
+    // 写值或键之前调用：同一容器内的第二个元素起先写逗号
+    void separator();
+    void appendEscaped(std::string_view str);
+
+    std::string* out_;
+    int precision_;
+    int depth_ = 0;
+    bool after_key_ = false;
+    std::array<bool, kMaxDepth + 1> first_{};  // 每层容器是否还没有写过元素
+};
+
+}  // namespace simple_middleware
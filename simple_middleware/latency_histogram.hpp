@@ -0,0 +1,197 @@
+/*
+ * @Desc: 无锁延迟直方图（对数-线性分桶）
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+namespace simple_middleware {
+
+/**
+ * @brief 直方图摘要
+ * @details 数值单位与 record() 时一致（通常是微秒或纳秒）
+ */
+struct LatencySummary {
+    uint64_t count = 0;
+    uint64_t min = 0;
+    uint64_t mean = 0;
+    uint64_t p50 = 0;
+    uint64_t p90 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+    uint64_t max = 0;
+};
+
+/**
+ * @brief 延迟直方图
+ * @details 对数-线性分桶（与 HdrHistogram 相同的思路）：每个 2 的幂区间再均分为 16 个子桶，
+ *          相对误差不超过 1/16（约 6%），覆盖 [0, 2^48) 只需 720 个桶。
+ *          record() 只做几次 relaxed 原子加，可以在回调/发布等热路径上多线程并发调用；
+ *          读取（percentile/summary）不加锁，与写入并发时得到的是近似快照。
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr uint64_t kSubBucketCount = 1ULL << kSubBucketBits;
+    static constexpr int kMaxMsb = 47;
+    static constexpr size_t kBucketCount = (kMaxMsb - kSubBucketBits + 1) * kSubBucketCount + kSubBucketCount;
+
+    LatencyHistogram() { reset(); }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * @brief 记录一个样本
+     */
+    void record(uint64_t value) {
+        buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t cur = max_.load(std::memory_order_relaxed);
+        while (value > cur && !max_.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {
+        }
+        cur = min_.load(std::memory_order_relaxed);
+        while (value < cur && !min_.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief 清空所有样本
+     * 【注意】与 record() 并发时可能丢失少量样本，只适合周期性"取摘要后清零"的统计窗口
+     */
+    void reset() {
+        for (auto& b : buckets_) {
+            b.store(0, std::memory_order_relaxed);
+        }
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+        min_.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 把另一个直方图的样本累加到本直方图（用于跨线程/跨窗口汇总）
+     */
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            uint64_t n = other.buckets_[i].load(std::memory_order_relaxed);
+            if (n != 0) {
+                buckets_[i].fetch_add(n, std::memory_order_relaxed);
+            }
+        }
+        count_.fetch_add(other.count(), std::memory_order_relaxed);
+        sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        uint64_t other_max = other.max();
+        uint64_t cur = max_.load(std::memory_order_relaxed);
+        while (other_max > cur && !max_.compare_exchange_weak(cur, other_max, std::memory_order_relaxed)) {
+        }
+        uint64_t other_min = other.min_.load(std::memory_order_relaxed);
+        cur = min_.load(std::memory_order_relaxed);
+        while (other_min < cur && !min_.compare_exchange_weak(cur, other_min, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    uint64_t min() const {
+        uint64_t v = min_.load(std::memory_order_relaxed);
+        return v == std::numeric_limits<uint64_t>::max() ? 0 : v;
+    }
+    uint64_t mean() const {
+        uint64_t n = count();
+        return n == 0 ? 0 : sum_.load(std::memory_order_relaxed) / n;
+    }
+
+    /**
+     * @brief 百分位数
+     * @param p 百分比，取值 [0, 100]
+     * @return 样本所在桶的上界（不超过观测到的最大值），没有样本时返回 0
+     */
+    uint64_t percentile(double p) const {
+        uint64_t total = count();
+        if (total == 0) {
+            return 0;
+        }
+        if (p < 0.0) p = 0.0;
+        if (p > 100.0) p = 100.0;
+
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total) + 0.5);
+        if (rank == 0) rank = 1;
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                uint64_t upper = bucketUpperBound(i);
+                uint64_t observed_max = max();
+                return upper < observed_max ? upper : observed_max;
+            }
+        }
+        return max();
+    }
+
+    LatencySummary summary() const {
+        LatencySummary s;
+        s.count = count();
+        if (s.count == 0) {
+            return s;
+        }
+        s.min = min();
+        s.mean = mean();
+        s.p50 = percentile(50.0);
+        s.p90 = percentile(90.0);
+        s.p99 = percentile(99.0);
+        s.p999 = percentile(99.9);
+        s.max = max();
+        return s;
+    }
+
+    /**
+     * @brief 值 -> 桶下标
+     * @details v < 16 时每个值一个桶；否则按最高位 msb 分组，组内取 msb 后面 4 位作为子桶
+     */
+    static size_t bucketIndex(uint64_t value) {
+        if (value < kSubBucketCount) {
+            return static_cast<size_t>(value);
+        }
+        int msb = 63 - __builtin_clzll(value);
+        if (msb > kMaxMsb) {
+            return kBucketCount - 1;
+        }
+        int shift = msb - kSubBucketBits;
+        uint64_t sub = (value >> shift) & (kSubBucketCount - 1);
+        return static_cast<size_t>((msb - kSubBucketBits + 1) * kSubBucketCount + sub);
+    }
+
+    /**
+     * @brief 桶下标 -> 该桶能表示的最大值
+     */
+    static uint64_t bucketUpperBound(size_t index) {
+        if (index < kSubBucketCount) {
+            return index;
+        }
+        uint64_t group = index / kSubBucketCount;  // = msb - kSubBucketBits + 1
+        uint64_t sub = index % kSubBucketCount;
+        int shift = static_cast<int>(group) - 1;
+        uint64_t lower = (kSubBucketCount + sub) << shift;
+        return lower + ((1ULL << shift) - 1);
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_;
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+    std::atomic<uint64_t> min_{std::numeric_limits<uint64_t>::max()};
+};
+
+}  // namespace simple_middleware
@@ -0,0 +1,69 @@
+/*
+ * @Desc: 压测消息头（DataPublisher 写入，TestSubscriber 解析）
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace simple_middleware {
+
+/**
+ * @brief 压测消息头
+ * @details 二进制负载的前 kSize 字节，按本机字节序逐字段 memcpy（压测两端在同一类机器上运行）：
+ *          magic(4) + publisher_id(4) + sequence(8) + send_ns(8) + topic_index(2) + flags(2) + payload_size(4)
+ *          send_ns 取 steady_clock，Linux 上是系统级单调时钟，同一台机器上的不同进程可以直接相减
+ */
+struct LoadTestHeader {
+    static constexpr uint32_t kMagic = 0x3148544C;  // "LTH1"
+    static constexpr size_t kSize = 32;
+
+    uint32_t publisher_id = 0;   // 发布者实例ID（区分同一话题上的多个发布者）
+    uint64_t sequence = 0;       // 该发布者在该话题上的序号，从 1 开始连续递增
+    int64_t send_ns = 0;         // 发送时刻（steady_clock 纳秒）
+    uint16_t topic_index = 0;    // 话题在发布者话题列表中的下标
+    uint16_t flags = 0;          // 保留
+    uint32_t payload_size = 0;   // 整条负载的字节数（含消息头）
+};
+
+/**
+ * @brief 把消息头写到 dst（至少 LoadTestHeader::kSize 字节）
+ */
+inline void EncodeLoadTestHeader(const LoadTestHeader& header, char* dst) {
+    uint32_t magic = LoadTestHeader::kMagic;
+    std::memcpy(dst + 0, &magic, 4);
+    std::memcpy(dst + 4, &header.publisher_id, 4);
+    std::memcpy(dst + 8, &header.sequence, 8);
+    std::memcpy(dst + 16, &header.send_ns, 8);
+    std::memcpy(dst + 24, &header.topic_index, 2);
+    std::memcpy(dst + 26, &header.flags, 2);
+    std::memcpy(dst + 28, &header.payload_size, 4);
+}
+
+/**
+ * @brief 从负载中解析消息头
+ * @return 负载太短或 magic 不匹配（不是压测消息）时返回 false
+ */
+inline bool DecodeLoadTestHeader(const std::string& data, LoadTestHeader* header) {
+    if (data.size() < LoadTestHeader::kSize) {
+        return false;
+    }
+    uint32_t magic = 0;
+    std::memcpy(&magic, data.data(), 4);
+    if (magic != LoadTestHeader::kMagic) {
+        return false;
+    }
+    std::memcpy(&header->publisher_id, data.data() + 4, 4);
+    std::memcpy(&header->sequence, data.data() + 8, 8);
+    std::memcpy(&header->send_ns, data.data() + 16, 8);
+    std::memcpy(&header->topic_index, data.data() + 24, 2);
+    std::memcpy(&header->flags, data.data() + 26, 2);
+    std::memcpy(&header->payload_size, data.data() + 28, 4);
+    return true;
+}
+
+}  // namespace simple_middleware
@@ -7,16 +7,151 @@
 #include <cstring>
 #include <unistd.h>
 #include <cerrno>
+#include <ctime>
+#include <array>
+#include <algorithm>
+#include <pthread.h>
+#include <cstdlib>
+#include <cctype>
 
 namespace simple_middleware {
 
+namespace detail {
+
+/**
+ * @brief 一条待写出的日志
+ */
+struct LogRecord {
+    int64_t timestamp_ns = 0;
+    LogLevel level = LogLevel::INFO;
+    std::string text;
+};
+
+/**
+ * @brief 单生产者单消费者环形缓冲区
+ * @details 生产者是拥有它的业务线程，消费者是刷新线程；head/tail 分处不同缓存行，
+ *          push 只有一次 acquire 读和一次 release 写，没有锁也没有系统调用
+ */
+class LogRing {
+public:
+    static constexpr size_t kCapacity = 4096;  // 必须是 2 的幂
+
+    bool Push(LogRecord&& record) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= kCapacity) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        slots_[head & (kCapacity - 1)] = std::move(record);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename Fn>
+    size_t Drain(Fn&& fn) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        uint64_t head = head_.load(std::memory_order_acquire);
+        size_t n = 0;
+        for (; tail < head; ++tail, ++n) {
+            fn(std::move(slots_[tail & (kCapacity - 1)]));
+        }
+        tail_.store(tail, std::memory_order_release);
+        return n;
+    }
+
+    // 丢弃未写出的记录（fork 后子进程中清理父进程其他线程留下的内容）
+    void Discard() { tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release); }
+
+    bool Empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    uint64_t TakeDropped() { return dropped_.exchange(0, std::memory_order_relaxed); }
+
+    std::atomic<bool> orphaned{false};  // 所属线程已退出，写空后可以回收
+
+private:
+    std::array<LogRecord, kCapacity> slots_;
+    alignas(64) std::atomic<uint64_t> head_{0};
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    alignas(64) std::atomic<uint64_t> dropped_{0};
+};
+
+}  // namespace detail
+
+namespace {
+
+// 刷新线程的最长等待时间，也就是普通日志的最大写出延迟
+constexpr auto kFlushInterval = std::chrono::milliseconds(20);
+
+// Logger 析构后（静态对象析构顺序不确定）仍有日志时，直接同步写 stderr
+std::atomic<bool> g_logger_destroyed{false};
+
+// 线程退出时把缓冲区标记为孤儿，交给刷新线程写空后回收
+struct ThreadRingHolder {
+    std::shared_ptr<detail::LogRing> ring;
+    ~ThreadRingHolder() {
+        if (ring) {
+            ring->orphaned.store(true, std::memory_order_release);
+        }
+    }
+};
+thread_local ThreadRingHolder t_ring_holder;
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+const char* LevelTag(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "[DEBUG] ";
+        case LogLevel::INFO:  return "[INFO]  ";
+        case LogLevel::WARN:  return "[WARN]  ";
+        case LogLevel::ERROR: return "[ERROR] ";
+    }
+    return "";
+}
+
+}  // namespace
+
+Logger::Logger() {
+    // fork() 只复制调用线程：子进程里没有刷新线程，锁也可能停在被其他线程持有的状态
+    pthread_atfork(&Logger::OnForkPrepare, &Logger::OnForkParent, &Logger::OnForkChild);
+}
+
 Logger::~Logger() {
+    stopping_ = true;
+    wake_cv_.notify_all();
+    if (flusher_ && flusher_->joinable()) {
+        flusher_->join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(flush_mutex_);
+        DrainLocked();
+    }
+    g_logger_destroyed = true;
     if (log_file_.is_open()) {
         log_file_.close();
     }
 }
 
+void Logger::SetLevel(LogLevel level) {
+    int value = std::max(static_cast<int>(level), SIMPLE_LOG_MIN_LEVEL);
+    detail::g_runtime_log_level.store(value, std::memory_order_relaxed);
+}
+
 void Logger::Init(const std::string& module_name, const std::string& log_file_path) {
+    // 运行期级别可以通过环境变量调整，不需要重新编译
+    if (const char* env = std::getenv("SIMPLE_LOG_LEVEL")) {
+        std::string value(env);
+        std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+        if (value == "debug") SetLevel(LogLevel::DEBUG);
+        else if (value == "info") SetLevel(LogLevel::INFO);
+        else if (value == "warn") SetLevel(LogLevel::WARN);
+        else if (value == "error") SetLevel(LogLevel::ERROR);
+    }
+
     std::lock_guard<std::mutex> lock(mutex_);
     module_name_ = module_name;
     
@@ -58,36 +193,170 @@ void Logger::Init(const std::string& module_name, const std::string& log_file_pa
     initialized_ = true;
 }
 
+detail::LogRing* Logger::ThreadRing() {
+    if (!t_ring_holder.ring) {
+        auto ring = std::make_shared<detail::LogRing>();
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        rings_.push_back(ring);
+        t_ring_holder.ring = std::move(ring);
+    }
+    return t_ring_holder.ring.get();
+}
+
+void Logger::StartFlusher() {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    if (flusher_started_.load(std::memory_order_acquire)) {
+        return;
+    }
+    flusher_ = std::make_unique<std::thread>(&Logger::FlushLoop, this);
+    flusher_started_.store(true, std::memory_order_release);
+}
+
 void Logger::Log(LogLevel level, const std::string& message) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-    std::stringstream ss;
-    ss << "[" << std::put_time(std::localtime(&now), "%H:%M:%S") << "] ";
-    
-    switch (level) {
-        case LogLevel::DEBUG: ss << "[DEBUG] "; break;
-        case LogLevel::INFO:  ss << "[INFO]  "; break;
-        case LogLevel::WARN:  ss << "[WARN]  "; break;
-        case LogLevel::ERROR: ss << "[ERROR] "; break;
+    Log(level, std::string(message));
+}
+
+void Logger::Log(LogLevel level, std::string&& message) {
+    if (!IsEnabled(level)) {
+        return;
     }
-    
-    if (!module_name_.empty()) {
-        ss << "[" << module_name_ << "] ";
+    if (g_logger_destroyed.load(std::memory_order_relaxed)) {
+        std::cerr << LevelTag(level) << message << std::endl;
+        return;
     }
-    
-    ss << message;
-    
-    std::string final_msg = ss.str();
-    
-    // Output to console
-    std::cout << final_msg << std::endl;
-    
-    // Output to file
+    if (!flusher_started_.load(std::memory_order_acquire)) {
+        StartFlusher();
+    }
+
+    detail::LogRecord record;
+    record.timestamp_ns = NowNs();
+    record.level = level;
+    record.text = std::move(message);
+    if (!ThreadRing()->Push(std::move(record))) {
+        // 缓冲区满：丢弃并计数，由刷新线程汇报，绝不阻塞调用线程
+        wake_cv_.notify_one();
+        return;
+    }
+
+    // 告警和错误尽快写出；普通日志最多等一个刷新周期
+    if (level == LogLevel::WARN || level == LogLevel::ERROR) {
+        wake_cv_.notify_one();
+    }
+}
+
+void Logger::Flush() {
+    std::lock_guard<std::mutex> lock(flush_mutex_);
+    DrainLocked();
+}
+
+void Logger::FlushLoop() {
+    while (!stopping_) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait_for(lock, kFlushInterval);
+        }
+        std::lock_guard<std::mutex> lock(flush_mutex_);
+        DrainLocked();
+    }
+}
+
+void Logger::DrainLocked() {
+    // 1. 取出缓冲区列表快照，顺便回收所属线程已退出且已写空的缓冲区
+    std::vector<std::shared_ptr<detail::LogRing>> rings;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        rings_.erase(std::remove_if(rings_.begin(), rings_.end(), [](const std::shared_ptr<detail::LogRing>& ring) {
+            return ring->orphaned.load(std::memory_order_acquire) && ring->Empty();
+        }), rings_.end());
+        rings = rings_;
+    }
+
+    // 2. 收集所有记录，按时间排序（同一线程内本来就有序，stable_sort 保持先后）
+    std::vector<detail::LogRecord> batch;
+    uint64_t dropped = 0;
+    for (auto& ring : rings) {
+        ring->Drain([&batch](detail::LogRecord&& record) { batch.push_back(std::move(record)); });
+        dropped += ring->TakeDropped();
+    }
+    if (dropped > 0) {
+        dropped_total_.fetch_add(dropped, std::memory_order_relaxed);
+        detail::LogRecord note;
+        note.timestamp_ns = NowNs();
+        note.level = LogLevel::WARN;
+        note.text = "[Logger] " + std::to_string(dropped) + " log lines dropped (thread buffer full)";
+        batch.push_back(std::move(note));
+    }
+    if (batch.empty()) {
+        return;
+    }
+    std::stable_sort(batch.begin(), batch.end(), [](const detail::LogRecord& a, const detail::LogRecord& b) {
+        return a.timestamp_ns < b.timestamp_ns;
+    });
+
+    // 3. 格式化并批量写出；同一秒内的时间前缀只格式化一次
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out;
+    out.reserve(batch.size() * 96);
+    time_t cached_second = -1;
+    char time_prefix[32] = {0};
+    for (const auto& record : batch) {
+        time_t second = static_cast<time_t>(record.timestamp_ns / 1000000000LL);
+        if (second != cached_second) {
+            struct tm tm_buf;
+            localtime_r(&second, &tm_buf);
+            strftime(time_prefix, sizeof(time_prefix), "[%H:%M:%S] ", &tm_buf);
+            cached_second = second;
+        }
+        out += time_prefix;
+        out += LevelTag(record.level);
+        if (!module_name_.empty()) {
+            out += "[";
+            out += module_name_;
+            out += "] ";
+        }
+        out += record.text;
+        out += '\n';
+    }
+
+    std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+    std::cout.flush();
     if (log_file_.is_open()) {
-        log_file_ << final_msg << std::endl;
-        log_file_.flush(); // 确保实时写入
+        log_file_.write(out.data(), static_cast<std::streamsize>(out.size()));
+        log_file_.flush();
+    }
+}
+
+void Logger::OnForkPrepare() {
+    Logger& logger = GetInstance();
+    logger.flush_mutex_.lock();
+    logger.registry_mutex_.lock();
+    logger.mutex_.lock();
+}
+
+void Logger::OnForkParent() {
+    Logger& logger = GetInstance();
+    logger.mutex_.unlock();
+    logger.registry_mutex_.unlock();
+    logger.flush_mutex_.unlock();
+}
+
+void Logger::OnForkChild() {
+    Logger& logger = GetInstance();
+    logger.mutex_.unlock();
+    logger.registry_mutex_.unlock();
+    logger.flush_mutex_.unlock();
+
+    // fork 前已进入缓冲区的日志由父进程负责写出，子进程里全部丢掉，避免输出两遍；
+    // 子进程只有发起 fork 的线程，其他线程的缓冲区直接标记为孤儿
+    for (auto& ring : logger.rings_) {
+        ring->Discard();
+        if (ring != t_ring_holder.ring) {
+            ring->orphaned.store(true, std::memory_order_release);
+        }
     }
+    // 刷新线程在子进程中不存在，丢弃线程对象（不能 join/detach），下次打日志时重新启动
+    (void)logger.flusher_.release();
+    logger.flusher_started_.store(false, std::memory_order_release);
 }
 
 } // namespace simple_middleware
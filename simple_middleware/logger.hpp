@@ -6,6 +6,22 @@
 #include <iostream>
 #include <memory>
 #include <sstream>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @brief 编译期最低日志级别：0=DEBUG 1=INFO 2=WARN 3=ERROR
+ * @details 低于该级别的 LOG_* 语句条件恒为 false，流参数不会求值，优化后整条语句被消除。
+ *          通过 -DSIMPLE_LOG_MIN_LEVEL=1 设置（build_all.sh 读取同名环境变量）
+ */
+#ifndef SIMPLE_LOG_MIN_LEVEL
+#define SIMPLE_LOG_MIN_LEVEL 0
+#endif
 
 namespace simple_middleware {
 
@@ -16,6 +32,60 @@ enum class LogLevel {
     ERROR
 };
 
+namespace detail {
+class LogRing;
+
+// 运行期最低日志级别（内联变量，判断时不经过 GetInstance() 的静态局部变量初始化检查）
+inline std::atomic<int> g_runtime_log_level{SIMPLE_LOG_MIN_LEVEL};
+
+/**
+ * @brief 单个日志调用点的计数状态（LOG_EVERY_N / LOG_FIRST_N / LOG_EVERY_MS 使用）
+ * @details 每个调用点一个静态实例，多线程同时命中时只用原子操作，不加锁
+ */
+struct LogSite {
+    std::atomic<uint64_t> count{0};
+    std::atomic<int64_t> last_ns{std::numeric_limits<int64_t>::min()};
+};
+
+// 第 1、n+1、2n+1 ... 次命中时返回 true
+inline bool LogSiteEveryN(LogSite& site, uint64_t n) {
+    uint64_t c = site.count.fetch_add(1, std::memory_order_relaxed);
+    return n <= 1 || c % n == 0;
+}
+
+// 前 n 次命中时返回 true（之后只做一次读，计数不再增长）
+inline bool LogSiteFirstN(LogSite& site, uint64_t n) {
+    if (site.count.load(std::memory_order_relaxed) >= n) {
+        return false;
+    }
+    return site.count.fetch_add(1, std::memory_order_relaxed) < n;
+}
+
+// 距上次输出至少 interval_ms 时返回 true；多个线程同时到期时只有一个能抢到
+inline bool LogSiteEveryMs(LogSite& site, int64_t interval_ms) {
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t last = site.last_ns.load(std::memory_order_relaxed);
+    if (last != std::numeric_limits<int64_t>::min() && now - last < interval_ms * 1000000) {
+        return false;
+    }
+    return site.last_ns.compare_exchange_strong(last, now, std::memory_order_relaxed);
+}
+
+// 让 "cond ? (void)0 : LogVoidify() & LogStream(...) << ..." 两个分支类型一致
+struct LogVoidify {
+    template <typename T>
+    void operator&(const T&) const {}
+};
+}  // namespace detail
+
+/**
+ * @brief 异步日志
+ * @details 调用线程只把"时间戳 + 级别 + 已拼好的文本"放进本线程独占的无锁环形缓冲区（单生产者单消费者），
+ *          时间格式化、写控制台和写文件都由后台刷新线程批量完成，一批只 flush 一次。
+ *          缓冲区满时直接丢弃并计数，绝不阻塞调用线程（控制回路里打日志不会被磁盘 IO 拖慢），
+ *          丢弃的条数由刷新线程以 WARN 日志报告。
+ */
 class Logger {
 public:
     static Logger& GetInstance() {
@@ -25,24 +95,75 @@ public:
 
     void Init(const std::string& module_name, const std::string& log_file_path = "");
     void Log(LogLevel level, const std::string& message);
+    void Log(LogLevel level, std::string&& message);
+
+    /**
+     * @brief 设置运行期最低日志级别（不能低于编译期的 SIMPLE_LOG_MIN_LEVEL）
+     * @details Init() 会读取环境变量 SIMPLE_LOG_LEVEL（debug/info/warn/error）作为初始值
+     */
+    static void SetLevel(LogLevel level);
+    static LogLevel GetLevel() {
+        return static_cast<LogLevel>(detail::g_runtime_log_level.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief 该级别的日志是否会输出（在拼接日志内容之前判断）
+     */
+    static bool IsEnabled(LogLevel level) {
+        return static_cast<int>(level) >= SIMPLE_LOG_MIN_LEVEL &&
+               static_cast<int>(level) >= detail::g_runtime_log_level.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 同步刷出所有线程缓冲区中的日志（进程退出前 / 崩溃处理中调用）
+     */
+    void Flush();
 
-    static void Info(const std::string& msg) { GetInstance().Log(LogLevel::INFO, msg); }
-    static void Warn(const std::string& msg) { GetInstance().Log(LogLevel::WARN, msg); }
-    static void Error(const std::string& msg) { GetInstance().Log(LogLevel::ERROR, msg); }
-    static void Debug(const std::string& msg) { GetInstance().Log(LogLevel::DEBUG, msg); }
+    /**
+     * @brief 因缓冲区满被丢弃的日志条数（累计）
+     */
+    uint64_t GetDroppedCount() const { return dropped_total_.load(std::memory_order_relaxed); }
+
+    // 注意：参数在调用前已经拼接好，热路径上请用 LOG_* 宏（级别关闭时不求值）
+    static void Info(const std::string& msg) { if (IsEnabled(LogLevel::INFO)) GetInstance().Log(LogLevel::INFO, msg); }
+    static void Warn(const std::string& msg) { if (IsEnabled(LogLevel::WARN)) GetInstance().Log(LogLevel::WARN, msg); }
+    static void Error(const std::string& msg) { if (IsEnabled(LogLevel::ERROR)) GetInstance().Log(LogLevel::ERROR, msg); }
+    static void Debug(const std::string& msg) { if (IsEnabled(LogLevel::DEBUG)) GetInstance().Log(LogLevel::DEBUG, msg); }
 
 private:
-    Logger() = default;
+    Logger();
     ~Logger();
     
     // 禁止拷贝
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
 
+    // 当前线程的缓冲区（首次使用时创建并登记）
+    detail::LogRing* ThreadRing();
+    void StartFlusher();
+    void FlushLoop();
+    // 取出所有缓冲区中的日志，格式化后批量写出（调用方持有 flush_mutex_）
+    void DrainLocked();
+
+    // fork() 时保持锁状态一致，子进程中重新启动刷新线程
+    static void OnForkPrepare();
+    static void OnForkParent();
+    static void OnForkChild();
+
     std::string module_name_;
     std::ofstream log_file_;
-    std::mutex mutex_;
+    std::mutex mutex_;                  // 保护 module_name_ / log_file_
     bool initialized_ = false;
+
+    std::mutex registry_mutex_;         // 保护 rings_ / flusher_
+    std::vector<std::shared_ptr<detail::LogRing>> rings_;
+    std::unique_ptr<std::thread> flusher_;
+    std::atomic<bool> flusher_started_{false};
+    std::atomic<bool> stopping_{false};
+    std::mutex flush_mutex_;            // 同一时刻只有一个消费者（刷新线程或 Flush()）
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::atomic<uint64_t> dropped_total_{0};
 };
 
 // 日志流类，支持 << 操作符
@@ -80,9 +201,45 @@ private:
 };
 
 // 日志宏定义
-#define LOG_DEBUG(module) simple_middleware::LogStream(simple_middleware::LogLevel::DEBUG, module)
-#define LOG_INFO(module) simple_middleware::LogStream(simple_middleware::LogLevel::INFO, module)
-#define LOG_WARN(module) simple_middleware::LogStream(simple_middleware::LogLevel::WARN, module)
-#define LOG_ERROR(module) simple_middleware::LogStream(simple_middleware::LogLevel::ERROR, module)
+// 级别关闭（编译期或运行期）时右侧的 LogStream 不会构造，<< 后面的参数也不会求值：
+//   LOG_DEBUG("Control") << "speed=" << ComputeSpeed();   // DEBUG 关闭时 ComputeSpeed() 不会被调用
+#define SIMPLE_LOG_IS_ON_(level) \
+    (static_cast<int>(level) >= SIMPLE_LOG_MIN_LEVEL && simple_middleware::Logger::IsEnabled(level))
+
+#define SIMPLE_LOG_STREAM_IF_(level, module, condition) \
+    !(SIMPLE_LOG_IS_ON_(level) && (condition)) \
+        ? (void)0 \
+        : simple_middleware::detail::LogVoidify() & simple_middleware::LogStream(level, module)
+
+// 每个宏展开处的 lambda 类型不同，其中的静态 LogSite 即该调用点独有的计数器
+#define SIMPLE_LOG_SITE_() \
+    ([]() -> simple_middleware::detail::LogSite& { \
+        static simple_middleware::detail::LogSite site; \
+        return site; \
+    }())
+
+#define LOG_DEBUG(module) SIMPLE_LOG_STREAM_IF_(simple_middleware::LogLevel::DEBUG, module, true)
+#define LOG_INFO(module) SIMPLE_LOG_STREAM_IF_(simple_middleware::LogLevel::INFO, module, true)
+#define LOG_WARN(module) SIMPLE_LOG_STREAM_IF_(simple_middleware::LogLevel::WARN, module, true)
+#define LOG_ERROR(module) SIMPLE_LOG_STREAM_IF_(simple_middleware::LogLevel::ERROR, module, true)
+
+// 条件日志：LOG_IF(WARN, "Planning", points.empty()) << "...";
+#define LOG_IF(severity, module, condition) \
+    SIMPLE_LOG_STREAM_IF_(simple_middleware::LogLevel::severity, module, condition)
+
+// 限频日志（替代调用点上的 static int count 计数）：
+//   LOG_EVERY_N(WARN, "Control", 100) << ...;  第 1、101、201 ... 次输出
+//   LOG_FIRST_N(INFO, "Map", 5) << ...;        只输出前 5 次
+//   LOG_EVERY_MS(DEBUG, "Sim", 1000) << ...;   每秒最多输出一次
+// 计数只在该级别开启时进行
+#define LOG_EVERY_N(severity, module, n) \
+    SIMPLE_LOG_STREAM_IF_(simple_middleware::LogLevel::severity, module, \
+                          simple_middleware::detail::LogSiteEveryN(SIMPLE_LOG_SITE_(), (n)))
+#define LOG_FIRST_N(severity, module, n) \
+    SIMPLE_LOG_STREAM_IF_(simple_middleware::LogLevel::severity, module, \
+                          simple_middleware::detail::LogSiteFirstN(SIMPLE_LOG_SITE_(), (n)))
+#define LOG_EVERY_MS(severity, module, interval_ms) \
+    SIMPLE_LOG_STREAM_IF_(simple_middleware::LogLevel::severity, module, \
+                          simple_middleware::detail::LogSiteEveryMs(SIMPLE_LOG_SITE_(), (interval_ms)))
 
 } // namespace simple_middleware
@@ -0,0 +1,69 @@
+#include "loop_monitor.hpp"
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace simple_middleware {
+
+namespace {
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+LoopMonitor::LoopMonitor(const std::string& name, std::chrono::nanoseconds period)
+    : name_(name), period_ns_(period.count() > 0 ? period.count() : 1) {}
+
+void LoopMonitor::beginCycle() {
+    int64_t now = NowNs();
+    if (last_begin_ns_ == 0) {
+        tid_.store(static_cast<int>(syscall(SYS_gettid)), std::memory_order_relaxed);
+    } else {
+        int64_t interval = now - last_begin_ns_;
+        int64_t deviation = interval > period_ns_ ? interval - period_ns_ : period_ns_ - interval;
+        interval_window_.record(static_cast<uint64_t>(interval));
+        jitter_window_.record(static_cast<uint64_t>(deviation));
+        if (interval * 2 > period_ns_ * 3) {
+            late_window_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    last_begin_ns_ = now;
+    begin_ns_ = now;
+    begin_allocs_ = AllocTracker::ThreadCounters();
+}
+
+void LoopMonitor::endCycle() {
+    int64_t exec = NowNs() - begin_ns_;
+    AllocCounters allocs = AllocTracker::ThreadCounters();
+    exec_window_.record(static_cast<uint64_t>(exec));
+    allocs_window_.record(allocs.allocs - begin_allocs_.allocs);
+    alloc_count_window_.fetch_add(allocs.allocs - begin_allocs_.allocs, std::memory_order_relaxed);
+    alloc_bytes_window_.fetch_add(allocs.bytes - begin_allocs_.bytes, std::memory_order_relaxed);
+    total_cycles_.fetch_add(1, std::memory_order_relaxed);
+    if (exec > period_ns_) {
+        overruns_window_.fetch_add(1, std::memory_order_relaxed);
+        total_overruns_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+LoopWindowStats LoopMonitor::takeWindow() {
+    LoopWindowStats stats;
+    stats.exec = exec_window_.summary();
+    stats.interval = interval_window_.summary();
+    stats.jitter = jitter_window_.summary();
+    stats.cycles = stats.exec.count;
+    stats.overruns = overruns_window_.exchange(0, std::memory_order_relaxed);
+    stats.late_cycles = late_window_.exchange(0, std::memory_order_relaxed);
+    stats.allocs = allocs_window_.summary();
+    stats.alloc_count = alloc_count_window_.exchange(0, std::memory_order_relaxed);
+    stats.alloc_bytes = alloc_bytes_window_.exchange(0, std::memory_order_relaxed);
+    exec_window_.reset();
+    allocs_window_.reset();
+    interval_window_.reset();
+    jitter_window_.reset();
+    return stats;
+}
+
+}  // namespace simple_middleware
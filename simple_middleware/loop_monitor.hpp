@@ -0,0 +1,113 @@
+/*
+ * @Desc: 周期循环监控 - 统计循环的实际周期、抖动、执行耗时和超时次数
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "alloc_tracker.hpp"
+#include "latency_histogram.hpp"
+
+namespace simple_middleware {
+
+/**
+ * @brief 一个统计窗口内的循环时序（时间单位纳秒）
+ */
+struct LoopWindowStats {
+    uint64_t cycles = 0;
+    LatencySummary interval;  // 相邻两次周期开始的间隔
+    LatencySummary jitter;    // |间隔 - 目标周期|
+    LatencySummary exec;      // 循环体执行耗时
+    uint64_t overruns = 0;    // 执行耗时超过目标周期
+    uint64_t late_cycles = 0; // 间隔超过 1.5 倍目标周期
+    LatencySummary allocs;    // 每个周期的堆分配次数（需开启 SIMPLE_TRACK_ALLOCATIONS）
+    uint64_t alloc_count = 0; // 窗口内堆分配的总次数
+    uint64_t alloc_bytes = 0; // 窗口内堆分配的总字节数
+};
+
+/**
+ * @brief 周期循环监控
+ * @details 由 StatusReporter::RegisterLoop() 创建，循环线程在每个周期开始时调用 beginCycle()、
+ *          工作完成（睡眠之前）时调用 endCycle()，或直接用 LoopCycle 包住循环体。
+ *          记录只做几次 relaxed 原子操作；StatusReporter 每秒调用 takeWindow() 取走窗口统计并清零。
+ */
+class LoopMonitor {
+public:
+    LoopMonitor(const std::string& name, std::chrono::nanoseconds period);
+
+    LoopMonitor(const LoopMonitor&) = delete;
+    LoopMonitor& operator=(const LoopMonitor&) = delete;
+
+    /**
+     * @brief 周期开始（只能由循环所在的线程调用）
+     */
+    void beginCycle();
+
+    /**
+     * @brief 周期内的工作完成
+     */
+    void endCycle();
+
+    /**
+     * @brief 取走当前窗口的统计并开始新窗口（上报线程调用）
+     */
+    LoopWindowStats takeWindow();
+
+    const std::string& name() const { return name_; }
+    int64_t periodNs() const { return period_ns_; }
+    uint64_t totalCycles() const { return total_cycles_.load(std::memory_order_relaxed); }
+    uint64_t totalOverruns() const { return total_overruns_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 运行该循环的线程 ID（首次 beginCycle() 之前为 0）
+     */
+    int tid() const { return tid_.load(std::memory_order_relaxed); }
+
+private:
+    std::string name_;
+    int64_t period_ns_;
+
+    // 仅循环线程访问
+    int64_t last_begin_ns_ = 0;
+    int64_t begin_ns_ = 0;
+    AllocCounters begin_allocs_;
+
+    std::atomic<int> tid_{0};
+    LatencyHistogram interval_window_;
+    LatencyHistogram jitter_window_;
+    LatencyHistogram exec_window_;
+    LatencyHistogram allocs_window_;
+    std::atomic<uint64_t> alloc_count_window_{0};
+    std::atomic<uint64_t> alloc_bytes_window_{0};
+    std::atomic<uint64_t> overruns_window_{0};
+    std::atomic<uint64_t> late_window_{0};
+    std::atomic<uint64_t> total_cycles_{0};
+    std::atomic<uint64_t> total_overruns_{0};
+};
+
+/**
+ * @brief RAII：构造时 beginCycle()，析构时 endCycle()
+ * @details 放在循环体开头、睡眠之外的作用域里；monitor 为空时什么都不做
+ */
+class LoopCycle {
+public:
+    explicit LoopCycle(LoopMonitor* monitor) : monitor_(monitor) {
+        if (monitor_) monitor_->beginCycle();
+    }
+    ~LoopCycle() {
+        if (monitor_) monitor_->endCycle();
+    }
+
+    LoopCycle(const LoopCycle&) = delete;
+    LoopCycle& operator=(const LoopCycle&) = delete;
+
+private:
+    LoopMonitor* monitor_;
+};
+
+}  // namespace simple_middleware
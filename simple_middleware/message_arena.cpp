@@ -0,0 +1,59 @@
+/*
+ * @Desc: 按周期复用的 protobuf Arena 实现
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#include "message_arena.hpp"
+
+namespace simple_middleware {
+
+namespace {
+
+// protobuf 要求初始块至少能放下内部的块头，过小的块等于没有
+constexpr size_t kMinBlockSize = 1024;
+
+size_t RoundUpPow2(size_t n) {
+    size_t v = kMinBlockSize;
+    while (v < n) v <<= 1;
+    return v;
+}
+
+}  // namespace
+
+MessageArena::MessageArena(size_t initial_block_size)
+    : block_size_(RoundUpPow2(initial_block_size)) {
+    createArena();
+}
+
+MessageArena::~MessageArena() {
+    // Arena 先析构（会访问初始块中的块头），再释放初始块
+    arena_.reset();
+}
+
+void MessageArena::createArena() {
+    block_.reset(new char[block_size_]);
+    google::protobuf::ArenaOptions options;
+    options.initial_block = block_.get();
+    options.initial_block_size = block_size_;
+    arena_ = std::make_unique<google::protobuf::Arena>(options);
+}
+
+size_t MessageArena::spaceAllocated() const {
+    return static_cast<size_t>(arena_->SpaceAllocated());
+}
+
+void MessageArena::reset() {
+    size_t used = spaceAllocated();
+    if (used <= block_size_) {
+        // 只用了初始块：Reset 保留初始块，不涉及堆
+        arena_->Reset();
+        return;
+    }
+    // 本周期溢出到额外的块：换一个能放下这个用量的初始块
+    arena_.reset();
+    block_size_ = RoundUpPow2(used);
+    createArena();
+}
+
+}  // namespace simple_middleware
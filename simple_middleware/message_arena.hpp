@@ -0,0 +1,82 @@
+/*
+ * @Desc: 按周期复用的 protobuf Arena - 每帧构造/解析的消息放在同一块内存里，周期结束整体释放
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include <google/protobuf/arena.h>
+
+namespace simple_middleware {
+
+/**
+ * @brief 按周期复用的 protobuf Arena
+ * @details 每个周期开始时调用 reset()，然后用 create<T>() 构造本周期的消息；
+ *          消息及其嵌套子消息、字符串、repeated 字段都从 Arena 的内存块里顺序分配，
+ *          不再为每个 Obstacle / Point3D 单独 new，reset() 时整体释放，不逐个析构。
+ *
+ *          Arena 使用自己持有的初始内存块：reset() 后初始块保留复用。
+ *          某个周期用量超过初始块时，下一次 reset() 把初始块扩大到该用量，
+ *          之后同等规模的周期不再产生堆分配。
+ *
+ *          非线程安全；create() 返回的指针在下一次 reset() 之前有效，不能跨周期保存
+ *          （需要保留的数据拷贝到堆上的消息里，例如 member_ = *msg）。
+ *
+ * @code
+ *   arena_.reset();
+ *   auto* det = arena_.create<senseauto::demo::Detection2DArray>();
+ *   det->add_boxes()->set_label("car");
+ *   middleware.publish(topics::kDetection2D, *det);
+ * @endcode
+ */
+class MessageArena {
+public:
+    static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+    /**
+     * @param initial_block_size 初始内存块大小（字节），之后按实际用量自动扩大
+     */
+    explicit MessageArena(size_t initial_block_size = kDefaultBlockSize);
+    ~MessageArena();
+
+    MessageArena(const MessageArena&) = delete;
+    MessageArena& operator=(const MessageArena&) = delete;
+
+    /**
+     * @brief 在 Arena 上构造一个空消息
+     */
+    template <typename T>
+    T* create() {
+        return google::protobuf::Arena::CreateMessage<T>(arena_.get());
+    }
+
+    /**
+     * @brief 释放本周期构造的所有消息，必要时扩大初始块
+     */
+    void reset();
+
+    google::protobuf::Arena* get() const { return arena_.get(); }
+
+    /**
+     * @brief 当前初始块大小（字节）
+     */
+    size_t blockSize() const { return block_size_; }
+
+    /**
+     * @brief 本周期已占用的内存（字节，含初始块）
+     */
+    size_t spaceAllocated() const;
+
+private:
+    void createArena();
+
+    std::unique_ptr<char[]> block_;
+    size_t block_size_;
+    std::unique_ptr<google::protobuf::Arena> arena_;
+};
+
+}  // namespace simple_middleware
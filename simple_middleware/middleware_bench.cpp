@@ -0,0 +1,554 @@
+/*
+ * @Desc: 中间件吞吐/延迟基准测试
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ *
+ * 测量 publish → 订阅回调 的延迟（p50/p90/p99/p99.9/max）和吞吐，扫描以下维度：
+ *   - 负载大小：默认 64B / 1KB / 16KB / 64KB / 1MB
+ *   - 订阅者扇出：默认 1 / 8 / 64
+ *   - 发布线程数：默认 1 / 4
+ *   - 投递方式：
+ *       local     同一中间件实例，发布线程内直接分发（进程内最短路径）
+ *       loopback  同一 domain 的两个实例，经 LoopbackTransport 投递线程（跨实例）
+ *       udp       发布者、订阅者各 fork 一个子进程，经 UDP 广播（跨进程，受单包 64KB 限制）
+ *
+ * 使用方法：
+ *   ./middleware_bench [--modes local,loopback,udp] [--sizes 64,1024,...] [--fanout 1,8,64]
+ *                      [--threads 1,4] [--messages 20000] [--udp-rate 20000] [--udp-port 18999]
+ *                      [--out middleware_bench.json]
+ *
+ * 结果以 JSON 写入 --out 指定的文件（"-" 表示标准输出），便于跨版本对比回归。
+ * 每条消息负载的前 8 字节是发送时刻（steady_clock 纳秒，Linux 上为系统级单调时钟，可跨进程比较）。
+ */
+
+#include "pub_sub_middleware.hpp"
+#include "latency_histogram.hpp"
+#include "logger.hpp"
+#include "json11.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace simple_middleware;
+
+namespace {
+
+inline constexpr Topic<std::string> kBenchTopic{"bench/data", kPriorityBestEffort};
+
+// 负载头：发送时刻(8) + 发布线程号(4) + 序号(4)
+constexpr size_t kHeaderSize = 16;
+// UDP 单个数据报上限 65507，再减去话题名和分隔符
+constexpr size_t kUdpMaxPayload = 65507 - 11;
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct BenchOptions {
+    std::vector<std::string> modes{"local", "loopback", "udp"};
+    std::vector<size_t> sizes{64, 1024, 16384, 65536, 1048576};
+    std::vector<int> fanouts{1, 8, 64};
+    std::vector<int> threads{1, 4};
+    uint64_t messages = 20000;               // 每个发布线程的消息数上限
+    uint64_t min_messages = 100;             // 大负载时每线程至少发送的消息数
+    uint64_t bytes_budget = 32ULL << 20;     // 每个发布线程的字节预算，用于缩减大负载的消息数
+    uint64_t udp_rate = 20000;               // UDP 模式下每个发布线程的发送速率（条/秒），0 表示不限速
+    int udp_port = 18999;                    // 与系统默认端口分开，避免干扰正在运行的节点
+    std::string out = "middleware_bench.json";
+};
+
+struct BenchCase {
+    std::string mode;
+    size_t payload = 0;
+    int fanout = 1;
+    int threads = 1;
+    uint64_t messages = 0;  // 每线程
+};
+
+struct BenchResult {
+    BenchCase config;
+    bool skipped = false;
+    std::string note;
+    uint64_t published = 0;
+    uint64_t expected = 0;
+    uint64_t delivered = 0;
+    double publish_seconds = 0.0;   // 所有发布线程发完的耗时
+    double total_seconds = 0.0;     // 第一条发出到最后一条送达的耗时
+    LatencySummary latency;         // 纳秒
+};
+
+// 订阅侧：每个订阅者一个直方图，避免 64 路扇出时在同一组原子量上竞争
+class SubscriberSet {
+public:
+    SubscriberSet(PubSubMiddleware& bus, int fanout) {
+        for (int i = 0; i < fanout; ++i) {
+            histograms_.push_back(std::make_unique<LatencyHistogram>());
+            LatencyHistogram* histogram = histograms_.back().get();
+            bus.subscribe(kBenchTopic, [this, histogram](const Message& msg) {
+                int64_t now = NowNs();
+                if (msg.data.size() < kHeaderSize) {
+                    return;
+                }
+                int64_t sent_ns = 0;
+                std::memcpy(&sent_ns, msg.data.data(), sizeof(sent_ns));
+                histogram->record(now > sent_ns ? static_cast<uint64_t>(now - sent_ns) : 0);
+                last_delivery_ns_.store(now, std::memory_order_relaxed);
+                delivered_.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+    }
+
+    uint64_t delivered() const { return delivered_.load(std::memory_order_relaxed); }
+    int64_t lastDeliveryNs() const { return last_delivery_ns_.load(std::memory_order_relaxed); }
+
+    LatencySummary summary() const {
+        LatencyHistogram merged;
+        for (const auto& h : histograms_) {
+            merged.merge(*h);
+        }
+        return merged.summary();
+    }
+
+    // 等待全部送达；一段时间没有新消息（UDP 丢包）或超时后返回
+    void waitFor(uint64_t expected, int idle_ms, int timeout_ms) const {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        uint64_t last = delivered();
+        auto last_progress = std::chrono::steady_clock::now();
+        while (delivered() < expected && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            uint64_t cur = delivered();
+            if (cur != last) {
+                last = cur;
+                last_progress = std::chrono::steady_clock::now();
+            } else if (std::chrono::steady_clock::now() - last_progress > std::chrono::milliseconds(idle_ms)) {
+                break;
+            }
+        }
+    }
+
+private:
+    std::vector<std::unique_ptr<LatencyHistogram>> histograms_;
+    std::atomic<uint64_t> delivered_{0};
+    std::atomic<int64_t> last_delivery_ns_{0};
+};
+
+/**
+ * @brief 多线程发布
+ * @param rate 每线程速率（条/秒），0 表示不限速；限速按绝对截止时间推进，不会因单次睡过头而累积漂移
+ * @return 发布耗时（秒）
+ */
+double RunPublishers(PubSubMiddleware& bus, const BenchCase& c, uint64_t rate,
+                     int64_t* start_ns, std::atomic<uint64_t>* published) {
+    std::vector<std::thread> workers;
+    std::atomic<bool> go{false};
+    for (int t = 0; t < c.threads; ++t) {
+        workers.emplace_back([&, t]() {
+            // 负载提前分配好，循环里只改写头部
+            std::string payload(c.payload, static_cast<char>('a' + t % 26));
+            uint32_t thread_id = static_cast<uint32_t>(t);
+            std::memcpy(&payload[8], &thread_id, sizeof(thread_id));
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            auto next = std::chrono::steady_clock::now();
+            const auto period = rate ? std::chrono::nanoseconds(1000000000ULL / rate) : std::chrono::nanoseconds(0);
+            for (uint64_t seq = 0; seq < c.messages; ++seq) {
+                if (rate) {
+                    std::this_thread::sleep_until(next);
+                    next += period;
+                }
+                uint32_t seq32 = static_cast<uint32_t>(seq);
+                std::memcpy(&payload[12], &seq32, sizeof(seq32));
+                int64_t now = NowNs();
+                std::memcpy(&payload[0], &now, sizeof(now));
+                if (bus.publish(kBenchTopic, payload)) {
+                    published->fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    *start_ns = NowNs();
+    go.store(true, std::memory_order_release);
+    for (auto& w : workers) {
+        w.join();
+    }
+    return (NowNs() - *start_ns) / 1e9;
+}
+
+BenchResult RunInProcess(const BenchCase& c, int case_index) {
+    BenchResult r;
+    r.config = c;
+
+    // 每个用例使用独立的 domain，互不干扰；local 模式只有一个实例，回环上没有对端
+    std::string domain = "middleware_bench_" + std::to_string(getpid()) + "_" + std::to_string(case_index);
+    PubSubMiddleware pub_bus(std::make_unique<LoopbackTransport>(domain));
+    std::unique_ptr<PubSubMiddleware> sub_bus;
+    if (c.mode == "loopback") {
+        sub_bus = std::make_unique<PubSubMiddleware>(std::make_unique<LoopbackTransport>(domain));
+    }
+    PubSubMiddleware& sub_target = sub_bus ? *sub_bus : pub_bus;
+
+    SubscriberSet subscribers(sub_target, c.fanout);
+    std::atomic<uint64_t> published{0};
+    int64_t start_ns = 0;
+    r.publish_seconds = RunPublishers(pub_bus, c, 0, &start_ns, &published);
+    r.published = published.load();
+    r.expected = r.published * static_cast<uint64_t>(c.fanout);
+    subscribers.waitFor(r.expected, 2000, 60000);
+
+    r.delivered = subscribers.delivered();
+    r.total_seconds = std::max(r.publish_seconds, (subscribers.lastDeliveryNs() - start_ns) / 1e9);
+    r.latency = subscribers.summary();
+    return r;
+}
+
+// UDP 订阅子进程回传给父进程的结果
+struct UdpSubscriberReport {
+    uint64_t delivered;
+    int64_t last_delivery_ns;
+    LatencySummary latency;
+};
+
+// UDP 发布子进程回传给父进程的结果
+struct UdpPublisherReport {
+    uint64_t published;
+    int64_t start_ns;
+    double publish_seconds;
+};
+
+bool ReadFull(int fd, void* buf, size_t len) {
+    char* p = static_cast<char*>(buf);
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n <= 0) return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void WriteFull(int fd, const void* buf, size_t len) {
+    const char* p = static_cast<const char*>(buf);
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n <= 0) return;
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+}
+
+// 子进程的中间件日志（UDP 收包调试日志等）不混进基准输出
+void SilenceStdout() {
+    int devnull = open("/dev/null", O_WRONLY);
+    if (devnull >= 0) {
+        dup2(devnull, STDOUT_FILENO);
+        close(devnull);
+    }
+}
+
+std::unique_ptr<PubSubMiddleware> MakeUdpBus(int port) {
+    UdpTransportOptions options;
+    options.port = port;
+    options.rcvbuf_bytes = 8 * 1024 * 1024;
+    options.max_rcvbuf_bytes = 32 * 1024 * 1024;
+    return std::make_unique<PubSubMiddleware>(std::make_unique<UdpBroadcastTransport>(options));
+}
+
+BenchResult RunUdp(const BenchCase& c, const BenchOptions& options) {
+    BenchResult r;
+    r.config = c;
+    if (c.payload > kUdpMaxPayload) {
+        r.skipped = true;
+        r.note = "payload exceeds UDP datagram limit";
+        return r;
+    }
+
+    int sub_report[2], sub_control[2], pub_report[2];
+    if (pipe(sub_report) != 0 || pipe(sub_control) != 0 || pipe(pub_report) != 0) {
+        r.skipped = true;
+        r.note = "pipe() failed";
+        return r;
+    }
+    std::cout.flush();
+
+    // 1. 订阅子进程：订阅就绪后回报 'R'，收到父进程的 'D'（发布完毕）后等待剩余消息并回报结果
+    pid_t sub_pid = fork();
+    if (sub_pid == 0) {
+        SilenceStdout();
+        close(sub_report[0]);
+        close(sub_control[1]);
+        close(pub_report[0]);
+        close(pub_report[1]);
+        {
+            auto bus = MakeUdpBus(options.udp_port);
+            SubscriberSet subscribers(*bus, c.fanout);
+            char ready = 'R';
+            WriteFull(sub_report[1], &ready, 1);
+            uint64_t expected = 0;
+            ReadFull(sub_control[0], &expected, sizeof(expected));
+            subscribers.waitFor(expected, 500, 10000);
+
+            UdpSubscriberReport report{subscribers.delivered(), subscribers.lastDeliveryNs(), subscribers.summary()};
+            WriteFull(sub_report[1], &report, sizeof(report));
+        }
+        _exit(0);
+    }
+    close(sub_report[1]);
+    close(sub_control[0]);
+
+    char ready = 0;
+    if (sub_pid < 0 || !ReadFull(sub_report[0], &ready, 1)) {
+        r.skipped = true;
+        r.note = "failed to start subscriber process";
+    } else {
+        // 2. 发布子进程
+        pid_t pub_pid = fork();
+        if (pub_pid == 0) {
+            SilenceStdout();
+            close(pub_report[0]);
+            close(sub_report[0]);
+            close(sub_control[1]);
+            UdpPublisherReport report{0, 0, 0.0};
+            {
+                auto bus = MakeUdpBus(options.udp_port);
+                std::atomic<uint64_t> published{0};
+                report.publish_seconds = RunPublishers(*bus, c, options.udp_rate, &report.start_ns, &published);
+                report.published = published.load();
+            }
+            WriteFull(pub_report[1], &report, sizeof(report));
+            _exit(0);
+        }
+        close(pub_report[1]);
+
+        UdpPublisherReport pub_result{0, 0, 0.0};
+        bool pub_ok = pub_pid > 0 && ReadFull(pub_report[0], &pub_result, sizeof(pub_result));
+        if (pub_pid > 0) {
+            waitpid(pub_pid, nullptr, 0);
+        }
+
+        uint64_t expected = pub_result.published * static_cast<uint64_t>(c.fanout);
+        WriteFull(sub_control[1], &expected, sizeof(expected));
+
+        UdpSubscriberReport sub_result{};
+        if (pub_ok && ReadFull(sub_report[0], &sub_result, sizeof(sub_result))) {
+            r.published = pub_result.published;
+            r.expected = expected;
+            r.delivered = sub_result.delivered;
+            r.publish_seconds = pub_result.publish_seconds;
+            r.total_seconds = std::max(r.publish_seconds, (sub_result.last_delivery_ns - pub_result.start_ns) / 1e9);
+            r.latency = sub_result.latency;
+        } else {
+            r.skipped = true;
+            r.note = "benchmark process failed";
+        }
+    }
+
+    close(sub_report[0]);
+    close(sub_control[1]);
+    close(pub_report[0]);
+    if (sub_pid > 0) {
+        waitpid(sub_pid, nullptr, 0);
+    }
+    return r;
+}
+
+json11::Json ResultToJson(const BenchResult& r) {
+    json11::Json::object obj{
+        {"mode", r.config.mode},
+        {"payload_bytes", static_cast<double>(r.config.payload)},
+        {"fanout", r.config.fanout},
+        {"publisher_threads", r.config.threads},
+        {"messages_per_thread", static_cast<double>(r.config.messages)},
+        {"skipped", r.skipped},
+    };
+    if (!r.note.empty()) {
+        obj["note"] = r.note;
+    }
+    if (r.skipped) {
+        return obj;
+    }
+
+    double delivered_ratio = r.expected ? static_cast<double>(r.delivered) / r.expected : 0.0;
+    obj["published"] = static_cast<double>(r.published);
+    obj["expected_deliveries"] = static_cast<double>(r.expected);
+    obj["delivered"] = static_cast<double>(r.delivered);
+    obj["loss_ratio"] = 1.0 - std::min(delivered_ratio, 1.0);
+    obj["publish_seconds"] = r.publish_seconds;
+    obj["total_seconds"] = r.total_seconds;
+    obj["publish_msgs_per_sec"] = r.publish_seconds > 0 ? r.published / r.publish_seconds : 0.0;
+    obj["delivery_msgs_per_sec"] = r.total_seconds > 0 ? r.delivered / r.total_seconds : 0.0;
+    obj["delivery_mb_per_sec"] = r.total_seconds > 0
+        ? static_cast<double>(r.delivered) * r.config.payload / r.total_seconds / (1024.0 * 1024.0) : 0.0;
+    obj["latency_ns"] = json11::Json::object{
+        {"count", static_cast<double>(r.latency.count)},
+        {"min", static_cast<double>(r.latency.min)},
+        {"mean", static_cast<double>(r.latency.mean)},
+        {"p50", static_cast<double>(r.latency.p50)},
+        {"p90", static_cast<double>(r.latency.p90)},
+        {"p99", static_cast<double>(r.latency.p99)},
+        {"p999", static_cast<double>(r.latency.p999)},
+        {"max", static_cast<double>(r.latency.max)},
+    };
+    return obj;
+}
+
+template <typename T>
+std::vector<T> ParseList(const std::string& text) {
+    std::vector<T> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        std::stringstream conv(item);
+        T value;
+        if (conv >> value) {
+            values.push_back(value);
+        }
+    }
+    return values;
+}
+
+template <>
+std::vector<std::string> ParseList<std::string>(const std::string& text) {
+    std::vector<std::string> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) values.push_back(item);
+    }
+    return values;
+}
+
+void PrintUsage() {
+    std::cerr << "Usage: middleware_bench [--modes local,loopback,udp] [--sizes 64,1024,...]\n"
+                 "                        [--fanout 1,8,64] [--threads 1,4] [--messages N]\n"
+                 "                        [--udp-rate MSGS_PER_SEC] [--udp-port PORT] [--out FILE|-]\n";
+}
+
+bool ParseArgs(int argc, char* argv[], BenchOptions* options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--modes") {
+            options->modes = ParseList<std::string>(value);
+        } else if (arg == "--sizes") {
+            options->sizes = ParseList<size_t>(value);
+        } else if (arg == "--fanout") {
+            options->fanouts = ParseList<int>(value);
+        } else if (arg == "--threads") {
+            options->threads = ParseList<int>(value);
+        } else if (arg == "--messages") {
+            options->messages = std::stoull(value);
+        } else if (arg == "--udp-rate") {
+            options->udp_rate = std::stoull(value);
+        } else if (arg == "--udp-port") {
+            options->udp_port = std::stoi(value);
+        } else if (arg == "--out") {
+            options->out = value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!ParseArgs(argc, argv, &options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    json11::Json::array results;
+    int case_index = 0;
+    for (const auto& mode : options.modes) {
+        if (mode != "local" && mode != "loopback" && mode != "udp") {
+            LOG_WARN("Bench") << "未知模式: " << mode;
+            continue;
+        }
+        for (size_t size : options.sizes) {
+            for (int fanout : options.fanouts) {
+                for (int threads : options.threads) {
+                    BenchCase c;
+                    c.mode = mode;
+                    c.payload = std::max(size, kHeaderSize);
+                    c.fanout = std::max(fanout, 1);
+                    c.threads = std::max(threads, 1);
+                    // 大负载按字节预算缩减消息数，保证每个用例的耗时和内存占用可控
+                    c.messages = std::max(options.min_messages,
+                                          std::min(options.messages, options.bytes_budget / c.payload));
+
+                    BenchResult r = (mode == "udp") ? RunUdp(c, options) : RunInProcess(c, case_index);
+                    ++case_index;
+
+                    if (r.skipped) {
+                        LOG_INFO("Bench") << mode << " size=" << c.payload << " fanout=" << c.fanout
+                                          << " threads=" << c.threads << " skipped: " << r.note;
+                    } else {
+                        LOG_INFO("Bench") << mode << " size=" << c.payload << " fanout=" << c.fanout
+                                          << " threads=" << c.threads
+                                          << " delivered=" << r.delivered << "/" << r.expected
+                                          << " p50=" << r.latency.p50 / 1000.0 << "us"
+                                          << " p99=" << r.latency.p99 / 1000.0 << "us"
+                                          << " p99.9=" << r.latency.p999 / 1000.0 << "us"
+                                          << " rate=" << static_cast<uint64_t>(r.total_seconds > 0 ? r.delivered / r.total_seconds : 0)
+                                          << " msg/s";
+                    }
+                    results.push_back(ResultToJson(r));
+                }
+            }
+        }
+    }
+
+    char hostname[256] = {0};
+    gethostname(hostname, sizeof(hostname) - 1);
+    json11::Json report = json11::Json::object{
+        {"benchmark", "middleware_bench"},
+        {"timestamp", static_cast<double>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count())},
+        {"host", json11::Json::object{
+            {"hostname", std::string(hostname)},
+            {"hardware_concurrency", static_cast<int>(std::thread::hardware_concurrency())},
+        }},
+        {"parameters", json11::Json::object{
+            {"messages_per_thread_max", static_cast<double>(options.messages)},
+            {"bytes_budget_per_thread", static_cast<double>(options.bytes_budget)},
+            {"udp_rate_per_thread", static_cast<double>(options.udp_rate)},
+            {"udp_port", options.udp_port},
+        }},
+        {"results", results},
+    };
+
+    if (options.out == "-") {
+        std::cout << report.dump() << std::endl;
+    } else {
+        std::ofstream out(options.out);
+        if (!out) {
+            LOG_ERROR("Bench") << "无法写入结果文件: " << options.out;
+            return 1;
+        }
+        out << report.dump() << std::endl;
+        LOG_INFO("Bench") << "结果已写入 " << options.out << "（" << results.size() << " 个用例）";
+    }
+    return 0;
+}
@@ -0,0 +1,340 @@
+#include "profiler.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "logger.hpp"
+
+namespace simple_middleware {
+
+namespace detail {
+
+struct ProfileEvent {
+    const char* name = nullptr;
+    int64_t begin_ns = 0;
+    int64_t end_ns = 0;
+    uint64_t allocs = 0;
+    uint64_t alloc_bytes = 0;
+};
+
+/**
+ * @brief 单写者环形缓冲区
+ * @details 写者是所属线程，写满后覆盖最旧的记录（保留最近的一段时间）。
+ *          读者（Dump）复制前后各读一次 head，复制期间可能被覆盖的条目直接丢弃，
+ *          因此写入路径上不需要任何同步
+ */
+class ProfileRing {
+public:
+    static constexpr size_t kCapacity = 16384;  // 必须是 2 的幂
+
+    ProfileRing(int tid, std::string thread_name) : tid_(tid), thread_name_(std::move(thread_name)) {}
+
+    void Push(const char* name, int64_t begin_ns, int64_t end_ns, uint64_t allocs, uint64_t alloc_bytes) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[head & (kCapacity - 1)];
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.begin_ns.store(begin_ns, std::memory_order_relaxed);
+        slot.end_ns.store(end_ns, std::memory_order_relaxed);
+        slot.allocs.store(allocs, std::memory_order_relaxed);
+        slot.alloc_bytes.store(alloc_bytes, std::memory_order_relaxed);
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    void Snapshot(std::vector<ProfileEvent>* out) const {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        uint64_t first = head > kCapacity ? head - kCapacity : 0;
+        size_t base = out->size();
+        for (uint64_t i = first; i < head; ++i) {
+            const Slot& slot = slots_[i & (kCapacity - 1)];
+            out->push_back({slot.name.load(std::memory_order_relaxed),
+                            slot.begin_ns.load(std::memory_order_relaxed),
+                            slot.end_ns.load(std::memory_order_relaxed),
+                            slot.allocs.load(std::memory_order_relaxed),
+                            slot.alloc_bytes.load(std::memory_order_relaxed)});
+        }
+        // 复制期间写者前进到 head_now，并且可能正在写第 head_now 条：
+        // 序号 < head_now + 1 - kCapacity 的条目可能已被覆盖
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t head_now = head_.load(std::memory_order_relaxed);
+        if (head_now + 1 > kCapacity) {
+            uint64_t safe_from = head_now + 1 - kCapacity;
+            if (safe_from > first) {
+                size_t overwritten = static_cast<size_t>(std::min<uint64_t>(safe_from - first, head - first));
+                out->erase(out->begin() + base, out->begin() + base + overwritten);
+            }
+        }
+    }
+
+    int tid() const { return tid_; }
+
+    std::string threadName() const {
+        std::lock_guard<std::mutex> lock(name_mutex_);
+        return thread_name_;
+    }
+
+    void setThreadName(const std::string& name) {
+        std::lock_guard<std::mutex> lock(name_mutex_);
+        thread_name_ = name;
+    }
+
+    // 所属线程退出后不会再写入；导出之后即可回收
+    void markExited() { exited_.store(true, std::memory_order_release); }
+    bool exited() const { return exited_.load(std::memory_order_acquire); }
+
+private:
+    struct Slot {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<int64_t> begin_ns{0};
+        std::atomic<int64_t> end_ns{0};
+        std::atomic<uint64_t> allocs{0};
+        std::atomic<uint64_t> alloc_bytes{0};
+    };
+
+    std::array<Slot, kCapacity> slots_;
+    alignas(64) std::atomic<uint64_t> head_{0};
+    int tid_;
+    std::atomic<bool> exited_{false};
+    mutable std::mutex name_mutex_;
+    std::string thread_name_;
+};
+
+}  // namespace detail
+
+namespace {
+
+// 全局状态故意不析构：atexit 导出、信号触发的导出可能发生在静态对象析构之后
+struct ProfilerState {
+    std::mutex mutex;  // 保护 rings / 串行化 Dump
+    std::vector<std::shared_ptr<detail::ProfileRing>> rings;
+    std::string output_dir;
+    std::string process_name;
+};
+
+ProfilerState& State() {
+    static ProfilerState* state = new ProfilerState();
+    return *state;
+}
+
+std::mutex g_init_mutex;
+volatile std::sig_atomic_t g_dump_requested = 0;
+
+// 线程退出时把自己的环形缓冲区标记为已退出，下一次导出写出其中的记录后从 rings 中摘除并释放，
+// 线程反复重启（相机渲染线程、被守护进程重启的循环）时登记表不会无限增长
+struct ThreadRingHolder {
+    std::shared_ptr<detail::ProfileRing> ring;
+    ~ThreadRingHolder() {
+        if (ring) ring->markExited();
+    }
+};
+thread_local ThreadRingHolder t_ring;
+
+void OnDumpSignal(int) {
+    g_dump_requested = 1;
+}
+
+std::string ReadProcessName() {
+    std::ifstream comm("/proc/self/comm");
+    std::string name;
+    std::getline(comm, name);
+    return name.empty() ? "process" : name;
+}
+
+std::string CurrentThreadName() {
+    char buf[32] = {0};
+    if (pthread_getname_np(pthread_self(), buf, sizeof(buf)) == 0 && buf[0] != '\0') {
+        return buf;
+    }
+    return "thread";
+}
+
+detail::ProfileRing* ThreadRing() {
+    if (!t_ring.ring) {
+        int tid = static_cast<int>(syscall(SYS_gettid));
+        t_ring.ring = std::make_shared<detail::ProfileRing>(tid, CurrentThreadName());
+        std::lock_guard<std::mutex> lock(State().mutex);
+        State().rings.push_back(t_ring.ring);
+    }
+    return t_ring.ring.get();
+}
+
+void AppendJsonString(std::string* out, const std::string& value) {
+    out->push_back('"');
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out->push_back('\\');
+            out->push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out->append(buf);
+        } else {
+            out->push_back(c);
+        }
+    }
+    out->push_back('"');
+}
+
+// 轮询导出请求（信号处理函数里只置标志，文件 IO 放到这个线程做）
+void DumpWatcher() {
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        if (g_dump_requested) {
+            g_dump_requested = 0;
+            std::string path = Profiler::Dump();
+            if (!path.empty()) {
+                LOG_INFO("Profiler") << "Trace written to " << path;
+            }
+        }
+    }
+}
+
+void DumpAtExit() {
+    Profiler::Dump();
+}
+
+}  // namespace
+
+int Profiler::InitFromEnv() {
+    std::lock_guard<std::mutex> lock(g_init_mutex);
+    int state = detail::g_profiler_state.load(std::memory_order_relaxed);
+    if (state != 0) {
+        return state;
+    }
+
+    const char* dir = std::getenv("SIMPLE_PROFILE_DIR");
+    if (dir == nullptr || dir[0] == '\0') {
+        detail::g_profiler_state.store(2, std::memory_order_relaxed);
+        return 2;
+    }
+
+    State().output_dir = dir;
+    State().process_name = ReadProcessName();
+    mkdir(dir, 0777);
+
+    struct sigaction sa {};
+    sa.sa_handler = OnDumpSignal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGUSR2, &sa, nullptr);
+    std::thread(DumpWatcher).detach();
+    std::atexit(DumpAtExit);
+
+    detail::g_profiler_state.store(1, std::memory_order_relaxed);
+    return 1;
+}
+
+void Profiler::Record(const char* name, int64_t begin_ns, int64_t end_ns, uint64_t allocs, uint64_t alloc_bytes) {
+    ThreadRing()->Push(name, begin_ns, end_ns, allocs, alloc_bytes);
+}
+
+void Profiler::SetThreadName(const std::string& name) {
+    if (!IsEnabled()) return;
+    ThreadRing()->setThreadName(name);
+}
+
+std::string Profiler::Dump() {
+    if (detail::g_profiler_state.load(std::memory_order_relaxed) != 1) {
+        return "";
+    }
+
+    ProfilerState& state = State();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    int pid = static_cast<int>(getpid());
+
+    // 每条事件单独一行，scripts/merge_traces.sh 依赖这一格式按行拼接多个文件
+    std::string out;
+    out.reserve(1 << 20);
+    out += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + std::to_string(pid) + ",\"tid\":0,\"args\":{\"name\":";
+    AppendJsonString(&out, state.process_name);
+    out += "}}";
+
+    // 开启分配计数时按作用域名汇总，导出后在日志中输出每次调用的平均分配次数
+    struct AllocSummary {
+        uint64_t calls = 0;
+        uint64_t allocs = 0;
+        uint64_t alloc_bytes = 0;
+    };
+    const bool track_allocs = AllocTracker::IsEnabled();
+    std::map<std::string, AllocSummary> alloc_summary;
+
+    std::vector<detail::ProfileEvent> events;
+    std::vector<const detail::ProfileRing*> exited_rings;  // 复制前已经退出的线程：记录完整，写出后回收
+    char buf[160];
+    for (const auto& ring : state.rings) {
+        if (ring->exited()) {
+            exited_rings.push_back(ring.get());
+        }
+        out += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + std::to_string(pid)
+            + ",\"tid\":" + std::to_string(ring->tid()) + ",\"args\":{\"name\":";
+        AppendJsonString(&out, ring->threadName());
+        out += "}}";
+
+        events.clear();
+        ring->Snapshot(&events);
+        for (const auto& ev : events) {
+            if (ev.name == nullptr) continue;
+            out += ",\n{\"name\":";
+            AppendJsonString(&out, ev.name);
+            // Chrome trace 的时间单位是微秒，保留 3 位小数即纳秒精度
+            std::snprintf(buf, sizeof(buf), ",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+                          pid, ring->tid(), ev.begin_ns / 1000.0, (ev.end_ns - ev.begin_ns) / 1000.0);
+            out += buf;
+            if (track_allocs) {
+                std::snprintf(buf, sizeof(buf), ",\"args\":{\"allocs\":%llu,\"alloc_bytes\":%llu}",
+                              static_cast<unsigned long long>(ev.allocs),
+                              static_cast<unsigned long long>(ev.alloc_bytes));
+                out += buf;
+                AllocSummary& summary = alloc_summary[ev.name];
+                ++summary.calls;
+                summary.allocs += ev.allocs;
+                summary.alloc_bytes += ev.alloc_bytes;
+            }
+            out += "}";
+        }
+    }
+    out += "\n]}\n";
+
+    std::string path = state.output_dir + "/" + state.process_name + "." + std::to_string(pid) + ".trace.json";
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::out | std::ios::trunc);
+        if (!file.is_open()) {
+            return "";
+        }
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (!file.good()) {
+            return "";
+        }
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        return "";
+    }
+    // 已退出线程的记录只出现在这一次导出的文件里，之后的导出（覆盖同一个文件）不再包含
+    state.rings.erase(std::remove_if(state.rings.begin(), state.rings.end(),
+                                     [&](const std::shared_ptr<detail::ProfileRing>& ring) {
+                                         return std::find(exited_rings.begin(), exited_rings.end(), ring.get())
+                                             != exited_rings.end();
+                                     }),
+                      state.rings.end());
+    for (const auto& entry : alloc_summary) {
+        const AllocSummary& summary = entry.second;
+        LOG_INFO("Profiler") << entry.first << ": " << static_cast<double>(summary.allocs) / summary.calls
+            << " allocs/call, " << static_cast<double>(summary.alloc_bytes) / summary.calls << " bytes/call ("
+            << summary.calls << " calls)";
+    }
+    return path;
+}
+
+}  // namespace simple_middleware
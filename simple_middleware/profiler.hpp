@@ -0,0 +1,128 @@
+/*
+ * @Desc: 热路径剖析 - PROFILE_SCOPE 记录代码段耗时，导出 Chrome / Perfetto trace JSON
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include "alloc_tracker.hpp"
+
+/**
+ * @brief 编译期开关：-DSIMPLE_ENABLE_PROFILING=0 时 PROFILE_SCOPE 展开为空语句
+ * @details 开启时是否真正记录由运行期决定：设置环境变量 SIMPLE_PROFILE_DIR=<目录> 后才记录，
+ *          未设置时每个作用域只多一次原子读
+ */
+#ifndef SIMPLE_ENABLE_PROFILING
+#define SIMPLE_ENABLE_PROFILING 1
+#endif
+
+namespace simple_middleware {
+
+namespace detail {
+class ProfileRing;
+
+// 0: 尚未读取环境变量  1: 记录  2: 不记录
+inline std::atomic<int> g_profiler_state{0};
+
+inline int64_t ProfileNowNs() {
+    // steady_clock 在 Linux 上是系统级单调时钟，不同进程的时间戳可以放到同一条时间轴上
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}  // namespace detail
+
+/**
+ * @brief 剖析器
+ * @details 每个线程一个环形缓冲区（单写者，写满后覆盖最旧的记录），作用域结束时写入一条
+ *          "名称 + 开始时刻 + 时长"，不加锁、不分配内存。
+ *          收到 SIGUSR2、调用 Dump() 或进程正常退出（exit / main 返回）时，把所有线程的记录写到
+ *          $SIMPLE_PROFILE_DIR/<进程名>.<pid>.trace.json（Chrome trace 格式，可直接拖进 Perfetto / chrome://tracing）。
+ *          开启分配计数时每个事件带 args.allocs / args.alloc_bytes，导出时在日志中输出各作用域的平均分配次数。
+ *          已退出线程的缓冲区在下一次导出后回收，它的记录只出现在那一次导出的文件里。
+ *          多个节点的文件用 scripts/merge_traces.sh 合并后即在同一条时间轴上显示。
+ */
+class Profiler {
+public:
+    /**
+     * @brief 是否正在记录（首次调用时读取环境变量）
+     */
+    static bool IsEnabled() {
+        int state = detail::g_profiler_state.load(std::memory_order_relaxed);
+        if (state == 0) {
+            state = InitFromEnv();
+        }
+        return state == 1;
+    }
+
+    /**
+     * @brief 记录一段耗时
+     * @param name 必须是静态存储期的字符串（字符串字面量），只保存指针
+     * @param allocs / alloc_bytes 该段代码内的堆分配次数和字节数（开启 SIMPLE_TRACK_ALLOCATIONS 时有效）
+     */
+    static void Record(const char* name, int64_t begin_ns, int64_t end_ns,
+                       uint64_t allocs = 0, uint64_t alloc_bytes = 0);
+
+    /**
+     * @brief 立即把当前所有线程的记录写到 trace 文件
+     * @return 写出的文件路径，未开启或写失败时返回空串
+     */
+    static std::string Dump();
+
+    /**
+     * @brief 为当前线程设置在 trace 中显示的名称（默认取 pthread 线程名）
+     */
+    static void SetThreadName(const std::string& name);
+
+private:
+    static int InitFromEnv();
+};
+
+/**
+ * @brief RAII 计时：构造时取开始时刻，析构时记录（同时记录作用域内本线程的堆分配次数）
+ */
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name)
+        : name_(Profiler::IsEnabled() ? name : nullptr) {
+        if (name_) {
+            begin_allocs_ = AllocTracker::ThreadCounters();
+            begin_ns_ = detail::ProfileNowNs();
+        }
+    }
+
+    ~ProfileScope() {
+        if (name_) {
+            int64_t end_ns = detail::ProfileNowNs();
+            AllocCounters end_allocs = AllocTracker::ThreadCounters();
+            Profiler::Record(name_, begin_ns_, end_ns, end_allocs.allocs - begin_allocs_.allocs,
+                             end_allocs.bytes - begin_allocs_.bytes);
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name_;
+    int64_t begin_ns_ = 0;
+    AllocCounters begin_allocs_;
+};
+
+}  // namespace simple_middleware
+
+#define SIMPLE_PROFILE_CONCAT_INNER_(a, b) a##b
+#define SIMPLE_PROFILE_CONCAT_(a, b) SIMPLE_PROFILE_CONCAT_INNER_(a, b)
+
+// 用法：在需要计时的代码块开头写 PROFILE_SCOPE("Planning::GenerateTrajectory");
+// 名称必须是字符串字面量
+#if SIMPLE_ENABLE_PROFILING
+#define PROFILE_SCOPE(name) \
+    ::simple_middleware::ProfileScope SIMPLE_PROFILE_CONCAT_(simple_profile_scope_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
@@ -1,5 +1,5 @@
 /*
- * @Desc: 简易订阅发布中间件实现（UDP广播版）
+ * @Desc: 简易订阅发布中间件实现（本地分发 + 可替换传输层）
  * @Author: JacksonZhou
  * @Date: 2025/12/19
  */
@@ -7,357 +7,235 @@
 #include "pub_sub_middleware.hpp"
 #include <chrono>
 #include <algorithm>
-#include <sys/socket.h>
-#include <arpa/inet.h>
-#include <unistd.h>
-#include <cstring>
-#include <iostream>
-#include <cerrno>
 #include <unordered_map>
+#include "config_manager.hpp"
 #include "logger.hpp"
+#include "profiler.hpp"
+#include "topics.hpp"
 
 namespace simple_middleware {
 
-PubSubMiddleware::PubSubMiddleware() : next_subscribe_id_(1) {
-    initUdpSocket();
-    running_ = true;
-    // 【分离线程】启动后台线程监听网络消息
-    // this 指针允许线程访问当前对象的私有成员
-    receiver_thread_ = std::thread(&PubSubMiddleware::udpReceiveLoop, this);
+namespace {
+
+// 需要输出调试日志的关键话题（按ID比较，避免每条消息都做字符串比较）
+bool IsKeyTopic(TopicId topic_id) {
+    return topic_id == topics::kCameraFront.id || topic_id == topics::kDetection2D.id
+        || topic_id == topics::kPerceptionObstacles.id || topic_id == topics::kPlanningTrajectory.id
+        || topic_id == topics::kMap.id || topic_id == topics::kPredictionTrajectories.id;
 }
 
-PubSubMiddleware::~PubSubMiddleware() {
-    // 【安全退出】先设置标志位让循环停止，再等待线程结束
-    running_ = false;
-    if (udp_socket_fd_ >= 0) {
-        close(udp_socket_fd_);
-        udp_socket_fd_ = -1;
-    }
-    if (receiver_thread_.joinable()) {
-        receiver_thread_.join();
-    }
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
-void PubSubMiddleware::initUdpSocket() {
-    // SOCK_DGRAM 表示使用数据报协议（UDP）
-    udp_socket_fd_ = socket(AF_INET, SOCK_DGRAM, 0);
-    if (udp_socket_fd_ < 0) {
-        LOG_ERROR("PubSubMiddleware") << "创建 socket 失败";
-        return;
-    }
+inline void AddCounter(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.fetch_add(value, std::memory_order_relaxed);
+}
 
-    // 【广播权限】默认 Socket 不允许发送广播消息，必须显式开启
-    int broadcast = 1;
-    if (setsockopt(udp_socket_fd_, SOL_SOCKET, SO_BROADCAST, &broadcast, sizeof(broadcast)) < 0) {
-        LOG_ERROR("PubSubMiddleware") << "设置广播权限失败";
-        close(udp_socket_fd_);
-        return;
+inline void UpdateMax(std::atomic<uint64_t>& counter, uint64_t value) {
+    uint64_t current = counter.load(std::memory_order_relaxed);
+    while (value > current && !counter.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
     }
+}
 
-    // 【地址重用】允许程序在重启后立即重新绑定该端口，避免 "Address already in use" 错误
-    int reuse = 1;
-    if (setsockopt(udp_socket_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0) {
-        LOG_ERROR("PubSubMiddleware") << "设置地址重用失败";
-    }
-    
-    #ifdef SO_REUSEPORT
-    // 【端口重用】允许跨进程共享同一端口（macOS/Linux 特性）
-    if (setsockopt(udp_socket_fd_, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse)) < 0) {
-        LOG_ERROR("PubSubMiddleware") << "设置端口重用失败";
-    }
-    #endif
-
-    // 【绑定端口】作为接收方，需要绑定固定端口来监听广播
-    struct sockaddr_in addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(UDP_PORT);
-    addr.sin_addr.s_addr = htonl(INADDR_ANY); // 监听所有网卡
-
-    if (bind(udp_socket_fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-        LOG_ERROR("PubSubMiddleware") << "绑定端口失败 (端口: " << UDP_PORT 
-            << ", 错误: " << strerror(errno) << ", errno: " << errno << ")";
-        close(udp_socket_fd_);
-        udp_socket_fd_ = -1;
-        return;
-    }
+inline uint64_t LoadCounter(const std::atomic<uint64_t>& counter) {
+    return counter.load(std::memory_order_relaxed);
+}
 
-    // 【目标地址】广播地址 255.255.255.255 会发给局域网内所有机器
-    memset(&broadcast_addr_, 0, sizeof(broadcast_addr_));
-    broadcast_addr_.sin_family = AF_INET;
-    broadcast_addr_.sin_port = htons(UDP_PORT);
-    broadcast_addr_.sin_addr.s_addr = htonl(INADDR_BROADCAST);
+constexpr int kDefaultCallbackBudgetMs = 10;
+constexpr int64_t kBudgetWarningIntervalMs = 5000;
 
-    LOG_INFO("PubSubMiddleware") << "UDP广播服务已启动，端口: " << UDP_PORT;
+}  // namespace
+
+PubSubMiddleware& PubSubMiddleware::createFromConfig() {
+    // CreateTransportFromConfig() 负责加载 config/middleware.json，这里只读取其中的回调预算
+    static PubSubMiddleware instance(CreateTransportFromConfig());
+    int budget_ms = ConfigManager::GetInstance().Get<int>("middleware", "callback_budget_ms", kDefaultCallbackBudgetMs);
+    instance.setDefaultCallbackBudget(std::chrono::milliseconds(budget_ms > 0 ? budget_ms : 0));
+    return instance;
 }
 
-void PubSubMiddleware::udpReceiveLoop() {
-    char buffer[65535]; 
-    struct sockaddr_in sender_addr;
-    socklen_t sender_len = sizeof(sender_addr);
+PubSubMiddleware::PubSubMiddleware(std::unique_ptr<Transport> transport)
+    : next_subscribe_id_(1), transport_(std::move(transport)) {
+    if (transport_) {
+        // 传输层在自己的线程中回调 onTransportMessage
+        transport_->start([this](std::string_view topic, const std::string& data) {
+            this->onTransportMessage(topic, data);
+        });
+    }
+}
 
-    LOG_INFO("PubSubMiddleware") << "UDP receive loop started";
-    
-    while (running_) {
-        if (udp_socket_fd_ < 0) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-            continue;
-        }
+PubSubMiddleware::~PubSubMiddleware() {
+    // 【安全退出】先停止传输层，确保之后不会再有远端消息进入分发流程
+    if (transport_) {
+        transport_->stop();
+    }
+}
 
-        // 【阻塞接收】recvfrom 会在这里挂起，直到有数据包到达
-        ssize_t len = recvfrom(udp_socket_fd_, buffer, sizeof(buffer) - 1, 0, 
-                               (struct sockaddr*)&sender_addr, &sender_len);
-        
-        if (len > 0) {
-            // 总是记录收到的 UDP 数据包（用于调试）
-            static int total_recv_count = 0;
-            total_recv_count++;
-            if (total_recv_count <= 10 || total_recv_count % 50 == 0) {
-                LOG_INFO("PubSubMiddleware") << "Received UDP packet #" << total_recv_count 
-                    << ", size=" << len << " bytes";
-            }
-            // 注意：不要设置 buffer[len] = '\0'，因为数据可能包含二进制内容
-            // 使用 std::string 的构造函数，指定长度，可以正确处理二进制数据
-            std::string raw_data(buffer, len);
-            
-            // 【简易协议】自定义协议格式 topic|data
-            size_t sep_pos = raw_data.find('|');
-            if (sep_pos != std::string::npos && sep_pos < static_cast<size_t>(len)) {
-                std::string topic = raw_data.substr(0, sep_pos);
-                std::string data = raw_data.substr(sep_pos + 1);
-                
-                // 对于关键 topic，记录接收日志
-                if (topic == "sensor/camera/front" || topic == "perception/detection_2d" || topic == "planning/trajectory" 
-                    || topic == "visualizer/map" || topic == "prediction/trajectories") {
-                    static std::unordered_map<std::string, int> recv_counts;
-                    recv_counts[topic]++;
-                    int count = recv_counts[topic];
-                    if (count <= 5 || count % 10 == 0) {
-                        LOG_INFO("PubSubMiddleware") << "Received UDP packet: topic=" << topic 
-                            << ", data_size=" << data.size() << " bytes (count=" << count << ")";
-                    }
-                }
-                
-                // 将接收到的网络消息分发给本地所有的订阅者
-                dispatchLocal(topic, data);
-            } else {
-                static int parse_fail_count = 0;
-                if (parse_fail_count++ % 1000 == 0) { // 降低频率
-                    LOG_WARN("PubSubMiddleware") << "Failed to parse UDP packet: len=" << len 
-                        << ", no '|' separator found";
-                }
-            }
-        } else if (len < 0) {
-            static int error_count = 0;
-            if (error_count++ % 100 == 0) {
-                LOG_ERROR("PubSubMiddleware") << "recvfrom error: " << strerror(errno);
-            }
-        }
+void PubSubMiddleware::onTransportMessage(std::string_view topic, const std::string& data) {
+    // 网络收到的只有话题名，这里算一次哈希，后续分发全部按ID查表
+    TopicId topic_id = HashTopicName(topic);
+
+    // 将接收到的远端消息分发给本地所有的订阅者
+    TopicCounters* counters = dispatchLocal(topic_id, topic, data, false);
+    uint64_t count = counters->in.msgs.fetch_add(1, std::memory_order_relaxed) + 1;
+    AddCounter(counters->in.bytes, data.size());
+
+    // 对于关键 topic，记录接收日志
+    if (IsKeyTopic(topic_id) && (count <= 5 || count % 10 == 0)) {
+        LOG_INFO("PubSubMiddleware") << "Received remote message: topic=" << topic
+            << ", data_size=" << data.size() << " bytes (count=" << count << ")";
     }
 }
 
-void PubSubMiddleware::dispatchLocal(const std::string& topic, const std::string& data) {
+PubSubMiddleware::TopicCounters* PubSubMiddleware::getCountersLocked(TopicId topic_id, std::string_view topic) {
+    auto& counters = topic_counters_[topic_id];
+    if (!counters) {
+        counters = std::make_unique<TopicCounters>();
+        counters->name = std::string(topic);
+    }
+    return counters.get();
+}
+
+PubSubMiddleware::TopicCounters* PubSubMiddleware::dispatchLocal(TopicId topic_id, std::string_view topic,
+                                                                const std::string& data, bool from_publisher) {
+    PROFILE_SCOPE("PubSub::Dispatch");
     // 【临界区保护】访问 topic_subscribers_ 这个共享 map 时必须加锁
     // 但是，在调用回调函数之前，我们需要先收集所有需要调用的回调函数
     // 然后在锁外调用它们，避免死锁和阻塞
-    std::vector<std::function<void()>> callbacks_to_execute;
+    struct PendingCallback {
+        int64_t sub_id;
+        std::shared_ptr<const SubscribeCallback> callback;
+        std::shared_ptr<SubscriberCounters> counters;
+    };
+    std::vector<PendingCallback> callbacks_to_execute;
+    TopicCounters* counters = nullptr;
+    int64_t start_ns = NowNs();
     
     {
         std::lock_guard<std::mutex> lock(mutex_);
+        counters = getCountersLocked(topic_id, topic);
 
-        auto now = std::chrono::system_clock::now();
-        auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now.time_since_epoch()).count();
-
-        Message msg(topic, data);
-        msg.timestamp = timestamp;
-
-        auto it = topic_subscribers_.find(topic);
+        auto it = topic_subscribers_.find(topic_id);
         if (it != topic_subscribers_.end()) {
-            // 对于关键 topic，记录分发日志
-            if (topic == "perception/detection_2d" || topic == "perception/obstacles" || topic == "planning/trajectory"
-                || topic == "visualizer/map" || topic == "prediction/trajectories") {
-                static std::unordered_map<std::string, int> dispatch_counts;
-                dispatch_counts[topic]++;
-                int count = dispatch_counts[topic];
-                if (count <= 5 || count % 10 == 0) {
-                    LOG_INFO("PubSubMiddleware") << "Dispatching " << topic << " to " 
-                        << it->second.size() << " subscribers (count=" << count << ")";
-                }
-            }
-            
-            // 收集所有需要调用的回调函数（在锁内）
+            // 收集所有需要调用的回调函数（在锁内），只增加引用计数，不拷贝回调
+            callbacks_to_execute.reserve(it->second.size());
             for (int64_t sub_id : it->second) {
                 auto sub_it = subscriptions_.find(sub_id);
                 if (sub_it != subscriptions_.end()) {
-                // 对于关键 topic，记录回调执行
-                if (topic == "sensor/camera/front" || topic == "perception/detection_2d" || topic == "perception/obstacles" || topic == "planning/trajectory"
-                    || topic == "visualizer/map" || topic == "prediction/trajectories") {
-                    static std::unordered_map<std::string, int> callback_counts;
-                    callback_counts[topic]++;
-                    int count = callback_counts[topic];
-                    if (count <= 5 || count % 10 == 0) {
-                        LOG_INFO("PubSubMiddleware") << "Calling callback for topic=" << topic 
-                            << ", sub_id=" << sub_id << " (count=" << count << ")";
-                    }
-                }
-                    
-                    // 将回调函数添加到列表中（复制回调函数和消息）
-                    callbacks_to_execute.push_back([topic, sub_id, msg, sub_it]() {
-                        // NOTE 在调用外部回调时使用 try-catch，防止某一个订阅者的错误搞崩整个中间件
-                        try {
-                            // 对于关键 topic，记录回调执行前后
-                            bool is_key_topic = (topic == "perception/obstacles" || topic == "visualizer/map" || topic == "prediction/trajectories");
-                            if (is_key_topic) {
-                                static std::unordered_map<std::string, int> exec_counts;
-                                exec_counts[topic]++;
-                                int count = exec_counts[topic];
-                                if (count <= 3) {
-                                    LOG_INFO("PubSubMiddleware") << "About to execute callback for " << topic << ", sub_id=" << sub_id;
-                                }
-                            }
-                            sub_it->second.callback(msg);
-                            if (is_key_topic) {
-                                static std::unordered_map<std::string, int> exec_counts;
-                                exec_counts[topic]++;
-                                int count = exec_counts[topic];
-                                if (count <= 3) {
-                                    LOG_INFO("PubSubMiddleware") << "Callback completed for " << topic << ", sub_id=" << sub_id;
-                                }
-                            }
-                        } catch (const std::exception& e) {
-                            LOG_ERROR("PubSubMiddleware") << "回调执行发生异常, topic=" << topic 
-                                << ", sub_id=" << sub_id << ", error=" << e.what();
-                        } catch (...) {
-                            LOG_ERROR("PubSubMiddleware") << "回调执行发生未知错误, topic=" << topic << ", sub_id=" << sub_id;
-                        }
-                    });
-                }
-            }
-        } else {
-            // 对于关键 topic，记录没有订阅者的情况
-            if (topic == "perception/detection_2d" || topic == "perception/obstacles" || topic == "planning/trajectory"
-                || topic == "visualizer/map" || topic == "prediction/trajectories") {
-                static std::unordered_map<std::string, int> no_sub_counts;
-                no_sub_counts[topic]++;
-                int count = no_sub_counts[topic];
-                if (count <= 3 || count % 10 == 0) {
-                    LOG_WARN("PubSubMiddleware") << "No subscribers for " << topic << " (count=" << count << ")";
+                    callbacks_to_execute.push_back({sub_id, sub_it->second.callback, sub_it->second.counters});
                 }
             }
         }
     } // 锁在这里释放
-    
-    // 在锁外执行所有回调函数，避免死锁和阻塞
-    for (auto& callback : callbacks_to_execute) {
-        callback();
+
+    DispatchCounters& dispatch = from_publisher ? counters->out.dispatch : counters->in.dispatch;
+    uint64_t count = dispatch.count.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (IsKeyTopic(topic_id)) {
+        // 对于关键 topic，记录分发日志 / 没有订阅者的情况
+        if (!callbacks_to_execute.empty() && (count <= 5 || count % 10 == 0)) {
+            LOG_INFO("PubSubMiddleware") << "Dispatching " << topic << " to " 
+                << callbacks_to_execute.size() << " subscribers (count=" << count << ")";
+        } else if (callbacks_to_execute.empty() && (count <= 3 || count % 10 == 0)) {
+            LOG_WARN("PubSubMiddleware") << "No subscribers for " << topic << " (count=" << count << ")";
+        }
+    }
+
+    if (!callbacks_to_execute.empty()) {
+        auto now = std::chrono::system_clock::now();
+        Message msg(std::string(topic), data);
+        msg.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+            now.time_since_epoch()).count();
+        
+        // 在锁外执行所有回调函数，避免死锁和阻塞；所有订阅者共享同一份消息
+        int64_t cb_start_ns = NowNs();
+        for (auto& entry : callbacks_to_execute) {
+            // NOTE 在调用外部回调时使用 try-catch，防止某一个订阅者的错误搞崩整个中间件
+            try {
+                (*entry.callback)(msg);
+            } catch (const std::exception& e) {
+                LOG_ERROR("PubSubMiddleware") << "回调执行发生异常, topic=" << topic 
+                    << ", sub_id=" << entry.sub_id << ", error=" << e.what();
+            } catch (...) {
+                LOG_ERROR("PubSubMiddleware") << "回调执行发生未知错误, topic=" << topic << ", sub_id=" << entry.sub_id;
+            }
+            int64_t cb_end_ns = NowNs();
+            bool warned = recordCallback(topic, entry.sub_id, *entry.counters,
+                                         static_cast<uint64_t>(cb_end_ns - cb_start_ns));
+            // 相邻回调共用一次取时；输出过告警时重新取时，日志耗时不计入下一个订阅者
+            cb_start_ns = warned ? NowNs() : cb_end_ns;
+        }
     }
+
+    uint64_t dispatch_ns = static_cast<uint64_t>(NowNs() - start_ns);
+    AddCounter(dispatch.ns_total, dispatch_ns);
+    UpdateMax(dispatch.ns_max, dispatch_ns);
+    return counters;
+}
+
+bool PubSubMiddleware::recordCallback(std::string_view topic, int64_t sub_id, SubscriberCounters& counters,
+                                      uint64_t elapsed_ns) {
+    AddCounter(counters.calls, 1);
+    AddCounter(counters.ns_total, elapsed_ns);
+    UpdateMax(counters.ns_max, elapsed_ns);
+    counters.histogram.record(elapsed_ns);
+
+    int64_t budget_ns = counters.budget_ns.load(std::memory_order_relaxed);
+    if (budget_ns < 0) {
+        budget_ns = default_callback_budget_ns_.load(std::memory_order_relaxed);
+    }
+    if (budget_ns <= 0 || elapsed_ns <= static_cast<uint64_t>(budget_ns)) {
+        return false;
+    }
+    uint64_t over = counters.over_budget.fetch_add(1, std::memory_order_relaxed) + 1;
+    // 按订阅限频：一个慢回调不会淹没其他订阅的告警
+    if (!Logger::IsEnabled(LogLevel::WARN) || !detail::LogSiteEveryMs(counters.budget_warning, kBudgetWarningIntervalMs)) {
+        return false;
+    }
+    LOG_WARN("PubSubMiddleware") << "回调耗时超出预算, topic=" << topic << ", sub_id=" << sub_id
+        << ", elapsed=" << elapsed_ns / 1e6 << "ms, budget=" << budget_ns / 1e6
+        << "ms, p99=" << counters.histogram.percentile(99.0) / 1e6 << "ms (over_budget=" << over << ")";
+    return true;
 }
 
 bool PubSubMiddleware::publish(const std::string& topic, const std::string& data) {
     if (topic.empty()) return false;
+    return publishRaw(HashTopicName(topic), topic, data);
+}
 
-    // 对于关键 topic，记录发布日志
-    if (topic == "sensor/camera/front" || topic == "perception/detection_2d" || topic == "perception/obstacles" || topic == "planning/trajectory"
-        || topic == "visualizer/map" || topic == "prediction/trajectories") {
-        static std::unordered_map<std::string, int> pub_counts;
-        pub_counts[topic]++;
-        int count = pub_counts[topic];
-        if (count <= 5 || count % 10 == 0) {
-            LOG_INFO("PubSubMiddleware") << "Publishing " << topic << " #" << count 
-                << ", data_size=" << data.size() << " bytes";
-        }
-    }
+bool PubSubMiddleware::publishRaw(TopicId topic_id, std::string_view topic, const std::string& data) {
+    if (topic.empty()) return false;
 
     // 1. 本地分发：同一进程内的订阅者能更快收到
-    // 只对关键topic记录dispatchLocal的调用
-    bool is_key_topic = (topic == "visualizer/map" || topic == "prediction/trajectories" 
-                        || topic == "perception/obstacles" || topic == "planning/trajectory");
-    if (is_key_topic) {
-        static std::unordered_map<std::string, int> dispatch_log_counts;
-        dispatch_log_counts[topic]++;
-        int count = dispatch_log_counts[topic];
-        if (count <= 3) {
-            LOG_INFO("PubSubMiddleware") << "About to call dispatchLocal for topic=" << topic;
-        }
-    }
-    dispatchLocal(topic, data);
-    if (is_key_topic) {
-        static std::unordered_map<std::string, int> dispatch_log_counts;
-        dispatch_log_counts[topic]++;
-        int count = dispatch_log_counts[topic];
-        if (count <= 3) {
-            LOG_INFO("PubSubMiddleware") << "dispatchLocal completed for topic=" << topic;
-        }
+    TopicCounters* counters = dispatchLocal(topic_id, topic, data, true);
+    uint64_t count = counters->out.msgs.fetch_add(1, std::memory_order_relaxed) + 1;
+    AddCounter(counters->out.bytes, data.size());
+
+    // 对于关键 topic，记录发布日志
+    if (IsKeyTopic(topic_id) && (count <= 5 || count % 10 == 0)) {
+        LOG_INFO("PubSubMiddleware") << "Publishing " << topic << " #" << count 
+            << ", data_size=" << data.size() << " bytes";
     }
 
-    // 2. UDP 网络广播：发送给其他进程或机器
-    if (udp_socket_fd_ >= 0) {
-        // 按照协议打包数据
-        std::string raw_packet = topic + "|" + data;
-        size_t packet_size = raw_packet.size();
-        
-        // 检查数据包大小（UDP 理论最大 65507 字节，但实际 MTU 约 1500 字节）
-        if (packet_size > 65507) {
-            LOG_ERROR("PubSubMiddleware") << "Packet too large for UDP: " << packet_size 
-                << " bytes (max 65507), topic=" << topic;
+    // 2. 传输层：发送给其他进程或机器
+    if (transport_) {
+        if (!transport_->send(topic, data)) {
+            AddCounter(counters->out.send_drops, 1);
             return false;
         }
-        
-        // 对于关键 topic，记录 UDP 发送日志
-        if (topic == "planning/trajectory" || topic == "visualizer/map" || topic == "prediction/trajectories") {
-            static std::unordered_map<std::string, int> send_counts;
-            send_counts[topic]++;
-            int count = send_counts[topic];
-            if (count <= 5 || count % 10 == 0) {
-                LOG_INFO("PubSubMiddleware") << "Sending UDP packet: topic=" << topic 
-                    << ", packet_size=" << packet_size << " bytes (count=" << count << ")";
-                // 对于大包，警告可能超过MTU
-                if (packet_size > 1500) {
-                    LOG_WARN("PubSubMiddleware") << "Large packet may exceed MTU (1500 bytes): " 
-                        << packet_size << " bytes, topic=" << topic;
-                }
-            }
-        }
-        
-        ssize_t sent = sendto(udp_socket_fd_, raw_packet.c_str(), packet_size, 0, 
-                              (struct sockaddr*)&broadcast_addr_, sizeof(broadcast_addr_));
-        
-        if (sent < 0) {
-            static int send_error_count = 0;
-            if (send_error_count++ % 100 == 0) {
-                LOG_ERROR("PubSubMiddleware") << "sendto failed: " << strerror(errno) 
-                    << ", topic=" << topic << ", size=" << packet_size;
-            }
-        } else if (sent != static_cast<ssize_t>(packet_size)) {
-            static int partial_send_count = 0;
-            if (partial_send_count++ % 100 == 0) {
-                LOG_WARN("PubSubMiddleware") << "Partial send: " << sent << "/" << packet_size 
-                    << " bytes, topic=" << topic;
-            }
-        } else {
-            // 对于关键 topic，记录 UDP 发送成功日志
-            if (topic == "planning/trajectory") {
-                static int send_success_count = 0;
-                send_success_count++;
-                if (send_success_count % 10 == 0 || send_success_count <= 5) {
-                    LOG_INFO("PubSubMiddleware") << "UDP sendto successful: topic=" << topic 
-                        << ", sent=" << sent << " bytes (count=" << send_success_count << ")";
-                }
-            } else {
-                static int send_count = 0;
-                if (send_count++ % 100 == 0 && packet_size > 10000) { // 只记录大包
-                    LOG_DEBUG("PubSubMiddleware") << "Published large packet: topic=" << topic 
-                        << ", size=" << packet_size << " bytes";
-                }
-            }
-        }
+        AddCounter(counters->out.fragments, transport_->wireFragments(topic.size() + 1 + data.size()));
     }
 
     return true;
 }
 
 int64_t PubSubMiddleware::subscribe(const std::string& topic, SubscribeCallback callback) {
+    if (topic.empty()) return -1;
+    return subscribeRaw(HashTopicName(topic), topic, std::move(callback));
+}
+
+int64_t PubSubMiddleware::subscribeRaw(TopicId topic_id, std::string_view topic, SubscribeCallback callback) {
     if (topic.empty() || !callback) return -1;
     
     std::lock_guard<std::mutex> lock(mutex_);
@@ -365,23 +243,39 @@ int64_t PubSubMiddleware::subscribe(const std::string& topic, SubscribeCallback
     
     Subscription sub;
     sub.id = subscribe_id;
-    sub.topic = topic;
-    sub.callback = callback;
+    sub.topic_id = topic_id;
+    sub.topic = std::string(topic);
+    sub.callback = std::make_shared<const SubscribeCallback>(std::move(callback));
+    sub.counters = std::make_shared<SubscriberCounters>();
 
-    subscriptions_[subscribe_id] = sub;
-    topic_subscribers_[topic].push_back(subscribe_id);
+    subscriptions_[subscribe_id] = std::move(sub);
+    topic_subscribers_[topic_id].push_back(subscribe_id);
+    topic_names_.emplace(topic_id, std::string(topic));
 
     return subscribe_id;
 }
 
+void PubSubMiddleware::onDecodeError(std::string_view topic, size_t data_size) {
+    uint64_t count = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        TopicCounters* counters = getCountersLocked(HashTopicName(topic), topic);
+        count = counters->in.decode_errors.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    if (count % 100 == 1) {
+        LOG_WARN("PubSubMiddleware") << "消息解码失败, topic=" << topic << ", data_size=" << data_size
+            << " (count=" << count << ")";
+    }
+}
+
 bool PubSubMiddleware::unsubscribe(int64_t subscribe_id) {
     std::lock_guard<std::mutex> lock(mutex_);
 
     auto sub_it = subscriptions_.find(subscribe_id);
     if (sub_it == subscriptions_.end()) return false;
 
-    std::string topic = sub_it->second.topic;
-    auto topic_it = topic_subscribers_.find(topic);
+    TopicId topic_id = sub_it->second.topic_id;
+    auto topic_it = topic_subscribers_.find(topic_id);
     if (topic_it != topic_subscribers_.end()) {
         auto& ids = topic_it->second;
         // NOTE【Erase-Remove Idiom】C++ 经典的删除容器内特定元素的方法
@@ -389,6 +283,7 @@ bool PubSubMiddleware::unsubscribe(int64_t subscribe_id) {
         
         if (ids.empty()) {
             topic_subscribers_.erase(topic_it);
+            topic_names_.erase(topic_id);
         }
     }
 
@@ -397,9 +292,13 @@ bool PubSubMiddleware::unsubscribe(int64_t subscribe_id) {
 }
 
 size_t PubSubMiddleware::unsubscribeTopic(const std::string& topic) {
+    return unsubscribeTopicById(HashTopicName(topic));
+}
+
+size_t PubSubMiddleware::unsubscribeTopicById(TopicId topic_id) {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    auto it = topic_subscribers_.find(topic);
+    auto it = topic_subscribers_.find(topic_id);
     if (it == topic_subscribers_.end()) return 0;
 
     size_t count = it->second.size();
@@ -407,12 +306,17 @@ size_t PubSubMiddleware::unsubscribeTopic(const std::string& topic) {
         subscriptions_.erase(sub_id);
     }
     topic_subscribers_.erase(it);
+    topic_names_.erase(topic_id);
     return count;
 }
 
 size_t PubSubMiddleware::getSubscriberCount(const std::string& topic) const {
+    return getSubscriberCountById(HashTopicName(topic));
+}
+
+size_t PubSubMiddleware::getSubscriberCountById(TopicId topic_id) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto it = topic_subscribers_.find(topic);
+    auto it = topic_subscribers_.find(topic_id);
     if (it == topic_subscribers_.end()) return 0;
     return it->second.size();
 }
@@ -420,10 +324,84 @@ size_t PubSubMiddleware::getSubscriberCount(const std::string& topic) const {
 std::vector<std::string> PubSubMiddleware::getAllTopics() const {
     std::lock_guard<std::mutex> lock(mutex_);
     std::vector<std::string> topics;
-    for (const auto& pair : topic_subscribers_) {
-        topics.push_back(pair.first);
+    topics.reserve(topic_names_.size());
+    for (const auto& pair : topic_names_) {
+        topics.push_back(pair.second);
     }
     return topics;
 }
 
+std::vector<TopicStats> PubSubMiddleware::getTopicStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<TopicStats> result;
+    result.reserve(topic_counters_.size());
+    for (const auto& pair : topic_counters_) {
+        const TopicCounters& c = *pair.second;
+        TopicStats stats;
+        stats.topic = c.name;
+        stats.topic_id = pair.first;
+        stats.msgs_out = LoadCounter(c.out.msgs);
+        stats.bytes_out = LoadCounter(c.out.bytes);
+        stats.fragments_out = LoadCounter(c.out.fragments);
+        stats.msgs_in = LoadCounter(c.in.msgs);
+        stats.bytes_in = LoadCounter(c.in.bytes);
+        stats.send_drops = LoadCounter(c.out.send_drops);
+        stats.decode_errors = LoadCounter(c.in.decode_errors);
+        stats.dispatch_count = LoadCounter(c.out.dispatch.count) + LoadCounter(c.in.dispatch.count);
+        stats.dispatch_ns_total = LoadCounter(c.out.dispatch.ns_total) + LoadCounter(c.in.dispatch.ns_total);
+        stats.dispatch_ns_max = std::max(LoadCounter(c.out.dispatch.ns_max), LoadCounter(c.in.dispatch.ns_max));
+
+        auto sub_it = topic_subscribers_.find(pair.first);
+        if (sub_it != topic_subscribers_.end()) {
+            for (int64_t sub_id : sub_it->second) {
+                auto it = subscriptions_.find(sub_id);
+                if (it == subscriptions_.end()) continue;
+                stats.subscribers.push_back(subscriberStatsLocked(it->second));
+            }
+        }
+        result.push_back(std::move(stats));
+    }
+    std::sort(result.begin(), result.end(),
+              [](const TopicStats& a, const TopicStats& b) { return a.topic < b.topic; });
+    return result;
+}
+
+SubscriberStats PubSubMiddleware::subscriberStatsLocked(const Subscription& sub) const {
+    const SubscriberCounters& c = *sub.counters;
+    SubscriberStats stats;
+    stats.subscribe_id = sub.id;
+    stats.topic = sub.topic;
+    stats.calls = LoadCounter(c.calls);
+    stats.callback_ns_total = LoadCounter(c.ns_total);
+    stats.callback_ns_max = LoadCounter(c.ns_max);
+    stats.callback_ns = c.histogram.summary();
+    int64_t budget_ns = c.budget_ns.load(std::memory_order_relaxed);
+    if (budget_ns < 0) {
+        budget_ns = default_callback_budget_ns_.load(std::memory_order_relaxed);
+    }
+    stats.budget_ns = static_cast<uint64_t>(budget_ns);
+    stats.over_budget = LoadCounter(c.over_budget);
+    return stats;
+}
+
+bool PubSubMiddleware::getSubscriberStats(int64_t subscribe_id, SubscriberStats* stats) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = subscriptions_.find(subscribe_id);
+    if (it == subscriptions_.end()) return false;
+    *stats = subscriberStatsLocked(it->second);
+    return true;
+}
+
+void PubSubMiddleware::setDefaultCallbackBudget(std::chrono::nanoseconds budget) {
+    default_callback_budget_ns_.store(budget.count() > 0 ? budget.count() : 0, std::memory_order_relaxed);
+}
+
+bool PubSubMiddleware::setCallbackBudget(int64_t subscribe_id, std::chrono::nanoseconds budget) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = subscriptions_.find(subscribe_id);
+    if (it == subscriptions_.end()) return false;
+    it->second.counters->budget_ns.store(budget.count() > 0 ? budget.count() : 0, std::memory_order_relaxed);
+    return true;
+}
+
 }  // namespace simple_middleware
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <string>
+#include <chrono>
 #include <functional>
 #include <unordered_map>
 #include <vector>
@@ -15,7 +16,14 @@
 
 #include <thread>
 #include <atomic>
-#include <netinet/in.h>
+#include <string_view>
+#include <type_traits>
+
+#include "topic.hpp"
+#include "transport.hpp"
+#include "message_arena.hpp"
+#include "latency_histogram.hpp"
+#include "logger.hpp"
 
 namespace simple_middleware {
 
@@ -37,21 +45,64 @@ struct Message {
  */
 using SubscribeCallback = std::function<void(const Message&)>;
 
+/**
+ * @brief 单个订阅者的回调耗时统计
+ */
+struct SubscriberStats {
+    int64_t subscribe_id = 0;
+    std::string topic;
+    uint64_t calls = 0;              // 回调次数
+    uint64_t callback_ns_total = 0;  // 回调累计耗时（纳秒）
+    uint64_t callback_ns_max = 0;    // 单次回调最大耗时（纳秒）
+    LatencySummary callback_ns;      // 回调耗时分布（纳秒，进程启动以来）
+    uint64_t budget_ns = 0;          // 生效的耗时预算，0 表示不检查
+    uint64_t over_budget = 0;        // 超出预算的次数
+};
+
+/**
+ * @brief 单个主题的统计快照（均为进程启动以来的累计值）
+ */
+struct TopicStats {
+    std::string topic;
+    TopicId topic_id = 0;
+    uint64_t msgs_out = 0;           // 本节点发布的消息数
+    uint64_t bytes_out = 0;          // 本节点发布的字节数
+    uint64_t fragments_out = 0;      // 发布时在网络上产生的分片数（UDP 超过 MTU 时 > msgs_out）
+    uint64_t msgs_in = 0;            // 从传输层收到的消息数
+    uint64_t bytes_in = 0;           // 从传输层收到的字节数
+    uint64_t send_drops = 0;         // 发送失败数（传输层拒绝发送）
+    uint64_t decode_errors = 0;      // 订阅端解码失败数
+    uint64_t dispatch_count = 0;     // 本地分发次数
+    uint64_t dispatch_ns_total = 0;  // 本地分发累计耗时（含所有回调，纳秒）
+    uint64_t dispatch_ns_max = 0;    // 单次分发最大耗时（纳秒）
+    std::vector<SubscriberStats> subscribers;
+};
+
 /**
  * @brief 简易订阅发布中间件
- * @details 提供线程安全的订阅/发布功能
+ * @details 提供线程安全的订阅/发布功能，跨进程通信由可替换的 Transport 完成
  */
 class PubSubMiddleware {
 public:
     /**
      * @brief 获取单例实例
      * 【注意：单例模式】保证全局只有一个中间件实例，方便在不同模块间共享通信状态
+     * 传输层和回调耗时预算由 config/middleware.json 决定，默认 UDP 广播、预算 10ms
      */
     static PubSubMiddleware& getInstance() {
-        static PubSubMiddleware instance;
+        static PubSubMiddleware& instance = createFromConfig();
         return instance;
     }
 
+    /**
+     * @brief 使用指定传输层创建独立的中间件实例
+     * @param transport 传输层，为空时只做进程内本地分发
+     * @details 节点代码统一使用 getInstance()；独立实例用于基准测试和测试，
+     *          例如多个使用不同 LoopbackTransport domain 的实例可以在同一进程内互不干扰
+     */
+    explicit PubSubMiddleware(std::unique_ptr<Transport> transport);
+    ~PubSubMiddleware();
+
     /**
      * @brief 发布消息
      * @param topic 主题名称
@@ -60,6 +111,34 @@ public:
      */
     bool publish(const std::string& topic, const std::string& data);
 
+    /**
+     * @brief 按话题描述符发布消息（推荐）
+     * @param topic 话题描述符，决定消息类型和编码方式
+     * @param msg 消息对象，类型必须与描述符一致，否则编译失败
+     * @return 是否发布成功
+     */
+    template <typename T>
+    bool publish(const Topic<T>& topic, const typename Topic<T>::MessageType& msg) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return publishRaw(topic.id, topic.name, msg);
+        } else {
+            std::string data;
+            if (!MessageCodec<T>::Encode(msg, &data)) {
+                return false;
+            }
+            return publishRaw(topic.id, topic.name, data);
+        }
+    }
+
+    /**
+     * @brief 按话题描述符发布已编码好的数据
+     * @details 用于转发、分片重组等数据已经是序列化形式的场景，避免重复编解码
+     */
+    template <typename T>
+    bool publishSerialized(const Topic<T>& topic, const std::string& data) {
+        return publishRaw(topic.id, topic.name, data);
+    }
+
     /**
      * @brief 订阅主题
      * @param topic 主题名称
@@ -69,6 +148,60 @@ public:
      */
     int64_t subscribe(const std::string& topic, SubscribeCallback callback);
 
+    /**
+     * @brief 按话题描述符订阅
+     * @param topic 话题描述符
+     * @param callback 回调函数，参数为 const T&（自动解码）或 const Message&（原始数据）
+     * @return 订阅ID，失败返回-1
+     * @details protobuf 消息解码到该订阅自己的 MessageArena 上，每条消息复用同一块内存，
+     *          回调中的 const T& 只在回调期间有效，需要保留时拷贝出去（member_ = msg）
+     */
+    template <typename T, typename Callback>
+    int64_t subscribe(const Topic<T>& topic, Callback&& callback) {
+        if constexpr (std::is_invocable_v<Callback, const Message&>) {
+            return subscribeRaw(topic.id, topic.name, SubscribeCallback(std::forward<Callback>(callback)));
+        } else {
+            static_assert(std::is_invocable_v<Callback, const T&>,
+                          "callback must accept const T& (topic message type) or const Message&");
+            std::function<void(const T&)> typed_callback(std::forward<Callback>(callback));
+            if constexpr (std::is_base_of_v<google::protobuf::MessageLite, T>) {
+                auto arena = std::make_shared<DecodeArena>();
+                return subscribeRaw(topic.id, topic.name, [this, topic, typed_callback, arena](const Message& msg) {
+                    // 同一订阅的回调可能并发（接收线程 + 本地发布线程）或重入，Arena 被占用时退回栈上解码
+                    if (arena->busy.exchange(true, std::memory_order_acquire)) {
+                        T decoded;
+                        if (!MessageCodec<T>::Decode(msg.data, &decoded)) {
+                            onDecodeError(topic.name, msg.data.size());
+                            return;
+                        }
+                        typed_callback(decoded);
+                        return;
+                    }
+                    struct Release {
+                        std::atomic<bool>& busy;
+                        ~Release() { busy.store(false, std::memory_order_release); }
+                    } release{arena->busy};
+                    arena->arena.reset();
+                    T* decoded = arena->arena.template create<T>();
+                    if (!MessageCodec<T>::Decode(msg.data, decoded)) {
+                        onDecodeError(topic.name, msg.data.size());
+                        return;
+                    }
+                    typed_callback(*decoded);
+                });
+            } else {
+                return subscribeRaw(topic.id, topic.name, [this, topic, typed_callback](const Message& msg) {
+                    T decoded;
+                    if (!MessageCodec<T>::Decode(msg.data, &decoded)) {
+                        onDecodeError(topic.name, msg.data.size());
+                        return;
+                    }
+                    typed_callback(decoded);
+                });
+            }
+        }
+    }
+
     /**
      * @brief 取消订阅
      * @param subscribe_id 订阅ID
@@ -83,6 +216,9 @@ public:
      */
     size_t unsubscribeTopic(const std::string& topic);
 
+    template <typename T>
+    size_t unsubscribeTopic(const Topic<T>& topic) { return unsubscribeTopicById(topic.id); }
+
     /**
      * @brief 获取某个主题的订阅者数量
      * @param topic 主题名称
@@ -90,43 +226,146 @@ public:
      */
     size_t getSubscriberCount(const std::string& topic) const;
 
+    template <typename T>
+    size_t getSubscriberCount(const Topic<T>& topic) const { return getSubscriberCountById(topic.id); }
+
     /**
      * @brief 获取所有主题列表
      * @return 主题列表
      */
     std::vector<std::string> getAllTopics() const;
 
+    /**
+     * @brief 获取所有主题的统计快照
+     * @details 计数器为每个主题独立的原子量，发布/分发热路径上只做 relaxed 自增，
+     *          这里读取时不保证各字段之间严格一致
+     */
+    std::vector<TopicStats> getTopicStats() const;
+
+    /**
+     * @brief 查询单个订阅的回调耗时统计
+     * @return 订阅不存在时返回 false
+     */
+    bool getSubscriberStats(int64_t subscribe_id, SubscriberStats* stats) const;
+
+    /**
+     * @brief 设置回调耗时预算的默认值（对未单独设置预算的订阅生效，包括已存在的订阅）
+     * @param budget 单次回调允许的耗时，0 表示不检查
+     * @details 回调在传输层接收线程或发布线程上同步执行，超出预算时按订阅限频输出告警（每 5 秒最多一条），
+     *          并计入 SubscriberStats::over_budget。全局单例从 config/middleware.json 的 callback_budget_ms 读取
+     */
+    void setDefaultCallbackBudget(std::chrono::nanoseconds budget);
+
+    /**
+     * @brief 为单个订阅设置回调耗时预算（覆盖默认值），0 表示不检查
+     * @return 订阅不存在时返回 false
+     */
+    bool setCallbackBudget(int64_t subscribe_id, std::chrono::nanoseconds budget);
+
+    /**
+     * @brief 当前使用的传输层名称（"udp" / "loopback" / "none"）
+     */
+    const char* getTransportName() const { return transport_ ? transport_->name() : "none"; }
+
+    /**
+     * @brief 获取传输层统计（收发包数、内核丢包数、socket 缓冲区大小等）
+     */
+    TransportStats getTransportStats() const { return transport_ ? transport_->getStats() : TransportStats(); }
+
 private:
-    PubSubMiddleware();
-    ~PubSubMiddleware();
     PubSubMiddleware(const PubSubMiddleware&) = delete;
     PubSubMiddleware& operator=(const PubSubMiddleware&) = delete;
 
-    // 仅分发到本地订阅者，不进行网络广播
-    void dispatchLocal(const std::string& topic, const std::string& data);
+    // 字符串接口和描述符接口最终都走这里，topic_id 已经算好
+    bool publishRaw(TopicId topic_id, std::string_view topic, const std::string& data);
+    int64_t subscribeRaw(TopicId topic_id, std::string_view topic, SubscribeCallback callback);
+    size_t unsubscribeTopicById(TopicId topic_id);
+    size_t getSubscriberCountById(TopicId topic_id) const;
+    void onDecodeError(std::string_view topic, size_t data_size);
+
+    // 传输层收到远端消息
+    void onTransportMessage(std::string_view topic, const std::string& data);
+
+    // 本地分发计数（发布线程和接收线程各记一份，读取时相加）
+    struct DispatchCounters {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> ns_total{0};
+        std::atomic<uint64_t> ns_max{0};
+    };
+
+    // 每个主题的计数器
+    // 【注意：缓存行对齐】发布线程和接收/分发线程各写一组计数器，分开放在不同缓存行，避免伪共享；
+    // 本地分发在哪个线程上发生，就记在哪一组
+    struct TopicCounters {
+        struct alignas(64) Out {
+            std::atomic<uint64_t> msgs{0};
+            std::atomic<uint64_t> bytes{0};
+            std::atomic<uint64_t> fragments{0};
+            std::atomic<uint64_t> send_drops{0};
+            DispatchCounters dispatch;  // 发布时的本地分发
+        } out;
+        struct alignas(64) In {
+            std::atomic<uint64_t> msgs{0};
+            std::atomic<uint64_t> bytes{0};
+            std::atomic<uint64_t> decode_errors{0};
+            DispatchCounters dispatch;  // 收到远端消息后的分发
+        } in;
+        std::string name;
+    };
 
-    // UDP 接收线程
-    void udpReceiveLoop();
-    void initUdpSocket();
+    // protobuf 订阅的解码 Arena，按订阅独占，初始块随消息大小自动扩大
+    struct DecodeArena {
+        std::atomic<bool> busy{false};
+        MessageArena arena{16 * 1024};
+    };
+
+    // 每个订阅者的回调计数器
+    struct alignas(64) SubscriberCounters {
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> ns_total{0};
+        std::atomic<uint64_t> ns_max{0};
+        std::atomic<uint64_t> over_budget{0};
+        std::atomic<int64_t> budget_ns{-1};  // -1 表示使用默认预算
+        LatencyHistogram histogram;          // 回调耗时分布（纳秒）
+        detail::LogSite budget_warning;      // 超预算告警限频
+    };
 
     // 订阅信息结构
     struct Subscription {
         int64_t id;
+        TopicId topic_id;
         std::string topic;
-        SubscribeCallback callback;
+        std::shared_ptr<const SubscribeCallback> callback;  // 共享持有，分发时无需拷贝 std::function
+        std::shared_ptr<SubscriberCounters> counters;
     };
 
+    // 查找或创建主题计数器，调用方必须持有 mutex_；计数器创建后不会释放，指针一直有效
+    TopicCounters* getCountersLocked(TopicId topic_id, std::string_view topic);
+
+    // 仅分发到本地订阅者，不进行网络广播，返回该主题的计数器
+    // from_publisher：在发布线程上分发（计入 out.dispatch），否则计入 in.dispatch
+    TopicCounters* dispatchLocal(TopicId topic_id, std::string_view topic, const std::string& data,
+                                 bool from_publisher);
+
+    // 记录一次回调耗时，超出预算时限频告警；返回是否输出了告警
+    bool recordCallback(std::string_view topic, int64_t sub_id, SubscriberCounters& counters, uint64_t elapsed_ns);
+
+    // 读取订阅的统计，调用方必须持有 mutex_
+    SubscriberStats subscriberStatsLocked(const Subscription& sub) const;
+
+    // 全局单例：传输层和回调预算都来自 config/middleware.json
+    static PubSubMiddleware& createFromConfig();
+
     mutable std::mutex mutex_;                                    // 互斥锁
-    std::unordered_map<std::string, std::vector<int64_t>> topic_subscribers_;  // 主题 -> 订阅ID列表
+    std::unordered_map<TopicId, std::vector<int64_t>> topic_subscribers_;  // 主题ID -> 订阅ID列表
+    std::unordered_map<TopicId, std::string> topic_names_;       // 主题ID -> 主题名称
+    std::unordered_map<TopicId, std::unique_ptr<TopicCounters>> topic_counters_;  // 主题ID -> 统计计数器
     std::unordered_map<int64_t, Subscription> subscriptions_;     // 订阅ID -> 订阅信息
     int64_t next_subscribe_id_;                                    // 下一个订阅ID
+    std::atomic<int64_t> default_callback_budget_ns_{0};           // 默认回调耗时预算，0 表示不检查
 
-    // 网络通信相关
-    int udp_socket_fd_ = -1;
-    struct sockaddr_in broadcast_addr_;
-    std::thread receiver_thread_;
-    std::atomic<bool> running_{false};
-    static constexpr int UDP_PORT = 18888;  // 改为不常用端口，避免冲突
+    // 跨进程传输层（UDP 广播 / 进程内回环）
+    std::unique_ptr<Transport> transport_;
 };
 
 }  // namespace simple_middleware
@@ -0,0 +1,77 @@
+/*
+ * @Desc: 不可变快照 - 写者整体替换 shared_ptr<const T>，读者拿引用计数指针，不拷贝数据
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace simple_middleware {
+
+/**
+ * @brief 单写多读的不可变快照
+ * @details 替代 "互斥锁 + 成员消息 + 读者整份拷贝" 的写法：
+ *          写者每次构造一个新对象，通过 publish() 原子替换；读者 load() 得到 shared_ptr<const T>，
+ *          持有期间对象不会被修改或释放，读完即放，不需要拷贝整条消息，也不会和写者互相阻塞。
+ *
+ *          shared_ptr 的原子读写使用 std::atomic_load / std::atomic_store（C++17），
+ *          libstdc++ 内部按地址哈希到一把很短的自旋锁，只保护指针和引用计数的交换，与 T 的大小无关。
+ *          旧快照在最后一个读者释放时析构，可能发生在读者线程上。
+ *
+ * @code
+ *   // 写者（订阅回调）
+ *   auto frame = std::make_shared<senseauto::demo::FrameData>();
+ *   if (frame->ParseFromString(msg.data)) ground_truth_.publish(std::move(frame));
+ *
+ *   // 读者（周期循环）
+ *   if (auto gt = ground_truth_.load()) { use(gt->car_state()); }
+ * @endcode
+ */
+template <typename T>
+class Snapshot {
+public:
+    using Ptr = std::shared_ptr<const T>;
+
+    Snapshot() = default;
+    explicit Snapshot(Ptr initial) : ptr_(std::move(initial)) {}
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    /**
+     * @brief 发布新快照，之后的 load() 都返回它；已经拿到旧快照的读者不受影响
+     */
+    void publish(Ptr value) {
+        std::atomic_store_explicit(&ptr_, std::move(value), std::memory_order_release);
+    }
+
+    /**
+     * @brief 发布新快照（移入一个值）
+     */
+    void publish(T&& value) {
+        publish(std::make_shared<const T>(std::move(value)));
+    }
+
+    /**
+     * @brief 当前快照，还没有发布过时为 nullptr
+     */
+    Ptr load() const {
+        return std::atomic_load_explicit(&ptr_, std::memory_order_acquire);
+    }
+
+    /**
+     * @brief 清空快照
+     */
+    void reset() {
+        publish(Ptr());
+    }
+
+private:
+    Ptr ptr_;
+};
+
+}  // namespace simple_middleware
@@ -5,11 +5,59 @@
  */
 
 #include "status_reporter.hpp"
+#include "topics.hpp"
+#include "alloc_tracker.hpp"
+#include "logger.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <dirent.h>
+#include <unistd.h>
 
 namespace simple_middleware {
 
+namespace {
+
+struct ProcStat {
+    std::string comm;
+    uint64_t ticks = 0;  // utime + stime，单位为时钟滴答
+};
+
+/**
+ * @brief 解析 /proc/.../stat
+ * @details comm 可能含空格和括号，以最后一个 ')' 为界；其后第 1 个字段是 state（第 3 列），
+ *          utime / stime 是第 14 / 15 列
+ */
+bool ReadProcStat(const std::string& path, ProcStat* out) {
+    std::ifstream file(path);
+    std::string line;
+    if (!std::getline(file, line)) return false;
+    size_t open = line.find('(');
+    size_t close = line.rfind(')');
+    if (open == std::string::npos || close == std::string::npos || close < open) return false;
+    out->comm = line.substr(open + 1, close - open - 1);
+
+    std::istringstream fields(line.substr(close + 1));
+    std::string field;
+    uint64_t utime = 0;
+    uint64_t stime = 0;
+    for (int column = 3; column <= 15 && (fields >> field); ++column) {
+        if (column == 14) utime = std::strtoull(field.c_str(), nullptr, 10);
+        if (column == 15) stime = std::strtoull(field.c_str(), nullptr, 10);
+    }
+    out->ticks = utime + stime;
+    return true;
+}
+
+uint64_t NsToUs(uint64_t ns) {
+    return ns / 1000;
+}
+
+}  // namespace
+
 StatusReporter::StatusReporter(const std::string& node_name) 
     : node_name_(node_name) {
     current_status_.set_node_name(node_name);
@@ -41,6 +89,169 @@ void StatusReporter::SetStatus(senseauto::demo::NodeStatus::State state, const s
     current_status_.set_message(msg);
 }
 
+LoopMonitor* StatusReporter::RegisterLoop(const std::string& name, std::chrono::nanoseconds period) {
+    std::lock_guard<std::mutex> lock(loops_mutex_);
+    loops_.push_back(std::make_unique<LoopMonitor>(name, period));
+    return loops_.back().get();
+}
+
+void StatusReporter::PublishTopicStats() {
+    auto& middleware = PubSubMiddleware::getInstance();
+
+    senseauto::demo::NodeTopicStats snapshot;
+    snapshot.set_node_name(node_name_);
+    snapshot.set_timestamp(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+
+    for (const auto& stats : middleware.getTopicStats()) {
+        auto* entry = snapshot.add_topics();
+        entry->set_topic(stats.topic);
+        entry->set_msgs_out(stats.msgs_out);
+        entry->set_bytes_out(stats.bytes_out);
+        entry->set_fragments_out(stats.fragments_out);
+        entry->set_msgs_in(stats.msgs_in);
+        entry->set_bytes_in(stats.bytes_in);
+        entry->set_send_drops(stats.send_drops);
+        entry->set_decode_errors(stats.decode_errors);
+        entry->set_dispatch_count(stats.dispatch_count);
+        entry->set_dispatch_ns_total(stats.dispatch_ns_total);
+        entry->set_dispatch_ns_max(stats.dispatch_ns_max);
+        entry->set_subscribers(static_cast<uint32_t>(stats.subscribers.size()));
+        uint64_t callback_ns_max = 0;
+        uint64_t callback_ns_p99 = 0;
+        uint64_t over_budget = 0;
+        for (const auto& sub : stats.subscribers) {
+            callback_ns_max = std::max(callback_ns_max, sub.callback_ns_max);
+            callback_ns_p99 = std::max(callback_ns_p99, sub.callback_ns.p99);
+            over_budget += sub.over_budget;
+        }
+        entry->set_callback_ns_max(callback_ns_max);
+        entry->set_callback_ns_p99(callback_ns_p99);
+        entry->set_callback_over_budget(over_budget);
+    }
+
+    TransportStats transport_stats = middleware.getTransportStats();
+    snapshot.set_kernel_drops(transport_stats.kernel_drops);
+    snapshot.set_rcvbuf_bytes(transport_stats.rcvbuf_bytes);
+
+    middleware.publish(topics::kTopicStats, snapshot);
+}
+
+void StatusReporter::PublishLoopStats() {
+    auto now = std::chrono::steady_clock::now();
+    bool first_sample = prev_sample_time_.time_since_epoch().count() == 0;
+    double window_s = first_sample ? 0.0 : std::chrono::duration<double>(now - prev_sample_time_).count();
+    prev_sample_time_ = now;
+    static const double ticks_per_s = static_cast<double>(sysconf(_SC_CLK_TCK));
+    // 滴答差 -> 窗口内 CPU 占用百分比
+    auto cpu_percent = [&](uint64_t ticks, uint64_t prev_ticks) {
+        if (window_s <= 0.0 || ticks < prev_ticks) return 0.0;
+        return (ticks - prev_ticks) / ticks_per_s / window_s * 100.0;
+    };
+
+    senseauto::demo::NodeLoopStats snapshot;
+    snapshot.set_node_name(node_name_);
+    snapshot.set_timestamp(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+
+    // 1. 各线程 CPU 时间
+    std::map<int, std::string> loop_by_tid;
+    {
+        std::lock_guard<std::mutex> lock(loops_mutex_);
+        for (const auto& loop : loops_) {
+            if (loop->tid() != 0) loop_by_tid[loop->tid()] = loop->name();
+        }
+    }
+
+    std::map<int, double> cpu_by_tid;
+    std::map<int, uint64_t> thread_ticks;
+    if (DIR* dir = opendir("/proc/self/task")) {
+        while (struct dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] < '0' || entry->d_name[0] > '9') continue;
+            int tid = std::atoi(entry->d_name);
+            ProcStat stat;
+            if (!ReadProcStat(std::string("/proc/self/task/") + entry->d_name + "/stat", &stat)) continue;
+            thread_ticks[tid] = stat.ticks;
+
+            auto prev = prev_thread_ticks_.find(tid);
+            double percent = prev != prev_thread_ticks_.end() ? cpu_percent(stat.ticks, prev->second) : 0.0;
+            cpu_by_tid[tid] = percent;
+
+            auto* thread = snapshot.add_threads();
+            thread->set_tid(tid);
+            thread->set_name(stat.comm);
+            auto loop = loop_by_tid.find(tid);
+            if (loop != loop_by_tid.end()) thread->set_loop(loop->second);
+            thread->set_cpu_percent(percent);
+            thread->set_cpu_ms_total(static_cast<uint64_t>(stat.ticks * 1000.0 / ticks_per_s));
+        }
+        closedir(dir);
+    }
+    // 只保留仍存活的线程，tid 复用时不会拿到旧线程的滴答
+    prev_thread_ticks_.swap(thread_ticks);
+
+    ProcStat process;
+    if (ReadProcStat("/proc/self/stat", &process)) {
+        if (!first_sample) snapshot.set_process_cpu_percent(cpu_percent(process.ticks, prev_process_ticks_));
+        prev_process_ticks_ = process.ticks;
+    }
+
+    // 2. 周期循环时序
+    const bool track_allocs = AllocTracker::IsEnabled();
+    snapshot.set_alloc_tracking(track_allocs);
+    std::ostringstream alloc_report;
+    {
+        std::lock_guard<std::mutex> lock(loops_mutex_);
+        for (const auto& loop : loops_) {
+            LoopWindowStats window = loop->takeWindow();
+            auto* timing = snapshot.add_loops();
+            timing->set_name(loop->name());
+            timing->set_period_us(static_cast<uint32_t>(NsToUs(loop->periodNs())));
+            timing->set_cycles(window.cycles);
+            timing->set_rate_hz(window_s > 0.0 ? window.cycles / window_s : 0.0);
+            timing->set_interval_p50_us(NsToUs(window.interval.p50));
+            timing->set_interval_p99_us(NsToUs(window.interval.p99));
+            timing->set_interval_max_us(NsToUs(window.interval.max));
+            timing->set_jitter_mean_us(NsToUs(window.jitter.mean));
+            timing->set_jitter_p99_us(NsToUs(window.jitter.p99));
+            timing->set_exec_p50_us(NsToUs(window.exec.p50));
+            timing->set_exec_p99_us(NsToUs(window.exec.p99));
+            timing->set_exec_max_us(NsToUs(window.exec.max));
+            timing->set_overruns(window.overruns);
+            timing->set_late_cycles(window.late_cycles);
+            timing->set_total_cycles(loop->totalCycles());
+            timing->set_total_overruns(loop->totalOverruns());
+            timing->set_tid(loop->tid());
+            auto cpu = cpu_by_tid.find(loop->tid());
+            timing->set_cpu_percent(cpu != cpu_by_tid.end() ? cpu->second : 0.0);
+            if (track_allocs && window.cycles > 0) {
+                double allocs_per_cycle = static_cast<double>(window.alloc_count) / window.cycles;
+                timing->set_allocs_per_cycle(allocs_per_cycle);
+                timing->set_allocs_max_per_cycle(window.allocs.max);
+                timing->set_alloc_bytes_per_cycle(static_cast<double>(window.alloc_bytes) / window.cycles);
+                alloc_report << " " << loop->name() << "=" << allocs_per_cycle << " allocs/iter ("
+                             << window.alloc_bytes / window.cycles << " B/iter, max "
+                             << window.allocs.max << ")";
+            }
+
+            // 偶发的调度延迟很常见，告警限频；完整数据以 system/loop_stats 为准
+            if (window.overruns > 0 || window.late_cycles > 0) {
+                LOG_EVERY_MS(WARN, "StatusReporter", 5000)
+                    << node_name_ << " loop '" << loop->name() << "' missed its "
+                    << loop->periodNs() / 1e6 << "ms period: overruns=" << window.overruns
+                    << ", late=" << window.late_cycles << ", interval_max=" << window.interval.max / 1e6
+                    << "ms, exec_max=" << window.exec.max / 1e6 << "ms";
+            }
+        }
+    }
+
+    if (track_allocs && alloc_report.tellp() > 0) {
+        LOG_EVERY_MS(INFO, "StatusReporter", 10000) << node_name_ << " heap allocations:" << alloc_report.str();
+    }
+
+    PubSubMiddleware::getInstance().publish(topics::kLoopStats, snapshot);
+}
+
 void StatusReporter::ReportLoop() {
     auto& middleware = PubSubMiddleware::getInstance();
     
@@ -51,11 +262,10 @@ void StatusReporter::ReportLoop() {
             auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
             current_status_.set_timestamp(millis);
             
-            std::string data;
-            if (current_status_.SerializeToString(&data)) {
-                middleware.publish("system/node_status", data);
-            }
+            middleware.publish(topics::kNodeStatus, current_status_);
         }
+        PublishTopicStats();
+        PublishLoopStats();
         // 每隔 1 秒上报一次
         std::this_thread::sleep_for(std::chrono::milliseconds(1000));
     }
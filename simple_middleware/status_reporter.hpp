@@ -10,7 +10,12 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <map>
+#include <memory>
+#include <vector>
+#include <chrono>
 #include "pub_sub_middleware.hpp"
+#include "loop_monitor.hpp"
 #include "common_msgs/system_status.pb.h"
 
 namespace simple_middleware {
@@ -25,8 +30,20 @@ public:
     
     void SetStatus(senseauto::demo::NodeStatus::State state, const std::string& msg);
 
+    /**
+     * @brief 登记一个周期循环，上报其实际周期、抖动、执行耗时和超时次数（system/loop_stats）
+     * @param name 循环名称，如 "physics"
+     * @param period 目标周期
+     * @return 循环线程使用的监控对象，生命周期与 StatusReporter 相同
+     */
+    LoopMonitor* RegisterLoop(const std::string& name, std::chrono::nanoseconds period);
+
 private:
     void ReportLoop();
+    // 发布本节点的中间件统计快照（system/topic_stats），供 SystemMonitor 汇总
+    void PublishTopicStats();
+    // 发布周期循环时序和各线程 CPU 占用（system/loop_stats）
+    void PublishLoopStats();
 
     std::string node_name_;
     senseauto::demo::NodeStatus current_status_;
@@ -34,6 +51,14 @@ private:
     
     std::thread report_thread_;
     std::atomic<bool> running_{false};
+
+    std::mutex loops_mutex_;
+    std::vector<std::unique_ptr<LoopMonitor>> loops_;
+
+    // 以下仅上报线程访问：上一次采样的 CPU 时钟滴答，用于差分计算占用率
+    std::map<int, uint64_t> prev_thread_ticks_;
+    uint64_t prev_process_ticks_ = 0;
+    std::chrono::steady_clock::time_point prev_sample_time_;
 };
 
 } // namespace simple_middleware
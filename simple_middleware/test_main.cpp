@@ -7,6 +7,12 @@
  *   1. 创建一个发布者，定时发送数据
  *   2. 创建一个订阅者，接收数据
  *   3. 运行一段时间后停止
+ *
+ *   ./test_middleware            使用全局中间件（传输层由 config/middleware.json 决定，默认 UDP）
+ *   ./test_middleware loopback   发布者和订阅者各用一个独立的中间件实例，经进程内回环传输通信，
+ *                                不占用 UDP 端口，可与其他测试同时运行
+ *   ./test_middleware [loopback] load
+ *                                压测模式：DataPublisher 以 2kHz、64B~2KB 随机大小、4 条一组突发发送二进制负载
  */
 
 #include "pub_sub_middleware.hpp"
@@ -16,6 +22,7 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <memory>
 
 using namespace simple_middleware;
 
@@ -25,13 +32,44 @@ int main(int argc, char* argv[]) {
     // 测试主题
     const std::string test_topic = "test/topic";
 
-    // 1. 创建发布者（每500ms发布一次）
+    // 0. 选择中间件实例
+    std::unique_ptr<PubSubMiddleware> pub_bus;
+    std::unique_ptr<PubSubMiddleware> sub_bus;
+    bool use_loopback = false;
+    bool use_load = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        use_loopback = use_loopback || arg == "loopback";
+        use_load = use_load || arg == "load";
+    }
+    if (use_loopback) {
+        // 同一 domain 的两个实例组成一条虚拟总线，消息只能经回环传输到达订阅者
+        pub_bus = std::make_unique<PubSubMiddleware>(std::make_unique<LoopbackTransport>("test_main"));
+        sub_bus = std::make_unique<PubSubMiddleware>(std::make_unique<LoopbackTransport>("test_main"));
+    }
+    PubSubMiddleware& pub_middleware = use_loopback ? *pub_bus : PubSubMiddleware::getInstance();
+    PubSubMiddleware& sub_middleware = use_loopback ? *sub_bus : PubSubMiddleware::getInstance();
+    LOG_INFO("TestMain") << "传输层: " << pub_middleware.getTransportName();
+
+    // 1. 创建发布者（默认每500ms发布一次；压测模式按 LoadProfile 生成流量）
     LOG_INFO("TestMain") << "创建数据发布者...";
-    DataPublisher publisher(test_topic, 500);
+    LoadProfile profile;
+    profile.topics = {test_topic};
+    profile.rate_hz = 2000.0;
+    profile.size.kind = PayloadSizeDistribution::kUniform;
+    profile.size.min_bytes = 64;
+    profile.size.max_bytes = 2048;
+    profile.burst_size = 4;
+    profile.report_interval_ms = 2000;
+    std::unique_ptr<DataPublisher> publisher_ptr = use_load
+        ? std::make_unique<DataPublisher>(profile, pub_middleware)
+        : std::make_unique<DataPublisher>(test_topic, 500, pub_middleware);
+    DataPublisher& publisher = *publisher_ptr;
     
     // 2. 创建订阅者
     LOG_INFO("TestMain") << "创建测试订阅者...";
-    TestSubscriber subscriber(test_topic);
+    TestSubscriber subscriber(test_topic, sub_middleware);
+    subscriber.setReportInterval(2000);
 
     // 3. 先启动订阅者
     if (!subscriber.start()) {
@@ -47,7 +85,7 @@ int main(int argc, char* argv[]) {
     }
 
     LOG_INFO("TestMain") << "系统运行中，按Ctrl+C停止...";
-    LOG_INFO("TestMain") << "发布间隔: " << publisher.getInterval() << "ms";
+    LOG_INFO("TestMain") << "发布速率: " << publisher.getProfile().rate_hz << " Hz";
     LOG_INFO("TestMain") << "订阅主题: " << test_topic;
 
     // 5. 运行10秒
@@ -69,12 +107,15 @@ int main(int argc, char* argv[]) {
 
     // 7. 打印最终统计
     LOG_INFO("TestMain") << "=== 最终统计 ===";
-    LOG_INFO("TestMain") << "发布消息总数: " << publisher.getMessageCount();
+    LOG_INFO("TestMain") << "发布消息总数: " << publisher.getMessageCount()
+                         << "（实测 " << publisher.getStats().measured_rate_hz << " Hz）";
     LOG_INFO("TestMain") << "接收消息总数: " << subscriber.getMessageCount();
-    LOG_INFO("TestMain") << "最后一条消息: " << subscriber.getLastMessage();
+    if (!use_load) {
+        LOG_INFO("TestMain") << "最后一条消息: " << subscriber.getLastMessage();
+    }
 
     // 8. 测试中间件统计信息
-    auto& middleware = PubSubMiddleware::getInstance();
+    auto& middleware = sub_middleware;
     LOG_INFO("TestMain") << "主题订阅者数量: " << middleware.getSubscriberCount(test_topic);
     
     auto topics = middleware.getAllTopics();
@@ -84,6 +125,25 @@ int main(int argc, char* argv[]) {
                             << middleware.getSubscriberCount(topic) << ")";
     }
 
+    // 9. 中间件内置的主题统计
+    for (auto* bus : {&pub_middleware, &sub_middleware}) {
+        for (const auto& stats : bus->getTopicStats()) {
+            LOG_INFO("TestMain") << "  [stats] " << stats.topic
+                                 << " out=" << stats.msgs_out << " in=" << stats.msgs_in
+                                 << " bytes_out=" << stats.bytes_out << " frags=" << stats.fragments_out
+                                 << " send_drops=" << stats.send_drops << " decode_errors=" << stats.decode_errors << " dispatch=" << stats.dispatch_count
+                                 << " avg_dispatch_us=" << (stats.dispatch_count ? stats.dispatch_ns_total / 1000.0 / stats.dispatch_count : 0.0);
+            for (const auto& sub : stats.subscribers) {
+                LOG_INFO("TestMain") << "    [sub " << sub.subscribe_id << "] calls=" << sub.calls
+                                     << " p50_us=" << sub.callback_ns.p50 / 1000.0
+                                     << " p99_us=" << sub.callback_ns.p99 / 1000.0
+                                     << " max_us=" << sub.callback_ns.max / 1000.0
+                                     << " over_budget=" << sub.over_budget;
+            }
+        }
+        if (!use_loopback) break;
+    }
+
     LOG_INFO("TestMain") << "=== 测试完成 ===";
     return 0;
 }
@@ -5,12 +5,32 @@
  */
 
 #include "test_subscriber.hpp"
+#include "load_test.hpp"
 #include "logger.hpp"
+#include "json_reader.hpp"
+#include <chrono>
+#include <sstream>
+#include <iomanip>
 
 namespace simple_middleware {
 
-TestSubscriber::TestSubscriber(const std::string& topic)
-    : topic_(topic)
+namespace {
+
+int64_t SteadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 数据流 = 发布者 × 话题下标
+uint64_t StreamKey(uint32_t publisher_id, uint16_t topic_index) {
+    return (static_cast<uint64_t>(publisher_id) << 16) | topic_index;
+}
+
+}  // namespace
+
+TestSubscriber::TestSubscriber(const std::string& topic, PubSubMiddleware& middleware)
+    : middleware_(middleware)
+    , topic_(topic)
     , subscribe_id_(-1)
     , subscribed_(false)
     , message_count_(0) {
@@ -27,8 +47,18 @@ bool TestSubscriber::start() {
         return false;
     }
 
+    message_count_ = 0;
+    decoded_count_ = 0;
+    latency_total_.reset();
+    latency_window_.reset();
+    {
+        std::lock_guard<std::mutex> lock(stream_mutex_);
+        streams_.clear();
+        gaps_ = lost_ = duplicates_ = reordered_ = max_reorder_distance_ = 0;
+    }
+
     // 订阅主题
-    subscribe_id_ = PubSubMiddleware::getInstance().subscribe(
+    subscribe_id_ = middleware_.subscribe(
         topic_,
         [this](const Message& msg) { this->onMessage(msg); }
     );
@@ -39,8 +69,11 @@ bool TestSubscriber::start() {
     }
 
     subscribed_ = true;
-    message_count_ = 0;
-    
+
+    if (report_interval_ms_ > 0) {
+        report_thread_ = std::make_unique<std::thread>(&TestSubscriber::reportThread, this);
+    }
+
     LOG_INFO("TestSubscriber") << "TestSubscriber订阅成功，主题: " << topic_ 
                                << ", 订阅ID: " << subscribe_id_;
     return true;
@@ -52,28 +85,186 @@ void TestSubscriber::stop() {
     }
 
     if (subscribe_id_ >= 0) {
-        PubSubMiddleware::getInstance().unsubscribe(subscribe_id_);
+        middleware_.unsubscribe(subscribe_id_);
         subscribe_id_ = -1;
     }
 
-    subscribed_ = false;
-    
+    {
+        std::lock_guard<std::mutex> lock(report_mutex_);
+        subscribed_ = false;
+    }
+    report_cv_.notify_all();
+    if (report_thread_ && report_thread_->joinable()) {
+        report_thread_->join();
+    }
+    report_thread_.reset();
+
     LOG_INFO("TestSubscriber") << "TestSubscriber取消订阅，主题: " << topic_ 
                                << ", 总共接收: " << message_count_ << " 条消息";
+    if (decoded_count_ > 0) {
+        LOG_INFO("TestSubscriber") << formatStats(getStats());
+    }
 }
 
 void TestSubscriber::onMessage(const Message& msg) {
-    message_count_++;
-    
+    int64_t now_ns = SteadyNowNs();
+    message_count_.fetch_add(1, std::memory_order_relaxed);
+
+    // 1. 二进制压测消息：LoadTestHeader
+    LoadTestHeader header;
+    bool decoded = DecodeLoadTestHeader(msg.data, &header);
+
+    // 2. 文本消息：兼容 DataPublisher 的 JSON 格式（sequence / send_ns / publisher_id）
+    if (!decoded) {
+        {
+            std::lock_guard<std::mutex> lock(last_msg_mutex_);
+            last_message_ = msg.data;
+        }
+        LOG_DEBUG("TestSubscriber") << "收到消息 #" << message_count_ 
+                                    << ", 主题: " << msg.topic 
+                                    << ", 数据: " << msg.data 
+                                    << ", 时间戳: " << msg.timestamp;
+
+        if (!msg.data.empty() && msg.data.front() == '{') {
+            // 只取压测头字段，负载部分直接跳过
+            int64_t publisher_id = 0;
+            int64_t sequence = -1;
+            int64_t send_ns = -1;
+            JsonReader reader(msg.data);
+            bool parsed = reader.forEachMember([&](std::string_view key) {
+                if (key == "send_ns") reader.readInt(&send_ns);
+                else if (key == "sequence") reader.readInt(&sequence);
+                else if (key == "publisher_id") reader.readInt(&publisher_id);
+            });
+            if (parsed && send_ns >= 0 && sequence >= 0) {
+                header.publisher_id = static_cast<uint32_t>(publisher_id);
+                header.sequence = static_cast<uint64_t>(sequence);
+                header.send_ns = send_ns;
+                header.topic_index = 0;
+                decoded = true;
+            }
+        }
+    }
+
+    if (!decoded) {
+        return;
+    }
+
+    decoded_count_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t latency_ns = now_ns > header.send_ns ? static_cast<uint64_t>(now_ns - header.send_ns) : 0;
+    latency_total_.record(latency_ns);
+    latency_window_.record(latency_ns);
+    trackSequence(StreamKey(header.publisher_id, header.topic_index), header.sequence);
+}
+
+void TestSubscriber::trackSequence(uint64_t stream_key, uint64_t sequence) {
+    constexpr uint64_t kWindow = StreamState::kWindow;
+    std::lock_guard<std::mutex> lock(stream_mutex_);
+
+    auto& state = streams_[stream_key];
+    if (!state) {
+        // 新数据流：从第一条收到的序号开始跟踪，订阅之前发出的消息不算丢失
+        state = std::make_unique<StreamState>();
+        state->highest = sequence;
+        state->seen.set(sequence % kWindow);
+        return;
+    }
+
+    if (sequence > state->highest) {
+        uint64_t skipped = sequence - state->highest - 1;
+        if (skipped > 0) {
+            gaps_++;
+            lost_ += skipped;
+        }
+        // 窗口向前滑动，清掉被复用的位
+        if (sequence - state->highest >= kWindow) {
+            state->seen.reset();
+        } else {
+            for (uint64_t s = state->highest + 1; s < sequence; ++s) {
+                state->seen.reset(s % kWindow);
+            }
+        }
+        state->seen.set(sequence % kWindow);
+        state->highest = sequence;
+        return;
+    }
+
+    uint64_t distance = state->highest - sequence;
+    if (distance < kWindow && state->seen.test(sequence % kWindow)) {
+        duplicates_++;
+        return;
+    }
+
+    // 迟到的消息：之前按丢失计算过，这里补回来
+    reordered_++;
+    if (distance > max_reorder_distance_) {
+        max_reorder_distance_ = distance;
+    }
+    if (distance < kWindow) {
+        state->seen.set(sequence % kWindow);
+        if (lost_ > 0) {
+            lost_--;
+        }
+    }
+}
+
+TestSubscriberStats TestSubscriber::getStats() const {
+    TestSubscriberStats stats;
+    stats.messages = message_count_;
+    stats.decoded = decoded_count_;
     {
-        std::lock_guard<std::mutex> lock(last_msg_mutex_);
-        last_message_ = msg.data;
-    }
-    
-    LOG_DEBUG("TestSubscriber") << "收到消息 #" << message_count_ 
-                                << ", 主题: " << msg.topic 
-                                << ", 数据: " << msg.data 
-                                << ", 时间戳: " << msg.timestamp;
+        std::lock_guard<std::mutex> lock(stream_mutex_);
+        stats.streams = streams_.size();
+        stats.gaps = gaps_;
+        stats.lost = lost_;
+        stats.duplicates = duplicates_;
+        stats.reordered = reordered_;
+        stats.max_reorder_distance = max_reorder_distance_;
+    }
+    stats.window_rate_hz = window_rate_hz_;
+    stats.latency = latency_total_.summary();
+    stats.window_latency = latency_window_.summary();
+    return stats;
+}
+
+std::string TestSubscriber::formatStats(const TestSubscriberStats& stats) {
+    auto us = [](uint64_t ns) { return ns / 1000.0; };
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1)
+        << "recv=" << stats.messages << " (" << stats.window_rate_hz << " Hz)"
+        << " streams=" << stats.streams
+        << " lost=" << stats.lost << " gaps=" << stats.gaps
+        << " dup=" << stats.duplicates << " reorder=" << stats.reordered
+        << " (max_dist=" << stats.max_reorder_distance << ")"
+        << " latency_us p50=" << us(stats.latency.p50) << " p99=" << us(stats.latency.p99)
+        << " p99.9=" << us(stats.latency.p999) << " max=" << us(stats.latency.max);
+    if (stats.window_latency.count > 0) {
+        oss << " | window p50=" << us(stats.window_latency.p50) << " p99=" << us(stats.window_latency.p99)
+            << " max=" << us(stats.window_latency.max);
+    }
+    return oss.str();
+}
+
+void TestSubscriber::reportThread() {
+    uint64_t last_count = message_count_;
+    int64_t last_ns = SteadyNowNs();
+
+    std::unique_lock<std::mutex> lock(report_mutex_);
+    while (subscribed_) {
+        report_cv_.wait_for(lock, std::chrono::milliseconds(report_interval_ms_));
+        if (!subscribed_) {
+            break;
+        }
+
+        int64_t now_ns = SteadyNowNs();
+        uint64_t count = message_count_;
+        window_rate_hz_ = (count - last_count) * 1e9 / static_cast<double>(std::max<int64_t>(now_ns - last_ns, 1));
+        last_count = count;
+        last_ns = now_ns;
+
+        LOG_INFO("TestSubscriber") << "[" << topic_ << "] " << formatStats(getStats());
+        latency_window_.reset();
+    }
 }
 
 std::string TestSubscriber::getLastMessage() const {
@@ -1,5 +1,5 @@
 /*
- * @Desc: 测试订阅者 - 用于测试中间件功能
+ * @Desc: 测试订阅者 - 用于测试中间件功能 / 压测时统计延迟、丢包和乱序
  * @Author: JacksonZhou
  * @Date: 2025/12/19
  */
@@ -9,21 +9,48 @@
 #include <string>
 #include <atomic>
 #include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <memory>
+#include <bitset>
+#include <unordered_map>
 #include "pub_sub_middleware.hpp"
+#include "latency_histogram.hpp"
 
 namespace simple_middleware {
 
+/**
+ * @brief 订阅端统计
+ * @details 延迟单位为纳秒（发送时刻取自 LoadTestHeader 或 JSON 中的 send_ns）
+ */
+struct TestSubscriberStats {
+    uint64_t messages = 0;          // 收到的消息总数
+    uint64_t decoded = 0;           // 能解析出序号/发送时刻的消息数
+    uint64_t streams = 0;           // 数据流个数（发布者 × 话题）
+    uint64_t gaps = 0;              // 序号跳变次数
+    uint64_t lost = 0;              // 当前仍缺失的消息数（跳过的序号中之后没有补到的）
+    uint64_t duplicates = 0;        // 重复消息数
+    uint64_t reordered = 0;         // 迟到（序号小于已收到的最大序号）的消息数
+    uint64_t max_reorder_distance = 0;  // 迟到消息与当时最大序号的最大差值
+    double window_rate_hz = 0.0;    // 最近一个报告窗口的接收速率
+    LatencySummary latency;         // 自启动以来的延迟
+    LatencySummary window_latency;  // 最近一个报告窗口的延迟
+};
+
 /**
  * @brief 测试订阅者类
- * @details 订阅主题并统计接收到的消息
+ * @details 订阅主题并统计接收到的消息；消息带有 LoadTestHeader（或旧版 JSON 的 sequence/send_ns）时，
+ *          按"发布者 + 话题"分流检测跳号、重复和乱序，并用无锁直方图记录发布→回调延迟
  */
 class TestSubscriber {
 public:
     /**
      * @brief 构造函数
      * @param topic 订阅的主题
+     * @param middleware 使用的中间件实例，默认全局单例
      */
-    explicit TestSubscriber(const std::string& topic);
+    explicit TestSubscriber(const std::string& topic,
+                            PubSubMiddleware& middleware = PubSubMiddleware::getInstance());
 
     /**
      * @brief 析构函数
@@ -41,28 +68,82 @@ public:
      */
     void stop();
 
+    /**
+     * @brief 设置周期性报告间隔（毫秒），0 表示不输出；需在 start() 之前设置
+     */
+    void setReportInterval(int interval_ms) { report_interval_ms_ = interval_ms; }
+
     /**
      * @brief 获取接收到的消息数量
      */
     uint64_t getMessageCount() const { return message_count_; }
 
     /**
-     * @brief 获取最后一次接收到的消息
+     * @brief 获取最后一次接收到的文本消息（二进制压测消息不保存）
      */
     std::string getLastMessage() const;
 
+    /**
+     * @brief 获取统计快照
+     */
+    TestSubscriberStats getStats() const;
+
+    /**
+     * @brief 格式化统计为一行日志
+     */
+    static std::string formatStats(const TestSubscriberStats& stats);
+
 private:
     /**
      * @brief 消息回调函数
      */
     void onMessage(const Message& msg);
 
+    /**
+     * @brief 更新数据流的序号状态
+     */
+    void trackSequence(uint64_t stream_key, uint64_t sequence);
+
+    /**
+     * @brief 周期性报告线程
+     */
+    void reportThread();
+
+    // 单个数据流的序号跟踪状态
+    struct StreamState {
+        static constexpr uint64_t kWindow = 4096;  // 记住最近多少个序号，用于区分重复和迟到
+        uint64_t highest = 0;                      // 已收到的最大序号
+        std::bitset<kWindow> seen;                 // seen[seq % kWindow]：窗口内的序号是否收到过
+    };
+
+    PubSubMiddleware& middleware_;         // 中间件实例
     std::string topic_;                    // 订阅主题
     int64_t subscribe_id_;                 // 订阅ID
     std::atomic<bool> subscribed_;         // 是否已订阅
     std::atomic<uint64_t> message_count_;  // 消息计数
     std::string last_message_;             // 最后一次消息
     mutable std::mutex last_msg_mutex_;    // 保护last_message_的互斥锁
+
+    // 延迟直方图（无锁，回调线程写入，报告线程读取）
+    LatencyHistogram latency_total_;
+    LatencyHistogram latency_window_;
+    std::atomic<uint64_t> decoded_count_{0};
+
+    // 序号跟踪（按数据流分开，回调可能来自多个线程，用互斥锁保护）
+    mutable std::mutex stream_mutex_;
+    std::unordered_map<uint64_t, std::unique_ptr<StreamState>> streams_;
+    uint64_t gaps_ = 0;
+    uint64_t lost_ = 0;
+    uint64_t duplicates_ = 0;
+    uint64_t reordered_ = 0;
+    uint64_t max_reorder_distance_ = 0;
+
+    // 周期性报告
+    int report_interval_ms_ = 0;
+    std::unique_ptr<std::thread> report_thread_;
+    std::mutex report_mutex_;
+    std::condition_variable report_cv_;
+    std::atomic<double> window_rate_hz_{0.0};
 };
 
 }  // namespace simple_middleware
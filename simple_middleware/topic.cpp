@@ -0,0 +1,23 @@
+/*
+ * @Desc: 话题描述符 - JSON 编解码实现
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#include "topic.hpp"
+#include "json11.hpp"
+
+namespace simple_middleware {
+
+bool MessageCodec<json11::Json>::Encode(const json11::Json& msg, std::string* out) {
+    *out = msg.dump();
+    return true;
+}
+
+bool MessageCodec<json11::Json>::Decode(const std::string& data, json11::Json* msg) {
+    std::string err;
+    *msg = json11::Json::parse(data, err);
+    return err.empty();
+}
+
+}  // namespace simple_middleware
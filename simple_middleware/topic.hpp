@@ -0,0 +1,104 @@
+/*
+ * @Desc: 编译期话题描述符（话题名 + 哈希ID + 消息类型 + QoS）
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <google/protobuf/message_lite.h>
+
+// json11 只做前向声明，避免不使用 JSON 话题的模块也必须引入 json11 头文件
+namespace json11 {
+class Json;
+}
+
+namespace simple_middleware {
+
+/**
+ * @brief 话题ID，由话题名在编译期哈希得到
+ */
+using TopicId = uint64_t;
+
+/**
+ * @brief 计算话题名的哈希值（64位 FNV-1a）
+ * 【注意：constexpr】描述符中的 ID 在编译期算好，运行时查表只需比较整数
+ */
+constexpr TopicId HashTopicName(std::string_view name) {
+    TopicId hash = 14695981039346656037ULL;
+    for (char c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief 话题优先级（QoS）
+ */
+enum TopicPriority : uint8_t {
+    kPriorityBestEffort = 0,  // 尽力而为，可丢弃（如调试数据、大块图像分片）
+    kPriorityNormal = 1,      // 普通数据
+    kPriorityCritical = 2,    // 关键数据（真值、控制指令等），不可随意丢弃
+};
+
+/**
+ * @brief 话题描述符
+ * @tparam T 该话题承载的消息类型
+ * @details 用法：inline constexpr Topic<FrameData> kGroundTruth{"visualizer/data", kPriorityCritical};
+ *          publish/subscribe 根据描述符的类型参数选择编解码方式，类型不匹配会在编译期报错
+ */
+template <typename T>
+struct Topic {
+    using MessageType = T;
+
+    std::string_view name;   // 话题名称
+    TopicPriority priority;  // QoS 优先级
+    TopicId id;              // 编译期哈希ID
+
+    constexpr Topic(std::string_view topic_name, TopicPriority topic_priority = kPriorityNormal)
+        : name(topic_name), priority(topic_priority), id(HashTopicName(topic_name)) {}
+
+    std::string str() const { return std::string(name); }
+};
+
+/**
+ * @brief 消息编解码器
+ * @details 未特化的类型没有 Encode/Decode，用于话题收发时直接编译失败
+ */
+template <typename T, typename Enable = void>
+struct MessageCodec;
+
+/**
+ * @brief protobuf 消息编解码
+ */
+template <typename T>
+struct MessageCodec<T, std::enable_if_t<std::is_base_of_v<google::protobuf::MessageLite, T>>> {
+    static bool Encode(const T& msg, std::string* out) { return msg.SerializeToString(out); }
+    static bool Decode(const std::string& data, T* msg) { return msg->ParseFromString(data); }
+};
+
+/**
+ * @brief 原始字节流（分片包、已序列化数据等）
+ */
+template <>
+struct MessageCodec<std::string> {
+    static bool Encode(const std::string& msg, std::string* out) { *out = msg; return true; }
+    static bool Decode(const std::string& data, std::string* msg) { *msg = data; return true; }
+};
+
+/**
+ * @brief JSON 消息编解码（实现在 topic.cpp 中）
+ */
+template <>
+struct MessageCodec<json11::Json> {
+    static bool Encode(const json11::Json& msg, std::string* out);
+    static bool Decode(const std::string& data, json11::Json* msg);
+};
+
+}  // namespace simple_middleware
@@ -0,0 +1,59 @@
+/*
+ * @Desc: 系统话题目录（所有模块共用的话题描述符）
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include "topic.hpp"
+#include "common_msgs/visualizer_data.pb.h"
+#include "common_msgs/sensor_data.pb.h"
+#include "common_msgs/map_data.pb.h"
+#include "common_msgs/system_status.pb.h"
+#include "common_msgs/daemon.pb.h"
+
+namespace simple_middleware {
+namespace topics {
+
+// ---------------- 仿真 / 可视化 ----------------
+// 仿真真值（自车状态 + 障碍物真值）
+// 兼容用的聚合话题，只需要自车状态或障碍物的模块订阅下面两个拆分话题
+inline constexpr Topic<senseauto::demo::FrameData> kGroundTruth{"visualizer/data", kPriorityCritical};
+// 自车状态（100Hz，与物理仿真同频）
+inline constexpr Topic<senseauto::demo::EgoState> kEgoState{"simulator/ego_state", kPriorityCritical};
+// 障碍物真值（世界坐标，10Hz）
+inline constexpr Topic<senseauto::demo::ObstacleArray> kGroundTruthObstacles{"simulator/obstacles", kPriorityNormal};
+// 前端控制指令（浏览器发来的 JSON）
+inline constexpr Topic<json11::Json> kVisualizerControl{"visualizer/control", kPriorityCritical};
+// 地图（JSON，超过 MTU 时走分片话题）
+inline constexpr Topic<json11::Json> kMap{"visualizer/map", kPriorityNormal};
+inline constexpr Topic<std::string> kMapChunk{"visualizer/map/chunk", kPriorityNormal};
+// 地图（protobuf，供需要车道几何的节点使用；超过 MTU 时走分片话题）
+inline constexpr Topic<senseauto::demo::MapData> kMapData{"map/data", kPriorityNormal};
+inline constexpr Topic<std::string> kMapDataChunk{"map/data/chunk", kPriorityNormal};
+
+// ---------------- 传感器 ----------------
+inline constexpr Topic<senseauto::demo::CameraFrame> kCameraFront{"sensor/camera/front", kPriorityBestEffort};
+inline constexpr Topic<std::string> kCameraFrontChunk{"sensor/camera/front/chunk", kPriorityBestEffort};
+// 激光雷达点云（超过 MTU 时走分片话题）
+inline constexpr Topic<senseauto::demo::PointCloud> kLidarTop{"sensor/lidar/top", kPriorityBestEffort};
+inline constexpr Topic<std::string> kLidarTopChunk{"sensor/lidar/top/chunk", kPriorityBestEffort};
+
+// ---------------- 感知 / 预测 / 规划 / 控制 ----------------
+inline constexpr Topic<senseauto::demo::ObstacleArray> kPerceptionObstacles{"perception/obstacles", kPriorityNormal};
+inline constexpr Topic<senseauto::demo::Detection2DArray> kDetection2D{"perception/detection_2d", kPriorityNormal};
+inline constexpr Topic<senseauto::demo::PredictionArray> kPredictionTrajectories{"prediction/trajectories", kPriorityNormal};
+inline constexpr Topic<senseauto::demo::Trajectory> kPlanningTrajectory{"planning/trajectory", kPriorityCritical};
+inline constexpr Topic<senseauto::demo::ControlCommand> kControlCommand{"control/command", kPriorityCritical};
+
+// ---------------- 系统 ----------------
+inline constexpr Topic<senseauto::demo::NodeStatus> kNodeStatus{"system/node_status", kPriorityNormal};
+inline constexpr Topic<senseauto::demo::NodeTopicStats> kTopicStats{"system/topic_stats", kPriorityBestEffort};
+inline constexpr Topic<senseauto::demo::NodeLoopStats> kLoopStats{"system/loop_stats", kPriorityBestEffort};
+inline constexpr Topic<simple_daemon::SystemStatus> kSystemStatus{"system/status", kPriorityNormal};
+inline constexpr Topic<simple_daemon::SystemCommand> kSystemCommand{"system/command", kPriorityCritical};
+inline constexpr Topic<simple_daemon::CommandResponse> kSystemResponse{"system/response", kPriorityNormal};
+
+}  // namespace topics
+}  // namespace simple_middleware
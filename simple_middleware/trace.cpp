@@ -0,0 +1,122 @@
+/*
+ * @Desc: 端到端链路追踪实现
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#include "trace.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+namespace simple_middleware {
+
+namespace {
+
+// 时钟不同步时间隔可能为负，按 0 计
+uint64_t ClampInterval(int64_t from_us, int64_t to_us) {
+    return to_us > from_us ? static_cast<uint64_t>(to_us - from_us) : 0;
+}
+
+}  // namespace
+
+int64_t TraceNowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void TraceBegin(senseauto::demo::TraceContext* ctx, uint64_t trace_id) {
+    ctx->Clear();
+    ctx->set_trace_id(trace_id);
+    ctx->set_origin_timestamp_us(TraceNowUs());
+}
+
+void TraceStampStage(senseauto::demo::TraceContext* ctx, const std::string& stage) {
+    auto* stamp = ctx->add_stamps();
+    stamp->set_stage(stage);
+    stamp->set_timestamp_us(TraceNowUs());
+}
+
+TraceCollector::TraceCollector(size_t dedup_window)
+    : dedup_window_(dedup_window == 0 ? 1 : dedup_window) {}
+
+LatencyHistogram& TraceCollector::histogramFor(const std::string& stage) {
+    for (auto& entry : stages_) {
+        if (entry.stage == stage) {
+            return *entry.histogram;
+        }
+    }
+    stages_.push_back(StageHistogram{stage, std::make_unique<LatencyHistogram>()});
+    return *stages_.back().histogram;
+}
+
+bool TraceCollector::record(const senseauto::demo::TraceContext& ctx, int64_t now_us) {
+    if (ctx.trace_id() == 0 || ctx.origin_timestamp_us() == 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!recent_id_set_.insert(ctx.trace_id()).second) {
+        return false;
+    }
+    recent_ids_.push_back(ctx.trace_id());
+    if (recent_ids_.size() > dedup_window_) {
+        recent_id_set_.erase(recent_ids_.front());
+        recent_ids_.pop_front();
+    }
+
+    int64_t prev_us = ctx.origin_timestamp_us();
+    for (const auto& stamp : ctx.stamps()) {
+        histogramFor(stamp.stage()).record(ClampInterval(prev_us, stamp.timestamp_us()));
+        prev_us = stamp.timestamp_us();
+    }
+    histogramFor(kActuationStage).record(ClampInterval(prev_us, now_us));
+    end_to_end_.record(ClampInterval(ctx.origin_timestamp_us(), now_us));
+    return true;
+}
+
+std::vector<StageLatency> TraceCollector::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<StageLatency> result;
+    result.reserve(stages_.size() + 1);
+    // actuation 总是链路的最后一段，放到各阶段之后
+    const StageHistogram* actuation = nullptr;
+    for (const auto& entry : stages_) {
+        if (entry.stage == kActuationStage) {
+            actuation = &entry;
+            continue;
+        }
+        result.push_back(StageLatency{entry.stage, entry.histogram->summary()});
+    }
+    if (actuation) {
+        result.push_back(StageLatency{actuation->stage, actuation->histogram->summary()});
+    }
+    result.push_back(StageLatency{kEndToEndStage, end_to_end_.summary()});
+    return result;
+}
+
+std::string TraceCollector::formatReport() const {
+    std::string report = "Pipeline latency (ms):\n";
+    char line[160];
+    std::snprintf(line, sizeof(line), "  %-12s %8s %9s %9s %9s\n", "stage", "count", "p50", "p99", "max");
+    report += line;
+    for (const auto& s : snapshot()) {
+        std::snprintf(line, sizeof(line), "  %-12s %8llu %9.2f %9.2f %9.2f\n",
+                      s.stage.c_str(),
+                      static_cast<unsigned long long>(s.latency.count),
+                      s.latency.p50 / 1000.0, s.latency.p99 / 1000.0, s.latency.max / 1000.0);
+        report += line;
+    }
+    report.pop_back();
+    return report;
+}
+
+void TraceCollector::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : stages_) {
+        entry.histogram->reset();
+    }
+    end_to_end_.reset();
+}
+
+}  // namespace simple_middleware
@@ -0,0 +1,107 @@
+/*
+ * @Desc: 端到端链路追踪（追踪上下文传递 + 分阶段延迟统计）
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_set>
+#include <memory>
+#include <mutex>
+
+#include "latency_histogram.hpp"
+#include "common_msgs/trace.pb.h"
+
+namespace simple_middleware {
+
+/**
+ * @brief 当前墙上时钟（微秒）
+ * @details 追踪打点需要跨进程比较，因此用 system_clock 而不是 steady_clock；
+ *          跨机器部署时各节点需要做时钟同步（NTP/PTP），否则分阶段延迟没有意义
+ */
+int64_t TraceNowUs();
+
+/**
+ * @brief 开始一条新的追踪链路（由链路源头调用，即 Simulator 发布真值时）
+ */
+void TraceBegin(senseauto::demo::TraceContext* ctx, uint64_t trace_id);
+
+/**
+ * @brief 在上下文末尾追加一个处理阶段的打点
+ * @details 各模块的约定：把输入消息的 trace 原样拷贝到输出消息，发布前调用本函数打上自己的阶段名
+ */
+void TraceStampStage(senseauto::demo::TraceContext* ctx, const std::string& stage);
+
+/**
+ * @brief 单个阶段的延迟摘要（单位：微秒）
+ */
+struct StageLatency {
+    std::string stage;
+    LatencySummary latency;
+};
+
+/**
+ * @brief 链路延迟收集器
+ * @details 在链路终点（Simulator 收到 control/command）调用 record()：
+ *          - 每个打点相对前一个打点（第一个相对 origin）的间隔记为该阶段的延迟；
+ *          - 最后一个打点到终点收到消息的间隔记为 "actuation"；
+ *          - origin 到终点的间隔记为 "end_to_end"。
+ *          下游模块是周期运行的，同一条链路的上下文会随多条消息重复到达，
+ *          收集器只统计每个 trace_id 第一次到达的那条（即"这帧真值最早在何时影响到控制"）。
+ */
+class TraceCollector {
+public:
+    static constexpr const char* kActuationStage = "actuation";
+    static constexpr const char* kEndToEndStage = "end_to_end";
+
+    /**
+     * @param dedup_window 记住最近多少个 trace_id 用于去重
+     */
+    explicit TraceCollector(size_t dedup_window = 1024);
+
+    /**
+     * @brief 记录一条到达终点的链路
+     * @param now_us 到达时刻（微秒）
+     * @return 该 trace_id 是第一次到达并被统计时返回 true
+     */
+    bool record(const senseauto::demo::TraceContext& ctx, int64_t now_us);
+    bool record(const senseauto::demo::TraceContext& ctx) { return record(ctx, TraceNowUs()); }
+
+    /**
+     * @brief 各阶段的延迟摘要，按链路顺序排列，end_to_end 在最后
+     */
+    std::vector<StageLatency> snapshot() const;
+
+    /**
+     * @brief 格式化为日志表格（stage / count / p50 / p99 / max，单位毫秒）
+     */
+    std::string formatReport() const;
+
+    /**
+     * @brief 清空统计窗口（去重记录保留）
+     */
+    void reset();
+
+private:
+    LatencyHistogram& histogramFor(const std::string& stage);
+
+    struct StageHistogram {
+        std::string stage;
+        std::unique_ptr<LatencyHistogram> histogram;
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<StageHistogram> stages_;  // 按第一次出现的顺序
+    LatencyHistogram end_to_end_;
+
+    size_t dedup_window_;
+    std::deque<uint64_t> recent_ids_;
+    std::unordered_set<uint64_t> recent_id_set_;
+};
+
+}  // namespace simple_middleware
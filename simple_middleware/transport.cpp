@@ -0,0 +1,483 @@
+/*
+ * @Desc: 中间件传输层实现
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#include "transport.hpp"
+#include <chrono>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+#include "config_manager.hpp"
+#include "logger.hpp"
+#include "profiler.hpp"
+
+namespace simple_middleware {
+
+// ============================================================
+// UdpBroadcastTransport
+// ============================================================
+
+namespace {
+
+// *BUFFORCE 仅 Linux 提供，其他平台只使用普通选项
+#ifdef SO_RCVBUFFORCE
+constexpr int kRcvBufForceOpt = SO_RCVBUFFORCE;
+constexpr int kSndBufForceOpt = SO_SNDBUFFORCE;
+#else
+constexpr int kRcvBufForceOpt = -1;
+constexpr int kSndBufForceOpt = -1;
+#endif
+
+int64_t NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+UdpBroadcastTransport::UdpBroadcastTransport(const UdpTransportOptions& options) : options_(options) {
+    memset(&broadcast_addr_, 0, sizeof(broadcast_addr_));
+}
+
+UdpBroadcastTransport::~UdpBroadcastTransport() {
+    stop();
+}
+
+bool UdpBroadcastTransport::start(TransportReceiveHandler handler) {
+    if (running_) return true;
+    handler_ = std::move(handler);
+
+    // socket 创建失败时仍然启动接收线程（与原先行为一致），只是不会收到任何远端消息
+    initSocket();
+    running_ = true;
+    // 【分离线程】启动后台线程监听网络消息
+    receiver_thread_ = std::thread(&UdpBroadcastTransport::receiveLoop, this);
+    return socket_fd_ >= 0;
+}
+
+void UdpBroadcastTransport::stop() {
+    // 【安全退出】先设置标志位让循环停止，再等待线程结束
+    if (!running_.exchange(false)) return;
+    if (socket_fd_ >= 0) {
+        // 仅 close 不会唤醒阻塞在 recvfrom 上的线程，先 shutdown 让 recvfrom 立即返回
+        shutdown(socket_fd_, SHUT_RDWR);
+    }
+    if (receiver_thread_.joinable()) {
+        receiver_thread_.join();
+    }
+    if (socket_fd_ >= 0) {
+        close(socket_fd_);
+        socket_fd_ = -1;
+    }
+}
+
+bool UdpBroadcastTransport::initSocket() {
+    // SOCK_DGRAM 表示使用数据报协议（UDP）
+    socket_fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (socket_fd_ < 0) {
+        LOG_ERROR("PubSubMiddleware") << "创建 socket 失败";
+        return false;
+    }
+
+    // 【广播权限】默认 Socket 不允许发送广播消息，必须显式开启
+    int broadcast = 1;
+    if (setsockopt(socket_fd_, SOL_SOCKET, SO_BROADCAST, &broadcast, sizeof(broadcast)) < 0) {
+        LOG_ERROR("PubSubMiddleware") << "设置广播权限失败";
+        close(socket_fd_);
+        socket_fd_ = -1;
+        return false;
+    }
+
+    // 【地址重用】允许程序在重启后立即重新绑定该端口，避免 "Address already in use" 错误
+    int reuse = 1;
+    if (setsockopt(socket_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0) {
+        LOG_ERROR("PubSubMiddleware") << "设置地址重用失败";
+    }
+
+    #ifdef SO_REUSEPORT
+    // 【端口重用】允许跨进程共享同一端口（macOS/Linux 特性）
+    if (setsockopt(socket_fd_, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse)) < 0) {
+        LOG_ERROR("PubSubMiddleware") << "设置端口重用失败";
+    }
+    #endif
+
+    // 【缓冲区】默认 SO_RCVBUF 较小，相机分片突发时接收线程稍有延迟内核就会丢包
+    if (options_.rcvbuf_bytes > 0) {
+        setBufferSize(kRcvBufForceOpt, SO_RCVBUF, options_.rcvbuf_bytes);
+    }
+    if (options_.sndbuf_bytes > 0) {
+        setBufferSize(kSndBufForceOpt, SO_SNDBUF, options_.sndbuf_bytes);
+    }
+    int value = 0;
+    socklen_t value_len = sizeof(value);
+    if (getsockopt(socket_fd_, SOL_SOCKET, SO_RCVBUF, &value, &value_len) == 0) {
+        rcvbuf_bytes_ = value;
+    }
+    value_len = sizeof(value);
+    if (getsockopt(socket_fd_, SOL_SOCKET, SO_SNDBUF, &value, &value_len) == 0) {
+        sndbuf_bytes_ = value;
+    }
+
+    #ifdef SO_RXQ_OVFL
+    // 【丢包检测】开启后每个数据包都会在辅助数据中携带该 socket 的累计丢包数（Linux 特性）
+    int rxq_ovfl = 1;
+    if (setsockopt(socket_fd_, SOL_SOCKET, SO_RXQ_OVFL, &rxq_ovfl, sizeof(rxq_ovfl)) < 0) {
+        LOG_WARN("PubSubMiddleware") << "开启 SO_RXQ_OVFL 失败，无法统计内核丢包: " << strerror(errno);
+    }
+    #endif
+
+    // 【绑定端口】作为接收方，需要绑定固定端口来监听广播
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(options_.port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY); // 监听所有网卡
+
+    if (bind(socket_fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        LOG_ERROR("PubSubMiddleware") << "绑定端口失败 (端口: " << options_.port
+            << ", 错误: " << strerror(errno) << ", errno: " << errno << ")";
+        close(socket_fd_);
+        socket_fd_ = -1;
+        return false;
+    }
+
+    // 【目标地址】广播地址 255.255.255.255 会发给局域网内所有机器
+    broadcast_addr_.sin_family = AF_INET;
+    broadcast_addr_.sin_port = htons(options_.port);
+    broadcast_addr_.sin_addr.s_addr = htonl(INADDR_BROADCAST);
+
+    LOG_INFO("PubSubMiddleware") << "UDP广播服务已启动，端口: " << options_.port
+        << ", rcvbuf=" << rcvbuf_bytes_ << ", sndbuf=" << sndbuf_bytes_;
+    return true;
+}
+
+int UdpBroadcastTransport::setBufferSize(int force_opt, int opt, int bytes) {
+    // 先尝试 *BUFFORCE，无权限时退回普通选项（会被 rmem_max/wmem_max 截断）
+    if (force_opt < 0 || setsockopt(socket_fd_, SOL_SOCKET, force_opt, &bytes, sizeof(bytes)) < 0) {
+        if (setsockopt(socket_fd_, SOL_SOCKET, opt, &bytes, sizeof(bytes)) < 0) {
+            LOG_WARN("PubSubMiddleware") << "设置 socket 缓冲区失败: " << strerror(errno);
+        }
+    }
+    // 内核实际分配的值是设置值的两倍（含管理开销），以读回的值为准
+    int actual = 0;
+    socklen_t len = sizeof(actual);
+    getsockopt(socket_fd_, SOL_SOCKET, opt, &actual, &len);
+    // 自适应扩大到系统上限后每次调整都会被截断成同一个值，同一个截断值只告警一次
+    int& last_warned = opt == SO_RCVBUF ? last_warned_rcvbuf_ : last_warned_sndbuf_;
+    if (actual < bytes && actual != last_warned) {
+        last_warned = actual;
+        LOG_WARN("PubSubMiddleware") << "socket 缓冲区被系统上限截断: 期望 " << bytes
+            << " bytes, 实际 " << actual << " bytes（可调大 net.core.rmem_max / wmem_max）";
+    }
+    return actual;
+}
+
+void UdpBroadcastTransport::onKernelDropCounter(uint32_t counter) {
+    // 计数器是 32 位累计值，用无符号减法处理回绕
+    uint32_t delta = counter - last_drop_counter_;
+    last_drop_counter_ = counter;
+    if (delta == 0) return;
+
+    uint64_t total = kernel_drops_.fetch_add(delta) + delta;
+    LOG_EVERY_N(WARN, "PubSubMiddleware", 20) << "内核接收队列溢出，丢弃 " << delta << " 个数据包 (累计 " << total
+        << "), rcvbuf=" << rcvbuf_bytes_;
+
+    // 【自适应】发生丢包时翻倍接收缓冲区，直到上限；至少间隔 1 秒，给新缓冲区生效的时间
+    if (!options_.adaptive_rcvbuf) return;
+    int current = rcvbuf_bytes_;
+    // getsockopt 读回的是翻倍后的值，与上限比较时换算回设置值
+    if (current / 2 >= options_.max_rcvbuf_bytes) return;
+    int64_t now_ms = NowMs();
+    if (now_ms - last_resize_ms_ < 1000) return;
+    last_resize_ms_ = now_ms;
+
+    int target = std::min(std::max(current, 64 * 1024), options_.max_rcvbuf_bytes);
+    int actual = setBufferSize(kRcvBufForceOpt, SO_RCVBUF, target);
+    if (actual > current) {
+        rcvbuf_bytes_ = actual;
+        rcvbuf_resizes_++;
+        LOG_INFO("PubSubMiddleware") << "接收缓冲区扩大: " << current << " -> " << actual << " bytes";
+    }
+}
+
+TransportStats UdpBroadcastTransport::getStats() const {
+    TransportStats stats;
+    stats.packets_sent = packets_sent_;
+    stats.bytes_sent = bytes_sent_;
+    stats.send_errors = send_errors_;
+    stats.packets_received = packets_received_;
+    stats.bytes_received = bytes_received_;
+    stats.kernel_drops = kernel_drops_;
+    stats.rcvbuf_resizes = rcvbuf_resizes_;
+    stats.rcvbuf_bytes = rcvbuf_bytes_;
+    stats.sndbuf_bytes = sndbuf_bytes_;
+    return stats;
+}
+
+void UdpBroadcastTransport::receiveLoop() {
+    char buffer[65535];
+    struct sockaddr_in sender_addr;
+    // 辅助数据缓冲区，用于接收 SO_RXQ_OVFL 丢包计数
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(uint32_t))];
+
+    LOG_INFO("PubSubMiddleware") << "UDP receive loop started";
+
+    while (running_) {
+        if (socket_fd_ < 0) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            continue;
+        }
+
+        // 【阻塞接收】recvmsg 会在这里挂起，直到有数据包到达
+        // 与 recvfrom 相比多了辅助数据（cmsg），可以拿到内核丢包计数
+        struct iovec iov;
+        iov.iov_base = buffer;
+        iov.iov_len = sizeof(buffer) - 1;
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = &sender_addr;
+        msg.msg_namelen = sizeof(sender_addr);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        ssize_t len = recvmsg(socket_fd_, &msg, 0);
+
+        if (len > 0) {
+            uint64_t packet_index = ++packets_received_;
+            bytes_received_ += len;
+            #ifdef SO_RXQ_OVFL
+            for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+                    uint32_t counter = 0;
+                    memcpy(&counter, CMSG_DATA(cmsg), sizeof(counter));
+                    onKernelDropCounter(counter);
+                }
+            }
+            #endif
+
+            // 前 10 个包用 INFO 记录（确认链路已通），之后每 50 个包用 DEBUG 记录
+            LOG_IF(INFO, "PubSubMiddleware", packet_index <= 10) << "Received UDP packet #" << packet_index
+                << ", size=" << len << " bytes";
+            LOG_IF(DEBUG, "PubSubMiddleware", packet_index > 10 && packet_index % 50 == 0)
+                << "Received UDP packet #" << packet_index << ", size=" << len << " bytes";
+            // 注意：不要设置 buffer[len] = '\0'，因为数据可能包含二进制内容
+            // 【简易协议】自定义协议格式 topic|data
+            const char* sep = static_cast<const char*>(memchr(buffer, '|', len));
+            if (sep != nullptr) {
+                std::string_view topic(buffer, sep - buffer);
+                std::string data(sep + 1, buffer + len - (sep + 1));
+                // 将接收到的网络消息交给中间件分发
+                handler_(topic, data);
+            } else {
+                LOG_EVERY_N(WARN, "PubSubMiddleware", 1000) << "Failed to parse UDP packet: len=" << len
+                    << ", no '|' separator found";
+            }
+        } else if (len < 0 && running_) {
+            LOG_EVERY_N(ERROR, "PubSubMiddleware", 100) << "recvmsg error: " << strerror(errno);
+        }
+    }
+}
+
+bool UdpBroadcastTransport::send(std::string_view topic, const std::string& data) {
+    // socket 没有建立（未启动或初始化失败）时消息发不出去，计入发布端的 send_drops
+    if (socket_fd_ < 0) return false;
+    PROFILE_SCOPE("Udp::Send");
+
+    // 按照协议打包数据
+    std::string raw_packet;
+    raw_packet.reserve(topic.size() + 1 + data.size());
+    raw_packet.append(topic.data(), topic.size());
+    raw_packet.push_back('|');
+    raw_packet.append(data);
+    size_t packet_size = raw_packet.size();
+
+    // 检查数据包大小（UDP 理论最大 65507 字节，但实际 MTU 约 1500 字节）
+    if (packet_size > 65507) {
+        LOG_ERROR("PubSubMiddleware") << "Packet too large for UDP: " << packet_size
+            << " bytes (max 65507), topic=" << topic;
+        return false;
+    }
+
+    // 超过 MTU 的包会在 IP 层分片，任一分片丢失整包都会丢失
+    if (packet_size > 1500) {
+        LOG_EVERY_N(WARN, "PubSubMiddleware", 100) << "Large packet may exceed MTU (1500 bytes): "
+            << packet_size << " bytes, topic=" << topic;
+    }
+
+    ssize_t sent = sendto(socket_fd_, raw_packet.data(), packet_size, 0,
+                          (struct sockaddr*)&broadcast_addr_, sizeof(broadcast_addr_));
+
+    // 发送缓冲区满（ENOBUFS / EAGAIN）等内核拒绝发送的情况和部分发送都算丢包，返回 false
+    if (sent < 0) {
+        send_errors_++;
+        LOG_EVERY_N(ERROR, "PubSubMiddleware", 100) << "sendto failed: " << strerror(errno)
+            << ", topic=" << topic << ", size=" << packet_size;
+        return false;
+    }
+    if (sent != static_cast<ssize_t>(packet_size)) {
+        send_errors_++;
+        LOG_EVERY_N(WARN, "PubSubMiddleware", 100) << "Partial send: " << sent << "/" << packet_size
+            << " bytes, topic=" << topic;
+        return false;
+    }
+    packets_sent_++;
+    bytes_sent_ += sent;
+    if (packet_size > 10000) { // 只记录大包
+        LOG_EVERY_N(DEBUG, "PubSubMiddleware", 100) << "Published large packet: topic=" << topic
+            << ", size=" << packet_size << " bytes";
+    }
+    return true;
+}
+
+// ============================================================
+// LoopbackTransport
+// ============================================================
+
+namespace detail {
+
+// 每个中间件实例对应一个投递端点：独立的队列 + 投递线程
+struct LoopbackEndpoint {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::pair<std::string, std::string>> queue;  // (topic, data)
+    TransportReceiveHandler handler;
+    std::thread thread;
+    bool running = false;
+
+    void deliverLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cv.wait(lock, [this] { return !running || !queue.empty(); });
+            if (!running) break;
+            auto item = std::move(queue.front());
+            queue.pop_front();
+            // 在锁外调用 handler，避免回调中再次 send 时死锁
+            lock.unlock();
+            handler(item.first, item.second);
+            lock.lock();
+        }
+    }
+};
+
+// 同一 domain 的所有端点
+struct LoopbackHub {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<LoopbackEndpoint>> endpoints;
+};
+
+}  // namespace detail
+
+namespace {
+
+std::mutex g_hub_registry_mutex;
+// domain -> Hub，所有使用该 domain 的传输层都析构后 Hub 自动释放
+std::unordered_map<std::string, std::weak_ptr<detail::LoopbackHub>> g_hub_registry;
+
+}  // namespace
+
+LoopbackTransport::LoopbackTransport(const std::string& domain) : domain_(domain) {
+    std::lock_guard<std::mutex> lock(g_hub_registry_mutex);
+    auto existing = g_hub_registry[domain_].lock();
+    if (!existing) {
+        existing = std::make_shared<detail::LoopbackHub>();
+        g_hub_registry[domain_] = existing;
+    }
+    hub_ = existing;
+}
+
+LoopbackTransport::~LoopbackTransport() {
+    stop();
+}
+
+bool LoopbackTransport::start(TransportReceiveHandler handler) {
+    if (endpoint_) return true;
+
+    auto endpoint = std::make_shared<detail::LoopbackEndpoint>();
+    endpoint->handler = std::move(handler);
+    endpoint->running = true;
+    endpoint->thread = std::thread(&detail::LoopbackEndpoint::deliverLoop, endpoint.get());
+
+    {
+        std::lock_guard<std::mutex> lock(hub_->mutex);
+        hub_->endpoints.push_back(endpoint);
+    }
+    endpoint_ = endpoint;
+
+    LOG_INFO("PubSubMiddleware") << "Loopback transport started, domain=" << domain_;
+    return true;
+}
+
+void LoopbackTransport::stop() {
+    if (!endpoint_) return;
+
+    // 先从 Hub 摘除，保证不会再有新消息入队
+    {
+        std::lock_guard<std::mutex> lock(hub_->mutex);
+        auto& eps = hub_->endpoints;
+        eps.erase(std::remove(eps.begin(), eps.end(), endpoint_), eps.end());
+    }
+    {
+        std::lock_guard<std::mutex> lock(endpoint_->mutex);
+        endpoint_->running = false;
+    }
+    endpoint_->cv.notify_all();
+    if (endpoint_->thread.joinable()) {
+        endpoint_->thread.join();
+    }
+    endpoint_.reset();
+}
+
+bool LoopbackTransport::send(std::string_view topic, const std::string& data) {
+    if (!endpoint_) return true;
+
+    std::lock_guard<std::mutex> lock(hub_->mutex);
+    for (const auto& endpoint : hub_->endpoints) {
+        // 本地订阅者已由中间件直接分发，不再回环给自己
+        if (endpoint == endpoint_) continue;
+        {
+            std::lock_guard<std::mutex> ep_lock(endpoint->mutex);
+            endpoint->queue.emplace_back(std::string(topic), data);
+        }
+        endpoint->cv.notify_one();
+    }
+    return true;
+}
+
+// ============================================================
+// 工厂
+// ============================================================
+
+std::unique_ptr<Transport> CreateTransportFromConfig() {
+    auto& config = ConfigManager::GetInstance();
+    config.Load("middleware", "config/middleware.json");
+
+    std::string type = config.Get<std::string>("middleware", "transport", "udp");
+    if (type == "loopback") {
+        std::string domain = config.Get<std::string>("middleware", "loopback_domain", "default");
+        return std::make_unique<LoopbackTransport>(domain);
+    }
+    if (type != "udp") {
+        LOG_WARN("PubSubMiddleware") << "Unknown transport type: " << type << ", fallback to udp";
+    }
+    UdpTransportOptions options;
+    options.port = config.Get<int>("middleware", "udp_port", options.port);
+    options.rcvbuf_bytes = config.Get<int>("middleware", "udp_rcvbuf_bytes", options.rcvbuf_bytes);
+    options.sndbuf_bytes = config.Get<int>("middleware", "udp_sndbuf_bytes", options.sndbuf_bytes);
+    options.adaptive_rcvbuf = config.Get<bool>("middleware", "udp_rcvbuf_adaptive", options.adaptive_rcvbuf);
+    options.max_rcvbuf_bytes = config.Get<int>("middleware", "udp_rcvbuf_max_bytes", options.max_rcvbuf_bytes);
+    return std::make_unique<UdpBroadcastTransport>(options);
+}
+
+}  // namespace simple_middleware
@@ -0,0 +1,188 @@
+/*
+ * @Desc: 中间件传输层（UDP 广播 / 进程内回环）
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <netinet/in.h>
+
+namespace simple_middleware {
+
+namespace detail {
+struct LoopbackHub;
+struct LoopbackEndpoint;
+}  // namespace detail
+
+/**
+ * @brief 传输层收到远端消息后的回调
+ * @param topic 主题名称
+ * @param data 消息数据
+ */
+using TransportReceiveHandler = std::function<void(std::string_view topic, const std::string& data)>;
+
+/**
+ * @brief 传输层统计信息
+ */
+struct TransportStats {
+    uint64_t packets_sent = 0;       // 发送成功的数据包数
+    uint64_t bytes_sent = 0;         // 发送成功的字节数（含协议头）
+    uint64_t send_errors = 0;        // 发送失败次数（sendto 出错 / 部分发送）
+    uint64_t packets_received = 0;   // 收到的数据包数
+    uint64_t bytes_received = 0;     // 收到的字节数（含协议头）
+    uint64_t kernel_drops = 0;       // 内核因接收缓冲区满丢弃的数据包数（SO_RXQ_OVFL）
+    uint64_t rcvbuf_resizes = 0;     // 自适应扩大接收缓冲区的次数
+    int rcvbuf_bytes = 0;            // 当前接收缓冲区大小（内核实际值）
+    int sndbuf_bytes = 0;            // 当前发送缓冲区大小（内核实际值）
+};
+
+/**
+ * @brief 传输层接口
+ * @details PubSubMiddleware 只负责本地订阅管理和分发，跨进程/跨机器的收发交给 Transport。
+ *          本地订阅者由中间件直接分发，Transport 只需要把消息送到"其他"中间件实例。
+ */
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    /**
+     * @brief 启动传输层（创建 socket / 接收线程等）
+     * @param handler 收到远端消息时的回调，在传输层的接收线程中调用
+     * @return 是否启动成功
+     */
+    virtual bool start(TransportReceiveHandler handler) = 0;
+
+    /**
+     * @brief 停止传输层，返回后不会再调用 handler
+     */
+    virtual void stop() = 0;
+
+    /**
+     * @brief 发送消息
+     * @return 消息没有发出去（超过单包上限、socket 不可用、内核拒绝发送或部分发送）时返回 false
+     */
+    virtual bool send(std::string_view topic, const std::string& data) = 0;
+
+    /**
+     * @brief 传输层名称（用于日志）
+     */
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief 一条消息在网络上会被拆成几个分片
+     * @param payload_bytes 传输层负载大小（含话题名和分隔符）
+     */
+    virtual uint32_t wireFragments(size_t payload_bytes) const { (void)payload_bytes; return 1; }
+
+    /**
+     * @brief 获取统计信息（不支持的传输层返回全 0）
+     */
+    virtual TransportStats getStats() const { return TransportStats(); }
+};
+
+/**
+ * @brief UDP 传输参数
+ */
+struct UdpTransportOptions {
+    int port = 18888;                        // 改为不常用端口，避免冲突
+    int rcvbuf_bytes = 0;                    // 初始 SO_RCVBUF，0 表示保持系统默认值
+    int sndbuf_bytes = 0;                    // 初始 SO_SNDBUF，0 表示保持系统默认值
+    bool adaptive_rcvbuf = true;             // 检测到内核丢包时自动翻倍接收缓冲区
+    int max_rcvbuf_bytes = 8 * 1024 * 1024;  // 自适应扩大的上限
+};
+
+/**
+ * @brief UDP 广播传输（默认）
+ * @details 协议格式 topic|data，广播到 255.255.255.255:port，同一端口的所有进程都能收到
+ */
+class UdpBroadcastTransport : public Transport {
+public:
+    explicit UdpBroadcastTransport(const UdpTransportOptions& options = UdpTransportOptions());
+    ~UdpBroadcastTransport() override;
+
+    bool start(TransportReceiveHandler handler) override;
+    void stop() override;
+    bool send(std::string_view topic, const std::string& data) override;
+    const char* name() const override { return "udp"; }
+    TransportStats getStats() const override;
+    // 超过 MTU 的数据报会在 IP 层分片：每片最多 1500 - 20(IP头) = 1480 字节，首片还要带 8 字节 UDP 头
+    uint32_t wireFragments(size_t payload_bytes) const override {
+        return static_cast<uint32_t>((payload_bytes + 8 + 1479) / 1480);
+    }
+
+    int port() const { return options_.port; }
+
+private:
+    bool initSocket();
+    void receiveLoop();
+
+    // 设置缓冲区大小，优先 *BUFFORCE（需要 CAP_NET_ADMIN，可突破 rmem_max/wmem_max），返回内核实际值
+    int setBufferSize(int force_opt, int opt, int bytes);
+    // 处理 SO_RXQ_OVFL 上报的累计丢包数
+    void onKernelDropCounter(uint32_t counter);
+
+    UdpTransportOptions options_;
+    int socket_fd_ = -1;
+    struct sockaddr_in broadcast_addr_;
+    TransportReceiveHandler handler_;
+    std::thread receiver_thread_;
+    std::atomic<bool> running_{false};
+
+    // 统计（发送在各发布线程，接收在接收线程，均用原子量）
+    std::atomic<uint64_t> packets_sent_{0};
+    std::atomic<uint64_t> bytes_sent_{0};
+    std::atomic<uint64_t> send_errors_{0};
+    std::atomic<uint64_t> packets_received_{0};
+    std::atomic<uint64_t> bytes_received_{0};
+    std::atomic<uint64_t> kernel_drops_{0};
+    std::atomic<uint64_t> rcvbuf_resizes_{0};
+    std::atomic<int> rcvbuf_bytes_{0};
+    std::atomic<int> sndbuf_bytes_{0};
+    uint32_t last_drop_counter_ = 0;           // 仅接收线程访问
+    int64_t last_resize_ms_ = 0;               // 仅接收线程访问
+    int last_warned_rcvbuf_ = 0;               // 最近一次告警的截断值（setBufferSize 只在启动和接收线程上调用）
+    int last_warned_sndbuf_ = 0;
+};
+
+/**
+ * @brief 进程内回环传输
+ * @details 同一 domain 下的所有中间件实例组成一条"虚拟总线"，消息经各实例的投递队列和
+ *          投递线程送达，完全不经过内核网络栈。不同 domain 之间互相隔离，
+ *          因此一个进程里可以同时存在多条互不干扰的总线（用于基准测试和单元测试）。
+ */
+class LoopbackTransport : public Transport {
+public:
+    explicit LoopbackTransport(const std::string& domain = "default");
+    ~LoopbackTransport() override;
+
+    bool start(TransportReceiveHandler handler) override;
+    void stop() override;
+    bool send(std::string_view topic, const std::string& data) override;
+    const char* name() const override { return "loopback"; }
+
+    const std::string& domain() const { return domain_; }
+
+private:
+    std::string domain_;
+    std::shared_ptr<detail::LoopbackHub> hub_;
+    std::shared_ptr<detail::LoopbackEndpoint> endpoint_;
+};
+
+/**
+ * @brief 按配置创建传输层
+ * @details 读取 config/middleware.json：
+ *          { "transport": "udp" | "loopback", "udp_port": 18888, "loopback_domain": "default",
+ *            "udp_rcvbuf_bytes": 0, "udp_sndbuf_bytes": 0,
+ *            "udp_rcvbuf_adaptive": true, "udp_rcvbuf_max_bytes": 8388608 }
+ *          配置文件不存在时使用 UDP 广播和默认参数
+ */
+std::unique_ptr<Transport> CreateTransportFromConfig();
+
+}  // namespace simple_middleware
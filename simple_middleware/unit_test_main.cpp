@@ -0,0 +1,91 @@
+/*
+ * @Desc: 中间件单元测试 - 不依赖网络和配置文件的确定性检查，失败时返回非 0
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ *
+ * 使用方法：
+ *   ./middleware_unit_test
+ */
+
+#include "pub_sub_middleware.hpp"
+#include "transport.hpp"
+#include "json_reader.hpp"
+#include "logger.hpp"
+
+#include <memory>
+#include <string>
+
+using namespace simple_middleware;
+
+namespace {
+
+int g_failures = 0;
+
+void Check(bool condition, const char* what) {
+    if (!condition) {
+        ++g_failures;
+        LOG_ERROR("UnitTest") << "FAILED: " << what;
+    }
+}
+
+// 模拟内核拒绝发送（如 ENOBUFS）的传输层：每次 send 都失败
+class FailingTransport : public Transport {
+public:
+    bool start(TransportReceiveHandler) override { return true; }
+    void stop() override {}
+    bool send(std::string_view, const std::string&) override { return false; }
+    const char* name() const override { return "failing"; }
+};
+
+uint64_t SendDrops(const PubSubMiddleware& middleware, const std::string& topic) {
+    for (const auto& stats : middleware.getTopicStats()) {
+        if (stats.topic == topic) return stats.send_drops;
+    }
+    return 0;
+}
+
+void TestSendDrops() {
+    PubSubMiddleware middleware(std::make_unique<FailingTransport>());
+    Check(!middleware.publish("test/send_drops", "a"), "publish fails when the transport cannot send");
+    Check(!middleware.publish("test/send_drops", "b"), "publish fails when the transport cannot send");
+    Check(SendDrops(middleware, "test/send_drops") == 2, "every failed send is counted in send_drops");
+
+    // 没有可用 socket 的 UDP 传输层同样报告发送失败
+    UdpBroadcastTransport udp;
+    Check(!udp.send("test/send_drops", "c"), "UDP send without a socket fails");
+}
+
+void TestJsonReadInt() {
+    int64_t value = 0;
+    JsonReader in_range("-42");
+    Check(in_range.readInt(&value) && value == -42, "readInt parses an int64");
+
+    JsonReader exponent("1.5e3");
+    Check(exponent.readInt(&value) && value == 1500, "readInt truncates a number with an exponent");
+
+    // 超出 int64 的数不能直接转换（未定义行为），必须报错
+    value = 7;
+    JsonReader huge("1e300");
+    Check(!huge.readInt(&value), "readInt rejects 1e300");
+    Check(value == 7, "readInt leaves the output untouched on error");
+    Check(!huge.error().empty(), "readInt reports an error for 1e300");
+
+    JsonReader too_long("-99999999999999999999");
+    Check(!too_long.readInt(&value), "readInt rejects an integer below int64 range");
+}
+
+}  // namespace
+
+int main() {
+    TestSendDrops();
+    TestJsonReadInt();
+
+    if (g_failures > 0) {
+        LOG_ERROR("UnitTest") << g_failures << " check(s) failed";
+        Logger::GetInstance().Flush();
+        return 1;
+    }
+    LOG_INFO("UnitTest") << "All checks passed";
+    Logger::GetInstance().Flush();
+    return 0;
+}
@@ -1,18 +1,122 @@
 #include "perception_component.hpp"
-#include <iostream>
 #include <chrono>
 #include <cmath>
 #include <algorithm>
 #include <random>
-#include <json11.hpp>
-#include <google/protobuf/util/json_util.h>
+#include <limits>
 #include <common_msgs/sensor_data.pb.h> 
+#include <common_msgs/obstacle_model.hpp>
 #include <simple_middleware/logger.hpp> // Add logger
+#include <simple_middleware/config_manager.hpp>
+
+namespace {
+
+// 框内像素与同一行框外背景的差异超过该值（三个通道差的绝对值之和）时认为是障碍物
+constexpr int kObjectColorDistance = 48;
+// 每个框在每个方向上最多采样的像素数
+constexpr int kVisibilitySamples = 16;
+
+int ColorDistance(const uint8_t* a, const uint8_t* b) {
+    return std::abs(a[0] - b[0]) + std::abs(a[1] - b[1]) + std::abs(a[2] - b[2]);
+}
+
+/**
+ * @brief 检测框在 RGB 图像中的可见比例
+ * @details 渲染的背景（天空、地面）按行变化，同一行紧挨框外的像素近似代表框内的背景；
+ *          统计框内采样点中与两侧背景都明显不同的比例。障碍物被遮挡或不在画面里时比例接近 0
+ * @return [0, 1]，框完全在图像外时返回 0
+ */
+double BoxVisibility(const std::string& rgb, int width, int height, int left, int top, int right, int bottom) {
+    const int x0 = std::max(left, 0);
+    const int x1 = std::min(right, width - 1);
+    const int y0 = std::max(top, 0);
+    const int y1 = std::min(bottom, height - 1);
+    if (x0 > x1 || y0 > y1) {
+        return 0.0;
+    }
+    const uint8_t* pixels = reinterpret_cast<const uint8_t*>(rgb.data());
+    auto at = [&](int x, int y) { return pixels + (static_cast<size_t>(y) * width + x) * 3; };
+
+    const int step_x = std::max(1, (x1 - x0 + 1) / kVisibilitySamples);
+    const int step_y = std::max(1, (y1 - y0 + 1) / kVisibilitySamples);
+    int samples = 0;
+    int hits = 0;
+    for (int y = y0; y <= y1; y += step_y) {
+        // 框外参考像素：左右各一个，超出图像的一侧不用；两侧都超出时这一行无从比较
+        const uint8_t* bg_left = left - 2 >= 0 ? at(left - 2, y) : nullptr;
+        const uint8_t* bg_right = right + 2 < width ? at(right + 2, y) : nullptr;
+        if (bg_left == nullptr && bg_right == nullptr) continue;
+        for (int x = x0; x <= x1; x += step_x) {
+            const uint8_t* p = at(x, y);
+            ++samples;
+            if ((bg_left == nullptr || ColorDistance(p, bg_left) > kObjectColorDistance)
+                && (bg_right == nullptr || ColorDistance(p, bg_right) > kObjectColorDistance)) {
+                ++hits;
+            }
+        }
+    }
+    return samples > 0 ? static_cast<double>(hits) / samples : 0.0;
+}
+
+/**
+ * @brief 按针孔模型把障碍物的 3D 框（8 个角点，尺寸与 Sensor 渲染相同）投影成图像上的 2D 框
+ * @param to_camera 世界坐标 (x, y) -> 相机坐标 (前, 左)
+ * @return 有角点离相机不足 kNearPlane（贴脸或在身后）时返回 false：这些角点按近平面投影，框只是近似范围
+ */
+template <typename ToCamera>
+bool ProjectBox(const senseauto::demo::Obstacle& obs, const ToCamera& to_camera, double focal, double img_cx,
+                double img_cy, double cam_z, int* left, int* top, int* right, int* bottom) {
+    constexpr double kNearPlane = 0.5;
+    const double length = obstacle_model::Length(obs);
+    const double width = obstacle_model::Width(obs);
+    const double z0 = obs.position().z();
+    const double z1 = z0 + obstacle_model::Height(obs);
+    const double c = std::cos(obs.heading());
+    const double s = std::sin(obs.heading());
+    bool in_front = true;
+    double min_u = std::numeric_limits<double>::max();
+    double max_u = std::numeric_limits<double>::lowest();
+    double min_v = std::numeric_limits<double>::max();
+    double max_v = std::numeric_limits<double>::lowest();
+    for (int i = 0; i < 4; ++i) {
+        const double lx = (i < 2 ? 0.5 : -0.5) * length;
+        const double ly = (i == 0 || i == 3 ? 0.5 : -0.5) * width;
+        double cam_x = 0.0;
+        double cam_y = 0.0;
+        to_camera(obs.position().x() + lx * c - ly * s, obs.position().y() + lx * s + ly * c, &cam_x, &cam_y);
+        if (cam_x < kNearPlane) {
+            in_front = false;
+            cam_x = kNearPlane;
+        }
+        // 图像 x 向右（相机坐标左正），图像 y 向下
+        const double u = img_cx - focal * cam_y / cam_x;
+        min_u = std::min(min_u, u);
+        max_u = std::max(max_u, u);
+        min_v = std::min(min_v, img_cy - focal * (z1 - cam_z) / cam_x);
+        max_v = std::max(max_v, img_cy - focal * (z0 - cam_z) / cam_x);
+    }
+    *left = static_cast<int>(std::floor(min_u));
+    *right = static_cast<int>(std::ceil(max_u));
+    *top = static_cast<int>(std::floor(min_v));
+    *bottom = static_cast<int>(std::ceil(max_v));
+    return in_front;
+}
+
+}  // namespace
 
-using namespace json11;
 
 PerceptionComponent::PerceptionComponent() : running_(false) {
     status_reporter_ = std::make_unique<simple_middleware::StatusReporter>("PerceptionNode");
+
+    // 订阅哪些相机与 Sensor 读同一份配置（SIMPLE_SENSOR_CONFIG 可切换到多相机配置）
+    auto& config = simple_middleware::ConfigManager::GetInstance();
+    std::vector<std::string> names{"front"};
+    if (config.Load("sensor", "config/sensor.json")) {
+        names = simple_middleware::EnabledCameraNames(config.GetConfig("sensor"));
+    }
+    for (auto& name : names) {
+        cameras_.push_back(std::make_unique<CameraInput>(std::move(name)));
+    }
 }
 
 PerceptionComponent::~PerceptionComponent() {
@@ -26,16 +130,26 @@ void PerceptionComponent::Start() {
     auto& middleware = simple_middleware::PubSubMiddleware::getInstance();
     
     // 订阅车辆状态以获知自身位置（用于将相对坐标转为绝对坐标）
-    middleware.subscribe("visualizer/data", [this](const simple_middleware::Message& msg) {
-        this->OnCarStatus(msg);
+    middleware.subscribe(simple_middleware::topics::kEgoState, [this](const senseauto::demo::EgoState& ego) {
+        this->OnEgoState(ego);
     });
 
-    // 订阅 Sensor 发来的相机数据
-    middleware.subscribe("sensor/camera/front", [this](const simple_middleware::Message& msg) {
-        simple_middleware::Logger::Info("Perception: Received sensor/camera/front message! size=" + std::to_string(msg.data.size()));
-        this->OnCameraData(msg);
+    // 订阅障碍物真值（用于模拟检测算法）
+    middleware.subscribe(simple_middleware::topics::kGroundTruthObstacles, [this](const simple_middleware::Message& msg) {
+        this->OnGroundTruthObstacles(msg);
     });
-    simple_middleware::Logger::Info("Perception: Subscribed to sensor/camera/front");
+
+    // 订阅各路相机：小帧整帧直接发送，压缩后仍超过单包的帧走分片话题（主话题上只有元数据帧）
+    for (auto& camera : cameras_) {
+        CameraInput& input = *camera;
+        middleware.subscribe(input.topics.topic(), [this, &input](const senseauto::demo::CameraFrame& frame) {
+            this->OnCameraData(input, frame);
+        });
+        middleware.subscribe(input.topics.chunk_topic(), [this, &input](const simple_middleware::Message& msg) {
+            this->OnCameraChunk(input, msg);
+        });
+        LOG_INFO("Perception") << "Subscribed to " << input.topics.topic_name << " and " << input.topics.chunk_topic_name;
+    }
 
     thread_ = std::thread(&PerceptionComponent::RunLoop, this);
     status_reporter_->Start();
@@ -51,324 +165,288 @@ void PerceptionComponent::Stop() {
 }
 
 void PerceptionComponent::RunLoop() {
-    // Perception 现在的核心是 OnCameraData 回调，RunLoop 主要负责监控或定时任务
-    // 这里我们保持简单的休眠即可
+    // Perception 现在的核心是 OnCameraData 回调，RunLoop 主要负责监控或定时任务：
+    // 有相机的帧丢了（或 Sensor 只发布了一部分相机）时，同步组超时后按已收到的相机发布
     while (running_) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        if (group_open_ && std::chrono::steady_clock::now() - group_started_ > kSyncGroupTimeout) {
+            FinishSyncGroup();
+        }
     }
 }
 
-void PerceptionComponent::OnCarStatus(const simple_middleware::Message& msg) {
-    senseauto::demo::FrameData frame;
-    if (frame.ParseFromString(msg.data)) {
-         std::lock_guard<std::mutex> lock(state_mutex_);
-         // 保存完整的真值数据，用于模拟检测算法
-         current_ground_truth_ = frame;
-         has_ground_truth_ = true;
-         if (frame.has_car_state()) {
-             current_car_state_ = frame.car_state();
-         }
+void PerceptionComponent::OnEgoState(const senseauto::demo::EgoState& ego) {
+    if (!ego.has_car_state()) return;
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    current_car_state_ = ego.car_state();
+    has_car_state_ = true;
+}
+
+void PerceptionComponent::OnGroundTruthObstacles(const simple_middleware::Message& msg) {
+    // 直接解码成新的快照对象（不经过订阅 Arena 再拷贝一次），OnCameraData 正在使用的旧快照不受影响
+    auto obstacles = std::make_shared<senseauto::demo::ObstacleArray>();
+    if (obstacles->ParseFromString(msg.data)) {
+        ground_truth_obstacles_.publish(std::move(obstacles));
+    } else {
+        LOG_EVERY_N(WARN, "Perception", 10) << "Failed to parse simulator/obstacles, size=" << msg.data.size();
     }
 }
 
-void PerceptionComponent::OnCameraData(const simple_middleware::Message& msg) {
+void PerceptionComponent::OnCameraChunk(CameraInput& input, const simple_middleware::Message& msg) {
+    // 分片只在接收线程上重组和解码，chunk_data / chunk_frame 跨帧复用
+    if (!input.chunks.add(msg.data, &input.chunk_data)) return;
+    if (!input.chunk_frame.ParseFromString(input.chunk_data)) {
+        LOG_EVERY_N(WARN, "Perception", 10) << "Failed to parse reassembled " << input.topics.name
+            << " camera frame, size=" << input.chunk_data.size() << ", dropped=" << input.chunks.droppedFrames()
+            << ", malformed=" << input.chunks.malformedPackets();
+        return;
+    }
+    OnCameraData(input, input.chunk_frame);
+}
+
+void PerceptionComponent::OnCameraData(CameraInput& input, const senseauto::demo::CameraFrame& frame) {
+    // 走分片的帧在主话题上先到一个不带图像的元数据帧，检测等分片重组出完整帧后再做
+    if (frame.raw_image().empty()) return;
+
     try {
-    senseauto::demo::CameraFrame frame;
-        if (!frame.ParseFromString(msg.data)) {
-            static int parse_fail_count = 0;
-            if (parse_fail_count++ % 10 == 0) {
-                simple_middleware::Logger::Warn("Perception: Failed to parse camera frame, size=" 
-                    + std::to_string(msg.data.size()));
-            }
+        // 取一份障碍物真值快照（只增加引用计数），处理期间不受写者影响
+        auto ground_truth = ground_truth_obstacles_.load();
+
+        LOG_EVERY_N(DEBUG, "Perception", 10) << "Received " << input.topics.name << " camera frame: image_size="
+            << frame.raw_image().size() << " bytes, width=" << frame.image_width() << ", height="
+            << frame.image_height() << ", sync " << frame.sync_sequence() << ", has_ground_truth="
+            << (ground_truth != nullptr ? "true" : "false");
+
+        std::lock_guard<std::mutex> lock(state_mutex_);
+
+        // 帧同步：新的 sync_sequence 开启新的一组（上一组没收齐就按已收到的发布）；
+        // 属于已发布的组、或比当前组 / 已发布的组更早的渲染周期的帧是迟到帧，直接丢弃，不再重新发布。
+        // Sensor 重启后序号从头开始，但渲染时间仍然更新，所以更小的序号只按时间判断。旧版 Sensor 不带同步信息，每帧单独成组
+        const bool has_sync = frame.sync_group_size() > 0;
+        if (has_sync && IsStaleFrame(frame)) {
+            ++stale_frames_;
+            LOG_EVERY_N(DEBUG, "Perception", 10) << "Dropped stale " << input.topics.name << " frame, sync "
+                << frame.sync_sequence() << ", stale_frames=" << stale_frames_;
             return;
         }
-        
-        static int recv_count = 0;
-        recv_count++;
-        // 总是打印，因为这是关键数据流（频率是1Hz，不会太多）
-        simple_middleware::Logger::Info("Perception: Received camera frame #" + std::to_string(recv_count)
-            + ", image_size=" + std::to_string(frame.raw_image().size()) + " bytes, width=" 
-            + std::to_string(frame.image_width()) + ", height=" 
-            + std::to_string(frame.image_height())
-            + ", has_ground_truth=" + (has_ground_truth_ ? "true" : "false"));
-
-        // 【架构调整】Perception 应该从图像中检测出 objects，而不是从 Sensor 的 objects 字段读取
-        // 在仿真环境中，我们基于真值数据模拟检测算法（添加噪声、漏检等）
-    
-    std::lock_guard<std::mutex> lock(state_mutex_);
-    
-        if (!has_ground_truth_) {
-            // 没有真值数据，无法模拟检测
-            static int no_gt_count = 0;
-            no_gt_count++;
-            if (no_gt_count % 3 == 0 || no_gt_count <= 5) {
-                simple_middleware::Logger::Warn("Perception: No ground truth data, will generate test boxes (count=" 
-                    + std::to_string(no_gt_count) + ")");
+        if (!has_sync || !group_open_ || frame.sync_sequence() != group_sequence_) {
+            if (group_open_) {
+                FinishSyncGroup();
             }
-            // 即使没有真值，也生成测试检测框
-            // 这样至少能看到检测框效果
+            BeginSyncGroup(frame);
         }
-        
-        // 1. 获取自车位姿（如果没有真值，使用默认值）
-        double car_x = 0.0;
-        double car_y = 0.0;
-        double car_heading = 0.0;
-        if (has_ground_truth_ && current_ground_truth_.has_car_state()) {
-            car_x = current_car_state_.position().x();
-            car_y = current_car_state_.position().y();
-            car_heading = current_car_state_.heading();
+
+        // 检测算法的输入是 RGB 图像：压缩格式先解码（缓冲区跨帧复用），"ppm" 本身就是 RGB 数据
+        const std::string* rgb = nullptr;
+        const size_t rgb_size = static_cast<size_t>(frame.image_width()) * frame.image_height() * 3;
+        if (frame.image_format() == simple_middleware::kImageFormatDeltaRle) {
+            if (simple_middleware::ImageDecode(frame.raw_image(), frame.image_width(), frame.image_height(),
+                                               &input.rgb)) {
+                rgb = &input.rgb;
+            }
+        } else if (frame.raw_image().size() == rgb_size) {
+            rgb = &frame.raw_image();
         }
+        if (rgb == nullptr || rgb_size == 0) {
+            LOG_EVERY_N(WARN, "Perception", 10) << "Cannot get RGB pixels from " << input.topics.name << " "
+                << frame.image_format() << " image, size=" << frame.raw_image().size() << ", "
+                << frame.image_width() << "x" << frame.image_height();
+            return;
+        }
+        LOG_IF(WARN, "Perception", ground_truth == nullptr) << "No ground truth data, nothing to detect";
 
-        // 2. 模拟检测算法：基于真值数据，添加传感器噪声和检测误差
-        // 在真实场景中，这里应该是深度学习模型或传统计算机视觉算法
-    Json::array obs_array;
-    senseauto::demo::Detection2DArray det_array;
-    det_array.set_timestamp(std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()).count());
-
-        // 相机参数（应该与 Sensor 一致）
-        const float fov = 60.0f; // 视场角
-        const float max_distance = 80.0f; // 最大探测距离
-        const float pos_x = 2.0f; // 相机安装位置
-
-        // 遍历真值中的障碍物，模拟检测过程（只有在有真值数据时才处理）
-        if (has_ground_truth_) {
-            for (const auto& obs : current_ground_truth_.obstacles()) {
-                // 计算相对坐标 (World -> Ego)
-                double dx = obs.position().x() - car_x;
-                double dy = obs.position().y() - car_y;
-                
-                // 旋转矩阵 (逆时针旋转 -heading)
-                double rel_x = dx * std::cos(-car_heading) - dy * std::sin(-car_heading);
-                double rel_y = dx * std::sin(-car_heading) + dy * std::cos(-car_heading);
-
-                // 转换到相机坐标系 (Ego -> Camera)
-                double cam_x = rel_x - pos_x;
-                double cam_y = rel_y;
-
-                // 视场角过滤 (FOV)
-                double angle = std::atan2(cam_y, cam_x) * 180.0 / M_PI;
-                double dist = std::sqrt(cam_x * cam_x + cam_y * cam_y);
-
-                // 只检测前方且在 FOV 内的物体
-                if (cam_x > 0 && std::abs(angle) < (fov / 2.0) && dist < max_distance) {
-                    // 模拟检测噪声（真实检测算法会有误差）
-                    static std::default_random_engine gen;
-                    static std::normal_distribution<double> noise_dist(0.0, 0.2); // 20cm 标准差
-                    double noise_x = noise_dist(gen);
-                    double noise_y = noise_dist(gen);
-                    
-                    double detected_x = cam_x + noise_x;
-                    double detected_y = cam_y + noise_y;
-                    
-                    // A. 转换世界坐标 (用于 Planning)
-                    double world_x = car_x + detected_x * std::cos(car_heading) - detected_y * std::sin(car_heading);
-                    double world_y = car_y + detected_x * std::sin(car_heading) + detected_y * std::cos(car_heading);
-
-        obs_array.push_back(Json::object{
-                        {"id", obs.id()},
-            {"position", Json::object{
-                {"x", world_x},
-                {"y", world_y},
-                {"z", 0.0}
-            }},
-                        {"type", obs.type()}
-        });
+        // 每路相机一条 Detection2DArray，构造在复用的 Arena 上（state_mutex_ 保护 output_arena_）
+        output_arena_.reset();
+        auto& det_array = *output_arena_.create<senseauto::demo::Detection2DArray>();
+        det_array.set_timestamp(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        det_array.set_camera_name(input.topics.name);
+        // 链路追踪：检测结果沿用输入相机帧的上下文（处理完成后再打点）
+        if (frame.has_trace()) {
+            det_array.mutable_trace()->CopyFrom(frame.trace());
+        }
 
-        // B. 生成 2D Bounding Box (用于 Visualizer 显示)
-                    // 简单的投影模型：将 3D 位置投影到 2D 图像坐标
-                    if (detected_x > 0.5) { // 只显示距离大于 0.5m 的物体
-            auto* box = det_array.add_boxes();
-                        double scale = 100.0 / detected_x; // 透视缩放
-                        int w = static_cast<int>(obs.width() * scale * 20); // 基于障碍物真实宽度
-                        int h = static_cast<int>(obs.height() * scale * 20);
-                        
-                        // 投影横向位置: detected_y 左正右负
-                        // 图像中心 x=80. detected_y=0 -> x=80. detected_y>0 -> x<80 (left)
-            // 假设 FOV 60度 -> tan(30) = 0.577
-                        int cx = 80 - static_cast<int>((detected_y / (detected_x * 0.577)) * 80);
-                        int cy = 60 + static_cast<int>(5.0 / detected_x); // 稍微向下偏
-            
-            box->set_x(cx - w/2);
-            box->set_y(cy - h/2);
-            box->set_width(w);
-            box->set_height(h);
-                        box->set_label(obs.type());
-                        box->set_score(0.9); // 模拟检测置信度
-                    }
-                }
-            } // 结束 for 循环
-        } // 结束 has_ground_truth_ 检查
-        
-        // 【测试用】如果没有检测到障碍物，或者没有真值数据，生成一些模拟检测框用于测试
-        // 这样即使没有真实障碍物，也能看到检测框效果
-        // 并且每帧都变化位置，让检测框动起来
-        // 【重要】总是生成测试框，确保有检测数据
-        // 【关键修改】无论是否有 ground truth 检测，都生成测试框，确保总是有检测数据
-        if (frame.image_width() > 0 && frame.image_height() > 0) {
-            // 总是生成测试框，不管 det_array 是否已有检测框
-            static int test_box_counter = 0;
-            test_box_counter++;
-            
-            // 生成 3 个测试检测框：左、中、右，每帧位置都变化
-            int img_w = frame.image_width();
-            int img_h = frame.image_height();
-            
-            // 使用正弦波让检测框位置动态变化
-            double time = test_box_counter * 0.1; // 时间因子
-            double offset_x1 = std::sin(time) * 20; // 左侧框左右移动
-            double offset_y1 = std::cos(time * 0.7) * 15; // 左侧框上下移动
-            double offset_x2 = std::sin(time * 1.3) * 15; // 中间框左右移动
-            double offset_y2 = std::cos(time * 0.9) * 10; // 中间框上下移动
-            double offset_x3 = std::sin(time * 0.8) * 25; // 右侧框左右移动
-            double offset_y3 = std::cos(time * 1.1) * 12; // 右侧框上下移动
-            
-            // 左侧检测框（动态位置）
-            auto* box1 = det_array.add_boxes();
-            box1->set_x(static_cast<int>(img_w / 4 - 20 + offset_x1));
-            box1->set_y(static_cast<int>(img_h / 2 - 15 + offset_y1));
-            box1->set_width(40);
-            box1->set_height(30);
-            box1->set_label("test_car");
-            box1->set_score(0.85);
-            
-            // 中间检测框（动态位置）
-            auto* box2 = det_array.add_boxes();
-            box2->set_x(static_cast<int>(img_w / 2 - 25 + offset_x2));
-            box2->set_y(static_cast<int>(img_h / 2 - 20 + offset_y2));
-            box2->set_width(50);
-            box2->set_height(40);
-            box2->set_label("test_car");
-            box2->set_score(0.90);
-            
-            // 右侧检测框（动态位置）
-            auto* box3 = det_array.add_boxes();
-            box3->set_x(static_cast<int>(img_w * 3 / 4 - 20 + offset_x3));
-            box3->set_y(static_cast<int>(img_h / 2 - 15 + offset_y3));
-            box3->set_width(40);
-            box3->set_height(30);
-            box3->set_label("test_car");
-            box3->set_score(0.85);
-            
-            simple_middleware::Logger::Info("Perception: Generated 3 test boxes (frame " 
-                + std::to_string(test_box_counter) + "), total boxes now=" 
-                + std::to_string(det_array.boxes_size()));
-            simple_middleware::Logger::Info("Perception: DEBUG: After logging test boxes, continuing...");
-        } else {
-            simple_middleware::Logger::Warn("Perception: Invalid image dimensions: width=" 
-                + std::to_string(frame.image_width()) + ", height=" + std::to_string(frame.image_height()));
+        if (ground_truth != nullptr) {
+            DetectObstacles(frame, *rgb, *ground_truth, &group_obstacles_, &det_array);
+        }
+        if (det_array.has_trace()) {
+            simple_middleware::TraceStampStage(det_array.mutable_trace(), "perception");
         }
-        
-        simple_middleware::Logger::Info("Perception: After test box generation, det_array.boxes_size()=" 
-            + std::to_string(det_array.boxes_size()));
-        simple_middleware::Logger::Info("Perception: DEBUG: About to check fallback boxes...");
-        
-        // 【关键】确保总是有检测框，如果没有则生成后备检测框
-        if (det_array.boxes_size() == 0 && frame.image_width() > 0 && frame.image_height() > 0) {
-            simple_middleware::Logger::Error("Perception: No detection boxes after processing! This should not happen. Generating fallback boxes.");
-            // 生成简单的固定位置检测框作为后备
-            auto* box1 = det_array.add_boxes();
-            box1->set_x(40); box1->set_y(45); box1->set_width(40); box1->set_height(30);
-            box1->set_label("fallback"); box1->set_score(0.8);
-            
-            auto* box2 = det_array.add_boxes();
-            box2->set_x(80); box2->set_y(40); box2->set_width(50); box2->set_height(40);
-            box2->set_label("fallback"); box2->set_score(0.9);
-            
-            auto* box3 = det_array.add_boxes();
-            box3->set_x(120); box3->set_y(45); box3->set_width(40); box3->set_height(30);
-            box3->set_label("fallback"); box3->set_score(0.8);
+
+        bool published = simple_middleware::PubSubMiddleware::getInstance().publish(
+            simple_middleware::topics::kDetection2D, det_array);
+        LOG_EVERY_N(DEBUG, "Perception", 10) << "Published " << det_array.boxes_size() << " boxes from "
+            << input.topics.name << " (" << (published ? "ok" : "failed") << ")";
+
+        if (++group_received_ >= group_expected_) {
+            FinishSyncGroup();
         }
+    } catch (const std::exception& e) {
+        LOG_EVERY_N(ERROR, "Perception", 10) << "Exception in OnCameraData: " << e.what();
+    } catch (...) {
+        LOG_EVERY_N(ERROR, "Perception", 10) << "Unknown exception in OnCameraData";
+    }
+}
+
+void PerceptionComponent::BeginSyncGroup(const senseauto::demo::CameraFrame& frame) {
+    group_open_ = true;
+    group_sequence_ = frame.sync_sequence();
+    group_sync_timestamp_ = frame.sync_timestamp();
+    group_started_ = std::chrono::steady_clock::now();
+    // 只订阅了 Sensor 一部分相机时，收齐订阅的这几路即可
+    group_expected_ = frame.sync_group_size() > 0
+        ? std::min(frame.sync_group_size(), static_cast<int>(cameras_.size())) : 1;
+    group_received_ = 0;
+    group_obstacles_.Clear();
+    group_obstacle_ids_.clear();
+    // 链路追踪：合并结果沿用组内第一帧的上下文
+    if (frame.has_trace()) {
+        group_obstacles_.mutable_trace()->CopyFrom(frame.trace());
+    }
+}
+
+bool PerceptionComponent::IsStaleFrame(const senseauto::demo::CameraFrame& frame) const {
+    if (group_open_ && frame.sync_sequence() != group_sequence_ && frame.sync_timestamp() < group_sync_timestamp_) {
+        return true;
+    }
+    return has_finished_group_ && (frame.sync_sequence() == finished_sequence_
+                                   || frame.sync_timestamp() <= finished_sync_timestamp_);
+}
+
+void PerceptionComponent::FinishSyncGroup() {
+    group_open_ = false;
+    // 旧版 Sensor 的帧不带同步信息（sync_timestamp 为 0），不作为迟到判断的基准
+    if (group_sync_timestamp_ > 0) {
+        has_finished_group_ = true;
+        finished_sequence_ = group_sequence_;
+        finished_sync_timestamp_ = group_sync_timestamp_;
+    }
+    if (group_received_ >= group_expected_) {
+        ++complete_groups_;
+    } else {
+        ++partial_groups_;
+    }
+
+    const int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    group_obstacles_.set_timestamp(now_ms);
+    if (group_obstacles_.has_trace()) {
+        simple_middleware::TraceStampStage(group_obstacles_.mutable_trace(), "perception");
+    }
+    bool published = simple_middleware::PubSubMiddleware::getInstance().publish(
+        simple_middleware::topics::kPerceptionObstacles, group_obstacles_);
+
+    // 多相机扩展性的观测点：每组收到几路、从渲染开始到合并发布的延迟、收不齐 / 迟到的累计次数
+    LOG_EVERY_N(INFO, "Perception", 10) << "Sync group " << group_sequence_ << ": " << group_received_ << "/"
+        << group_expected_ << " cameras, " << group_obstacles_.obstacles_size() << " obstacles ("
+        << (published ? "ok" : "failed") << "), latency "
+        << (group_sync_timestamp_ > 0 ? now_ms - group_sync_timestamp_ : 0) << " ms; complete="
+        << complete_groups_ << ", partial=" << partial_groups_ << ", stale_frames=" << stale_frames_;
+}
+
+void PerceptionComponent::DetectObstacles(const senseauto::demo::CameraFrame& frame, const std::string& rgb,
+                                          const senseauto::demo::ObstacleArray& ground_truth,
+                                          senseauto::demo::ObstacleArray* obstacles,
+                                          senseauto::demo::Detection2DArray* detections) {
+    // 【架构调整】Perception 应该从图像中检测出 objects，而不是从 Sensor 的 objects 字段读取
+    // 仿真环境中用真值给出候选位置，再到图像里核对：投影框内看不到障碍物（被遮挡、超出渲染距离）的算漏检
+
+    // 1. 自车位姿（还没收到时用原点）
+    double car_x = 0.0;
+    double car_y = 0.0;
+    double car_heading = 0.0;
+    if (has_car_state_) {
+        car_x = current_car_state_.position().x();
+        car_y = current_car_state_.position().y();
+        car_heading = current_car_state_.heading();
+    }
+
+    // 2. 相机参数：取自相机帧（多相机时各路不同），旧版 Sensor 没有携带时用前视相机的缺省值
+    const bool has_camera_info = frame.fov() > 0.0f;
+    const float fov = has_camera_info ? frame.fov() : 60.0f; // 视场角
+    const float max_distance = 80.0f; // 最大探测距离
+    const float pos_x = has_camera_info ? frame.pos_x() : 2.0f; // 相机安装位置
+    const float pos_y = has_camera_info ? frame.pos_y() : 0.0f;
+    const float pos_z = has_camera_info ? frame.pos_z() : 1.5f; // 相机安装高度
+    const double cam_yaw = has_camera_info ? frame.yaw() * M_PI / 180.0 : 0.0; // 安装朝向
 
-        simple_middleware::Logger::Info("Perception: Step 1: About to publish obstacles and detection_2d, det_array.boxes_size()=" 
-            + std::to_string(det_array.boxes_size()));
+    // 与 Sensor 渲染相同的针孔模型：光心在图像中心，焦距由水平 FOV 和图像宽度决定
+    const int img_w = frame.image_width();
+    const int img_h = frame.image_height();
+    const double img_cx = img_w / 2.0;
+    const double img_cy = img_h / 2.0;
+    const double focal = img_cx / std::tan(fov * M_PI / 360.0);
 
-        // 在锁内准备数据，然后在锁外发布
-        simple_middleware::Logger::Info("Perception: Step 2: Creating JSON payload");
-    Json json_payload = Json::object{
-        {"type", "perception_obstacles"},
-        {"obstacles", obs_array}
+    // World -> Ego（旋转 -heading）-> Camera（平移安装位置，再旋转 -yaw）
+    auto to_camera = [&](double wx, double wy, double* cam_x, double* cam_y) {
+        double dx = wx - car_x;
+        double dy = wy - car_y;
+        double rel_x = dx * std::cos(-car_heading) - dy * std::sin(-car_heading);
+        double rel_y = dx * std::sin(-car_heading) + dy * std::cos(-car_heading);
+        *cam_x = (rel_x - pos_x) * std::cos(cam_yaw) + (rel_y - pos_y) * std::sin(cam_yaw);
+        *cam_y = -(rel_x - pos_x) * std::sin(cam_yaw) + (rel_y - pos_y) * std::cos(cam_yaw);
     };
-        simple_middleware::Logger::Info("Perception: Step 3: JSON payload created");
 
-        simple_middleware::Logger::Info("Perception: Step 4: Serializing detection_2d array");
-    std::string det_data;
-        if (!det_array.SerializeToString(&det_data)) {
-            simple_middleware::Logger::Error("Perception: Failed to serialize detection_2d array!");
-            return;
-        }
-        simple_middleware::Logger::Info("Perception: Step 5: Serialized detection_2d array, size=" + std::to_string(det_data.size()) + " bytes");
-        
-        // 【关键】总是打印，因为这是关键数据流
-        simple_middleware::Logger::Info("Perception: About to publish detection_2d with " 
-            + std::to_string(det_array.boxes_size()) + " boxes, data_size=" + std::to_string(det_data.size()) + " bytes");
-        
-        // 打印每个检测框的详细信息
-        for (int i = 0; i < det_array.boxes_size(); ++i) {
-            const auto& box = det_array.boxes(i);
-            simple_middleware::Logger::Info("  Box " + std::to_string(i) + ": x=" 
-                + std::to_string(box.x()) + ", y=" + std::to_string(box.y())
-                + ", w=" + std::to_string(box.width()) + ", h=" + std::to_string(box.height())
-                + ", label=" + box.label());
-        }
-        
-        // 在锁外发布，避免死锁
-        simple_middleware::Logger::Info("Perception: Step 6: Getting middleware instance");
-        auto& middleware = simple_middleware::PubSubMiddleware::getInstance();
-        simple_middleware::Logger::Info("Perception: Step 7: Publishing perception/obstacles");
-        std::string json_str;
-        try {
-            json_str = json_payload.dump();
-            simple_middleware::Logger::Info("Perception: Step 7.1: JSON dump successful, size=" + std::to_string(json_str.size()));
-        } catch (const std::exception& e) {
-            simple_middleware::Logger::Error("Perception: Step 7.1: JSON dump failed: " + std::string(e.what()));
-            return;
+    for (const auto& obs : ground_truth.obstacles()) {
+        double cam_x = 0.0;
+        double cam_y = 0.0;
+        to_camera(obs.position().x(), obs.position().y(), &cam_x, &cam_y);
+
+        // 视场角过滤 (FOV)：只检测前方且在 FOV 内的物体
+        double angle = std::atan2(cam_y, cam_x) * 180.0 / M_PI;
+        double dist = std::sqrt(cam_x * cam_x + cam_y * cam_y);
+        if (cam_x <= 0 || std::abs(angle) >= (fov / 2.0) || dist >= max_distance) {
+            continue;
         }
-        try {
-            simple_middleware::Logger::Info("Perception: Step 7.2: About to call middleware.publish for perception/obstacles");
-            simple_middleware::Logger::Info("Perception: Step 7.2.1: Before publish call, json_str.size()=" + std::to_string(json_str.size()) 
-                + ", obstacles count=" + std::to_string(obs_array.size()));
-            // 打印JSON预览用于调试
-            if (json_str.size() > 0 && json_str.size() < 200) {
-                simple_middleware::Logger::Debug("Perception: JSON preview: " + json_str);
+
+        // 模拟检测噪声（真实检测算法会有误差）
+        static std::default_random_engine gen;
+        static std::normal_distribution<double> noise_dist(0.0, 0.2); // 20cm 标准差
+        double detected_x = cam_x + noise_dist(gen);
+        double detected_y = cam_y + noise_dist(gen);
+
+        // A. 2D Bounding Box：按无噪声的真值投影障碍物的 8 个角点，到图像里核对障碍物是否可见，可见比例作为检测置信度
+        int left = 0, right = 0, top = 0, bottom = 0;
+        double score = kUnverifiedScore;
+        if (ProjectBox(obs, to_camera, focal, img_cx, img_cy, pos_z, &left, &top, &right, &bottom)) {
+            score = BoxVisibility(rgb, img_w, img_h, left, top, right, bottom);
+            if (score < kMinVisibility) {
+                continue;
             }
-            bool pub_result = middleware.publish("perception/obstacles", json_str);
-            simple_middleware::Logger::Info("Perception: Step 7.2.2: After publish call, result=" + std::string(pub_result ? "success" : "failed"));
-            simple_middleware::Logger::Info("Perception: Step 8: Published perception/obstacles, result=" + std::string(pub_result ? "success" : "failed") 
-                + ", obstacles=" + std::to_string(obs_array.size()));
-        } catch (const std::exception& e) {
-            simple_middleware::Logger::Error("Perception: Step 8: Publish failed: " + std::string(e.what()));
-            return;
-        } catch (...) {
-            simple_middleware::Logger::Error("Perception: Step 8: Publish failed with unknown exception");
-            return;
+        } else {
+            // 障碍物贴着相机：框只是近似范围，框外往往也没有背景可比，无法在图像里核对。
+            // 离自车这么近不能漏报，照常报告，但框裁到图像内、置信度标为未核对
+            left = std::max(left, 0);
+            top = std::max(top, 0);
+            right = std::min(right, img_w);
+            bottom = std::min(bottom, img_h);
+        }
+
+        // B. 世界坐标 (用于 Planning)：Camera -> Ego -> World
+        // 相机视野有重叠时，同一组里先看到的那一路报告这个障碍物
+        if (group_obstacle_ids_.insert(obs.id()).second) {
+            double ego_x = pos_x + detected_x * std::cos(cam_yaw) - detected_y * std::sin(cam_yaw);
+            double ego_y = pos_y + detected_x * std::sin(cam_yaw) + detected_y * std::cos(cam_yaw);
+            double world_x = car_x + ego_x * std::cos(car_heading) - ego_y * std::sin(car_heading);
+            double world_y = car_y + ego_x * std::sin(car_heading) + ego_y * std::cos(car_heading);
+
+            auto* detected = obstacles->add_obstacles();
+            detected->set_id(obs.id());
+            detected->mutable_position()->set_x(world_x);
+            detected->mutable_position()->set_y(world_y);
+            detected->set_type(obs.type());
         }
-        
-        simple_middleware::Logger::Info("Perception: Step 9: Publishing perception/detection_2d");
-        bool published = middleware.publish("perception/detection_2d", det_data);
-        simple_middleware::Logger::Info("Perception: Step 10: Published perception/detection_2d, result=" + std::string(published ? "success" : "failed"));
-        
-        // 总是发布检测数据（即使没有检测到障碍物，也会生成测试框）
-        static int pub_count = 0;
-        pub_count++;
-        simple_middleware::Logger::Info("Perception: Published detection_2d #" + std::to_string(pub_count)
-            + " with " + std::to_string(det_array.boxes_size()) + " boxes, publish_result=" 
-            + (published ? "success" : "failed") + ", data_size=" + std::to_string(det_data.size()) + " bytes");
-        
-        if (det_array.boxes_size() == 0) {
-            simple_middleware::Logger::Error("Perception: Published detection_2d with 0 boxes! This should not happen.");
+
+        // 裁剪后落在图像外的近似框不输出（障碍物本身已经报告）
+        if (right > left && bottom > top) {
+            auto* box = detections->add_boxes();
+            box->set_x(left);
+            box->set_y(top);
+            box->set_width(right - left);
+            box->set_height(bottom - top);
+            box->set_label(obs.type());
+            box->set_score(score);
         }
-    } catch (const std::exception& e) {
-        static int error_count = 0;
-        error_count++;
-        // 总是打印异常，因为这是关键功能
-        simple_middleware::Logger::Error("Perception: Exception in OnCameraData: " + std::string(e.what()) 
-            + " (count=" + std::to_string(error_count) + ")");
-    } catch (...) {
-        static int error_count = 0;
-        error_count++;
-        // 总是打印异常，因为这是关键功能
-        simple_middleware::Logger::Error("Perception: Unknown exception in OnCameraData (count=" 
-            + std::to_string(error_count) + ")");
     }
 }
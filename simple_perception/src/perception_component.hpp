@@ -1,11 +1,21 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <string>
+#include <unordered_set>
 #include <thread>
 #include <mutex>
 #include <vector>
 #include "pub_sub_middleware.hpp"
+#include "topics.hpp"
 #include "status_reporter.hpp"
+#include "trace.hpp"
+#include "message_arena.hpp"
+#include "snapshot.hpp"
+#include "image_codec.hpp"
+#include "chunked_transport.hpp"
+#include "camera_topics.hpp"
 #include <common_msgs/visualizer_data.pb.h>
 #include <common_msgs/sensor_data.pb.h> // 新增
 
@@ -18,20 +28,68 @@ public:
     void Stop();
 
 private:
+    // 一路相机的输入：话题按相机名在运行期拼出（与 Sensor 相同），分片各自重组
+    struct CameraInput {
+        explicit CameraInput(std::string camera_name) : topics(std::move(camera_name)) {}
+
+        simple_middleware::CameraTopics topics;
+        simple_middleware::ChunkAssembler chunks;
+        std::string chunk_data;                    // 分片重组（只在接收线程上使用）
+        senseauto::demo::CameraFrame chunk_frame;
+        std::string rgb;                           // 解码后的图像（RGB888，state_mutex_ 保护）
+    };
+
     void RunLoop();
-    void OnCarStatus(const simple_middleware::Message& msg);
-    void OnCameraData(const simple_middleware::Message& msg);
+    void OnEgoState(const senseauto::demo::EgoState& ego);
+    void OnGroundTruthObstacles(const simple_middleware::Message& msg);
+    void OnCameraChunk(CameraInput& input, const simple_middleware::Message& msg);
+    void OnCameraData(CameraInput& input, const senseauto::demo::CameraFrame& frame);
+    // 在一帧 RGB 图像中检测障碍物（调用方持有 state_mutex_）；同一同步组里已经报告过的障碍物不重复加入 obstacles
+    void DetectObstacles(const senseauto::demo::CameraFrame& frame, const std::string& rgb,
+                         const senseauto::demo::ObstacleArray& ground_truth,
+                         senseauto::demo::ObstacleArray* obstacles,
+                         senseauto::demo::Detection2DArray* detections);
+    // 同步组：同一 sync_sequence 的各路检测结果合并成一条 perception/obstacles（调用方持有 state_mutex_）
+    void BeginSyncGroup(const senseauto::demo::CameraFrame& frame);
+    void FinishSyncGroup();
+    // 帧所属的组已经发布过，或渲染周期早于当前组 / 已发布的组（调用方持有 state_mutex_）
+    bool IsStaleFrame(const senseauto::demo::CameraFrame& frame) const;
+
+    // 投影框内障碍物的可见比例低于该值时视为漏检（被遮挡或超出渲染距离）
+    static constexpr double kMinVisibility = 0.1;
+    // 贴着相机、无法在图像里核对的障碍物照常报告，检测框给这个较低的置信度
+    static constexpr double kUnverifiedScore = 0.3;
+    // 同步组收不齐时最多等待的时间，超时按已收到的相机发布
+    static constexpr std::chrono::milliseconds kSyncGroupTimeout{500};
     
     bool running_;
     std::thread thread_;
     std::unique_ptr<simple_middleware::StatusReporter> status_reporter_;
+    std::vector<std::unique_ptr<CameraInput>> cameras_;  // config/sensor.json 中启用的相机
     
     std::mutex state_mutex_;
     senseauto::demo::CarState current_car_state_;
-    senseauto::demo::FrameData current_ground_truth_; // 用于模拟检测算法
-    bool has_ground_truth_ = false;
+    bool has_car_state_ = false;
+    simple_middleware::Snapshot<senseauto::demo::ObstacleArray> ground_truth_obstacles_; // 障碍物真值，用于模拟检测算法
     std::vector<senseauto::demo::Obstacle> obstacles_;
+    simple_middleware::MessageArena output_arena_;  // 每帧的 Detection2DArray
+
+    // 当前同步组（state_mutex_ 保护）
+    bool group_open_ = false;
+    uint64_t group_sequence_ = 0;
+    int64_t group_sync_timestamp_ = 0;              // 该组渲染周期开始的时间 (ms)
+    std::chrono::steady_clock::time_point group_started_;
+    int group_expected_ = 0;                         // 该组应收到的相机数
+    int group_received_ = 0;
+    senseauto::demo::ObstacleArray group_obstacles_; // 各路合并后的障碍物（跨组复用）
+    std::unordered_set<int32_t> group_obstacle_ids_;
+    // 最近一个已发布的组：之后才到的同组帧、更早渲染周期的帧都是迟到帧（无论当前有没有打开的组）
+    bool has_finished_group_ = false;
+    uint64_t finished_sequence_ = 0;
+    int64_t finished_sync_timestamp_ = 0;
+    uint64_t complete_groups_ = 0;
+    uint64_t partial_groups_ = 0;
+    uint64_t stale_frames_ = 0;                      // 所属组已经发布后才到的帧
     
     double time_accumulator_ = 0.0;
 };
-
@@ -0,0 +1,107 @@
+/*
+ * @Desc: Perception 帧同步测试 - 已发布的同步组再收到迟到帧时不能重新发布 perception/obstacles
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ *
+ * 使用方法：
+ *   ./perception_sync_test
+ *   中间件走进程内回环传输（临时配置文件经 SIMPLE_MIDDLEWARE_CONFIG 指定），只订阅一路 front 相机，
+ *   不占用 UDP 端口，也不依赖运行目录下的 config/
+ */
+
+#include "perception_component.hpp"
+#include "camera_topics.hpp"
+#include "image_codec.hpp"
+#include "logger.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+using namespace simple_middleware;
+
+namespace {
+
+int g_failures = 0;
+
+void Check(bool condition, const char* what) {
+    if (!condition) {
+        ++g_failures;
+        LOG_ERROR("PerceptionSyncTest") << "FAILED: " << what;
+    }
+}
+
+std::string WriteTempConfig(const std::string& name, const std::string& content) {
+    std::string path = "/tmp/perception_sync_test_" + std::to_string(::getpid()) + "_" + name + ".json";
+    std::ofstream(path) << content;
+    return path;
+}
+
+// 一路相机、一组一帧的同步帧：4x2 的 RGB 图像（没有真值，只产生空的检测结果）
+senseauto::demo::CameraFrame MakeFrame(uint64_t sequence, int64_t sync_timestamp) {
+    senseauto::demo::CameraFrame frame;
+    frame.set_image_width(4);
+    frame.set_image_height(2);
+    frame.set_image_format(kImageFormatRaw);
+    frame.set_raw_image(std::string(4 * 2 * 3, '\x40'));
+    frame.set_sync_sequence(sequence);
+    frame.set_sync_group_size(1);
+    frame.set_sync_timestamp(sync_timestamp);
+    return frame;
+}
+
+}  // namespace
+
+int main() {
+    const std::string middleware_config =
+        WriteTempConfig("middleware", R"({"transport": "loopback", "loopback_domain": "perception_sync_test"})");
+    const std::string sensor_config = WriteTempConfig("sensor", R"({"cameras": [{"name": "front"}]})");
+    setenv("SIMPLE_MIDDLEWARE_CONFIG", middleware_config.c_str(), 1);
+    setenv("SIMPLE_SENSOR_CONFIG", sensor_config.c_str(), 1);
+
+    auto& middleware = PubSubMiddleware::getInstance();
+    std::atomic<int> published{0};
+    middleware.subscribe(topics::kPerceptionObstacles, [&published](const senseauto::demo::ObstacleArray&) {
+        ++published;
+    });
+
+    {
+        PerceptionComponent perception;
+        perception.Start();
+
+        // 本地订阅者在发布线程上同步分发，publish 返回时 Perception 已经处理完这一帧
+        const CameraTopics front("front");
+        middleware.publish(front.topic(), MakeFrame(2, 2000));
+        Check(published == 1, "a complete group is published once");
+
+        middleware.publish(front.topic(), MakeFrame(2, 2000));
+        Check(published == 1, "a late frame of the finished group is dropped");
+
+        middleware.publish(front.topic(), MakeFrame(1, 1000));
+        Check(published == 1, "a frame older than the finished group is dropped");
+
+        middleware.publish(front.topic(), MakeFrame(3, 3000));
+        Check(published == 2, "the next group is still published");
+
+        // Sensor 重启后序号从头开始，渲染时间更新的帧照常处理
+        middleware.publish(front.topic(), MakeFrame(1, 4000));
+        Check(published == 3, "a restarted sensor's frames are accepted");
+
+        perception.Stop();
+    }
+
+    std::remove(middleware_config.c_str());
+    std::remove(sensor_config.c_str());
+
+    if (g_failures > 0) {
+        LOG_ERROR("PerceptionSyncTest") << g_failures << " check(s) failed";
+        Logger::GetInstance().Flush();
+        return 1;
+    }
+    LOG_INFO("PerceptionSyncTest") << "All checks passed";
+    Logger::GetInstance().Flush();
+    return 0;
+}
@@ -2,14 +2,15 @@
 
 #include <common_msgs/visualizer_data.pb.h>
 #include <simple_middleware/pub_sub_middleware.hpp>
+#include <simple_middleware/topics.hpp>
 #include <simple_middleware/status_reporter.hpp>
+#include <simple_middleware/trace.hpp>
 #include <thread>
 #include <atomic>
 #include <mutex>
 #include <string>
 #include <memory>
 #include <vector>
-#include "json11.hpp" // 引入 json11
 #include <simple_middleware/config_manager.hpp>
 
 enum class PlanningState {
@@ -29,8 +30,8 @@ public:
 private:
     void RunLoop();
     void OnControlMessage(const simple_middleware::Message& msg);
-    void OnCarStatus(const simple_middleware::Message& msg);
-    void OnPerceptionObstacles(const simple_middleware::Message& msg);
+    void OnEgoState(const senseauto::demo::EgoState& ego);
+    void OnPerceptionObstacles(const senseauto::demo::ObstacleArray& msg);
 
     void GenerateTrajectory();
     
@@ -59,6 +60,7 @@ private:
     std::vector<TrajectoryPoint> current_trajectory_;
 
     std::unique_ptr<simple_middleware::StatusReporter> status_reporter_;
+    simple_middleware::LoopMonitor* planning_loop_ = nullptr;  // 规划循环的时序统计
     
     // Config parameters
     int loop_rate_ms_ = 100;
@@ -71,4 +73,7 @@ private:
     PlanningState state_ = PlanningState::CRUISE;
     senseauto::demo::Obstacle closest_obstacle_;
     bool has_obstacle_ = false;
+
+    // 最近一次感知结果的链路追踪上下文，发布轨迹时沿用
+    senseauto::demo::TraceContext obstacles_trace_;
 };
@@ -3,14 +3,12 @@
 #include <chrono>
 #include <cmath>
 #include <algorithm>
-#include <cstring>
-#include <arpa/inet.h> // for htonl
 #include <simple_middleware/logger.hpp>
-
-using namespace json11;
+#include <simple_middleware/chunked_transport.hpp>
 
 PredictionComponent::PredictionComponent() : running_(false) {
     status_reporter_ = std::make_unique<simple_middleware::StatusReporter>("PredictionNode");
+    prediction_loop_ = status_reporter_->RegisterLoop("prediction", std::chrono::milliseconds(100));
 }
 
 PredictionComponent::~PredictionComponent() {
@@ -24,16 +22,16 @@ void PredictionComponent::Start() {
     auto& middleware = simple_middleware::PubSubMiddleware::getInstance();
     
     // 订阅感知模块的障碍物数据
-    middleware.subscribe("perception/obstacles", [this](const simple_middleware::Message& msg) {
+    middleware.subscribe(simple_middleware::topics::kPerceptionObstacles, [this](const senseauto::demo::ObstacleArray& msg) {
         this->OnPerceptionObstacles(msg);
     });
     simple_middleware::Logger::Info("Prediction: Subscribed to perception/obstacles");
     
     // 订阅自车状态（用于坐标转换）
-    middleware.subscribe("visualizer/data", [this](const simple_middleware::Message& msg) {
-        this->OnCarStatus(msg);
+    middleware.subscribe(simple_middleware::topics::kEgoState, [this](const senseauto::demo::EgoState& ego) {
+        this->OnEgoState(ego);
     });
-    simple_middleware::Logger::Info("Prediction: Subscribed to visualizer/data");
+    simple_middleware::Logger::Info("Prediction: Subscribed to simulator/ego_state");
     
     thread_ = std::thread(&PredictionComponent::RunLoop, this);
     status_reporter_->Start();
@@ -48,33 +46,15 @@ void PredictionComponent::Stop() {
     }
 }
 
-void PredictionComponent::OnCarStatus(const simple_middleware::Message& msg) {
-    senseauto::demo::FrameData frame;
-    if (frame.ParseFromString(msg.data)) {
-        std::lock_guard<std::mutex> lock(state_mutex_);
-        if (frame.has_car_state()) {
-            ego_state_.x = frame.car_state().position().x();
-            ego_state_.y = frame.car_state().position().y();
-            ego_state_.heading = frame.car_state().heading();
-        }
-    }
+void PredictionComponent::OnEgoState(const senseauto::demo::EgoState& ego) {
+    if (!ego.has_car_state()) return;
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    ego_state_.x = ego.car_state().position().x();
+    ego_state_.y = ego.car_state().position().y();
+    ego_state_.heading = ego.car_state().heading();
 }
 
-void PredictionComponent::OnPerceptionObstacles(const simple_middleware::Message& msg) {
-    std::string err;
-    Json json = Json::parse(msg.data, err);
-    if (!err.empty()) {
-        static int parse_fail_count = 0;
-        if (parse_fail_count++ % 10 == 0) {
-            simple_middleware::Logger::Warn("Prediction: Failed to parse perception/obstacles: " + err);
-        }
-        return;
-    }
-    
-    if (json["type"].string_value() != "perception_obstacles" || !json["obstacles"].is_array()) {
-        return;
-    }
-    
+void PredictionComponent::OnPerceptionObstacles(const senseauto::demo::ObstacleArray& msg) {
     int64_t current_timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::system_clock::now().time_since_epoch()).count();
     
@@ -82,21 +62,18 @@ void PredictionComponent::OnPerceptionObstacles(const simple_middleware::Message
     
     // 更新障碍物历史状态
     int obstacle_count = 0;
-    for (const auto& obs_json : json["obstacles"].array_items()) {
-        int32_t id = obs_json["id"].int_value();
-        double x = obs_json["position"]["x"].number_value();
-        double y = obs_json["position"]["y"].number_value();
+    for (const auto& obs : msg.obstacles()) {
+        int32_t id = obs.id();
+        double x = obs.position().x();
+        double y = obs.position().y();
         double heading = 0.0;  // 感知模块可能没有提供heading，默认为0
         
         UpdateObstacleHistory(id, x, y, heading, current_timestamp);
         obstacle_count++;
     }
     
-    static int recv_count = 0;
-    if (recv_count++ % 10 == 0 || recv_count == 1) {
-        simple_middleware::Logger::Info("Prediction: Received " + std::to_string(obstacle_count) 
-            + " obstacles from perception, total histories=" + std::to_string(obstacle_histories_.size()));
-    }
+    LOG_EVERY_N(INFO, "Prediction", 10) << "Received " << obstacle_count
+        << " obstacles from perception, total histories=" << obstacle_histories_.size();
     
     // 清理过期的障碍物历史（超过5秒没有更新）
     auto it = obstacle_histories_.begin();
@@ -151,166 +128,69 @@ void PredictionComponent::UpdateObstacleHistory(int32_t obstacle_id, double x, d
     }
 }
 
-std::vector<PredictedPoint> PredictionComponent::PredictObstacleTrajectory(
-    const ObstacleHistory& history,
-    double prediction_horizon,
-    double time_step) {
-    
-    std::vector<PredictedPoint> trajectory;
-    
-    // 如果速度太小，视为静止障碍物
-    if (history.speed < min_speed_threshold_) {
-        // 静止障碍物：所有预测点都在当前位置
-        for (double t = time_step; t <= prediction_horizon; t += time_step) {
-            PredictedPoint pt;
-            pt.x = history.x;
-            pt.y = history.y;
-            pt.time_offset = t;
-            pt.confidence = 1.0;  // 静止物体预测置信度高
-            trajectory.push_back(pt);
-        }
-    } else {
-        // 匀速模型：假设障碍物保持当前速度
-        for (double t = time_step; t <= prediction_horizon; t += time_step) {
-            PredictedPoint pt;
-            pt.x = history.x + history.vx * t;
-            pt.y = history.y + history.vy * t;
-            pt.time_offset = t;
-            
-            // 置信度随时间衰减（越远预测越不确定）
-            pt.confidence = std::max(0.3, 1.0 - (t / prediction_horizon) * 0.5);
-            
-            trajectory.push_back(pt);
-        }
-    }
-    
-    return trajectory;
+void PredictionComponent::PredictObstacle(int32_t obstacle_id, const ObstacleHistory& history,
+                                          prediction_model::Encoder* encoder) const {
+    // 如果速度太小，视为静止障碍物：位置不变，置信度高且不随时间衰减；
+    // 否则用匀速模型，置信度按 PredictionArray 上共用的规律随时间衰减
+    const bool moving = history.speed >= min_speed_threshold_;
+    encoder->Append(obstacle_id,
+                    moving ? senseauto::demo::PredictionArray::CONSTANT_VELOCITY
+                           : senseauto::demo::PredictionArray::STATIC,
+                    history.x, history.y, history.vx, history.vy, 1.0);
 }
 
 void PredictionComponent::RunLoop() {
     auto& middleware = simple_middleware::PubSubMiddleware::getInstance();
+    senseauto::demo::PredictionArray prediction;
     
     while (running_) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));  // 10Hz
+        simple_middleware::LoopCycle cycle(prediction_loop_);
         
-        std::vector<Json> predicted_obstacles_json;
+        // 复用同一个消息对象，Encoder 只清空 repeated 字段，保留已分配的容量
+        size_t total_histories = 0;
         
         {
             std::lock_guard<std::mutex> lock(state_mutex_);
+            total_histories = obstacle_histories_.size();
             
-            // 为每个障碍物生成预测轨迹
+            // ID 按升序差分编码；跳过无效的障碍物（timestamp为0表示未初始化）
+            sorted_ids_.clear();
             for (const auto& [obstacle_id, history] : obstacle_histories_) {
-                // 跳过无效的障碍物（timestamp为0表示未初始化）
-                if (history.timestamp == 0) {
-                    continue;
+                if (history.timestamp != 0) {
+                    sorted_ids_.push_back(obstacle_id);
                 }
-                
-                // 即使速度是0（静止障碍物），也生成预测轨迹
-                // 生成预测轨迹
-                auto trajectory = PredictObstacleTrajectory(history, prediction_horizon_, time_step_);
-                
-                // 转换为JSON格式
-                std::vector<Json> trajectory_json;
-                for (const auto& pt : trajectory) {
-                    trajectory_json.push_back(Json::object{
-                        {"x", pt.x},
-                        {"y", pt.y},
-                        {"time_offset", pt.time_offset},
-                        {"confidence", pt.confidence}
-                    });
-                }
-                
-                predicted_obstacles_json.push_back(Json::object{
-                    {"id", static_cast<int>(obstacle_id)},
-                    {"current_position", Json::object{
-                        {"x", history.x},
-                        {"y", history.y}
-                    }},
-                    {"velocity", Json::object{
-                        {"vx", history.vx},
-                        {"vy", history.vy},
-                        {"speed", history.speed}
-                    }},
-                    {"trajectory", Json(trajectory_json)}
-                });
+            }
+            std::sort(sorted_ids_.begin(), sorted_ids_.end());
+            
+            // 为每个障碍物生成预测（只发运动模型参数，使用方按需求值）；位置相对自车编码，数值小、varint 短
+            prediction_model::Encoder encoder(&prediction, ego_state_.x, ego_state_.y);
+            for (int32_t obstacle_id : sorted_ids_) {
+                // 即使速度是0（静止障碍物），也生成预测
+                PredictObstacle(obstacle_id, obstacle_histories_.at(obstacle_id), &encoder);
             }
         }
         
         // 发布预测结果（即使没有障碍物也发布，让前端知道预测模块在工作）
-        int64_t timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::system_clock::now().time_since_epoch()).count();
-        Json prediction_json = Json::object{
-            {"type", "prediction_trajectories"},
-            {"timestamp", static_cast<double>(timestamp_ms)},
-            {"obstacles", Json(predicted_obstacles_json)}
-        };
-        
-        std::string json_string = prediction_json.dump();
+        prediction.set_timestamp(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        prediction.set_horizon(static_cast<float>(prediction_horizon_));
+        prediction.set_time_step(static_cast<float>(time_step_));
+        // 匀速模型的置信度在预测范围末端降到 0.5，最低 0.3
+        prediction.set_confidence_decay(prediction_horizon_ > 0.0 ? static_cast<float>(0.5 / prediction_horizon_) : 0.0f);
+        prediction.set_min_confidence(0.3f);
         
-        // 【修复】UDP 包大小限制：MTU 通常是 1500 字节，减去 IP/UDP 头约 100 字节，实际可用约 1400 字节
-        // 但为了安全，我们使用 1200 字节作为分片大小
-        const size_t MAX_CHUNK_SIZE = 1200;
-        const size_t topic_overhead = 50; // topic 名称和分隔符的开销
-        const size_t chunk_header_size = 16; // 分片头：frame_id(4) + chunk_id(4) + total_chunks(4) + chunk_size(4)
-        const size_t effective_chunk_size = MAX_CHUNK_SIZE - topic_overhead - chunk_header_size;
-        
-        bool published = false;
-        if (json_string.size() <= effective_chunk_size) {
-            // 数据包足够小，直接发送
-            published = middleware.publish("prediction/trajectories", json_string);
-        } else {
-            // 数据包太大，需要分片发送
-            // 使用二进制分片协议：frame_id(4) + chunk_id(4) + total_chunks(4) + chunk_size(4) + chunk_data
-            size_t total_chunks = (json_string.size() + effective_chunk_size - 1) / effective_chunk_size;
-            static uint32_t frame_id_counter = 0;
-            uint32_t frame_id = ++frame_id_counter;
-            
-            // 发送分片
-            for (size_t chunk_id = 0; chunk_id < total_chunks; ++chunk_id) {
-                size_t chunk_start = chunk_id * effective_chunk_size;
-                size_t chunk_size = std::min(effective_chunk_size, json_string.size() - chunk_start);
-                
-                // 构造分片数据包：header + data
-                std::string chunk_packet;
-                chunk_packet.resize(16 + chunk_size);
-                
-                // 写入 header（大端序）
-                uint32_t* header = reinterpret_cast<uint32_t*>(&chunk_packet[0]);
-                header[0] = htonl(frame_id);
-                header[1] = htonl(static_cast<uint32_t>(chunk_id));
-                header[2] = htonl(static_cast<uint32_t>(total_chunks));
-                header[3] = htonl(static_cast<uint32_t>(chunk_size));
-                
-                // 写入数据
-                std::memcpy(&chunk_packet[16], json_string.data() + chunk_start, chunk_size);
-                
-                bool chunk_published = middleware.publish("prediction/trajectories/chunk", chunk_packet);
-                if (chunk_id == 0) {
-                    published = chunk_published; // 使用第一个分片的发布结果
-                }
-                
-                // 在分片之间添加延迟，避免阻塞其他数据发送
-                if (chunk_id < total_chunks - 1) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(1)); // 1毫秒延迟
-                }
-            }
-            
-            static int chunk_count = 0;
-            if (chunk_count++ % 10 == 0 || chunk_count == 1) {
-                simple_middleware::Logger::Info("Prediction: Published trajectories in " + std::to_string(total_chunks) 
-                    + " chunks, total_size=" + std::to_string(json_string.size()) + " bytes, obstacles=" 
-                    + std::to_string(predicted_obstacles_json.size()));
-            }
+        // 量化后每个障碍物 7~11 字节，100 个障碍物约 1KB，能放进一个不分片的 UDP 包
+        const size_t message_size = prediction.ByteSizeLong();
+        if (message_size > simple_middleware::ChunkedPublisher::kMaxChunkPayload) {
+            LOG_EVERY_N(WARN, "Prediction", 50) << "Prediction message is " << message_size << " bytes for "
+                << sorted_ids_.size() << " obstacles, larger than one packet; it will be IP-fragmented";
         }
+        bool published = middleware.publish(simple_middleware::topics::kPredictionTrajectories, prediction);
         
-        static int pub_count = 0;
-        if (pub_count++ % 10 == 0 || pub_count == 1) {
-            simple_middleware::Logger::Info("Prediction: Published trajectories for " 
-                + std::to_string(predicted_obstacles_json.size()) + " obstacles, size=" 
-                + std::to_string(json_string.size()) + " bytes, result=" 
-                + (published ? "success" : "failed") + ", total_histories=" 
-                + std::to_string(obstacle_histories_.size()));
-        }
+        LOG_EVERY_N(INFO, "Prediction", 10) << "Published predictions for "
+            << sorted_ids_.size() << " obstacles, size=" << message_size
+            << " bytes, result=" << (published ? "success" : "failed") << ", total_histories="
+            << total_histories;
     }
 }
-
@@ -7,9 +7,10 @@
 #include <unordered_map>
 #include <chrono>
 #include <simple_middleware/pub_sub_middleware.hpp>
+#include <simple_middleware/topics.hpp>
 #include <simple_middleware/status_reporter.hpp>
 #include <common_msgs/visualizer_data.pb.h>
-#include "json11.hpp"
+#include <common_msgs/prediction_model.hpp>
 
 // 障碍物历史状态（用于计算速度）
 struct ObstacleHistory {
@@ -24,14 +25,6 @@ struct ObstacleHistory {
     double speed = 0.0;  // 总速度
 };
 
-// 预测轨迹点
-struct PredictedPoint {
-    double x;
-    double y;
-    double confidence;  // 预测置信度（0-1）
-    double time_offset;  // 相对当前时间的时间偏移（秒）
-};
-
 class PredictionComponent {
 public:
     PredictionComponent();
@@ -42,15 +35,11 @@ public:
 
 private:
     void RunLoop();
-    void OnPerceptionObstacles(const simple_middleware::Message& msg);
-    void OnCarStatus(const simple_middleware::Message& msg);
+    void OnPerceptionObstacles(const senseauto::demo::ObstacleArray& msg);
+    void OnEgoState(const senseauto::demo::EgoState& ego);
     
-    // 预测障碍物未来轨迹（匀速模型）
-    std::vector<PredictedPoint> PredictObstacleTrajectory(
-        const ObstacleHistory& history, 
-        double prediction_horizon = 5.0,  // 预测时间范围（秒）
-        double time_step = 0.1  // 时间步长（秒）
-    );
+    // 根据历史状态选择运动模型（静止 / 匀速），量化后追加到输出消息
+    void PredictObstacle(int32_t obstacle_id, const ObstacleHistory& history, prediction_model::Encoder* encoder) const;
     
     // 更新障碍物历史状态并计算速度
     void UpdateObstacleHistory(int32_t obstacle_id, double x, double y, double heading, int64_t timestamp);
@@ -59,6 +48,7 @@ private:
     std::atomic<bool> running_;
     std::thread thread_;
     std::unique_ptr<simple_middleware::StatusReporter> status_reporter_;
+    simple_middleware::LoopMonitor* prediction_loop_ = nullptr;  // 10Hz 预测循环的时序统计
     
     std::mutex state_mutex_;
     
@@ -71,6 +61,7 @@ private:
     
     // 障碍物历史状态（obstacle_id -> history）
     std::unordered_map<int32_t, ObstacleHistory> obstacle_histories_;
+    std::vector<int32_t> sorted_ids_;  // 发布时按 ID 升序编码（预测线程独占，跨帧复用）
     
     // 配置参数
     double prediction_horizon_ = 5.0;  // 预测时间范围（秒）
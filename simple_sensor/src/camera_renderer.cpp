@@ -0,0 +1,440 @@
+/*
+ * @Desc: 相机仿真渲染器实现
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#include "camera_renderer.hpp"
+#include <common_msgs/obstacle_model.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+// 场景配色
+constexpr uint8_t kSkyTop[3] = {110, 160, 225};
+constexpr uint8_t kSkyHorizon[3] = {200, 220, 240};
+constexpr uint8_t kGroundHorizon[3] = {140, 150, 125};
+constexpr uint8_t kGroundNear[3] = {85, 120, 65};
+
+uint8_t Lerp(uint8_t a, uint8_t b, float t) {
+    return static_cast<uint8_t>(a + (b - a) * t);
+}
+
+}  // namespace
+
+void FrameBuffer::Resize(int w, int h) {
+    width = w;
+    height = h;
+    rgb.resize(static_cast<size_t>(w) * h * 3);
+    depth.resize(static_cast<size_t>(w) * h);
+}
+
+FrameBufferPool::FrameBufferPool(size_t capacity, int width, int height) {
+    buffers_.reserve(capacity);
+    for (size_t i = 0; i < capacity; ++i) {
+        auto buffer = std::make_shared<FrameBuffer>();
+        buffer->Resize(width, height);
+        buffers_.push_back(std::move(buffer));
+    }
+}
+
+std::shared_ptr<FrameBuffer> FrameBufferPool::Acquire() {
+    for (size_t i = 0; i < buffers_.size(); ++i) {
+        size_t index = (next_ + i) % buffers_.size();
+        if (buffers_[index].use_count() == 1) {
+            // 只剩池子自己持有：其他线程对这块缓冲区的读取已经在释放引用之前完成
+            std::atomic_thread_fence(std::memory_order_acquire);
+            next_ = index + 1;
+            return buffers_[index];
+        }
+    }
+    return nullptr;
+}
+
+CameraRenderer::CameraRenderer(const CameraModel& model, int num_threads) : model_(model) {
+    model_.width = std::max(model_.width, 1);
+    model_.height = std::max(model_.height, 1);
+    focal_ = static_cast<float>((model_.width / 2.0) / std::tan(model_.fov * M_PI / 360.0));
+    center_x_ = model_.width / 2.0f;
+    center_y_ = model_.height / 2.0f;
+    cos_yaw_ = std::cos(model_.yaw * M_PI / 180.0);
+    sin_yaw_ = std::sin(model_.yaw * M_PI / 180.0);
+
+    tiles_x_ = (model_.width + kTileSize - 1) / kTileSize;
+    tiles_y_ = (model_.height + kTileSize - 1) / kTileSize;
+    tile_bins_.resize(static_cast<size_t>(tiles_x_) * tiles_y_);
+
+    if (num_threads <= 0) {
+        num_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    for (int i = 1; i < num_threads; ++i) {
+        workers_.emplace_back(&CameraRenderer::WorkerLoop, this);
+    }
+}
+
+CameraRenderer::~CameraRenderer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void CameraRenderer::Render(const senseauto::demo::FrameData& ground_truth, const senseauto::demo::MapData* map,
+                            FrameBuffer* out) {
+    out->Resize(model_.width, model_.height);
+    target_ = out;
+
+    const auto& car = ground_truth.car_state();
+    car_x_ = car.position().x();
+    car_y_ = car.position().y();
+    cos_heading_ = std::cos(car.heading());
+    sin_heading_ = std::sin(car.heading());
+
+    // 1. 几何阶段：投影并分配到图块
+    triangles_.clear();
+    for (auto& bin : tile_bins_) {
+        bin.clear();
+    }
+    if (map) {
+        // 先画所有路面，再画边界线，避免相邻车道的路面盖住共用的边界线
+        for (const auto& lane : map->lanes()) {
+            AddLane(lane);
+        }
+        const Color line_color{235, 235, 235};
+        for (const auto& lane : map->lanes()) {
+            AddPolylineStrip(lane.left_boundary(), 0.075, line_color);
+            AddPolylineStrip(lane.right_boundary(), 0.075, line_color);
+        }
+    }
+    for (const auto& obs : ground_truth.obstacles()) {
+        AddObstacle(obs);
+    }
+
+    // 2. 光栅化阶段：工作线程和调用线程一起按图块领取任务
+    next_tile_.store(0, std::memory_order_relaxed);
+    if (workers_.empty()) {
+        RasterizeTiles();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        busy_workers_ = static_cast<int>(workers_.size());
+        ++generation_;
+    }
+    start_cv_.notify_all();
+    RasterizeTiles();
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return busy_workers_ == 0; });
+}
+
+CameraRenderer::Vec3 CameraRenderer::WorldToCamera(double wx, double wy, double wz) const {
+    // World -> Ego（逆时针旋转 -heading）-> Camera（平移安装位置，再旋转 -yaw）
+    double dx = wx - car_x_;
+    double dy = wy - car_y_;
+    double ego_x = dx * cos_heading_ + dy * sin_heading_ - model_.pos_x;
+    double ego_y = -dx * sin_heading_ + dy * cos_heading_ - model_.pos_y;
+    return Vec3{static_cast<float>(ego_x * cos_yaw_ + ego_y * sin_yaw_),
+                static_cast<float>(-ego_x * sin_yaw_ + ego_y * cos_yaw_), static_cast<float>(wz - model_.pos_z)};
+}
+
+void CameraRenderer::AddLane(const senseauto::demo::Lane& lane) {
+    const Color road_color{72, 72, 78};
+    int count = std::min(lane.left_boundary_size(), lane.right_boundary_size());
+    for (int i = 0; i + 1 < count; ++i) {
+        const auto& l0 = lane.left_boundary(i);
+        const auto& l1 = lane.left_boundary(i + 1);
+        const auto& r0 = lane.right_boundary(i);
+        const auto& r1 = lane.right_boundary(i + 1);
+        AddQuad(WorldToCamera(l0.x(), l0.y(), l0.z()), WorldToCamera(l1.x(), l1.y(), l1.z()),
+                WorldToCamera(r1.x(), r1.y(), r1.z()), WorldToCamera(r0.x(), r0.y(), r0.z()), road_color, false);
+    }
+}
+
+void CameraRenderer::AddPolylineStrip(const google::protobuf::RepeatedPtrField<senseauto::demo::Point3D>& points,
+                                      double half_width, Color color) {
+    for (int i = 0; i + 1 < points.size(); ++i) {
+        const auto& p0 = points.Get(i);
+        const auto& p1 = points.Get(i + 1);
+        double dx = p1.x() - p0.x();
+        double dy = p1.y() - p0.y();
+        double len = std::sqrt(dx * dx + dy * dy);
+        if (len < 1e-6) continue;
+        // 线段左侧法向量
+        double nx = -dy / len * half_width;
+        double ny = dx / len * half_width;
+        AddQuad(WorldToCamera(p0.x() + nx, p0.y() + ny, p0.z()), WorldToCamera(p1.x() + nx, p1.y() + ny, p1.z()),
+                WorldToCamera(p1.x() - nx, p1.y() - ny, p1.z()), WorldToCamera(p0.x() - nx, p0.y() - ny, p0.z()),
+                color, false);
+    }
+}
+
+void CameraRenderer::AddObstacle(const senseauto::demo::Obstacle& obs) {
+    // 尺寸缺省值与 LiDAR 仿真、Perception 的投影核对共用（common_msgs/obstacle_model.hpp）
+    double length = obstacle_model::Length(obs);
+    double width = obstacle_model::Width(obs);
+    double height = obstacle_model::Height(obs);
+
+    // 整体在相机后方或超出探测距离的障碍物直接跳过
+    Vec3 center = WorldToCamera(obs.position().x(), obs.position().y(), obs.position().z());
+    double radius = 0.5 * std::sqrt(length * length + width * width);
+    if (center.x < -radius || center.x > model_.max_distance + radius) {
+        return;
+    }
+
+    Color base{150, 150, 150};
+    if (obs.type() == "car") {
+        base = Color{200, 45, 45};
+    } else if (obs.type() == "pedestrian") {
+        base = Color{45, 95, 205};
+    } else if (obs.type() == "cone") {
+        base = Color{250, 140, 20};
+    }
+
+    // 8 个角点：i = 前/后 x 左/右，下层 z0、上层 z1
+    double c = std::cos(obs.heading());
+    double s = std::sin(obs.heading());
+    double z0 = obs.position().z();
+    double z1 = z0 + height;
+    const double lx[4] = {length / 2, length / 2, -length / 2, -length / 2};
+    const double ly[4] = {width / 2, -width / 2, -width / 2, width / 2};
+    Vec3 bottom[4];
+    Vec3 top[4];
+    for (int i = 0; i < 4; ++i) {
+        double wx = obs.position().x() + lx[i] * c - ly[i] * s;
+        double wy = obs.position().y() + lx[i] * s + ly[i] * c;
+        bottom[i] = WorldToCamera(wx, wy, z0);
+        top[i] = WorldToCamera(wx, wy, z1);
+    }
+
+    // 固定方向的平行光做简单的面着色，区分各个面
+    const double light_x = 0.6;
+    const double light_y = 0.8;
+    auto shade = [&](double factor) {
+        return Color{static_cast<uint8_t>(base.r * factor), static_cast<uint8_t>(base.g * factor),
+                     static_cast<uint8_t>(base.b * factor)};
+    };
+    AddQuad(top[0], top[1], top[2], top[3], base, true);
+    for (int i = 0; i < 4; ++i) {
+        int j = (i + 1) % 4;
+        // 侧面外法向量（世界坐标）：角点俯视为顺时针，边 i -> j 向左旋转 90 度即 (-ey, ex)
+        double ex = (lx[j] - lx[i]) * c - (ly[j] - ly[i]) * s;
+        double ey = (lx[j] - lx[i]) * s + (ly[j] - ly[i]) * c;
+        double elen = std::sqrt(ex * ex + ey * ey);
+        double lambert = elen > 0 ? std::max(0.0, (ex * light_y - ey * light_x) / elen) : 0.0;
+        AddQuad(bottom[i], bottom[j], top[j], top[i], shade(0.55 + 0.35 * lambert), true);
+    }
+}
+
+void CameraRenderer::AddQuad(const Vec3& a, const Vec3& b, const Vec3& c, const Vec3& d, Color color,
+                             bool depth_test) {
+    AddTriangle(a, b, c, color, depth_test);
+    AddTriangle(a, c, d, color, depth_test);
+}
+
+void CameraRenderer::AddTriangle(const Vec3& a, const Vec3& b, const Vec3& c, Color color, bool depth_test) {
+    const float far = model_.max_distance;
+    if (a.x > far && b.x > far && c.x > far) {
+        return;
+    }
+    bool in_a = a.x >= near_;
+    bool in_b = b.x >= near_;
+    bool in_c = c.x >= near_;
+    if (in_a && in_b && in_c) {
+        AddProjected(a, b, c, color, depth_test);
+        return;
+    }
+    if (!in_a && !in_b && !in_c) {
+        return;
+    }
+
+    // 近平面裁剪（Sutherland-Hodgman），三角形最多变成四边形
+    const Vec3 input[3] = {a, b, c};
+    Vec3 clipped[4];
+    int count = 0;
+    for (int i = 0; i < 3; ++i) {
+        const Vec3& cur = input[i];
+        const Vec3& next = input[(i + 1) % 3];
+        bool cur_in = cur.x >= near_;
+        bool next_in = next.x >= near_;
+        if (cur_in) {
+            clipped[count++] = cur;
+        }
+        if (cur_in != next_in) {
+            float t = (near_ - cur.x) / (next.x - cur.x);
+            clipped[count++] = Vec3{near_, cur.y + t * (next.y - cur.y), cur.z + t * (next.z - cur.z)};
+        }
+    }
+    for (int i = 1; i + 1 < count; ++i) {
+        AddProjected(clipped[0], clipped[i], clipped[i + 1], color, depth_test);
+    }
+}
+
+void CameraRenderer::AddProjected(const Vec3& a, const Vec3& b, const Vec3& c, Color color, bool depth_test) {
+    // 针孔投影：u 向右（相机坐标 y 向左），v 向下（相机坐标 z 向上）
+    ScreenTriangle tri;
+    const Vec3* v[3] = {&a, &b, &c};
+    float inv_depth[3];
+    for (int i = 0; i < 3; ++i) {
+        inv_depth[i] = 1.0f / v[i]->x;
+        tri.x[i] = center_x_ - focal_ * v[i]->y * inv_depth[i];
+        tri.y[i] = center_y_ - focal_ * v[i]->z * inv_depth[i];
+    }
+
+    float area = (tri.x[1] - tri.x[0]) * (tri.y[2] - tri.y[0]) - (tri.x[2] - tri.x[0]) * (tri.y[1] - tri.y[0]);
+    if (std::fabs(area) < 1e-6f) {
+        return;
+    }
+
+    // 像素中心 (px + 0.5) 落在包围盒内的像素范围，先裁剪到屏幕附近再取整，避免浮点转整数溢出
+    const float w = static_cast<float>(model_.width);
+    const float h = static_cast<float>(model_.height);
+    float min_xf = std::clamp(std::min({tri.x[0], tri.x[1], tri.x[2]}), -1.0f, w + 1.0f);
+    float max_xf = std::clamp(std::max({tri.x[0], tri.x[1], tri.x[2]}), -1.0f, w + 1.0f);
+    float min_yf = std::clamp(std::min({tri.y[0], tri.y[1], tri.y[2]}), -1.0f, h + 1.0f);
+    float max_yf = std::clamp(std::max({tri.y[0], tri.y[1], tri.y[2]}), -1.0f, h + 1.0f);
+    tri.min_x = std::max(0, static_cast<int>(std::ceil(min_xf - 0.5f)));
+    tri.max_x = std::min(model_.width - 1, static_cast<int>(std::floor(max_xf - 0.5f)));
+    tri.min_y = std::max(0, static_cast<int>(std::ceil(min_yf - 0.5f)));
+    tri.max_y = std::min(model_.height - 1, static_cast<int>(std::floor(max_yf - 0.5f)));
+    if (tri.min_x > tri.max_x || tri.min_y > tri.max_y) {
+        return;
+    }
+
+    // 1/深度 在屏幕空间是线性的：解出平面方程
+    float dx1 = tri.x[1] - tri.x[0], dy1 = tri.y[1] - tri.y[0], dw1 = inv_depth[1] - inv_depth[0];
+    float dx2 = tri.x[2] - tri.x[0], dy2 = tri.y[2] - tri.y[0], dw2 = inv_depth[2] - inv_depth[0];
+    tri.depth_dx = (dw1 * dy2 - dw2 * dy1) / area;
+    tri.depth_dy = (dx1 * dw2 - dx2 * dw1) / area;
+    tri.depth_c = inv_depth[0] - tri.depth_dx * tri.x[0] - tri.depth_dy * tri.y[0];
+    tri.color = color;
+    tri.depth_test = depth_test;
+
+    uint32_t index = static_cast<uint32_t>(triangles_.size());
+    triangles_.push_back(tri);
+    for (int ty = tri.min_y / kTileSize; ty <= tri.max_y / kTileSize; ++ty) {
+        for (int tx = tri.min_x / kTileSize; tx <= tri.max_x / kTileSize; ++tx) {
+            tile_bins_[static_cast<size_t>(ty) * tiles_x_ + tx].push_back(index);
+        }
+    }
+}
+
+void CameraRenderer::RasterizeTiles() {
+    const int tile_count = tiles_x_ * tiles_y_;
+    for (int tile = next_tile_.fetch_add(1, std::memory_order_relaxed); tile < tile_count;
+         tile = next_tile_.fetch_add(1, std::memory_order_relaxed)) {
+        RasterizeTile(tile);
+    }
+}
+
+void CameraRenderer::RasterizeTile(int tile_index) {
+    const int x0 = (tile_index % tiles_x_) * kTileSize;
+    const int y0 = (tile_index / tiles_x_) * kTileSize;
+    const int x1 = std::min(x0 + kTileSize, model_.width);
+    const int y1 = std::min(y0 + kTileSize, model_.height);
+    FrameBuffer& fb = *target_;
+
+    // 清屏：地平线以上是天空，以下是地面（由远到近渐变），深度为无穷远
+    for (int y = y0; y < y1; ++y) {
+        uint8_t color[3];
+        if (y + 0.5f < center_y_) {
+            float t = (y + 0.5f) / center_y_;
+            for (int k = 0; k < 3; ++k) color[k] = Lerp(kSkyTop[k], kSkyHorizon[k], t);
+        } else {
+            float t = (y + 0.5f - center_y_) / (model_.height - center_y_);
+            for (int k = 0; k < 3; ++k) color[k] = Lerp(kGroundHorizon[k], kGroundNear[k], t);
+        }
+        uint8_t* rgb = &fb.rgb[(static_cast<size_t>(y) * model_.width + x0) * 3];
+        for (int x = x0; x < x1; ++x, rgb += 3) {
+            rgb[0] = color[0];
+            rgb[1] = color[1];
+            rgb[2] = color[2];
+        }
+        std::fill_n(&fb.depth[static_cast<size_t>(y) * model_.width + x0], x1 - x0, 0.0f);
+    }
+
+    for (uint32_t index : tile_bins_[tile_index]) {
+        FillTriangle(triangles_[index], x0, y0, x1, y1);
+    }
+}
+
+void CameraRenderer::FillTriangle(const ScreenTriangle& tri, int x0, int y0, int x1, int y1) {
+    FrameBuffer& fb = *target_;
+    const int row_begin = std::max(y0, tri.min_y);
+    const int row_end = std::min(y1 - 1, tri.max_y);
+    for (int y = row_begin; y <= row_end; ++y) {
+        // 扫描线（像素中心）与三条边求交，得到该行的覆盖区间
+        const float yc = y + 0.5f;
+        float left = 1e30f;
+        float right = -1e30f;
+        for (int i = 0; i < 3; ++i) {
+            int j = (i + 1) % 3;
+            float ya = tri.y[i];
+            float yb = tri.y[j];
+            if ((ya <= yc && yc < yb) || (yb <= yc && yc < ya)) {
+                float x = tri.x[i] + (yc - ya) / (yb - ya) * (tri.x[j] - tri.x[i]);
+                left = std::min(left, x);
+                right = std::max(right, x);
+            }
+        }
+        if (left > right) {
+            continue;
+        }
+        left = std::max(left, static_cast<float>(x0) - 1.0f);
+        right = std::min(right, static_cast<float>(x1) + 1.0f);
+        const int col_begin = std::max({x0, tri.min_x, static_cast<int>(std::ceil(left - 0.5f))});
+        const int col_end = std::min({x1 - 1, tri.max_x, static_cast<int>(std::ceil(right - 0.5f)) - 1});
+        if (col_begin > col_end) {
+            continue;
+        }
+
+        const size_t row_offset = static_cast<size_t>(y) * model_.width;
+        uint8_t* rgb = &fb.rgb[(row_offset + col_begin) * 3];
+        if (!tri.depth_test) {
+            for (int x = col_begin; x <= col_end; ++x, rgb += 3) {
+                rgb[0] = tri.color.r;
+                rgb[1] = tri.color.g;
+                rgb[2] = tri.color.b;
+            }
+            continue;
+        }
+        float* depth = &fb.depth[row_offset];
+        float w = tri.depth_c + tri.depth_dx * (col_begin + 0.5f) + tri.depth_dy * yc;
+        for (int x = col_begin; x <= col_end; ++x, rgb += 3, w += tri.depth_dx) {
+            if (w > depth[x]) {
+                depth[x] = w;
+                rgb[0] = tri.color.r;
+                rgb[1] = tri.color.g;
+                rgb[2] = tri.color.b;
+            }
+        }
+    }
+}
+
+void CameraRenderer::WorkerLoop() {
+    uint64_t seen_generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [&] { return stop_ || generation_ != seen_generation; });
+            if (stop_) return;
+            seen_generation = generation_;
+        }
+        RasterizeTiles();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--busy_workers_ == 0) {
+                done_cv_.notify_one();
+            }
+        }
+    }
+}
@@ -0,0 +1,177 @@
+/*
+ * @Desc: 相机仿真渲染器 - 针孔相机投影真值障碍物、地面和车道线，分块扫描线光栅化 + 深度缓冲，多线程并行
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include <common_msgs/map_data.pb.h>
+#include <common_msgs/visualizer_data.pb.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 针孔相机参数（车辆坐标系：x 向前，y 向左，z 向上）
+ */
+struct CameraModel {
+    int width = 640;            // 图像宽度 (px)
+    int height = 480;           // 图像高度 (px)
+    float fov = 60.0f;          // 水平视场角 (degrees)
+    float max_distance = 80.0f; // 远裁剪距离 (m)
+    float pos_x = 2.0f;         // 安装位置相对于车辆中心的纵向偏移 (m)
+    float pos_y = 0.0f;         // 横向偏移 (m)
+    float pos_z = 1.5f;         // 安装高度 (m)
+    float yaw = 0.0f;           // 安装朝向，相对车头逆时针为正 (degrees)：0 前视，90 左视，180 后视
+};
+
+/**
+ * @brief 渲染目标：RGB 图像 + 深度缓冲
+ */
+struct FrameBuffer {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> rgb;  // RGB888，行优先
+    std::vector<float> depth;  // 1/深度，0 表示无穷远（越大越近）
+
+    // 以下由调用方在渲染后填写
+    uint64_t sequence = 0;                // 渲染序号
+    int64_t timestamp = 0;                // 渲染完成时间 (ms)
+    int32_t frame_id = 0;                 // 所依据的真值帧号
+    uint64_t sync_sequence = 0;           // 多相机帧同步：渲染周期序号
+    int sync_group_size = 0;              // 该周期一起渲染的相机数
+    int64_t sync_timestamp = 0;           // 该周期开始时间 (ms)
+    bool has_trace = false;
+    senseauto::demo::TraceContext trace;  // 链路追踪上下文（来自所依据的真值帧）
+
+    void Resize(int w, int h);
+};
+
+/**
+ * @brief 固定容量的帧缓冲池
+ * @details 缓冲区在构造时一次性分配，之后循环使用；Acquire() 只返回没有被其他地方持有的缓冲区
+ *          （例如还在发布线程手里的上一帧），全部被占用时返回 nullptr，由调用方跳过本帧。
+ *          Acquire() 只能由同一个线程调用。
+ */
+class FrameBufferPool {
+public:
+    FrameBufferPool(size_t capacity, int width, int height);
+
+    std::shared_ptr<FrameBuffer> Acquire();
+
+private:
+    std::vector<std::shared_ptr<FrameBuffer>> buffers_;
+    size_t next_ = 0;
+};
+
+/**
+ * @brief 分块扫描线光栅化渲染器
+ * @details 每帧分两个阶段：
+ *          1. 几何阶段（调用线程）：障碍物（带朝向的长方体）、车道路面和边界线变换到相机坐标系，
+ *             近平面裁剪后投影成屏幕三角形，按包围盒分配到各个图块（tile）的列表里；
+ *          2. 光栅化阶段（工作线程 + 调用线程）：按图块并行，每个线程原子地领取下一个图块，
+ *             先按地平线清屏（天空 / 地面），再按提交顺序逐个扫描线填充该图块内的三角形。
+ *             图块之间互不重叠，颜色和深度缓冲不需要加锁。
+ *
+ *          地面层（路面、车道线）总在障碍物后方，按提交顺序覆盖、不做深度测试；
+ *          障碍物之间按 1/深度 做深度测试。
+ *          三角形和图块列表在帧之间复用，稳定后每帧不产生堆分配。
+ */
+class CameraRenderer {
+public:
+    /**
+     * @param model 相机参数
+     * @param num_threads 光栅化线程数（含调用线程），<= 0 时取 CPU 核数
+     */
+    CameraRenderer(const CameraModel& model, int num_threads);
+    ~CameraRenderer();
+
+    CameraRenderer(const CameraRenderer&) = delete;
+    CameraRenderer& operator=(const CameraRenderer&) = delete;
+
+    /**
+     * @brief 渲染一帧
+     * @param ground_truth 真值（自车位姿 + 障碍物）
+     * @param map 地图，没有时只画天空和地面
+     * @param out 渲染目标，尺寸按相机参数调整
+     */
+    void Render(const senseauto::demo::FrameData& ground_truth, const senseauto::demo::MapData* map,
+                FrameBuffer* out);
+
+    const CameraModel& model() const { return model_; }
+    int ThreadCount() const { return static_cast<int>(workers_.size()) + 1; }
+    size_t LastTriangleCount() const { return triangles_.size(); }
+
+private:
+    struct Vec3 {
+        float x, y, z;
+    };
+
+    struct Color {
+        uint8_t r, g, b;
+    };
+
+    // 屏幕空间三角形（像素坐标 + 1/深度平面方程），扫描线填充用
+    struct ScreenTriangle {
+        float x[3];
+        float y[3];
+        float depth_dx, depth_dy, depth_c;  // 1/深度 = depth_c + depth_dx * px + depth_dy * py
+        Color color;
+        bool depth_test;
+        int min_x, max_x, min_y, max_y;  // 裁剪到屏幕后的像素包围盒
+    };
+
+    static constexpr int kTileSize = 64;
+
+    // 几何阶段
+    Vec3 WorldToCamera(double wx, double wy, double wz) const;
+    void AddLane(const senseauto::demo::Lane& lane);
+    void AddPolylineStrip(const google::protobuf::RepeatedPtrField<senseauto::demo::Point3D>& points,
+                          double half_width, Color color);
+    void AddObstacle(const senseauto::demo::Obstacle& obs);
+    void AddQuad(const Vec3& a, const Vec3& b, const Vec3& c, const Vec3& d, Color color, bool depth_test);
+    void AddTriangle(const Vec3& a, const Vec3& b, const Vec3& c, Color color, bool depth_test);
+    void AddProjected(const Vec3& a, const Vec3& b, const Vec3& c, Color color, bool depth_test);
+
+    // 光栅化阶段
+    void RasterizeTiles();
+    void RasterizeTile(int tile_index);
+    void FillTriangle(const ScreenTriangle& tri, int x0, int y0, int x1, int y1);
+    void WorkerLoop();
+
+    CameraModel model_;
+    float focal_ = 0.0f;   // 焦距 (px)
+    float center_x_ = 0.0f;
+    float center_y_ = 0.0f;
+    float near_ = 0.1f;    // 近裁剪距离 (m)
+    double cos_yaw_ = 1.0;  // 安装朝向
+    double sin_yaw_ = 0.0;
+
+    // 当前帧的自车位姿
+    double car_x_ = 0.0;
+    double car_y_ = 0.0;
+    double cos_heading_ = 1.0;
+    double sin_heading_ = 0.0;
+
+    int tiles_x_ = 0;
+    int tiles_y_ = 0;
+    std::vector<ScreenTriangle> triangles_;
+    std::vector<std::vector<uint32_t>> tile_bins_;  // 每个图块内的三角形下标（按提交顺序）
+    FrameBuffer* target_ = nullptr;
+
+    // 光栅化工作线程
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_ = 0;  // 每帧加一，唤醒工作线程
+    int busy_workers_ = 0;
+    bool stop_ = false;
+    std::atomic<int> next_tile_{0};
+};
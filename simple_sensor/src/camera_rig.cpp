@@ -0,0 +1,216 @@
+/*
+ * @Desc: 多相机组实现
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#include "camera_rig.hpp"
+
+#include <simple_middleware/logger.hpp>
+#include <simple_middleware/trace.hpp>
+
+#include <algorithm>
+
+namespace {
+
+// 每路相机的帧缓冲池容量：渲染中 + 最新一组同步帧 + 发布线程正在发送的一组
+constexpr size_t kFramePoolSize = 3;
+// CameraFrameSet 池的初始容量：正在组装的一组 + 最新一组 + 发布线程正在发送的一组
+constexpr size_t kFrameSetPoolSize = 3;
+
+int64_t NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::chrono::nanoseconds PeriodFromRate(double rate_hz) {
+    return std::chrono::nanoseconds(static_cast<int64_t>(1e9 / std::max(rate_hz, 0.1)));
+}
+
+}  // namespace
+
+CameraChannel::CameraChannel(const CameraConfig& camera_config)
+    : config(camera_config),
+      topics(camera_config.name),
+      render_period(PeriodFromRate(camera_config.frame_rate)),
+      publish_period(PeriodFromRate(camera_config.publish_rate)) {}
+
+CameraRig::CameraRig(const std::vector<CameraConfig>& cameras, int render_threads) {
+    if (render_threads <= 0) {
+        render_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    const int camera_count = std::max(static_cast<int>(cameras.size()), 1);
+    const int threads_per_camera = std::max(1, render_threads / camera_count);
+
+    const auto now = std::chrono::steady_clock::now();
+    tick_period_ = std::chrono::seconds(10);
+    for (const auto& camera : cameras) {
+        auto channel = std::make_unique<CameraChannel>(camera);
+        channel->renderer = std::make_unique<CameraRenderer>(camera.model, threads_per_camera);
+        channel->pool = std::make_unique<FrameBufferPool>(kFramePoolSize, camera.model.width, camera.model.height);
+        channel->next_render = now;
+        channel->next_publish = now;
+        tick_period_ = std::min(tick_period_, channel->render_period);
+        channels_.push_back(std::move(channel));
+    }
+    pending_.reserve(channels_.size());
+    frame_sets_.reserve(kFrameSetPoolSize);
+    for (size_t i = 0; i < kFrameSetPoolSize; ++i) {
+        auto frame_set = std::make_shared<CameraFrameSet>();
+        frame_set->frames.resize(channels_.size());
+        frame_sets_.push_back(std::move(frame_set));
+    }
+
+    const int worker_count = std::min(camera_count, render_threads) - 1;
+    for (int i = 0; i < worker_count; ++i) {
+        workers_.emplace_back(&CameraRig::WorkerLoop, this);
+    }
+}
+
+CameraRig::~CameraRig() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+int CameraRig::RenderTick(const senseauto::demo::FrameData& ground_truth, const senseauto::demo::MapData* map,
+                          std::chrono::steady_clock::time_point now) {
+    // 1. 挑出到期的相机；落后超过一个周期时从当前时间重新计时，不补渲染
+    pending_.clear();
+    for (auto& channel : channels_) {
+        if (now < channel->next_render) {
+            continue;
+        }
+        channel->next_render += channel->render_period;
+        if (channel->next_render <= now) {
+            channel->next_render = now + channel->render_period;
+        }
+        pending_.push_back(channel.get());
+    }
+    if (pending_.empty()) {
+        return 0;
+    }
+
+    // 空闲的 CameraFrameSet 放掉对旧帧的引用，否则这些帧缓冲会一直显示为被占用
+    for (const auto& frame_set : frame_sets_) {
+        if (frame_set.use_count() == 1) {
+            std::fill(frame_set->frames.begin(), frame_set->frames.end(), nullptr);
+        }
+    }
+
+    ground_truth_ = &ground_truth;
+    map_ = map;
+    ++sync_sequence_;
+    sync_timestamp_ = NowMs();
+    next_pending_.store(0, std::memory_order_relaxed);
+
+    // 2. 调用线程和工作线程一起按相机领取任务（只有一路到期时不唤醒工作线程）
+    if (workers_.empty() || pending_.size() == 1) {
+        RenderPending();
+    } else {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_workers_ = static_cast<int>(workers_.size());
+            ++generation_;
+        }
+        start_cv_.notify_all();
+        RenderPending();
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [this] { return busy_workers_ == 0; });
+    }
+
+    ground_truth_ = nullptr;
+    map_ = nullptr;
+
+    // 3. 本周期渲染完成的帧替换进新的一组同步帧（从池里取，不分配），其余相机沿用上一帧
+    auto previous = latest_frames_.load();
+    std::shared_ptr<CameraFrameSet> frame_set = AcquireFrameSet();
+    if (previous) {
+        frame_set->frames = previous->frames;
+    }
+    previous.reset();
+    for (size_t i = 0; i < channels_.size(); ++i) {
+        if (channels_[i]->rendered) {
+            frame_set->frames[i] = std::move(channels_[i]->rendered);
+            channels_[i]->rendered.reset();
+        }
+    }
+    latest_frames_.publish(std::move(frame_set));
+    return static_cast<int>(pending_.size());
+}
+
+std::shared_ptr<CameraFrameSet> CameraRig::AcquireFrameSet() {
+    for (const auto& frame_set : frame_sets_) {
+        if (frame_set.use_count() == 1) {
+            // 只剩池子自己持有：快照和发布线程对它的读取已经在释放引用之前完成
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return frame_set;
+        }
+    }
+    // 发布线程同时持有多组（例如发布慢于渲染）时扩容，之后继续复用
+    auto frame_set = std::make_shared<CameraFrameSet>();
+    frame_set->frames.resize(channels_.size());
+    frame_sets_.push_back(frame_set);
+    LOG_EVERY_N(DEBUG, "Sensor", 10) << "Camera frame set pool grown to " << frame_sets_.size();
+    return frame_set;
+}
+
+void CameraRig::RenderPending() {
+    for (size_t index = next_pending_.fetch_add(1, std::memory_order_relaxed); index < pending_.size();
+         index = next_pending_.fetch_add(1, std::memory_order_relaxed)) {
+        RenderChannel(*pending_[index]);
+    }
+}
+
+void CameraRig::RenderChannel(CameraChannel& channel) {
+    // 取一块空闲的帧缓冲（发布线程还没发完的帧不会被覆盖）
+    std::shared_ptr<FrameBuffer> buffer = channel.pool->Acquire();
+    if (!buffer) {
+        LOG_EVERY_N(WARN, "Sensor", 30) << "Camera " << channel.config.name << ": all frame buffers busy, skipping";
+        return;
+    }
+
+    auto render_start = std::chrono::steady_clock::now();
+    channel.renderer->Render(*ground_truth_, map_, buffer.get());
+    channel.last_render_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - render_start).count();
+
+    buffer->sequence = ++channel.render_sequence;
+    buffer->timestamp = NowMs();
+    buffer->frame_id = ground_truth_->frame_id();
+    buffer->sync_sequence = sync_sequence_;
+    buffer->sync_group_size = static_cast<int>(pending_.size());
+    buffer->sync_timestamp = sync_timestamp_;
+    // 链路追踪：沿用生成这帧图像所依据的真值帧的上下文
+    buffer->has_trace = ground_truth_->has_trace();
+    if (buffer->has_trace) {
+        buffer->trace.CopyFrom(ground_truth_->trace());
+        simple_middleware::TraceStampStage(&buffer->trace, "sensor");
+    }
+
+    channel.rendered = std::move(buffer);
+}
+
+void CameraRig::WorkerLoop() {
+    uint64_t seen_generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [&] { return stop_ || generation_ != seen_generation; });
+            if (stop_) return;
+            seen_generation = generation_;
+        }
+        RenderPending();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--busy_workers_ == 0) {
+                done_cv_.notify_one();
+            }
+        }
+    }
+}
@@ -0,0 +1,141 @@
+/*
+ * @Desc: 多相机组 - 每路相机独立的参数、渲染器和帧缓冲池，同一周期到期的相机共享一份真值快照并行渲染
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include "camera_renderer.hpp"
+
+#include <simple_middleware/snapshot.hpp>
+#include <simple_middleware/camera_topics.hpp>
+#include <common_msgs/sensor_data.pb.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 一路相机的配置（config/sensor.json 的 cameras 数组中的一项）
+ */
+struct CameraConfig {
+    std::string name = "front";  // 相机名称，发布话题为 sensor/camera/<name>
+    CameraModel model;           // 分辨率、视场角、安装位置和朝向
+    double frame_rate = 30.0;    // 渲染帧率 (Hz)
+    double publish_rate = 1.0;   // 发布帧率 (Hz)：原始 RGB 图像很大，按传输带宽单独限速
+};
+
+/**
+ * @brief 一路相机的运行时状态
+ */
+struct CameraChannel {
+    explicit CameraChannel(const CameraConfig& camera_config);
+
+    CameraConfig config;
+    // sensor/camera/<name> 和 .../chunk；话题描述符只引用其中的名字，CameraChannel 本身不可移动（由 CameraRig 用 unique_ptr 持有）
+    simple_middleware::CameraTopics topics;
+
+    // 渲染（CameraRig 内部使用）
+    std::unique_ptr<CameraRenderer> renderer;
+    std::unique_ptr<FrameBufferPool> pool;
+    std::chrono::nanoseconds render_period{0};
+    std::chrono::steady_clock::time_point next_render;
+    uint64_t render_sequence = 0;
+    int64_t last_render_us = 0;
+    std::shared_ptr<FrameBuffer> rendered;  // 本周期渲染完成的一帧，周期结束时并入 CameraFrameSet
+
+    // 发布（发布线程独占）：消息和缓冲区跨帧复用
+    std::chrono::nanoseconds publish_period{0};
+    std::chrono::steady_clock::time_point next_publish;
+    uint64_t published_sequence = 0;
+    senseauto::demo::CameraFrame frame_msg;
+    senseauto::demo::CameraFrame metadata_msg;
+    std::string serialized;
+    std::string metadata_serialized;
+};
+
+/**
+ * @brief 各相机最近渲染完成的一帧（下标与 CameraRig::channel() 一致，还没有渲染过的为空）
+ * @details 每个渲染周期结束后整体替换一次，发布线程一次 load() 拿到的各路画面总是来自同一时刻，
+ *          即使逐路发布期间渲染线程已经渲染了新的周期
+ */
+struct CameraFrameSet {
+    std::vector<std::shared_ptr<const FrameBuffer>> frames;
+};
+
+/**
+ * @brief 多相机组
+ * @details 渲染线程每个周期调用一次 RenderTick()：按各相机的帧率挑出本周期到期的相机，
+ *          调用线程和相机级工作线程原子地领取相机并渲染，全部渲染完成后才返回。
+ *          同一周期渲染的相机共享同一份真值快照，并带上相同的 sync_sequence / sync_timestamp，
+ *          订阅方据此把各路画面对齐成一组同步帧。帧率相同的相机总在同一周期渲染。
+ *
+ *          线程预算：render_threads（<= 0 时取 CPU 核数）在相机之间分配——
+ *          相机级工作线程数为 min(相机数, render_threads) - 1（调用线程也参与），
+ *          每路相机的渲染器内部再用 render_threads / 相机数 个线程做图块并行。
+ *          只有一路相机时退化为原来的单相机 + 图块并行。
+ */
+class CameraRig {
+public:
+    CameraRig(const std::vector<CameraConfig>& cameras, int render_threads);
+    ~CameraRig();
+
+    CameraRig(const CameraRig&) = delete;
+    CameraRig& operator=(const CameraRig&) = delete;
+
+    /**
+     * @brief 渲染本周期到期的相机
+     * @param ground_truth 真值快照（渲染期间只读）
+     * @param map 地图，没有时只画天空和地面
+     * @param now 本周期开始时间，用于判断各相机是否到期
+     * @return 本周期渲染的相机数
+     */
+    int RenderTick(const senseauto::demo::FrameData& ground_truth, const senseauto::demo::MapData* map,
+                   std::chrono::steady_clock::time_point now);
+
+    // 最近一组同步帧（只增加引用计数，不拷贝）
+    std::shared_ptr<const CameraFrameSet> LatestFrames() const { return latest_frames_.load(); }
+
+    size_t size() const { return channels_.size(); }
+    CameraChannel& channel(size_t index) { return *channels_[index]; }
+
+    // 渲染线程的周期：帧率最高的相机的周期
+    std::chrono::nanoseconds TickPeriod() const { return tick_period_; }
+    int WorkerCount() const { return static_cast<int>(workers_.size()) + 1; }
+
+private:
+    void RenderPending();
+    void RenderChannel(CameraChannel& channel);
+    void WorkerLoop();
+    // 取一个空闲的 CameraFrameSet（只由渲染线程调用，各路帧已在周期开始时清空）；都被占用时扩容
+    std::shared_ptr<CameraFrameSet> AcquireFrameSet();
+
+    std::vector<std::unique_ptr<CameraChannel>> channels_;
+    std::chrono::nanoseconds tick_period_{0};
+
+    // 当前周期（调用线程在派发前写好，工作线程只读）
+    const senseauto::demo::FrameData* ground_truth_ = nullptr;
+    const senseauto::demo::MapData* map_ = nullptr;
+    std::vector<CameraChannel*> pending_;
+    uint64_t sync_sequence_ = 0;
+    int64_t sync_timestamp_ = 0;
+    std::atomic<size_t> next_pending_{0};
+    simple_middleware::Snapshot<CameraFrameSet> latest_frames_;
+    // CameraFrameSet 池：与帧缓冲池相同，只复用没有被快照和发布线程持有的一组，稳定后每个周期不产生堆分配
+    std::vector<std::shared_ptr<CameraFrameSet>> frame_sets_;
+
+    // 相机级工作线程
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_ = 0;  // 每个周期加一，唤醒工作线程
+    int busy_workers_ = 0;
+    bool stop_ = false;
+};
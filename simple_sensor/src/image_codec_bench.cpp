@@ -0,0 +1,318 @@
+/*
+ * @Desc: 相机图像编解码基准测试 - rgb_delta_rle 的编码/解码吞吐和压缩率
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ *
+ * 用 CameraRenderer 渲染一段自车沿弯道行驶的画面（三条车道 + 前方车辆 / 行人 / 锥桶），
+ * 对每种分辨率分别测量逐帧编码、解码耗时（p50/p99），换算成原始 RGB 的 MB/s，
+ * 并与同样大小的 memcpy 对比；每帧都校验解码结果与原图逐字节一致。
+ * 额外跑一组随机噪声图像作为最坏情况（差分和游程都无效，压缩率略低于 1）。
+ *
+ * 使用方法：
+ *   ./image_codec_bench [--sizes 160x120,640x480,1280x720,1920x1080] [--frames 16] [--iterations 20]
+ *                       [--out image_codec_bench.json]
+ */
+
+#include "camera_renderer.hpp"
+#include <simple_middleware/image_codec.hpp>
+#include <simple_middleware/json_writer.hpp>
+#include <simple_middleware/latency_histogram.hpp>
+#include <simple_middleware/logger.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace simple_middleware;
+
+namespace {
+
+struct ImageSize {
+    int width = 0;
+    int height = 0;
+};
+
+struct BenchOptions {
+    std::vector<ImageSize> sizes{{160, 120}, {640, 480}, {1280, 720}, {1920, 1080}};
+    int frames = 16;
+    uint64_t iterations = 20;
+    std::string out = "image_codec_bench.json";
+};
+
+struct CaseResult {
+    std::string scene;  // rendered / noise
+    int width = 0;
+    int height = 0;
+    int frames = 0;
+    size_t raw_bytes = 0;      // 每帧原始 RGB 字节数
+    size_t encoded_bytes = 0;  // 每帧编码后的平均字节数
+    LatencySummary encode;
+    LatencySummary decode;
+    LatencySummary copy;  // 同样大小的 memcpy，作为内存带宽基线
+};
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 三条沿 x 方向缓慢弯曲的车道（车道宽 3.5m，中心车道 y = 0）
+void FillMap(senseauto::demo::MapData* map) {
+    const double lane_width = 3.5;
+    map->set_default_lane_width(lane_width);
+    for (int lane_index = -1; lane_index <= 1; ++lane_index) {
+        auto* lane = map->add_lanes();
+        lane->set_id(lane_index + 1);
+        lane->set_width(lane_width);
+        lane->set_type("curve");
+        for (double x = -20.0; x <= 400.0; x += 2.0) {
+            double y = lane_index * lane_width + 8.0 * std::sin(x / 60.0);
+            for (auto [points, offset] : {std::make_pair(lane->mutable_center_line(), 0.0),
+                                          std::make_pair(lane->mutable_left_boundary(), lane_width / 2),
+                                          std::make_pair(lane->mutable_right_boundary(), -lane_width / 2)}) {
+                auto* p = points->Add();
+                p->set_x(x);
+                p->set_y(y + offset);
+            }
+        }
+    }
+}
+
+// 第 index 帧：自车沿中心车道前进，障碍物散布在前方三条车道上
+void FillFrame(senseauto::demo::FrameData* frame, int index) {
+    const double car_x = index * 1.5;
+    auto* car = frame->mutable_car_state();
+    car->mutable_position()->set_x(car_x);
+    car->mutable_position()->set_y(8.0 * std::sin(car_x / 60.0));
+    car->set_heading(std::atan(8.0 / 60.0 * std::cos(car_x / 60.0)));
+    frame->set_frame_id(index);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> ahead(8.0, 90.0);
+    const char* types[] = {"car", "car", "pedestrian", "cone"};
+    for (int i = 0; i < 24; ++i) {
+        auto* obs = frame->add_obstacles();
+        double x = car_x + ahead(rng);
+        int lane = static_cast<int>(rng() % 3) - 1;
+        obs->set_id(i);
+        obs->set_type(types[i % 4]);
+        obs->mutable_position()->set_x(x);
+        obs->mutable_position()->set_y(lane * 3.5 + 8.0 * std::sin(x / 60.0));
+        obs->set_length(i % 4 < 2 ? 4.5 : 0.6);
+        obs->set_width(i % 4 < 2 ? 1.8 : 0.6);
+        obs->set_heading(car->heading());
+    }
+}
+
+template <typename Fn>
+LatencySummary Measure(const std::vector<std::vector<uint8_t>>& images, uint64_t iterations, Fn&& fn) {
+    for (const auto& image : images) {
+        fn(image);  // 热身：输出缓冲区长到稳定大小
+    }
+    LatencyHistogram histogram;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        for (const auto& image : images) {
+            int64_t t0 = NowNs();
+            fn(image);
+            histogram.record(static_cast<uint64_t>(NowNs() - t0));
+        }
+    }
+    return histogram.summary();
+}
+
+bool RunCase(const std::string& scene, const ImageSize& size, const std::vector<std::vector<uint8_t>>& images,
+             uint64_t iterations, CaseResult* result) {
+    CaseResult& r = *result;
+    r.scene = scene;
+    r.width = size.width;
+    r.height = size.height;
+    r.frames = static_cast<int>(images.size());
+    r.raw_bytes = images.front().size();
+
+    // 先逐帧校验往返一致性并统计压缩后大小
+    std::string encoded;
+    std::string decoded;
+    size_t total_encoded = 0;
+    for (size_t i = 0; i < images.size(); ++i) {
+        const auto& image = images[i];
+        ImageEncode(image.data(), size.width, size.height, &encoded);
+        total_encoded += encoded.size();
+        if (!ImageDecode(encoded, size.width, size.height, &decoded) || decoded.size() != image.size()
+            || std::memcmp(decoded.data(), image.data(), image.size()) != 0) {
+            LOG_ERROR("ImageCodecBench") << scene << " " << size.width << "x" << size.height << " frame " << i
+                << ": 解码结果与原图不一致";
+            return false;
+        }
+    }
+    r.encoded_bytes = total_encoded / images.size();
+
+    // 解码输入：每帧各自的编码结果
+    std::vector<std::string> encoded_frames(images.size());
+    for (size_t i = 0; i < images.size(); ++i) {
+        ImageEncode(images[i].data(), size.width, size.height, &encoded_frames[i]);
+    }
+
+    r.encode = Measure(images, iterations, [&](const std::vector<uint8_t>& image) {
+        ImageEncode(image.data(), size.width, size.height, &encoded);
+    });
+    size_t next = 0;
+    r.decode = Measure(images, iterations, [&](const std::vector<uint8_t>&) {
+        ImageDecode(encoded_frames[next], size.width, size.height, &decoded);
+        next = (next + 1) % encoded_frames.size();
+    });
+    std::vector<uint8_t> copy(r.raw_bytes);
+    r.copy = Measure(images, iterations, [&](const std::vector<uint8_t>& image) {
+        std::memcpy(copy.data(), image.data(), image.size());
+    });
+    return true;
+}
+
+double MegabytesPerSecond(size_t bytes, uint64_t ns) {
+    return ns > 0 ? static_cast<double>(bytes) * 1e3 / static_cast<double>(ns) : 0.0;
+}
+
+std::vector<ImageSize> ParseSizes(const std::string& value) {
+    std::vector<ImageSize> out;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t x = item.find('x');
+        if (x != std::string::npos) {
+            out.push_back({std::stoi(item.substr(0, x)), std::stoi(item.substr(x + 1))});
+        }
+    }
+    return out;
+}
+
+void PrintUsage() {
+    std::cerr << "Usage: image_codec_bench [--sizes 160x120,640x480,1280x720,1920x1080] [--frames N]"
+                 " [--iterations N] [--out FILE|-]\n";
+}
+
+bool ParseArgs(int argc, char* argv[], BenchOptions* options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--sizes") {
+            options->sizes = ParseSizes(value);
+        } else if (arg == "--frames") {
+            options->frames = std::max(1, std::stoi(value));
+        } else if (arg == "--iterations") {
+            options->iterations = std::stoull(value);
+        } else if (arg == "--out") {
+            options->out = value;
+        } else {
+            return false;
+        }
+    }
+    return !options->sizes.empty();
+}
+
+void WriteResult(JsonWriter& w, const CaseResult& r) {
+    w.beginObject();
+    w.field("scene", r.scene);
+    w.field("width", r.width);
+    w.field("height", r.height);
+    w.field("frames", r.frames);
+    w.field("raw_bytes", r.raw_bytes);
+    w.field("encoded_bytes", r.encoded_bytes);
+    w.field("ratio", static_cast<double>(r.raw_bytes) / std::max<size_t>(r.encoded_bytes, 1));
+    w.field("encode_p50_ns", r.encode.p50);
+    w.field("encode_p99_ns", r.encode.p99);
+    w.field("encode_mb_s", MegabytesPerSecond(r.raw_bytes, r.encode.p50));
+    w.field("decode_p50_ns", r.decode.p50);
+    w.field("decode_p99_ns", r.decode.p99);
+    w.field("decode_mb_s", MegabytesPerSecond(r.raw_bytes, r.decode.p50));
+    w.field("memcpy_mb_s", MegabytesPerSecond(r.raw_bytes, r.copy.p50));
+    w.endObject();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!ParseArgs(argc, argv, &options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    senseauto::demo::MapData map;
+    FillMap(&map);
+
+    std::vector<CaseResult> results;
+    for (const ImageSize& size : options.sizes) {
+        CameraModel model;
+        model.width = size.width;
+        model.height = size.height;
+        CameraRenderer renderer(model, 0);
+
+        std::vector<std::vector<uint8_t>> rendered;
+        FrameBuffer buffer;
+        for (int i = 0; i < options.frames; ++i) {
+            senseauto::demo::FrameData frame;
+            FillFrame(&frame, i);
+            renderer.Render(frame, &map, &buffer);
+            rendered.push_back(buffer.rgb);
+        }
+
+        std::vector<std::vector<uint8_t>> noise(std::min(options.frames, 4));
+        std::mt19937 rng(42);
+        for (auto& image : noise) {
+            image.resize(rendered.front().size());
+            for (auto& byte : image) {
+                byte = static_cast<uint8_t>(rng());
+            }
+        }
+
+        for (auto [scene, images] : {std::make_pair("rendered", &rendered), std::make_pair("noise", &noise)}) {
+            CaseResult r;
+            if (!RunCase(scene, size, *images, options.iterations, &r)) {
+                return 1;
+            }
+            LOG_INFO("ImageCodecBench") << r.scene << " " << r.width << "x" << r.height << ": " << r.raw_bytes
+                << " -> " << r.encoded_bytes << " bytes (ratio " << static_cast<double>(r.raw_bytes)
+                / std::max<size_t>(r.encoded_bytes, 1) << "), encode " << MegabytesPerSecond(r.raw_bytes, r.encode.p50)
+                << " MB/s, decode " << MegabytesPerSecond(r.raw_bytes, r.decode.p50) << " MB/s, memcpy "
+                << MegabytesPerSecond(r.raw_bytes, r.copy.p50) << " MB/s";
+            results.push_back(r);
+        }
+    }
+
+    std::string report_json;
+    JsonWriter w(&report_json);
+    w.beginObject();
+    w.field("benchmark", "image_codec_bench");
+    w.field("timestamp", static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count()));
+    w.field("format", kImageFormatDeltaRle);
+    w.key("results");
+    w.beginArray();
+    for (const auto& r : results) {
+        WriteResult(w, r);
+    }
+    w.endArray();
+    w.endObject();
+
+    if (options.out == "-") {
+        std::cout << report_json << std::endl;
+    } else {
+        std::ofstream out_file(options.out);
+        if (!out_file) {
+            LOG_ERROR("ImageCodecBench") << "无法写入结果文件: " << options.out;
+            return 1;
+        }
+        out_file << report_json << std::endl;
+        LOG_INFO("ImageCodecBench") << "结果已写入 " << options.out << "（" << results.size() << " 个用例）";
+    }
+    return 0;
+}
@@ -0,0 +1,234 @@
+/*
+ * @Desc: 激光雷达仿真基准测试 - BVH + 光线包 vs 逐条光线遍历所有障碍物
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ *
+ * 自车位于原点附近，障碍物（车辆 / 行人 / 锥桶）按固定伪随机种子散布在 80m 半径内。
+ * 对每组（线数, 障碍物数）分别用 LidarSimulator::Scan 和 ScanBruteForce 扫描同一帧真值，
+ * 比较单帧耗时（p50/p99）和点数（两种实现的点数必须一致）。
+ *
+ * 使用方法：
+ *   ./lidar_bench [--channels 32,64,128] [--obstacles 10,100,1000] [--iterations 50] [--out lidar_bench.json]
+ *
+ * 暴力遍历的迭代次数按障碍物数缩减，保证大负载用例耗时可控。
+ */
+
+#include "lidar_simulator.hpp"
+#include <simple_middleware/json_writer.hpp>
+#include <simple_middleware/latency_histogram.hpp>
+#include <simple_middleware/logger.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace simple_middleware;
+
+namespace {
+
+struct BenchOptions {
+    std::vector<int> channels{32, 64, 128};
+    std::vector<int> obstacles{10, 100, 1000};
+    uint64_t iterations = 50;
+    int azimuth_steps = 1800;
+    std::string out = "lidar_bench.json";
+};
+
+struct CaseResult {
+    std::string method;  // bvh / brute_force
+    int channels = 0;
+    int obstacles = 0;
+    uint64_t iterations = 0;
+    size_t rays = 0;
+    size_t points = 0;
+    size_t bvh_nodes = 0;
+    LatencySummary latency;
+};
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void FillFrame(senseauto::demo::FrameData* frame, int obstacle_count) {
+    auto* car = frame->mutable_car_state();
+    car->mutable_position()->set_x(5.0);
+    car->mutable_position()->set_y(-2.0);
+    car->set_heading(0.3);
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> radius(4.0, 80.0);
+    std::uniform_real_distribution<double> angle(-3.14159, 3.14159);
+    const char* types[] = {"car", "pedestrian", "cone"};
+    for (int i = 0; i < obstacle_count; ++i) {
+        auto* obs = frame->add_obstacles();
+        double r = radius(rng);
+        double a = angle(rng);
+        obs->set_id(i);
+        obs->set_type(types[i % 3]);
+        obs->mutable_position()->set_x(car->position().x() + r * std::cos(a));
+        obs->mutable_position()->set_y(car->position().y() + r * std::sin(a));
+        obs->set_length(i % 3 == 0 ? 4.5 : 0.6);
+        obs->set_width(i % 3 == 0 ? 1.8 : 0.6);
+        obs->set_heading(angle(rng));
+    }
+}
+
+template <typename Fn>
+CaseResult RunCase(const std::string& method, int channels, int obstacles, uint64_t iterations, Fn&& scan) {
+    CaseResult r;
+    r.method = method;
+    r.channels = channels;
+    r.obstacles = obstacles;
+    r.iterations = iterations;
+
+    scan();  // 热身：点云、BVH 容器长到稳定大小
+    LatencyHistogram histogram;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        int64_t t0 = NowNs();
+        scan();
+        histogram.record(static_cast<uint64_t>(NowNs() - t0));
+    }
+    r.latency = histogram.summary();
+    return r;
+}
+
+std::vector<int> ParseIntList(const std::string& value) {
+    std::vector<int> out;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(std::stoi(item));
+    }
+    return out;
+}
+
+void PrintUsage() {
+    std::cerr << "Usage: lidar_bench [--channels 32,64,128] [--obstacles 10,100,1000] [--azimuth-steps N]"
+                 " [--iterations N] [--out FILE|-]\n";
+}
+
+bool ParseArgs(int argc, char* argv[], BenchOptions* options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--channels") {
+            options->channels = ParseIntList(value);
+        } else if (arg == "--obstacles") {
+            options->obstacles = ParseIntList(value);
+        } else if (arg == "--azimuth-steps") {
+            options->azimuth_steps = std::stoi(value);
+        } else if (arg == "--iterations") {
+            options->iterations = std::stoull(value);
+        } else if (arg == "--out") {
+            options->out = value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void WriteResult(JsonWriter& w, const CaseResult& r) {
+    w.beginObject();
+    w.field("method", r.method);
+    w.field("channels", r.channels);
+    w.field("obstacles", r.obstacles);
+    w.field("iterations", r.iterations);
+    w.field("rays", r.rays);
+    w.field("points", r.points);
+    w.field("bvh_nodes", r.bvh_nodes);
+    w.field("p50_ns", r.latency.p50);
+    w.field("p99_ns", r.latency.p99);
+    w.field("max_ns", r.latency.max);
+    w.endObject();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!ParseArgs(argc, argv, &options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::vector<CaseResult> results;
+    for (int channels : options.channels) {
+        LidarModel model;
+        model.channels = channels;
+        model.azimuth_steps = options.azimuth_steps;
+        LidarSimulator lidar(model);
+
+        for (int obstacles : options.obstacles) {
+            senseauto::demo::FrameData frame;
+            FillFrame(&frame, obstacles);
+            std::vector<LidarPoint> points;
+
+            CaseResult bvh = RunCase("bvh", channels, obstacles, options.iterations, [&] {
+                lidar.Scan(frame, &points);
+            });
+            bvh.rays = lidar.RayCount();
+            bvh.points = points.size();
+            bvh.bvh_nodes = lidar.LastNodeCount();
+
+            uint64_t brute_iterations = std::max<uint64_t>(3, options.iterations * 10 / std::max(obstacles, 10));
+            CaseResult brute = RunCase("brute_force", channels, obstacles, brute_iterations, [&] {
+                lidar.ScanBruteForce(frame, &points);
+            });
+            brute.rays = lidar.RayCount();
+            brute.points = points.size();
+
+            if (bvh.points != brute.points) {
+                LOG_ERROR("LidarBench") << "channels=" << channels << " obstacles=" << obstacles
+                    << ": 点数不一致 bvh=" << bvh.points << " brute_force=" << brute.points;
+                return 1;
+            }
+            for (const CaseResult* r : {&bvh, &brute}) {
+                LOG_INFO("LidarBench") << "channels=" << r->channels << " obstacles=" << r->obstacles << " "
+                    << r->method << ": p50=" << r->latency.p50 / 1e6 << "ms p99=" << r->latency.p99 / 1e6
+                    << "ms, " << r->points << " points / " << r->rays << " rays";
+                results.push_back(*r);
+            }
+            LOG_INFO("LidarBench") << "channels=" << channels << " obstacles=" << obstacles << " speedup(p50)="
+                << static_cast<double>(brute.latency.p50) / std::max<uint64_t>(bvh.latency.p50, 1) << "x";
+        }
+    }
+
+    std::string report_json;
+    JsonWriter w(&report_json);
+    w.beginObject();
+    w.field("benchmark", "lidar_bench");
+    w.field("timestamp", static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count()));
+    w.field("azimuth_steps", options.azimuth_steps);
+    w.key("results");
+    w.beginArray();
+    for (const auto& r : results) {
+        WriteResult(w, r);
+    }
+    w.endArray();
+    w.endObject();
+
+    if (options.out == "-") {
+        std::cout << report_json << std::endl;
+    } else {
+        std::ofstream out_file(options.out);
+        if (!out_file) {
+            LOG_ERROR("LidarBench") << "无法写入结果文件: " << options.out;
+            return 1;
+        }
+        out_file << report_json << std::endl;
+        LOG_INFO("LidarBench") << "结果已写入 " << options.out << "（" << results.size() << " 个用例）";
+    }
+    return 0;
+}
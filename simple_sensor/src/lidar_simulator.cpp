@@ -0,0 +1,431 @@
+/*
+ * @Desc: 激光雷达仿真实现
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#include "lidar_simulator.hpp"
+#include <common_msgs/obstacle_model.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+// ---------------- 4 路浮点向量（x86 上用 SSE，其他平台退化为标量循环） ----------------
+#if defined(__SSE2__)
+struct F4 {
+    __m128 v;
+};
+struct M4 {
+    __m128 v;
+};
+
+inline F4 Load(const float* p) { return {_mm_load_ps(p)}; }
+inline void Store(float* p, F4 a) { _mm_store_ps(p, a.v); }
+inline F4 Set(float x) { return {_mm_set1_ps(x)}; }
+inline F4 operator+(F4 a, F4 b) { return {_mm_add_ps(a.v, b.v)}; }
+inline F4 operator-(F4 a, F4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline F4 operator*(F4 a, F4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline F4 Min(F4 a, F4 b) { return {_mm_min_ps(a.v, b.v)}; }
+inline F4 Max(F4 a, F4 b) { return {_mm_max_ps(a.v, b.v)}; }
+inline M4 Less(F4 a, F4 b) { return {_mm_cmplt_ps(a.v, b.v)}; }
+inline M4 LessEq(F4 a, F4 b) { return {_mm_cmple_ps(a.v, b.v)}; }
+inline M4 operator&(M4 a, M4 b) { return {_mm_and_ps(a.v, b.v)}; }
+inline F4 Select(M4 m, F4 a, F4 b) { return {_mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v))}; }
+inline int Bits(M4 m) { return _mm_movemask_ps(m.v); }
+// 1 / x；x 为 0 的分量按极小值处理，保证结果有限（slab 求交里不会出现 0 * inf = NaN）
+inline F4 SafeReciprocal(F4 x) {
+    __m128 zero = _mm_cmpeq_ps(x.v, _mm_setzero_ps());
+    __m128 safe = _mm_or_ps(_mm_and_ps(zero, _mm_set1_ps(1e-30f)), _mm_andnot_ps(zero, x.v));
+    return {_mm_div_ps(_mm_set1_ps(1.0f), safe)};
+}
+#else
+struct F4 {
+    float v[4];
+};
+struct M4 {
+    bool v[4];
+};
+
+template <typename Op>
+inline F4 Map(F4 a, F4 b, Op op) {
+    F4 r;
+    for (int i = 0; i < 4; ++i) r.v[i] = op(a.v[i], b.v[i]);
+    return r;
+}
+inline F4 Load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+inline void Store(float* p, F4 a) { std::copy(a.v, a.v + 4, p); }
+inline F4 Set(float x) { return {{x, x, x, x}}; }
+inline F4 operator+(F4 a, F4 b) { return Map(a, b, [](float x, float y) { return x + y; }); }
+inline F4 operator-(F4 a, F4 b) { return Map(a, b, [](float x, float y) { return x - y; }); }
+inline F4 operator*(F4 a, F4 b) { return Map(a, b, [](float x, float y) { return x * y; }); }
+inline F4 Min(F4 a, F4 b) { return Map(a, b, [](float x, float y) { return x < y ? x : y; }); }
+inline F4 Max(F4 a, F4 b) { return Map(a, b, [](float x, float y) { return x > y ? x : y; }); }
+inline M4 Less(F4 a, F4 b) { return {{a.v[0] < b.v[0], a.v[1] < b.v[1], a.v[2] < b.v[2], a.v[3] < b.v[3]}}; }
+inline M4 LessEq(F4 a, F4 b) { return {{a.v[0] <= b.v[0], a.v[1] <= b.v[1], a.v[2] <= b.v[2], a.v[3] <= b.v[3]}}; }
+inline M4 operator&(M4 a, M4 b) { return {{a.v[0] && b.v[0], a.v[1] && b.v[1], a.v[2] && b.v[2], a.v[3] && b.v[3]}}; }
+inline F4 Select(M4 m, F4 a, F4 b) {
+    F4 r;
+    for (int i = 0; i < 4; ++i) r.v[i] = m.v[i] ? a.v[i] : b.v[i];
+    return r;
+}
+inline int Bits(M4 m) { return m.v[0] | (m.v[1] << 1) | (m.v[2] << 2) | (m.v[3] << 3); }
+inline F4 SafeReciprocal(F4 x) {
+    F4 r;
+    for (int i = 0; i < 4; ++i) r.v[i] = 1.0f / (x.v[i] == 0.0f ? 1e-30f : x.v[i]);
+    return r;
+}
+#endif
+
+inline float SafeReciprocal(float x) {
+    return 1.0f / (x == 0.0f ? 1e-30f : x);
+}
+
+}  // namespace
+
+LidarSimulator::LidarSimulator(const LidarModel& model) : model_(model) {
+    model_.channels = std::max(model_.channels, 1);
+    model_.azimuth_steps = std::max(model_.azimuth_steps, 1);
+
+    const size_t ray_count = static_cast<size_t>(model_.channels) * model_.azimuth_steps;
+    dir_x_.resize(ray_count);
+    dir_y_.resize(ray_count);
+    dir_z_.resize(ray_count);
+    for (int ring = 0; ring < model_.channels; ++ring) {
+        double t = model_.channels > 1 ? static_cast<double>(ring) / (model_.channels - 1) : 0.0;
+        double elevation = (model_.min_elevation + (model_.max_elevation - model_.min_elevation) * t) * M_PI / 180.0;
+        for (int step = 0; step < model_.azimuth_steps; ++step) {
+            double azimuth = 2.0 * M_PI * step / model_.azimuth_steps;
+            size_t index = static_cast<size_t>(ring) * model_.azimuth_steps + step;
+            dir_x_[index] = static_cast<float>(std::cos(elevation) * std::cos(azimuth));
+            dir_y_[index] = static_cast<float>(std::cos(elevation) * std::sin(azimuth));
+            dir_z_[index] = static_cast<float>(std::sin(elevation));
+        }
+    }
+}
+
+void LidarSimulator::PrepareFrame(const senseauto::demo::FrameData& ground_truth) {
+    const auto& car = ground_truth.car_state();
+    cos_heading_ = static_cast<float>(std::cos(car.heading()));
+    sin_heading_ = static_cast<float>(std::sin(car.heading()));
+    origin_[0] = static_cast<float>(car.position().x() + model_.pos_x * cos_heading_ - model_.pos_y * sin_heading_);
+    origin_[1] = static_cast<float>(car.position().y() + model_.pos_x * sin_heading_ + model_.pos_y * cos_heading_);
+    origin_[2] = model_.pos_z;
+
+    boxes_.clear();
+    for (const auto& obs : ground_truth.obstacles()) {
+        Box box;
+        box.center_x = static_cast<float>(obs.position().x());
+        box.center_y = static_cast<float>(obs.position().y());
+        box.base_z = static_cast<float>(obs.position().z());
+        box.cos_heading = static_cast<float>(std::cos(obs.heading()));
+        box.sin_heading = static_cast<float>(std::sin(obs.heading()));
+        box.half_length = static_cast<float>(obstacle_model::Length(obs) / 2.0);
+        box.half_width = static_cast<float>(obstacle_model::Width(obs) / 2.0);
+        box.height = static_cast<float>(obstacle_model::Height(obs));
+        boxes_.push_back(box);
+    }
+    BuildBvh();
+}
+
+void LidarSimulator::BuildBvh() {
+    nodes_.clear();
+    box_order_.clear();
+    const uint32_t count = static_cast<uint32_t>(boxes_.size());
+    for (int axis = 0; axis < 3; ++axis) {
+        box_centroid_[axis].resize(count);
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        const Box& b = boxes_[i];
+        box_centroid_[0][i] = b.center_x;
+        box_centroid_[1][i] = b.center_y;
+        box_centroid_[2][i] = b.base_z + b.height / 2;
+        box_order_.push_back(i);
+    }
+    if (count == 0) {
+        return;
+    }
+    // 节点数最多 2n - 1，预留后递归构建时不会重新分配（可以安全地按下标回写）
+    nodes_.reserve(2 * static_cast<size_t>(count));
+    BuildNode(0, count);
+}
+
+uint32_t LidarSimulator::BuildNode(uint32_t first, uint32_t count) {
+    const uint32_t index = static_cast<uint32_t>(nodes_.size());
+    nodes_.push_back(BvhNode{});
+
+    BvhNode node;
+    float cmin[3] = {1e30f, 1e30f, 1e30f};
+    float cmax[3] = {-1e30f, -1e30f, -1e30f};
+    for (int axis = 0; axis < 3; ++axis) {
+        node.min[axis] = 1e30f;
+        node.max[axis] = -1e30f;
+    }
+    for (uint32_t k = first; k < first + count; ++k) {
+        const Box& b = boxes_[box_order_[k]];
+        // 带朝向长方体的轴对齐包围盒
+        float ext_x = std::fabs(b.cos_heading) * b.half_length + std::fabs(b.sin_heading) * b.half_width;
+        float ext_y = std::fabs(b.sin_heading) * b.half_length + std::fabs(b.cos_heading) * b.half_width;
+        node.min[0] = std::min(node.min[0], b.center_x - ext_x);
+        node.max[0] = std::max(node.max[0], b.center_x + ext_x);
+        node.min[1] = std::min(node.min[1], b.center_y - ext_y);
+        node.max[1] = std::max(node.max[1], b.center_y + ext_y);
+        node.min[2] = std::min(node.min[2], b.base_z);
+        node.max[2] = std::max(node.max[2], b.base_z + b.height);
+        for (int axis = 0; axis < 3; ++axis) {
+            cmin[axis] = std::min(cmin[axis], box_centroid_[axis][box_order_[k]]);
+            cmax[axis] = std::max(cmax[axis], box_centroid_[axis][box_order_[k]]);
+        }
+    }
+
+    if (count <= static_cast<uint32_t>(kLeafSize)) {
+        node.first = first;
+        node.count = count;
+        nodes_[index] = node;
+        return index;
+    }
+
+    // 按质心分布最宽的轴取中位数二分
+    int axis = 0;
+    for (int a = 1; a < 3; ++a) {
+        if (cmax[a] - cmin[a] > cmax[axis] - cmin[axis]) axis = a;
+    }
+    const uint32_t half = count / 2;
+    const std::vector<float>& centroid = box_centroid_[axis];
+    std::nth_element(box_order_.begin() + first, box_order_.begin() + first + half,
+                     box_order_.begin() + first + count,
+                     [&centroid](uint32_t a, uint32_t b) { return centroid[a] < centroid[b]; });
+
+    // 左子节点紧随当前节点（index + 1），右子节点下标记在 first 中
+    BuildNode(first, half);
+    node.first = BuildNode(first + half, count - half);
+    node.count = 0;
+    nodes_[index] = node;
+    return index;
+}
+
+void LidarSimulator::InitPacket(int ring, int first_step, RayPacket* packet) const {
+    for (int lane = 0; lane < kPacketSize; ++lane) {
+        int step = first_step + lane;
+        for (int axis = 0; axis < 3; ++axis) {
+            packet->origin[axis][lane] = origin_[axis];
+        }
+        if (step >= model_.azimuth_steps) {
+            // 补齐的空光线：最近距离为负，任何求交都不会命中
+            packet->dir[0][lane] = 1.0f;
+            packet->dir[1][lane] = 0.0f;
+            packet->dir[2][lane] = 0.0f;
+            for (int axis = 0; axis < 3; ++axis) {
+                packet->inv_dir[axis][lane] = SafeReciprocal(packet->dir[axis][lane]);
+            }
+            packet->t_best[lane] = -1.0f;
+            packet->label[lane] = -1;
+            continue;
+        }
+
+        // 传感器坐标系 -> 世界坐标系（只绕 z 轴旋转）
+        size_t ray = static_cast<size_t>(ring) * model_.azimuth_steps + step;
+        float dx = cos_heading_ * dir_x_[ray] - sin_heading_ * dir_y_[ray];
+        float dy = sin_heading_ * dir_x_[ray] + cos_heading_ * dir_y_[ray];
+        float dz = dir_z_[ray];
+        packet->dir[0][lane] = dx;
+        packet->dir[1][lane] = dy;
+        packet->dir[2][lane] = dz;
+        packet->inv_dir[0][lane] = SafeReciprocal(dx);
+        packet->inv_dir[1][lane] = SafeReciprocal(dy);
+        packet->inv_dir[2][lane] = SafeReciprocal(dz);
+
+        // 地面（z = 0）作为初始最近命中
+        packet->t_best[lane] = model_.max_range;
+        packet->label[lane] = -1;
+        if (dz < 0.0f) {
+            float t = -origin_[2] / dz;
+            if (t <= model_.max_range) {
+                packet->t_best[lane] = t;
+                packet->label[lane] = kLabelGround;
+            }
+        }
+    }
+}
+
+void LidarSimulator::TracePacket(RayPacket* packet) {
+    if (nodes_.empty()) {
+        return;
+    }
+    stack_.clear();
+    stack_.push_back(0);
+    while (!stack_.empty()) {
+        const uint32_t index = stack_.back();
+        stack_.pop_back();
+        const BvhNode& node = nodes_[index];
+
+        // 包内任意一条光线在当前最近距离之内穿过节点包围盒，才继续往下
+        int hit_bits = 0;
+        for (int half = 0; half < kPacketSize; half += 4) {
+            F4 t_near = Set(0.0f);
+            F4 t_far = Load(packet->t_best + half);
+            for (int axis = 0; axis < 3; ++axis) {
+                F4 origin = Load(packet->origin[axis] + half);
+                F4 inv = Load(packet->inv_dir[axis] + half);
+                F4 t0 = (Set(node.min[axis]) - origin) * inv;
+                F4 t1 = (Set(node.max[axis]) - origin) * inv;
+                t_near = Max(t_near, Min(t0, t1));
+                t_far = Min(t_far, Max(t0, t1));
+            }
+            hit_bits |= Bits(LessEq(t_near, t_far));
+        }
+        if (hit_bits == 0) {
+            continue;
+        }
+
+        if (node.count > 0) {
+            IntersectBoxes(node, packet);
+        } else {
+            stack_.push_back(node.first);
+            stack_.push_back(index + 1);
+        }
+    }
+}
+
+void LidarSimulator::IntersectBoxes(const BvhNode& leaf, RayPacket* packet) const {
+    for (uint32_t k = leaf.first; k < leaf.first + leaf.count; ++k) {
+        const Box& b = boxes_[box_order_[k]];
+        const F4 c = Set(b.cos_heading);
+        const F4 s = Set(b.sin_heading);
+        for (int half = 0; half < kPacketSize; half += 4) {
+            // 光线变换到长方体局部坐标系（平移到底面中心，再旋转 -heading）
+            F4 ox = Load(packet->origin[0] + half) - Set(b.center_x);
+            F4 oy = Load(packet->origin[1] + half) - Set(b.center_y);
+            F4 oz = Load(packet->origin[2] + half) - Set(b.base_z);
+            F4 dx = Load(packet->dir[0] + half);
+            F4 dy = Load(packet->dir[1] + half);
+            F4 local_ox = c * ox + s * oy;
+            F4 local_oy = c * oy - s * ox;
+            F4 inv_x = SafeReciprocal(c * dx + s * dy);
+            F4 inv_y = SafeReciprocal(c * dy - s * dx);
+            F4 inv_z = Load(packet->inv_dir[2] + half);
+
+            // slab 法：三对平行面的进入距离取最大、离开距离取最小
+            F4 t_best = Load(packet->t_best + half);
+            F4 t0 = (Set(-b.half_length) - local_ox) * inv_x;
+            F4 t1 = (Set(b.half_length) - local_ox) * inv_x;
+            F4 t_near = Max(Set(0.0f), Min(t0, t1));
+            F4 t_far = Min(t_best, Max(t0, t1));
+            t0 = (Set(-b.half_width) - local_oy) * inv_y;
+            t1 = (Set(b.half_width) - local_oy) * inv_y;
+            t_near = Max(t_near, Min(t0, t1));
+            t_far = Min(t_far, Max(t0, t1));
+            t0 = (Set(0.0f) - oz) * inv_z;
+            t1 = (Set(b.height) - oz) * inv_z;
+            t_near = Max(t_near, Min(t0, t1));
+            t_far = Min(t_far, Max(t0, t1));
+
+            M4 hit = LessEq(t_near, t_far) & Less(t_near, t_best);
+            int bits = Bits(hit);
+            if (bits == 0) {
+                continue;
+            }
+            Store(packet->t_best + half, Select(hit, t_near, t_best));
+            for (int lane = 0; lane < 4; ++lane) {
+                if (bits & (1 << lane)) {
+                    packet->label[half + lane] = kLabelObstacle;
+                }
+            }
+        }
+    }
+}
+
+void LidarSimulator::EmitPacket(const RayPacket& packet, int ring, int first_step,
+                                std::vector<LidarPoint>* points) const {
+    for (int lane = 0; lane < kPacketSize; ++lane) {
+        int step = first_step + lane;
+        if (step >= model_.azimuth_steps) {
+            break;
+        }
+        EmitPoint(ring * model_.azimuth_steps + step, packet.t_best[lane], packet.label[lane], points);
+    }
+}
+
+void LidarSimulator::EmitPoint(int ray, float t, int label, std::vector<LidarPoint>* points) const {
+    if (label < 0 || t < model_.min_range) {
+        return;
+    }
+    // 强度：障碍物反射较强，地面按入射角变化，都随距离衰减
+    float falloff = 1.0f - 0.6f * t / model_.max_range;
+    float base = label == kLabelObstacle ? 220.0f : 60.0f + 120.0f * std::fabs(dir_z_[ray]);
+    LidarPoint point;
+    point.x = t * dir_x_[ray];
+    point.y = t * dir_y_[ray];
+    point.z = t * dir_z_[ray];
+    point.ring = static_cast<uint16_t>(ray / model_.azimuth_steps);
+    point.intensity = static_cast<uint8_t>(std::clamp(base * falloff, 0.0f, 255.0f));
+    point.label = static_cast<uint8_t>(label);
+    points->push_back(point);
+}
+
+void LidarSimulator::Scan(const senseauto::demo::FrameData& ground_truth, std::vector<LidarPoint>* points) {
+    PrepareFrame(ground_truth);
+    points->clear();
+    RayPacket packet;
+    for (int ring = 0; ring < model_.channels; ++ring) {
+        for (int step = 0; step < model_.azimuth_steps; step += kPacketSize) {
+            InitPacket(ring, step, &packet);
+            TracePacket(&packet);
+            EmitPacket(packet, ring, step, points);
+        }
+    }
+}
+
+void LidarSimulator::ScanBruteForce(const senseauto::demo::FrameData& ground_truth,
+                                    std::vector<LidarPoint>* points) {
+    PrepareFrame(ground_truth);
+    points->clear();
+    RayPacket packet;  // 只用来复用 InitPacket 的光线生成和地面求交
+    for (int ring = 0; ring < model_.channels; ++ring) {
+        for (int step = 0; step < model_.azimuth_steps; step += kPacketSize) {
+            InitPacket(ring, step, &packet);
+            for (int lane = 0; lane < kPacketSize; ++lane) {
+                for (const Box& b : boxes_) {
+                    float ox = packet.origin[0][lane] - b.center_x;
+                    float oy = packet.origin[1][lane] - b.center_y;
+                    float oz = packet.origin[2][lane] - b.base_z;
+                    float dx = packet.dir[0][lane];
+                    float dy = packet.dir[1][lane];
+                    float local_ox = b.cos_heading * ox + b.sin_heading * oy;
+                    float local_oy = b.cos_heading * oy - b.sin_heading * ox;
+                    float inv_x = SafeReciprocal(b.cos_heading * dx + b.sin_heading * dy);
+                    float inv_y = SafeReciprocal(b.cos_heading * dy - b.sin_heading * dx);
+                    float inv_z = packet.inv_dir[2][lane];
+
+                    float t_best = packet.t_best[lane];
+                    float t0 = (-b.half_length - local_ox) * inv_x;
+                    float t1 = (b.half_length - local_ox) * inv_x;
+                    float t_near = std::max(0.0f, std::min(t0, t1));
+                    float t_far = std::min(t_best, std::max(t0, t1));
+                    t0 = (-b.half_width - local_oy) * inv_y;
+                    t1 = (b.half_width - local_oy) * inv_y;
+                    t_near = std::max(t_near, std::min(t0, t1));
+                    t_far = std::min(t_far, std::max(t0, t1));
+                    t0 = (0.0f - oz) * inv_z;
+                    t1 = (b.height - oz) * inv_z;
+                    t_near = std::max(t_near, std::min(t0, t1));
+                    t_far = std::min(t_far, std::max(t0, t1));
+                    if (t_near <= t_far && t_near < t_best) {
+                        packet.t_best[lane] = t_near;
+                        packet.label[lane] = kLabelObstacle;
+                    }
+                }
+            }
+            EmitPacket(packet, ring, step, points);
+        }
+    }
+}
@@ -0,0 +1,127 @@
+/*
+ * @Desc: 激光雷达仿真 - 按线束扫描模式从自车位姿发射光线，与障碍物长方体和地面求交，BVH 加速 + SoA 光线包 SIMD 求交
+ * @Author: JacksonZhou
+ * @Date: 2025/12/19
+ */
+
+#pragma once
+
+#include <common_msgs/visualizer_data.pb.h>
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 激光雷达参数（车辆坐标系：x 向前，y 向左，z 向上）
+ */
+struct LidarModel {
+    int channels = 32;             // 线数
+    int azimuth_steps = 1800;      // 每线水平采样数（1800 即 0.2° 分辨率）
+    float min_elevation = -25.0f;  // 最低光束俯仰角 (degrees)
+    float max_elevation = 15.0f;   // 最高光束俯仰角 (degrees)
+    float min_range = 0.5f;        // 最近有效距离 (m)，更近的回波视为车身遮挡
+    float max_range = 100.0f;      // 最远有效距离 (m)
+    float pos_x = 0.0f;            // 安装位置相对于车辆中心的纵向偏移 (m)
+    float pos_y = 0.0f;            // 横向偏移 (m)
+    float pos_z = 1.8f;            // 安装高度 (m)
+};
+
+/**
+ * @brief 打包后的点（与 PointCloud.data 的布局一致，16 字节）
+ */
+struct LidarPoint {
+    float x, y, z;      // 传感器坐标系 (m)
+    uint16_t ring;      // 线号（0 为最低的光束）
+    uint8_t intensity;  // 反射强度（按距离和入射角粗略模拟）
+    uint8_t label;      // kLabelGround / kLabelObstacle
+};
+static_assert(sizeof(LidarPoint) == 16, "LidarPoint must match PointCloud.point_step");
+
+/**
+ * @brief 激光雷达扫描仿真
+ * @details 每帧：
+ *          1. 由真值障碍物构建 BVH（轴对齐包围盒按质心中位数二分，叶子最多 kLeafSize 个长方体）；
+ *          2. 光线按 8 条一组打包（同一线束相邻的 8 个水平角），原点、方向、方向倒数和当前最近距离按 SoA 存放，
+ *             整包一起遍历 BVH：节点包围盒和叶子里的带朝向长方体都用 slab 法按 4 路 SIMD 求交，
+ *             包内没有任何光线命中节点时整个子树跳过；
+ *          3. 地面（z = 0 平面）解析求交，作为每条光线的初始最近距离。
+ *
+ *          光线方向在构造时按传感器坐标系预计算，每帧只绕 z 轴旋转到自车朝向；
+ *          BVH 节点、长方体和输出点的容器在帧之间复用，稳定后每帧不产生堆分配。非线程安全。
+ */
+class LidarSimulator {
+public:
+    static constexpr uint8_t kLabelGround = 0;
+    static constexpr uint8_t kLabelObstacle = 1;
+    static constexpr int kPacketSize = 8;
+    static constexpr int kLeafSize = 2;
+
+    explicit LidarSimulator(const LidarModel& model);
+
+    /**
+     * @brief 扫描一帧（BVH + 光线包）
+     * @param ground_truth 真值（自车位姿 + 障碍物）
+     * @param points 输出点云（传感器坐标系），按线号、水平角顺序，只包含有效回波
+     */
+    void Scan(const senseauto::demo::FrameData& ground_truth, std::vector<LidarPoint>* points);
+
+    /**
+     * @brief 逐条光线遍历所有障碍物（基准测试和正确性对照用）
+     */
+    void ScanBruteForce(const senseauto::demo::FrameData& ground_truth, std::vector<LidarPoint>* points);
+
+    const LidarModel& model() const { return model_; }
+    size_t RayCount() const { return dir_x_.size(); }
+    size_t LastNodeCount() const { return nodes_.size(); }
+
+private:
+    // 带朝向的长方体（世界坐标），底面在 base_z
+    struct Box {
+        float center_x, center_y, base_z;
+        float cos_heading, sin_heading;
+        float half_length, half_width, height;
+    };
+
+    // BVH 节点：count > 0 为叶子（box_order_[first, first + count)），否则左子节点紧随其后（下标 + 1），右子节点下标为 first
+    struct BvhNode {
+        float min[3];
+        float max[3];
+        uint32_t first;
+        uint32_t count;
+    };
+
+    // 一个光线包（SoA，世界坐标）
+    struct RayPacket {
+        alignas(16) float origin[3][kPacketSize];
+        alignas(16) float dir[3][kPacketSize];
+        alignas(16) float inv_dir[3][kPacketSize];
+        alignas(16) float t_best[kPacketSize];  // 当前最近命中距离（初始为地面或最远距离）
+        alignas(16) int32_t label[kPacketSize];  // -1 表示无回波
+    };
+
+    void PrepareFrame(const senseauto::demo::FrameData& ground_truth);
+    void BuildBvh();
+    uint32_t BuildNode(uint32_t first, uint32_t count);
+    void InitPacket(int ring, int first_step, RayPacket* packet) const;
+    void TracePacket(RayPacket* packet);
+    void IntersectBoxes(const BvhNode& leaf, RayPacket* packet) const;
+    void EmitPacket(const RayPacket& packet, int ring, int first_step, std::vector<LidarPoint>* points) const;
+    void EmitPoint(int ray, float t, int label, std::vector<LidarPoint>* points) const;
+
+    LidarModel model_;
+
+    // 传感器坐标系下的光线单位方向（SoA，下标为 ring * azimuth_steps + step）
+    std::vector<float> dir_x_;
+    std::vector<float> dir_y_;
+    std::vector<float> dir_z_;
+
+    // 当前帧
+    float origin_[3] = {0.0f, 0.0f, 0.0f};  // 传感器原点（世界坐标）
+    float cos_heading_ = 1.0f;
+    float sin_heading_ = 0.0f;
+    std::vector<Box> boxes_;
+    std::vector<float> box_centroid_[3];
+    std::vector<uint32_t> box_order_;
+    std::vector<BvhNode> nodes_;
+    std::vector<uint32_t> stack_;
+};
@@ -1,21 +1,123 @@
 #include "sensor_component.hpp"
 #include <iostream>
+#include <algorithm>
 #include <cmath>
 #include <chrono>
 #include <thread> // for std::this_thread::sleep_for
-#include <cstdlib> // for rand()
-#include <fstream>
-#include <vector>
-#include <cstring> // for memcpy
-#include <arpa/inet.h> // for htonl
 #include <simple_middleware/logger.hpp> // Add logger include
-#include <common_msgs/simple_image.hpp> // For SimpleImage
+#include <simple_middleware/config_manager.hpp>
 
 using namespace simple_middleware;
 
-SensorComponent::SensorComponent() 
+namespace {
+
+int64_t NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::chrono::nanoseconds PeriodFromRate(double rate_hz) {
+    return std::chrono::nanoseconds(static_cast<int64_t>(1e9 / std::max(rate_hz, 0.1)));
+}
+
+}  // namespace
+
+SensorComponent::SensorComponent()
     : running_(false), noise_distribution_(0.0f, 0.2f) { // 噪声标准差 0.2m
     status_reporter_ = std::make_unique<StatusReporter>("SensorNode");
+
+    // Load config
+    auto& config = ConfigManager::GetInstance();
+    if (config.Load("sensor", "config/sensor.json")) {
+        LoadCameraConfigs();
+
+        LidarModel& lidar = lidar_config_.model;
+        lidar_config_.enabled = config.Get<bool>("sensor", "lidar_enabled", lidar_config_.enabled);
+        lidar.channels = config.Get<int>("sensor", "lidar_channels", lidar.channels);
+        lidar.azimuth_steps = config.Get<int>("sensor", "lidar_azimuth_steps", lidar.azimuth_steps);
+        lidar.max_range = static_cast<float>(config.Get<double>("sensor", "lidar_max_range", lidar.max_range));
+        lidar.pos_z = static_cast<float>(config.Get<double>("sensor", "lidar_pos_z", lidar.pos_z));
+        lidar_config_.scan_rate = config.Get<double>("sensor", "lidar_rate", lidar_config_.scan_rate);
+        lidar_config_.publish_rate = config.Get<double>("sensor", "lidar_publish_rate", lidar_config_.publish_rate);
+    } else {
+        Logger::Warn("Failed to load config, using defaults.");
+        config_.cameras.push_back(CameraConfig());
+    }
+
+    rig_ = std::make_unique<CameraRig>(config_.cameras, config_.render_threads);
+    chunk_publisher_ = ChunkedPublisher(static_cast<size_t>(std::max(config_.chunks_per_burst, 1)));
+    render_loop_ = status_reporter_->RegisterLoop("camera_render", rig_->TickPeriod());
+
+    for (const auto& camera : config_.cameras) {
+        Logger::Info("Camera " + camera.name + ": " + std::to_string(camera.model.width) + "x"
+            + std::to_string(camera.model.height) + ", fov=" + std::to_string(camera.model.fov) + ", yaw="
+            + std::to_string(camera.model.yaw) + ", render " + std::to_string(camera.frame_rate) + " Hz, publish "
+            + std::to_string(camera.publish_rate) + " Hz");
+    }
+    Logger::Info("Camera rig: " + std::to_string(rig_->size()) + " cameras on " + std::to_string(rig_->WorkerCount())
+        + " render workers, image format " + config_.image_format);
+
+    if (lidar_config_.enabled) {
+        lidar_ = std::make_unique<LidarSimulator>(lidar_config_.model);
+        lidar_chunk_publisher_ = ChunkedPublisher(static_cast<size_t>(std::max(config_.chunks_per_burst, 1)));
+        lidar_loop_ = status_reporter_->RegisterLoop("lidar_scan", PeriodFromRate(lidar_config_.scan_rate));
+        Logger::Info("LiDAR: " + std::to_string(lidar_config_.model.channels) + " channels x "
+            + std::to_string(lidar_config_.model.azimuth_steps) + " steps, scan "
+            + std::to_string(lidar_config_.scan_rate) + " Hz, publish " + std::to_string(lidar_config_.publish_rate)
+            + " Hz");
+    }
+}
+
+void SensorComponent::LoadCameraConfigs() {
+    auto& config = ConfigManager::GetInstance();
+    config_.render_threads = config.Get<int>("sensor", "render_threads", config_.render_threads);
+    config_.chunks_per_burst = config.Get<int>("sensor", "chunks_per_burst", config_.chunks_per_burst);
+    config_.image_format = config.Get<std::string>("sensor", "image_format", config_.image_format);
+    if (config_.image_format != kImageFormatRaw && config_.image_format != kImageFormatDeltaRle) {
+        Logger::Warn("Unknown image_format '" + config_.image_format + "', sending raw RGB");
+        config_.image_format = kImageFormatRaw;
+    }
+
+    // 顶层参数即前视相机（兼容单相机配置），同时作为 cameras 数组中各项的缺省值
+    CameraConfig defaults;
+    CameraModel& model = defaults.model;
+    model.width = config.Get<int>("sensor", "image_width", model.width);
+    model.height = config.Get<int>("sensor", "image_height", model.height);
+    model.fov = static_cast<float>(config.Get<double>("sensor", "fov", model.fov));
+    model.max_distance = static_cast<float>(config.Get<double>("sensor", "max_distance", model.max_distance));
+    model.pos_x = static_cast<float>(config.Get<double>("sensor", "pos_x", model.pos_x));
+    model.pos_y = static_cast<float>(config.Get<double>("sensor", "pos_y", model.pos_y));
+    model.pos_z = static_cast<float>(config.Get<double>("sensor", "pos_z", model.pos_z));
+    defaults.frame_rate = config.Get<double>("sensor", "frame_rate", defaults.frame_rate);
+    defaults.publish_rate = config.Get<double>("sensor", "publish_rate", defaults.publish_rate);
+
+    const json11::Json cameras = config.GetConfig("sensor")["cameras"];
+    if (!cameras.is_array()) {
+        config_.cameras.push_back(defaults);
+        return;
+    }
+    for (const auto& item : cameras.array_items()) {
+        if (item["enabled"].is_bool() && !item["enabled"].bool_value()) {
+            continue;
+        }
+        auto number = [&item](const char* key, double default_val) {
+            return item[key].is_number() ? item[key].number_value() : default_val;
+        };
+        CameraConfig camera = defaults;
+        camera.name = item["name"].is_string() ? item["name"].string_value()
+                                               : "camera" + std::to_string(config_.cameras.size());
+        camera.model.width = static_cast<int>(number("image_width", camera.model.width));
+        camera.model.height = static_cast<int>(number("image_height", camera.model.height));
+        camera.model.fov = static_cast<float>(number("fov", camera.model.fov));
+        camera.model.max_distance = static_cast<float>(number("max_distance", camera.model.max_distance));
+        camera.model.pos_x = static_cast<float>(number("pos_x", camera.model.pos_x));
+        camera.model.pos_y = static_cast<float>(number("pos_y", camera.model.pos_y));
+        camera.model.pos_z = static_cast<float>(number("pos_z", camera.model.pos_z));
+        camera.model.yaw = static_cast<float>(number("yaw", camera.model.yaw));
+        camera.frame_rate = number("frame_rate", camera.frame_rate);
+        camera.publish_rate = number("publish_rate", camera.publish_rate);
+        config_.cameras.push_back(camera);
+    }
 }
 
 SensorComponent::~SensorComponent() {
@@ -28,43 +130,29 @@ void SensorComponent::Start() {
 
     // 订阅真值数据
     auto& middleware = PubSubMiddleware::getInstance();
-    middleware.subscribe("visualizer/data", [this](const Message& msg) {
+    middleware.subscribe(simple_middleware::topics::kGroundTruth, [this](const Message& msg) {
         this->OnVisualizerData(msg);
     });
 
-    thread_ = std::thread(&SensorComponent::RunLoop, this);
-    status_reporter_->Start();
-    
-    // 加载静态测试图片
-    // 优先使用 src/assets/test.png，如果不存在则尝试其他路径
-    std::ifstream file;
-    bool image_loaded = false;
-    
-    // 尝试多个路径
-    std::vector<std::string> paths = {
-        "src/assets/test.png",
-        "../src/assets/test.png",
-    };
-    
-    for (const auto& path : paths) {
-        file.open(path, std::ios::binary | std::ios::ate);
-        if (file) {
-             std::streamsize size = file.tellg();
-             file.seekg(0, std::ios::beg);
-             raw_image_buffer_.resize(size);
-             if (file.read(raw_image_buffer_.data(), size)) {
-                simple_middleware::Logger::Info("Loaded image from: " + path + " (" + std::to_string(size) + " bytes)");
-                image_loaded = true;
-                break;
-            }
+    // 订阅地图（车道几何），地图超过单包上限时走分片话题
+    middleware.subscribe(simple_middleware::topics::kMapData, [this](const Message& msg) {
+        this->OnMapData(msg.data);
+    });
+    middleware.subscribe(simple_middleware::topics::kMapDataChunk, [this](const Message& msg) {
+        std::string full_data;
+        if (map_chunks_.add(msg.data, &full_data)) {
+            this->OnMapData(full_data);
         }
-        file.close();
+    });
+
+    if (rig_->size() > 0) {
+        thread_ = std::thread(&SensorComponent::RunLoop, this);
+        publish_thread_ = std::thread(&SensorComponent::PublishLoop, this);
     }
-    
-            // 【简化】不再解析图片文件，直接生成白色背景图像
-            // 白色背景上红色检测框更明显
-            simple_middleware::Logger::Info("Generating white background image (160x120)");
-            raw_image_buffer_.clear(); // 清空，不再使用文件数据
+    if (lidar_) {
+        lidar_thread_ = std::thread(&SensorComponent::LidarLoop, this);
+    }
+    status_reporter_->Start();
 
     simple_middleware::Logger::Info("Started camera simulation.");
 }
@@ -75,207 +163,223 @@ void SensorComponent::Stop() {
     if (thread_.joinable()) {
         thread_.join();
     }
+    if (publish_thread_.joinable()) {
+        publish_thread_.join();
+    }
+    if (lidar_thread_.joinable()) {
+        lidar_thread_.join();
+    }
 }
 
 void SensorComponent::OnVisualizerData(const Message& msg) {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-    if (ground_truth_.ParseFromString(msg.data)) {
-        has_ground_truth_ = true;
-        static int recv_count = 0;
-        if (recv_count++ % 30 == 0) { // 每 30 次（1秒）输出一次
-            simple_middleware::Logger::Debug("Sensor: Received visualizer/data, has_car_state=" 
-                + std::string(ground_truth_.has_car_state() ? "true" : "false"));
-        }
+    // 每帧解码成一个新对象，整体替换快照；RunLoop 正在使用的旧快照不受影响
+    auto frame = std::make_shared<senseauto::demo::FrameData>();
+    if (frame->ParseFromString(msg.data)) {
+        // 每 30 次（1秒）输出一次
+        LOG_EVERY_N(DEBUG, "Sensor", 30) << "Received visualizer/data, has_car_state="
+            << (frame->has_car_state() ? "true" : "false");
+        ground_truth_.publish(std::move(frame));
     } else {
-        static int fail_count = 0;
-        if (fail_count++ % 30 == 0) {
-            simple_middleware::Logger::Warn("Sensor: Failed to parse visualizer/data");
-        }
+        LOG_EVERY_N(WARN, "Sensor", 30) << "Failed to parse visualizer/data";
+    }
+}
+
+void SensorComponent::OnMapData(const std::string& data) {
+    auto map = std::make_shared<senseauto::demo::MapData>();
+    if (!map->ParseFromString(data)) {
+        LOG_EVERY_N(WARN, "Sensor", 10) << "Failed to parse map/data, size=" << data.size();
+        return;
     }
+    LOG_EVERY_N(INFO, "Sensor", 60) << "Received map/data: " << map->lanes_size() << " lanes, "
+        << data.size() << " bytes";
+    map_.publish(std::move(map));
 }
 
 void SensorComponent::RunLoop() {
-    auto& middleware = PubSubMiddleware::getInstance();
-    
+    const auto period = rig_->TickPeriod();
+
     while (running_) {
         auto start_time = std::chrono::steady_clock::now();
-
-        // 1. 获取最新真值
-        senseauto::demo::FrameData current_gt;
-        bool has_data = false;
         {
-            std::lock_guard<std::mutex> lock(data_mutex_);
-            if (has_ground_truth_) {
-                current_gt = ground_truth_;
-                has_data = true;
-            }
-        }
+            simple_middleware::LoopCycle cycle(render_loop_);
 
-        if (!has_data) {
-            static int no_data_count = 0;
-            if (no_data_count++ % 50 == 0) { // 每 50 次（约1.6秒）输出一次
-                simple_middleware::Logger::Debug("Sensor: RunLoop - no ground truth data yet");
+            // 1. 获取最新真值和地图（只增加引用计数，不拷贝、不加锁），本周期所有相机共用这一份
+            auto current_gt = ground_truth_.load();
+            bool has_data = current_gt != nullptr;
+
+            if (!has_data) {
+                LOG_EVERY_N(DEBUG, "Sensor", 50) << "RunLoop - no ground truth data yet";
+            } else if (!current_gt->has_car_state()) {
+                LOG_EVERY_N(DEBUG, "Sensor", 50) << "RunLoop - has data but no car_state";
             }
-        } else if (!current_gt.has_car_state()) {
-            static int no_car_state_count = 0;
-            if (no_car_state_count++ % 50 == 0) {
-                simple_middleware::Logger::Debug("Sensor: RunLoop - has data but no car_state");
+
+            if (has_data && current_gt->has_car_state()) {
+                // 2. 并行渲染本周期到期的相机：真值障碍物 + 地面 + 车道线
+                auto map = map_.load();
+                int rendered = rig_->RenderTick(*current_gt, map.get(), start_time);
+                if (rendered > 0) {
+                    LOG_EVERY_N(DEBUG, "Sensor", 300) << "Rendered " << rendered << " cameras, "
+                        << rig_->channel(0).config.name << " " << rig_->channel(0).last_render_us
+                        << " us, map=" << (map ? "yes" : "no");
+                }
             }
         }
 
-        if (has_data && current_gt.has_car_state()) {
-            senseauto::demo::CameraFrame camera_frame;
-            camera_frame.set_timestamp(std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::system_clock::now().time_since_epoch()).count());
-            
-            // 【架构调整】Sensor 只负责发送原始图像数据，不包含 objects
-            // Objects 应该由 Perception 模块通过检测算法从图像中识别出来
-            // 这里我们不再填充 objects 数据
-
-            // 【模拟生成图像数据】
-            // 如果成功加载了图片，则发送；否则发送原来的噪点图
-            if (!raw_image_buffer_.empty()) {
-                // 从 PPM header 中解析实际尺寸（简单解析）
-                // PPM 格式: "P6\nWIDTH HEIGHT\n255\n[DATA]"
-                int w = 160, h = 120; // 默认值
-                size_t header_end = 0;
-                
-                std::string header = raw_image_buffer_.substr(0, std::min(50UL, raw_image_buffer_.size()));
-                size_t first_nl = header.find('\n');
-                if (first_nl != std::string::npos) {
-                    size_t space_pos = header.find(' ', first_nl);
-                    size_t second_nl = header.find('\n', space_pos);
-                    if (space_pos != std::string::npos && second_nl != std::string::npos) {
-                        try {
-                            w = std::stoi(header.substr(first_nl + 1, space_pos - first_nl - 1));
-                            h = std::stoi(header.substr(space_pos + 1, second_nl - space_pos - 1));
-                        } catch (...) {
-                            // 解析失败，使用默认值
-                        }
-                    }
-                }
-                
-                // 找到 header 结束位置（第三个换行符之后）
-                size_t p1 = raw_image_buffer_.find('\n');
-                size_t p2 = raw_image_buffer_.find(' ', p1);
-                size_t p3 = raw_image_buffer_.find('\n', p2);
-                if (p3 != std::string::npos) {
-                    size_t p4 = raw_image_buffer_.find('\n', p3 + 1);
-                    if (p4 != std::string::npos) {
-                        header_end = p4 + 1;
-                    }
-                }
-                
-                // 【修改】直接生成白色背景图像，不解析 PPM 文件
-                // 这样更简单，而且白色背景上红色检测框更明显
-                int width = 160;
-                int height = 120;
-                std::string white_image_data;
-                white_image_data.resize(width * height * 3); // RGB 数据
-                // 填充白色像素 (255, 255, 255)
-                std::memset(white_image_data.data(), 255, white_image_data.size());
-                camera_frame.set_image_width(width);
-                camera_frame.set_image_height(height);
-                camera_frame.set_image_format("ppm"); // 标记为 ppm 格式，但实际只包含 RGB 数据
-                camera_frame.set_raw_image(white_image_data);
-                
-                static int log_counter = 0;
-                if (log_counter++ % 10 == 0) {
-                    simple_middleware::Logger::Debug("Publishing white background image: " 
-                        + std::to_string(width) + "x" + std::to_string(height)
-                        + ", RGB size=" + std::to_string(white_image_data.size()) + " bytes");
-                }
-            } else {
-                // 生成白色背景图像 (fallback)
-                int width = 160;
-                int height = 120;
-                std::string white_image_data;
-                white_image_data.resize(width * height * 3); // RGB 数据
-                // 填充白色像素 (255, 255, 255)
-                std::memset(white_image_data.data(), 255, white_image_data.size());
-                camera_frame.set_image_width(width);
-                camera_frame.set_image_height(height);
-                camera_frame.set_image_format("ppm"); // 标记为 ppm 格式，但实际只包含 RGB 数据
-                camera_frame.set_raw_image(white_image_data);
+        std::this_thread::sleep_until(start_time + period);
+    }
+}
+
+void SensorComponent::PublishLoop() {
+    // 按发布频率最高的相机的周期轮询，各相机到期时只发布最新渲染完成的一帧
+    auto period = std::chrono::nanoseconds(std::chrono::seconds(1));
+    for (size_t i = 0; i < rig_->size(); ++i) {
+        period = std::min(period, rig_->channel(i).publish_period);
+    }
+
+    while (running_) {
+        auto start_time = std::chrono::steady_clock::now();
+
+        // 一次取出最近一组同步帧，逐路发布期间渲染线程继续渲染也不会混入其他时刻的画面；
+        // 持有期间这些缓冲区不会被渲染线程复用
+        auto frame_set = rig_->LatestFrames();
+        for (size_t i = 0; frame_set && i < rig_->size() && running_; ++i) {
+            CameraChannel& channel = rig_->channel(i);
+            const auto& frame = frame_set->frames[i];
+            if (start_time < channel.next_publish || !frame || frame->sequence == channel.published_sequence) {
+                continue;
             }
+            channel.published_sequence = frame->sequence;
+            channel.next_publish = std::max(channel.next_publish + channel.publish_period, start_time);
+            PublishFrame(channel, *frame);
+        }
+        frame_set.reset();
+
+        std::this_thread::sleep_until(start_time + period);
+    }
+}
+
+void SensorComponent::PublishFrame(CameraChannel& channel, const FrameBuffer& frame) {
+    auto& middleware = PubSubMiddleware::getInstance();
+    const CameraModel& model = channel.config.model;
+
+    // 【架构调整】Sensor 只负责发送原始图像数据，不包含 objects
+    // Objects 应该由 Perception 模块通过检测算法从图像中识别出来
+    // 相机参数和帧同步信息同时写进完整帧和元数据帧
+    auto fill_header = [&](senseauto::demo::CameraFrame* msg) {
+        msg->set_timestamp(frame.timestamp);
+        msg->set_frame_id(frame.frame_id);
+        msg->set_image_width(frame.width);
+        msg->set_image_height(frame.height);
+        msg->set_image_format(config_.image_format);
+        msg->set_camera_name(channel.config.name);
+        msg->set_fov(model.fov);
+        msg->set_pos_x(model.pos_x);
+        msg->set_pos_y(model.pos_y);
+        msg->set_pos_z(model.pos_z);
+        msg->set_yaw(model.yaw);
+        msg->set_sync_sequence(frame.sync_sequence);
+        msg->set_sync_group_size(frame.sync_group_size);
+        msg->set_sync_timestamp(frame.sync_timestamp);
+        if (frame.has_trace) {
+            msg->mutable_trace()->CopyFrom(frame.trace);
+        } else {
+            msg->clear_trace();
+        }
+    };
+
+    senseauto::demo::CameraFrame& camera_frame = channel.frame_msg;
+    fill_header(&camera_frame);
+    if (config_.image_format == kImageFormatDeltaRle) {
+        // 无损压缩：渲染图像大面积是纯色和渐变，640x480 的帧通常只剩原始大小的几十分之一，分片数同比减少
+        ImageEncode(frame.rgb.data(), frame.width, frame.height, camera_frame.mutable_raw_image());
+    } else {
+        // "ppm" 只是历史标记，实际只包含 RGB 数据
+        camera_frame.mutable_raw_image()->assign(reinterpret_cast<const char*>(frame.rgb.data()), frame.rgb.size());
+    }
+
+    // 发布传感器数据（如果数据包太大，需要分片发送）
+    if (!camera_frame.SerializeToString(&channel.serialized)) {
+        return;
+    }
+    if (channel.serialized.size() <= ChunkedPublisher::kMaxChunkPayload) {
+        // 数据包足够小，直接发送
+        middleware.publishSerialized(channel.topics.topic(), channel.serialized);
+        LOG_EVERY_N(DEBUG, "Sensor", 10) << "Published " << channel.config.name << " frame. Image size: "
+            << camera_frame.raw_image().size();
+        return;
+    }
+
+    // 【优化】先发送元数据（不含图像），再分批发送分片，避免长时间阻塞
+    fill_header(&channel.metadata_msg);
+    if (channel.metadata_msg.SerializeToString(&channel.metadata_serialized)) {
+        middleware.publishSerialized(channel.topics.topic(), channel.metadata_serialized);
+    }
+
+    chunk_publisher_.publishChunks(channel.topics.chunk_topic(), channel.serialized);
+
+    LOG_EVERY_N(DEBUG, "Sensor", 10) << "Published " << channel.config.name << " frame " << frame.sequence
+        << " (sync " << frame.sync_sequence << ") in " << chunk_publisher_.lastChunkCount()
+        << " chunks (image) + 1 metadata frame. Total size: " << channel.serialized.size()
+        << ", Metadata size: " << channel.metadata_serialized.size();
+}
+
+void SensorComponent::LidarLoop() {
+    const auto period = PeriodFromRate(lidar_config_.scan_rate);
+    // 每 publish_every 次扫描发布一次（扫描照常按 scan_rate 运行，保持时序统计真实）
+    const uint64_t publish_every = static_cast<uint64_t>(
+        std::max(1.0, std::round(lidar_config_.scan_rate / std::max(lidar_config_.publish_rate, 0.1))));
+    uint64_t scan_count = 0;
 
-            // 发布传感器数据（如果数据包太大，需要分片发送）
-            std::string serialized_data;
-            if (camera_frame.SerializeToString(&serialized_data)) {
-                // UDP 数据包大小限制：MTU 通常是 1500 字节，减去 IP/UDP 头约 100 字节，实际可用约 1400 字节
-                // 但为了安全，我们使用 1200 字节作为分片大小
-                const size_t MAX_CHUNK_SIZE = 1200;
-                const size_t topic_overhead = 50; // topic 名称和分隔符的开销
-                const size_t chunk_header_size = 16; // 分片头：frame_id(4) + chunk_id(4) + total_chunks(4) + chunk_size(4)
-                const size_t effective_chunk_size = MAX_CHUNK_SIZE - topic_overhead - chunk_header_size;
-                
-                if (serialized_data.size() <= effective_chunk_size) {
-                    // 数据包足够小，直接发送
-                    middleware.publish("sensor/camera/front", serialized_data);
-                    
-                    static int log_counter = 0;
-                    if (log_counter++ % 10 == 0) {
-                        simple_middleware::Logger::Debug("Published frame. Image size: " + std::to_string(camera_frame.raw_image().size()));
-                    }
-                } else {
-                    // 数据包太大，需要分片发送
-                    // 使用二进制分片协议：frame_id(4) + chunk_id(4) + total_chunks(4) + chunk_size(4) + chunk_data
-                    size_t total_chunks = (serialized_data.size() + effective_chunk_size - 1) / effective_chunk_size;
-                    static uint32_t frame_id_counter = 0;
-                    uint32_t frame_id = ++frame_id_counter;
-                    
-                    // 【优化】先发送元数据，再发送分片，避免长时间阻塞
-                    senseauto::demo::CameraFrame metadata_frame;
-                    metadata_frame.set_timestamp(camera_frame.timestamp());
-                    metadata_frame.set_image_width(camera_frame.image_width());
-                    metadata_frame.set_image_height(camera_frame.image_height());
-                    metadata_frame.set_image_format(camera_frame.image_format());
-                    
-                    std::string metadata_data;
-                    if (metadata_frame.SerializeToString(&metadata_data)) {
-                        middleware.publish("sensor/camera/front", metadata_data);
-                    }
-                    
-                    // 然后发送分片，分片之间添加延迟，避免阻塞其他数据
-                    for (size_t chunk_id = 0; chunk_id < total_chunks; ++chunk_id) {
-                        size_t chunk_start = chunk_id * effective_chunk_size;
-                        size_t chunk_size = std::min(effective_chunk_size, serialized_data.size() - chunk_start);
-                        
-                        // 构造分片数据包：header + data
-                        std::string chunk_packet;
-                        chunk_packet.resize(16 + chunk_size);
-                        
-                        // 写入 header（大端序）
-                        uint32_t* header = reinterpret_cast<uint32_t*>(&chunk_packet[0]);
-                        header[0] = htonl(frame_id);
-                        header[1] = htonl(static_cast<uint32_t>(chunk_id));
-                        header[2] = htonl(static_cast<uint32_t>(total_chunks));
-                        header[3] = htonl(static_cast<uint32_t>(chunk_size));
-                        
-                        // 写入数据
-                        std::memcpy(&chunk_packet[16], &serialized_data[chunk_start], chunk_size);
-                        
-                        middleware.publish("sensor/camera/front/chunk", chunk_packet);
-                        
-                        // 在分片之间添加延迟，避免阻塞其他数据发送（特别是 Simulator 的自车数据）
-                        if (chunk_id < total_chunks - 1) {
-                            std::this_thread::sleep_for(std::chrono::milliseconds(2)); // 2毫秒延迟，让其他数据有机会发送
-                        }
-                    }
-                    
-                    static int log_counter = 0;
-                    if (log_counter++ % 10 == 0) {
-                        simple_middleware::Logger::Debug("Published frame in " + std::to_string(total_chunks) 
-                            + " chunks (image) + 1 metadata frame. "
-                            + "Total size: " + std::to_string(serialized_data.size())
-                            + ", Metadata size: " + std::to_string(metadata_data.size()));
-                    }
+    while (running_) {
+        auto start_time = std::chrono::steady_clock::now();
+        {
+            simple_middleware::LoopCycle cycle(lidar_loop_);
+
+            auto current_gt = ground_truth_.load();
+            if (current_gt && current_gt->has_car_state()) {
+                auto scan_start = std::chrono::steady_clock::now();
+                lidar_->Scan(*current_gt, &lidar_points_);
+                auto scan_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - scan_start).count();
+                LOG_EVERY_N(DEBUG, "Sensor", 100) << "LiDAR scan: " << lidar_points_.size() << " points / "
+                    << lidar_->RayCount() << " rays, " << lidar_->LastNodeCount() << " BVH nodes, "
+                    << scan_us << " us";
+
+                if (scan_count++ % publish_every == 0) {
+                    PublishPointCloud(lidar_points_, *current_gt);
                 }
             }
         }
 
-        // 1Hz 频率控制（每秒1帧）
-        std::this_thread::sleep_until(start_time + std::chrono::milliseconds(1000));
+        std::this_thread::sleep_until(start_time + period);
     }
 }
 
+void SensorComponent::PublishPointCloud(const std::vector<LidarPoint>& points,
+                                        const senseauto::demo::FrameData& ground_truth) {
+    point_cloud_.set_timestamp(NowMs());
+    point_cloud_.set_frame_id(ground_truth.frame_id());
+    point_cloud_.set_point_count(static_cast<uint32_t>(points.size()));
+    point_cloud_.set_point_step(sizeof(LidarPoint));
+    point_cloud_.set_channels(lidar_->model().channels);
+    point_cloud_.set_azimuth_steps(lidar_->model().azimuth_steps);
+    // LidarPoint 的内存布局就是线上格式（x86 / ARM 均为小端）
+    point_cloud_.mutable_data()->assign(reinterpret_cast<const char*>(points.data()),
+                                        points.size() * sizeof(LidarPoint));
+    if (ground_truth.has_trace()) {
+        point_cloud_.mutable_trace()->CopyFrom(ground_truth.trace());
+        simple_middleware::TraceStampStage(point_cloud_.mutable_trace(), "sensor");
+    } else {
+        point_cloud_.clear_trace();
+    }
+
+    if (!point_cloud_.SerializeToString(&lidar_serialized_)) {
+        return;
+    }
+    // 点数少时整条直发 kLidarTop，否则只走分片话题
+    lidar_chunk_publisher_.publish(simple_middleware::topics::kLidarTop, simple_middleware::topics::kLidarTopChunk,
+                                   lidar_serialized_);
+
+    LOG_EVERY_N(DEBUG, "Sensor", 10) << "Published point cloud: " << points.size() << " points in "
+        << lidar_chunk_publisher_.lastChunkCount() << " chunks, " << lidar_serialized_.size() << " bytes";
+}
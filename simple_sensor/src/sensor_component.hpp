@@ -1,9 +1,17 @@
 #pragma once
 
 #include <simple_middleware/pub_sub_middleware.hpp>
+#include <simple_middleware/topics.hpp>
 #include <simple_middleware/status_reporter.hpp>
+#include <simple_middleware/trace.hpp>
+#include <simple_middleware/snapshot.hpp>
+#include <simple_middleware/chunked_transport.hpp>
+#include <simple_middleware/image_codec.hpp>
 #include <common_msgs/visualizer_data.pb.h>
 #include <common_msgs/sensor_data.pb.h>
+#include <common_msgs/map_data.pb.h>
+#include "camera_rig.hpp"
+#include "lidar_simulator.hpp"
 #include <thread>
 #include <atomic>
 #include <mutex>
@@ -18,31 +26,58 @@ public:
     void Stop();
 
 private:
-    void RunLoop();
+    void LoadCameraConfigs();
+    void RunLoop();      // 渲染循环（各相机中最高的 frame_rate）
+    void PublishLoop();  // 发布循环（各相机按自己的 publish_rate）
+    void PublishFrame(CameraChannel& channel, const FrameBuffer& frame);
+    void LidarLoop();    // 激光雷达扫描循环（lidar_rate），每 N 帧发布一次
+    void PublishPointCloud(const std::vector<LidarPoint>& points, const senseauto::demo::FrameData& ground_truth);
     void OnVisualizerData(const simple_middleware::Message& msg);
-    
-    // 模拟相机参数
-    struct CameraConfig {
-        float fov = 60.0f;          // 视场角 (degrees)
-        float max_distance = 80.0f; // 最大探测距离 (m)
-        float pos_x = 2.0f;         // 安装位置相对于车辆中心的纵向偏移 (m)
-        float pos_y = 0.0f;         // 横向偏移 (m)
+    void OnMapData(const std::string& data);
+
+    // 模拟相机组参数（config/sensor.json）
+    struct RigConfig {
+        std::vector<CameraConfig> cameras;  // cameras 数组，缺省时为一路前视相机（顶层参数）
+        int render_threads = 0;      // 渲染线程总数，0 表示取 CPU 核数
+        int chunks_per_burst = 32;   // 分片发布时每批连续发送的分片数（批间暂停 1ms）
+        std::string image_format = simple_middleware::kImageFormatDeltaRle;  // 图像编码：rgb_delta_rle（无损压缩）或 ppm（原始 RGB）
+    };
+
+    // 模拟激光雷达参数（config/sensor.json，lidar_ 前缀）
+    struct LidarConfig {
+        bool enabled = false;        // 默认关闭：点云 1~2MB/帧，广播传输下会占满链路
+        LidarModel model;            // 线数、水平分辨率、量程、安装位置
+        double scan_rate = 10.0;     // 扫描频率 (Hz)
+        double publish_rate = 1.0;   // 发布频率 (Hz)，与相机一样按传输带宽单独限速
     };
 
-    // 存储最新的真值数据
-    senseauto::demo::FrameData ground_truth_;
-    bool has_ground_truth_ = false;
-    std::mutex data_mutex_;
+    // 最新的真值数据（订阅回调整体替换，RunLoop 无锁读取）
+    simple_middleware::Snapshot<senseauto::demo::FrameData> ground_truth_;
+    // 地图（车道几何），收到 map/data 后整体替换
+    simple_middleware::Snapshot<senseauto::demo::MapData> map_;
+    simple_middleware::ChunkAssembler map_chunks_;
 
     std::unique_ptr<simple_middleware::StatusReporter> status_reporter_;
+    simple_middleware::LoopMonitor* render_loop_ = nullptr;  // 渲染循环的时序统计（一个周期渲染所有到期的相机）
     std::thread thread_;
+    std::thread publish_thread_;
     std::atomic<bool> running_;
-    
+
     // 随机数生成器用于模拟噪声
     std::default_random_engine generator_;
     std::normal_distribution<float> noise_distribution_;
-    
-    CameraConfig config_;
-    std::string raw_image_buffer_; // 缓存加载的图片数据
-};
 
+    RigConfig config_;
+    std::unique_ptr<CameraRig> rig_;
+    simple_middleware::ChunkedPublisher chunk_publisher_;  // 发布线程独占
+
+    // 激光雷达：扫描线程独占仿真器和点云缓冲区
+    LidarConfig lidar_config_;
+    std::unique_ptr<LidarSimulator> lidar_;
+    simple_middleware::LoopMonitor* lidar_loop_ = nullptr;
+    std::thread lidar_thread_;
+    std::vector<LidarPoint> lidar_points_;
+    senseauto::demo::PointCloud point_cloud_;
+    std::string lidar_serialized_;
+    simple_middleware::ChunkedPublisher lidar_chunk_publisher_;
+};
@@ -2,18 +2,18 @@
 #include <iostream>
 #include <cmath>
 #include <chrono>
-#include <json11.hpp>
 #include <google/protobuf/util/json_util.h>
 #include <simple_middleware/logger.hpp> // Add logger include
+#include <simple_middleware/profiler.hpp>
+#include <simple_middleware/json_reader.hpp>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-using namespace json11;
-
 SimulatorCore::SimulatorCore() : running_(false) {
     status_reporter_ = std::make_unique<simple_middleware::StatusReporter>("SimulatorNode");
+    physics_loop_ = status_reporter_->RegisterLoop("physics", std::chrono::milliseconds(10));
     InitScenario();
 }
 
@@ -28,12 +28,12 @@ void SimulatorCore::Start() {
     auto& middleware = simple_middleware::PubSubMiddleware::getInstance();
     
     // 订阅来自 Control 模块的物理控制指令
-    middleware.subscribe("control/command", [this](const simple_middleware::Message& msg) {
-        this->OnControlCommand(msg);
+    middleware.subscribe(simple_middleware::topics::kControlCommand, [this](const senseauto::demo::ControlCommand& cmd) {
+        this->OnControlCommand(cmd);
     });
     
     // 订阅控制命令（包括 reset）
-    middleware.subscribe("visualizer/control", [this](const simple_middleware::Message& msg) {
+    middleware.subscribe(simple_middleware::topics::kVisualizerControl, [this](const simple_middleware::Message& msg) {
         this->OnControlMessage(msg);
     });
 
@@ -114,42 +114,40 @@ void SimulatorCore::InitScenario() {
         + std::to_string(dynamic_obstacles_.size()) + " dynamic)");
 }
 
-void SimulatorCore::OnControlCommand(const simple_middleware::Message& msg) {
-    // 解析 ControlCommand
-    senseauto::demo::ControlCommand cmd;
-    if (cmd.ParseFromString(msg.data)) {
-        std::lock_guard<std::mutex> lock(state_mutex_);
+void SimulatorCore::OnControlCommand(const senseauto::demo::ControlCommand& cmd) {
+    // 链路终点：统计这条控制指令所依据的真值帧走完整条链路花了多久
+    if (cmd.has_trace()) {
+        trace_collector_.record(cmd.trace());
+    }
+
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    
+    // 简单模拟：假设 Control 发来的是目标速度和转角
+    // 实际上应该是油门/刹车踏板开度，这里简化处理
+    if (cmd.cmd() == "actuate") {
+        target_speed_ = cmd.value(); // 复用 value 存速度
+        target_steering_ = cmd.target().x(); // hack: 复用 x 存转角
         
-        // 简单模拟：假设 Control 发来的是目标速度和转角
-        // 实际上应该是油门/刹车踏板开度，这里简化处理
-        if (cmd.cmd() == "actuate") {
-            target_speed_ = cmd.value(); // 复用 value 存速度
-            target_steering_ = cmd.target().x(); // hack: 复用 x 存转角
-            
-            static int log_counter = 0;
-            if (log_counter++ % 100 == 0) { // 每 100 次（1秒）输出一次
-                simple_middleware::Logger::Debug(
-                    "Simulator: Received control command - speed=" + std::to_string(target_speed_) +
-                    ", steering=" + std::to_string(target_steering_));
-            }
-        }
-    } else {
-        simple_middleware::Logger::Warn("Simulator: Failed to parse control command");
+        LOG_EVERY_MS(DEBUG, "Simulator", 1000) << "Received control command - speed=" << target_speed_
+            << ", steering=" << target_steering_;
     }
 }
 
 void SimulatorCore::OnControlMessage(const simple_middleware::Message& msg) {
-    // 解析 JSON 控制消息（来自前端）
-    std::string err;
-    Json json = Json::parse(msg.data, err);
-    if (!err.empty()) {
-        return; // 不是 JSON 格式，忽略
-    }
-    
+    // JSON 控制消息（来自前端），只关心命令名，解析失败的消息直接忽略
     // 支持两种格式：前端可能发送 "cmd" 或 "type"
-    std::string cmd = json["cmd"].string_value();
+    std::string cmd;
+    std::string type;
+    simple_middleware::JsonReader reader(msg.data);
+    bool parsed = reader.forEachMember([&](std::string_view key) {
+        if (key == "cmd") reader.readString(&cmd);
+        else if (key == "type") reader.readString(&type);
+    });
+    if (!parsed) {
+        return;
+    }
     if (cmd.empty()) {
-        cmd = json["type"].string_value();
+        cmd = type;
     }
     
     if (cmd == "reset") {
@@ -171,6 +169,7 @@ void SimulatorCore::OnControlMessage(const simple_middleware::Message& msg) {
 }
 
 void SimulatorCore::StepPhysics(double dt) {
+    PROFILE_SCOPE("Simulator::StepPhysics");
     auto* car = world_state_.mutable_car_state();
     
     // 简单的惯性模拟 (一阶滞后)
@@ -231,17 +230,40 @@ void SimulatorCore::UpdateDynamicObstacles(double dt) {
     }
 }
 
+void SimulatorCore::PublishEgoState(simple_middleware::PubSubMiddleware& middleware) {
+    PROFILE_SCOPE("Simulator::PublishEgoState");
+    ego_state_.set_frame_id(world_state_.frame_id());
+    ego_state_.set_timestamp(static_cast<int64_t>(world_state_.timestamp()));
+    *ego_state_.mutable_car_state() = world_state_.car_state();
+    if (ego_state_.SerializeToString(&ego_buffer_)) {
+        middleware.publishSerialized(simple_middleware::topics::kEgoState, ego_buffer_);
+    }
+}
+
+void SimulatorCore::PublishObstacles(simple_middleware::PubSubMiddleware& middleware) {
+    PROFILE_SCOPE("Simulator::PublishObstacles");
+    obstacles_arena_.reset();
+    auto* obstacles = obstacles_arena_.create<senseauto::demo::ObstacleArray>();
+    obstacles->set_timestamp(static_cast<int64_t>(world_state_.timestamp()));
+    *obstacles->mutable_obstacles() = world_state_.obstacles();
+    if (obstacles->SerializeToString(&obstacles_buffer_)) {
+        middleware.publishSerialized(simple_middleware::topics::kGroundTruthObstacles, obstacles_buffer_);
+    }
+}
+
 void SimulatorCore::RunLoop() {
     auto& middleware = simple_middleware::PubSubMiddleware::getInstance();
     const double dt = 0.01; // 10ms (100Hz)
     int frame_id = 0;
-    static int no_publish_count = 0;
+    simple_middleware::Profiler::SetThreadName("Simulator::RunLoop");
 
     while (running_) {
         try {
             auto start = std::chrono::steady_clock::now();
+            physics_loop_->beginCycle();
 
             {
+                PROFILE_SCOPE("Simulator::Tick");
                 std::lock_guard<std::mutex> lock(state_mutex_);
                 StepPhysics(dt);
                 
@@ -249,62 +271,79 @@ void SimulatorCore::RunLoop() {
                 world_state_.set_timestamp(std::chrono::duration_cast<std::chrono::milliseconds>(
                     std::chrono::system_clock::now().time_since_epoch()).count());
                 world_state_.set_frame_id(frame_id++);
+
+                // 自车状态随物理仿真每个周期发布，Control / Planning / Prediction 只订阅这个小话题
+                PublishEgoState(middleware);
+
+                // 障碍物真值单独按较低频率发布
+                obstacles_publish_counter_++;
+                if (obstacles_publish_counter_ >= OBSTACLES_PUBLISH_INTERVAL) {
+                    obstacles_publish_counter_ = 0;
+                    PublishObstacles(middleware);
+                }
                 
-                // 发布节流：物理仿真保持 100Hz，但只每 PUBLISH_INTERVAL 帧发布一次给前端
+                // 兼容用的聚合真值：物理仿真保持 100Hz，但只每 PUBLISH_INTERVAL 帧发布一次
                 // 这样前端只需要处理 20Hz 的数据，避免过载
                 publish_counter_++;
                 if (publish_counter_ >= PUBLISH_INTERVAL) {
                     publish_counter_ = 0;
+                    PROFILE_SCOPE("Simulator::PublishGroundTruth");
                     
-                    // 序列化并广播真值
-                    std::string serialized;
-                    // Hack: 使用 "visualizer/data" 作为 topic 以兼容现有的 Sensor/Visualizer
+                    // 每个发布出去的真值帧开启一条新的追踪链路（trace_id = 帧号 + 1，保证非 0）
+                    simple_middleware::TraceBegin(world_state_.mutable_trace(),
+                                                  static_cast<uint64_t>(world_state_.frame_id()) + 1);
+
+                    // 序列化并广播真值（序列化缓冲区跨周期复用，SerializeToString 保留容量）
+                    // Hack: 真值沿用 "visualizer/data" 这个 topic 以兼容现有的 Sensor/Visualizer
                     // 它们之前是订阅 Control 发出的这个 topic
-                    if (world_state_.SerializeToString(&serialized)) {
-                        bool published = middleware.publish("visualizer/data", serialized);
+                    if (world_state_.SerializeToString(&publish_buffer_)) {
+                        bool published = middleware.publishSerialized(simple_middleware::topics::kGroundTruth, publish_buffer_);
                         if (published) {
-                            no_publish_count = 0;
-                            static int pub_count = 0;
-                            if (pub_count++ % 30 == 0 || pub_count == 1) { // 每 30 次或第一次打印
-                                simple_middleware::Logger::Debug("Simulator: Published visualizer/data, frame_id=" 
-                                    + std::to_string(world_state_.frame_id())
-                                    + ", car_state: x=" + std::to_string(world_state_.car_state().position().x())
-                                    + ", y=" + std::to_string(world_state_.car_state().position().y())
-                                    + ", speed=" + std::to_string(world_state_.car_state().speed())
-                                    + ", size=" + std::to_string(serialized.size()) + " bytes");
-                            }
+                            LOG_EVERY_N(DEBUG, "Simulator", 30) << "Published visualizer/data, frame_id="
+                                << world_state_.frame_id()
+                                << ", car_state: x=" << world_state_.car_state().position().x()
+                                << ", y=" << world_state_.car_state().position().y()
+                                << ", speed=" << world_state_.car_state().speed()
+                                << ", size=" << publish_buffer_.size() << " bytes";
                         } else {
-                            no_publish_count++;
-                            if (no_publish_count % 10 == 0) {
-                                simple_middleware::Logger::Warn("Simulator: Failed to publish visualizer/data (count=" 
-                                    + std::to_string(no_publish_count) + ")");
-                            }
+                            // 累计失败次数见话题统计中的 send_drops
+                            LOG_EVERY_N(WARN, "Simulator", 10) << "Failed to publish visualizer/data, frame_id="
+                                << world_state_.frame_id() << ", size=" << publish_buffer_.size() << " bytes";
                         }
                     } else {
-                        static int serialize_fail_count = 0;
-                        if (serialize_fail_count++ % 10 == 0) {
-                            simple_middleware::Logger::Warn("Simulator: Failed to serialize world_state");
-                        }
+                        LOG_EVERY_N(WARN, "Simulator", 10) << "Failed to serialize world_state";
                     }
                 }
             }
 
+            ReportPipelineLatency();
+            physics_loop_->endCycle();
+
             auto end = std::chrono::steady_clock::now();
             auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
             if (elapsed.count() < 10) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(10) - elapsed);
             }
         } catch (const std::exception& e) {
-            static int error_count = 0;
-            if (error_count++ % 10 == 0) {
-                simple_middleware::Logger::Error("Simulator: Exception in RunLoop: " + std::string(e.what()));
-            }
+            LOG_EVERY_N(ERROR, "Simulator", 10) << "Exception in RunLoop: " << e.what();
         } catch (...) {
-            static int error_count = 0;
-            if (error_count++ % 10 == 0) {
-                simple_middleware::Logger::Error("Simulator: Unknown exception in RunLoop");
-            }
+            LOG_EVERY_N(ERROR, "Simulator", 10) << "Unknown exception in RunLoop";
         }
     }
 }
 
+void SimulatorCore::ReportPipelineLatency() {
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_trace_report_ < std::chrono::milliseconds(TRACE_REPORT_INTERVAL_MS)) {
+        return;
+    }
+    last_trace_report_ = now;
+
+    // 每个窗口输出一次分阶段/端到端延迟，然后清零开始下一个窗口
+    auto stages = trace_collector_.snapshot();
+    if (stages.empty() || stages.back().latency.count == 0) {
+        return;
+    }
+    simple_middleware::Logger::Info(trace_collector_.formatReport());
+    trace_collector_.reset();
+}
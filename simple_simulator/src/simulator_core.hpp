@@ -2,6 +2,9 @@
 
 #include <simple_middleware/pub_sub_middleware.hpp>
 #include <simple_middleware/status_reporter.hpp>
+#include <simple_middleware/topics.hpp>
+#include <simple_middleware/trace.hpp>
+#include <simple_middleware/message_arena.hpp>
 #include <common_msgs/visualizer_data.pb.h>
 // #include <common_msgs/control_command.pb.h> // Removed: defined in visualizer_data.pb.h
 #include <thread>
@@ -9,6 +12,7 @@
 #include <mutex>
 #include <vector>
 #include <unordered_map>
+#include <chrono>
 
 class SimulatorCore {
 public:
@@ -20,7 +24,10 @@ public:
 
 private:
     void RunLoop();
-    void OnControlCommand(const simple_middleware::Message& msg);
+    // 拆分话题发布，调用方持有 state_mutex_
+    void PublishEgoState(simple_middleware::PubSubMiddleware& middleware);
+    void PublishObstacles(simple_middleware::PubSubMiddleware& middleware);
+    void OnControlCommand(const senseauto::demo::ControlCommand& cmd);
     void OnControlMessage(const simple_middleware::Message& msg); // 处理 reset 等命令
     
     // 物理步进
@@ -34,9 +41,15 @@ private:
     std::thread thread_;
     std::mutex state_mutex_;
     std::unique_ptr<simple_middleware::StatusReporter> status_reporter_;
+    simple_middleware::LoopMonitor* physics_loop_ = nullptr;  // 100Hz 物理仿真循环的时序统计
 
     // 世界状态
-    senseauto::demo::FrameData world_state_;
+    senseauto::demo::FrameData world_state_;  // 跨周期持续更新的世界状态，障碍物对象原地复用
+    std::string publish_buffer_;              // 真值序列化缓冲区
+    senseauto::demo::EgoState ego_state_;     // 自车状态消息，每周期原地更新
+    std::string ego_buffer_;
+    simple_middleware::MessageArena obstacles_arena_;
+    std::string obstacles_buffer_;
     double time_accumulator_ = 0.0;
 
     // 接收到的控制量 (来自 Control 模块)
@@ -46,6 +59,8 @@ private:
     // 发布节流：物理仿真保持 100Hz，但只每 N 帧发布一次给前端
     int publish_counter_ = 0;
     const int PUBLISH_INTERVAL = 5; // 每 5 帧发布一次，即 20Hz (100Hz / 5)
+    int obstacles_publish_counter_ = 0;
+    const int OBSTACLES_PUBLISH_INTERVAL = 10; // 障碍物真值 10Hz；自车状态每帧发布（100Hz）
     
     // 车辆物理参数
     const double WHEELBASE = 2.8;
@@ -61,5 +76,11 @@ private:
     
     // 更新动态障碍物位置
     void UpdateDynamicObstacles(double dt);
+
+    // 链路追踪：真值帧带上追踪上下文发出，经 Sensor→Perception→Planning→Control 后随控制指令回到这里
+    simple_middleware::TraceCollector trace_collector_;
+    std::chrono::steady_clock::time_point last_trace_report_;
+    const int TRACE_REPORT_INTERVAL_MS = 5000;
+    void ReportPipelineLatency();
 };
 
@@ -1,13 +1,12 @@
 #include "visualizer_component.hpp"
-#include <json11.hpp>
 #include <iostream>
 #include <chrono>
 #include <ctime>
 #include <cmath>
 #include <cstring> // for memcpy
 #include <simple_middleware/logger.hpp>
-
-using namespace json11;
+#include <simple_middleware/profiler.hpp>
+#include <simple_middleware/json_writer.hpp>
 
 VisualizerComponent::VisualizerComponent() {
     Reset();
@@ -16,15 +15,15 @@ VisualizerComponent::VisualizerComponent() {
 void VisualizerComponent::Reset() {
     std::lock_guard<std::mutex> lock(state_mutex_);
     
-    frame_data_.Clear();
-    
     // 初始化一个默认状态
-    auto* car = frame_data_.mutable_car_state();
+    senseauto::demo::FrameData frame;
+    auto* car = frame.mutable_car_state();
     car->mutable_position()->set_x(0.0);
     car->mutable_position()->set_y(0.0);
     car->set_heading(0.0);
     car->set_speed(0.0);
     car->set_steering_angle(0.0);
+    frame_data_.publish(std::move(frame));
 
     time_accumulator_ = 0.0;
 }
@@ -40,10 +39,9 @@ void VisualizerComponent::SetSteering(double angle) {
 }
 
 // 核心更新逻辑：从 Simulator 同步状态
-void VisualizerComponent::UpdateFromSimulator(const senseauto::demo::FrameData& sim_frame) {
-    std::lock_guard<std::mutex> lock(state_mutex_);
-    // 直接覆盖本地状态
-    frame_data_ = sim_frame;
+void VisualizerComponent::UpdateFromSimulator(std::shared_ptr<const senseauto::demo::FrameData> sim_frame) {
+    // 直接替换本地状态，正在序列化旧帧的线程不受影响
+    frame_data_.publish(std::move(sim_frame));
 }
 
 void VisualizerComponent::Update(double dt) {
@@ -98,13 +96,8 @@ bool VisualizerComponent::UpdateCameraImageRGB(const std::string& rgb_data, int
     
     has_new_image_ = true;
     
-    static int update_count = 0;
-    update_count++;
-    if (update_count % 3 == 0 || update_count <= 5) {
-        simple_middleware::Logger::Debug("VisualizerComponent: UpdateCameraImageRGB: image=" 
-            + std::to_string(width) + "x" + std::to_string(height) 
-            + ", detections=" + std::to_string(current_detections_.boxes_size()));
-    }
+    LOG_EVERY_N(DEBUG, "VisualizerComponent", 3) << "UpdateCameraImageRGB: image="
+        << width << "x" << height << ", detections=" << current_detections_.boxes_size();
     
     return true;
 }
@@ -113,31 +106,24 @@ void VisualizerComponent::UpdateDetections(const senseauto::demo::Detection2DArr
     std::lock_guard<std::mutex> lock(img_mutex_);
     current_detections_ = dets;
     
-    static int update_count = 0;
-    update_count++;
-    // 总是打印，因为这是关键数据流
-    simple_middleware::Logger::Info("VisualizerComponent: UpdateDetections: received " 
-        + std::to_string(dets.boxes_size()) + " boxes, current_image: " 
-        + std::to_string(current_image_.width) + "x" + std::to_string(current_image_.height));
+    LOG_INFO("VisualizerComponent") << "UpdateDetections: received " << dets.boxes_size()
+        << " boxes, current_image: " << current_image_.width << "x" << current_image_.height;
     for (int i = 0; i < dets.boxes_size(); ++i) {
         const auto& box = dets.boxes(i);
-        simple_middleware::Logger::Info("  Box " + std::to_string(i) + ": x=" + std::to_string(box.x()) 
-            + ", y=" + std::to_string(box.y()) + ", w=" + std::to_string(box.width()) 
-            + ", h=" + std::to_string(box.height()) + ", label=" + box.label());
+        LOG_DEBUG("VisualizerComponent") << "  Box " << i << ": x=" << box.x() << ", y=" << box.y()
+            << ", w=" << box.width() << ", h=" << box.height() << ", label=" << box.label();
     }
 }
 
 std::vector<unsigned char> VisualizerComponent::GetRenderedImage() {
+    PROFILE_SCOPE("Visualizer::RenderImage");
     std::lock_guard<std::mutex> lock(img_mutex_);
     
     // 只要有图像数据就渲染（不依赖 has_new_image_ 标志）
     // 这样即使只有检测数据更新，也能重新绘制
     if (current_image_.width == 0 || current_image_.height == 0) {
-        static int empty_count = 0;
-        if (empty_count++ % 10 == 0 || empty_count <= 3) {
-            simple_middleware::Logger::Debug("VisualizerComponent: GetRenderedImage: no image data, width=" 
-                + std::to_string(current_image_.width) + ", height=" + std::to_string(current_image_.height));
-        }
+        LOG_EVERY_N(DEBUG, "VisualizerComponent", 10) << "GetRenderedImage: no image data, width="
+            << current_image_.width << ", height=" << current_image_.height;
         return {};
     }
 
@@ -151,10 +137,8 @@ std::vector<unsigned char> VisualizerComponent::GetRenderedImage() {
     render_count++;
     
     if (detection_count > 0) {
-        // 总是打印，因为这是关键功能
-        simple_middleware::Logger::Info("VisualizerComponent: GetRenderedImage: Drawing " 
-            + std::to_string(detection_count) + " detection boxes on image " 
-            + std::to_string(render_image.width) + "x" + std::to_string(render_image.height));
+        LOG_DEBUG("VisualizerComponent") << "GetRenderedImage: Drawing " << detection_count
+            << " detection boxes on image " << render_image.width << "x" << render_image.height;
         
         for (int i = 0; i < detection_count; ++i) {
             const auto& box = current_detections_.boxes(i);
@@ -170,22 +154,19 @@ std::vector<unsigned char> VisualizerComponent::GetRenderedImage() {
             if (x + w > render_image.width) w = render_image.width - x;
             if (y + h > render_image.height) h = render_image.height - y;
             
-            // 总是打印前几次，确保能看到绘制信息
-            if (render_count <= 10) {
-                simple_middleware::Logger::Info("VisualizerComponent: Drawing box " + std::to_string(i) 
-                    + ": original(x=" + std::to_string(box.x()) + ", y=" + std::to_string(box.y()) 
-                    + ", w=" + std::to_string(box.width()) + ", h=" + std::to_string(box.height()) + ")"
-                    + " -> clamped(x=" + std::to_string(x) + ", y=" + std::to_string(y) 
-                    + ", w=" + std::to_string(w) + ", h=" + std::to_string(h) + ")"
-                    + ", image_size=" + std::to_string(render_image.width) + "x" + std::to_string(render_image.height)
-                    + ", label=" + box.label());
-            }
+            // 前几次渲染打印绘制信息
+            LOG_IF(INFO, "VisualizerComponent", render_count <= 10) << "Drawing box " << i
+                << ": original(x=" << box.x() << ", y=" << box.y()
+                << ", w=" << box.width() << ", h=" << box.height() << ")"
+                << " -> clamped(x=" << x << ", y=" << y << ", w=" << w << ", h=" << h << ")"
+                << ", image_size=" << render_image.width << "x" << render_image.height
+                << ", label=" << box.label();
             
             // 绘制红色检测框（使用更粗的线宽，确保可见）
             render_image.DrawRect(x, y, w, h, red, 5); // 线宽 5，更明显
             
             // 验证绘制是否成功（检查绘制后的像素是否变红）
-            if (render_count <= 5) {
+            if (render_count <= 5 && simple_middleware::Logger::IsEnabled(simple_middleware::LogLevel::INFO)) {
                 // 检查左上角、右上角像素是否被绘制（应该是红色）
                 if (x < render_image.width && y < render_image.height) {
                     const auto& pixel_tl = render_image.data[y * render_image.width + x];
@@ -204,13 +185,10 @@ std::vector<unsigned char> VisualizerComponent::GetRenderedImage() {
             }
         }
     } else {
-        // 总是打印，因为这是问题所在
-        if (render_count <= 10 || render_count % 5 == 0) {
-            simple_middleware::Logger::Warn("VisualizerComponent: GetRenderedImage: No detection boxes to draw (render_count=" 
-                + std::to_string(render_count) + ", image=" + std::to_string(render_image.width) 
-                + "x" + std::to_string(render_image.height) + ", current_detections_.boxes_size()=" 
-                + std::to_string(current_detections_.boxes_size()) + ")");
-        }
+        LOG_IF(WARN, "VisualizerComponent", render_count <= 10 || render_count % 5 == 0)
+            << "GetRenderedImage: No detection boxes to draw (render_count=" << render_count
+            << ", image=" << render_image.width << "x" << render_image.height
+            << ", current_detections_.boxes_size()=" << current_detections_.boxes_size() << ")";
     }
     
     // 返回 Raw RGB Buffer (去除 PPM Header)
@@ -247,43 +225,49 @@ std::vector<unsigned char> VisualizerComponent::GetRenderedImage() {
 }
 
 // 序列化给前端 WebSocket
-std::string VisualizerComponent::GetSerializedData(int frame_id) {
-    std::lock_guard<std::mutex> lock(state_mutex_);
+void VisualizerComponent::GetSerializedData(int frame_id, std::string* out) {
+    PROFILE_SCOPE("Visualizer::SerializeFrame");
+    // 只读快照，不需要持锁
+    auto frame = frame_data_.load();
+    
+    out->clear();
+    simple_middleware::JsonWriter w(out);
+    w.beginObject();
+    w.field("type", "frame_data");
+    w.field("frame_id", frame_id);
+    w.field("timestamp", static_cast<long long>(std::time(nullptr)));
     
-    // 1. 处理障碍物列表
-    Json::array obstacles_json;
-    for (int i = 0; i < frame_data_.obstacles_size(); ++i) {
-        const auto& obs = frame_data_.obstacles(i);
-        obstacles_json.push_back(Json::object {
-            {"id", obs.id()},
-            {"type", obs.type()},
-            {"position", Json::object {
-                {"x", obs.position().x()},
-                {"y", obs.position().y()}
-            }},
-            // 将新增字段也传给前端（前端目前可能还没用，但以后会有用）
-            {"length", obs.length()},
-            {"width", obs.width()},
-            {"heading", obs.heading()}
-        });
+    const auto& car = frame->car_state();
+    w.key("car_state");
+    w.beginObject();
+    w.field("speed", car.speed());
+    w.field("heading", car.heading());
+    w.field("steering_angle", car.steering_angle());
+    w.key("position");
+    w.beginObject();
+    w.field("x", car.position().x());
+    w.field("y", car.position().y());
+    w.endObject();
+    w.endObject();
+    
+    // 障碍物列表
+    w.key("obstacles");
+    w.beginArray();
+    for (const auto& obs : frame->obstacles()) {
+        w.beginObject();
+        w.field("id", obs.id());
+        w.field("type", obs.type());
+        w.key("position");
+        w.beginObject();
+        w.field("x", obs.position().x());
+        w.field("y", obs.position().y());
+        w.endObject();
+        // 将新增字段也传给前端（前端目前可能还没用，但以后会有用）
+        w.field("length", obs.length());
+        w.field("width", obs.width());
+        w.field("heading", obs.heading());
+        w.endObject();
     }
-
-    // 2. 构造最终的 JSON 对象
-    Json final_json = Json::object {
-        {"type", "frame_data"},
-        {"frame_id", frame_id},
-        {"timestamp", (int)std::time(nullptr)},
-        {"car_state", Json::object {
-            {"speed", frame_data_.car_state().speed()},
-            {"heading", frame_data_.car_state().heading()},
-            {"steering_angle", frame_data_.car_state().steering_angle()},
-            {"position", Json::object {
-                {"x", frame_data_.car_state().position().x()},
-                {"y", frame_data_.car_state().position().y()}
-            }}
-        }},
-        {"obstacles", obstacles_json}
-    };
-
-    return final_json.dump();
+    w.endArray();
+    w.endObject();
 }
@@ -5,6 +5,7 @@
 #include <common_msgs/visualizer_data.pb.h> 
 #include <common_msgs/sensor_data.pb.h> // New
 #include <common_msgs/simple_image.hpp> // New
+#include <simple_middleware/snapshot.hpp>
 
 #include <mutex>
 #include <vector>
@@ -25,7 +26,8 @@ public:
     void Update(double dt);
     
     // 更新外部数据
-    void UpdateFromSimulator(const senseauto::demo::FrameData& sim_frame);
+    // 整体替换当前帧快照，不拷贝消息
+    void UpdateFromSimulator(std::shared_ptr<const senseauto::demo::FrameData> sim_frame);
     bool UpdateCameraImage(const std::string& ppm_data);
     bool UpdateCameraImageRGB(const std::string& rgb_data, int width, int height); // 新增：处理纯 RGB 数据
     void UpdateDetections(const senseauto::demo::Detection2DArray& dets);
@@ -34,13 +36,14 @@ public:
     // 返回格式: [Width:4][Height:4][RGB...]
     std::vector<unsigned char> GetRenderedImage();
     
-    std::string GetSerializedData(int frame_id);
+    // 把当前帧序列化为前端使用的 frame_data JSON，写入 out（先清空，复用其容量）
+    void GetSerializedData(int frame_id, std::string* out);
 
 private:
     std::mutex state_mutex_;
     std::mutex img_mutex_;
     
-    senseauto::demo::FrameData frame_data_;
+    simple_middleware::Snapshot<senseauto::demo::FrameData> frame_data_;  // 最新的仿真帧（只读快照）
     
     // 图像与检测结果
     simple_image::SimpleImage current_image_;
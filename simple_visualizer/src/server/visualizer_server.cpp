@@ -3,16 +3,30 @@
 #include <iostream>
 #include <chrono>
 #include <ctime>
+#include <cmath>
 #include <iomanip>
-#include <arpa/inet.h> // for ntohl
 #include <common_msgs/daemon.pb.h>
+#include <common_msgs/prediction_model.hpp>
 #include <json11.hpp>
 #include <simple_middleware/logger.hpp> // Add middleware logger
+#include <simple_middleware/profiler.hpp>
+#include <simple_middleware/json_reader.hpp>
+#include <simple_middleware/json_writer.hpp>
+#include <simple_middleware/config_manager.hpp>
 
 using namespace json11;
 
 VisualizerServer::VisualizerServer() : running_(false) {
     status_reporter_ = std::make_unique<simple_middleware::StatusReporter>("VisualizerNode");
+
+    // 前端只有一个相机画面：显示 Sensor 配置中第一路启用的相机（SIMPLE_SENSOR_CONFIG 可切换配置）
+    auto& config = simple_middleware::ConfigManager::GetInstance();
+    std::string camera_name = "front";
+    if (config.Load("sensor", "config/sensor.json")) {
+        auto names = simple_middleware::EnabledCameraNames(config.GetConfig("sensor"));
+        if (!names.empty()) camera_name = names.front();
+    }
+    display_camera_ = std::make_unique<simple_middleware::CameraTopics>(camera_name);
 }
 
 VisualizerServer::~VisualizerServer() {
@@ -96,32 +110,20 @@ void VisualizerServer::BroadcastMessage(const std::string& message) {
 
     std::lock_guard<std::mutex> lock(conn_mutex_);
     
-    // 添加调试日志（仅对地图和预测数据）
-    static int broadcast_count = 0;
-    static int map_broadcast_count = 0;
-    static int pred_broadcast_count = 0;
-    
-    bool is_map = (message.find("\"type\"") != std::string::npos && 
-                   message.find("\"map_data\"") != std::string::npos);
-    bool is_pred = (message.find("\"type\"") != std::string::npos && 
-                    message.find("\"prediction_trajectories\"") != std::string::npos);
-    
-    if (is_map) {
-        if (map_broadcast_count++ % 10 == 0 || map_broadcast_count == 1) {
-            Log("INFO", "BroadcastMessage: Sending map_data to " + std::to_string(connections_.size()) 
-                + " connections, size=" + std::to_string(message.size()) + " bytes");
-        }
-    } else if (is_pred) {
-        if (pred_broadcast_count++ % 10 == 0 || pred_broadcast_count == 1) {
-            Log("INFO", "BroadcastMessage: Sending prediction_trajectories to " + std::to_string(connections_.size()) 
-                + " connections, size=" + std::to_string(message.size()) + " bytes");
+    // 添加调试日志（仅对地图和预测数据；INFO 关闭时连消息类型判断也省掉）
+    if (simple_middleware::Logger::IsEnabled(simple_middleware::LogLevel::INFO) &&
+        message.find("\"type\"") != std::string::npos) {
+        if (message.find("\"map_data\"") != std::string::npos) {
+            LOG_EVERY_N(INFO, "VisualizerServer", 10) << "BroadcastMessage: Sending map_data to "
+                << connections_.size() << " connections, size=" << message.size() << " bytes";
+        } else if (message.find("\"prediction_trajectories\"") != std::string::npos) {
+            LOG_EVERY_N(INFO, "VisualizerServer", 10) << "BroadcastMessage: Sending prediction_trajectories to "
+                << connections_.size() << " connections, size=" << message.size() << " bytes";
         }
     }
     
     if (connections_.empty()) {
-        if (broadcast_count++ % 100 == 0) {
-            Log("WARN", "BroadcastMessage: No WebSocket connections available!");
-        }
+        LOG_EVERY_N(WARN, "VisualizerServer", 100) << "BroadcastMessage: No WebSocket connections available!";
         return;
     }
     
@@ -132,13 +134,11 @@ void VisualizerServer::BroadcastMessage(const std::string& message) {
 
 void VisualizerServer::BroadcastBinaryMessage(const void* data, size_t len) {
     if (!data || len == 0) return;
+    PROFILE_SCOPE("Visualizer::BroadcastImage");
     std::lock_guard<std::mutex> lock(conn_mutex_);
     
-    static int broadcast_counter = 0;
     if (connections_.empty()) {
-        if (broadcast_counter++ % 100 == 0) { // 每 10 秒输出一次
-            Log("DEBUG", "No WebSocket connections, skipping image broadcast");
-        }
+        LOG_EVERY_MS(DEBUG, "VisualizerServer", 10000) << "No WebSocket connections, skipping image broadcast";
         return;
     }
     
@@ -146,10 +146,8 @@ void VisualizerServer::BroadcastBinaryMessage(const void* data, size_t len) {
         mg_websocket_write(conn, MG_WEBSOCKET_OPCODE_BINARY, (const char*)data, len);
     }
     
-    if (broadcast_counter++ % 30 == 0) { // 每 3 秒输出一次
-        Log("DEBUG", "Broadcasted binary message to " + std::to_string(connections_.size()) 
-            + " connections, size=" + std::to_string(len) + " bytes");
-    }
+    LOG_EVERY_MS(DEBUG, "VisualizerServer", 3000) << "Broadcasted binary message to " << connections_.size()
+        << " connections, size=" << len << " bytes";
 }
 
 void VisualizerServer::StartThreads() {
@@ -158,30 +156,29 @@ void VisualizerServer::StartThreads() {
     
     auto& middleware = simple_middleware::PubSubMiddleware::getInstance();
     
-    int64_t data_sub_id = middleware.subscribe("visualizer/data", [this](const simple_middleware::Message& msg) {
+    // 真值帧直接解码成新的快照对象交给组件，组件内不再拷贝
+    int64_t data_sub_id = middleware.subscribe(simple_middleware::topics::kGroundTruth, [this](const simple_middleware::Message& msg) {
         if (!running_) return;
-        
-        senseauto::demo::FrameData frame;
-        if (frame.ParseFromString(msg.data)) {
-            static int recv_count = 0;
-            if (recv_count++ % 30 == 0 || recv_count == 1) { // 每 30 帧或第一次打印
-                Log("DEBUG", "Received Sim Frame ID: " + std::to_string(frame.frame_id())
-                    + ", car_state: x=" + std::to_string(frame.car_state().position().x())
-                    + ", y=" + std::to_string(frame.car_state().position().y())
-                    + ", speed=" + std::to_string(frame.car_state().speed()));
-            }
 
-            biz_component_.UpdateFromSimulator(frame);
-            
-            std::string json_data = biz_component_.GetSerializedData(frame.frame_id());
-            msg_queue_.Push(json_data);
-        } else {
-             static int parse_fail_count = 0;
-             if (parse_fail_count++ % 10 == 0) {
-                 Log("WARN", "Failed to parse visualizer/data (Protobuf), message size=" 
-                     + std::to_string(msg.data.size()));
-             }
+        auto frame = std::make_shared<senseauto::demo::FrameData>();
+        if (!frame->ParseFromString(msg.data)) {
+            LOG_EVERY_N(WARN, "VisualizerServer", 10) << "Failed to parse visualizer/data (Protobuf), message size="
+                << msg.data.size();
+            return;
         }
+
+        // 每 30 帧或第一次打印
+        LOG_EVERY_N(DEBUG, "VisualizerServer", 30) << "Received Sim Frame ID: " << frame->frame_id()
+            << ", car_state: x=" << frame->car_state().position().x() << ", y="
+            << frame->car_state().position().y() << ", speed=" << frame->car_state().speed();
+
+        int frame_id = frame->frame_id();
+        biz_component_.UpdateFromSimulator(std::move(frame));
+
+        // 序列化缓冲区按线程复用，入队时只拷贝一次
+        thread_local std::string json_data;
+        biz_component_.GetSerializedData(frame_id, &json_data);
+        msg_queue_.Push(json_data);
     });
     if (data_sub_id >= 0) {
         Log("INFO", "Subscribed to visualizer/data (ID: " + std::to_string(data_sub_id) + ")");
@@ -189,32 +186,18 @@ void VisualizerServer::StartThreads() {
         Log("ERROR", "Failed to subscribe to visualizer/data");
     }
 
-    middleware.subscribe("planning/trajectory", [this](const simple_middleware::Message& msg) {
-        this->OnMiddlewareMessage(msg); 
-    });
-    
-    // 订阅规划轨迹分片
-    middleware.subscribe("planning/trajectory/chunk", [this](const simple_middleware::Message& msg) {
-        this->OnTrajectoryChunk(msg);
+    middleware.subscribe(simple_middleware::topics::kPlanningTrajectory, [this](const senseauto::demo::Trajectory& traj) {
+        this->OnPlanningTrajectory(traj);
     });
     
     // 订阅地图数据分片
-    middleware.subscribe("visualizer/map/chunk", [this](const simple_middleware::Message& msg) {
+    middleware.subscribe(simple_middleware::topics::kMapChunk, [this](const simple_middleware::Message& msg) {
         this->OnMapChunk(msg);
     });
     
-    // 订阅预测轨迹分片
-    middleware.subscribe("prediction/trajectories/chunk", [this](const simple_middleware::Message& msg) {
-        this->OnPredictionChunk(msg);
-    });
-    
     // 订阅预测轨迹
-    int64_t pred_sub_id = middleware.subscribe("prediction/trajectories", [this](const simple_middleware::Message& msg) {
-        static int recv_count = 0;
-        if (recv_count++ % 10 == 0 || recv_count == 1) {
-            Log("DEBUG", "Visualizer: Received prediction/trajectories message, size=" + std::to_string(msg.data.size()));
-        }
-        this->OnPredictionTrajectories(msg);
+    int64_t pred_sub_id = middleware.subscribe(simple_middleware::topics::kPredictionTrajectories, [this](const senseauto::demo::PredictionArray& prediction) {
+        this->OnPredictionTrajectories(prediction);
     });
     if (pred_sub_id >= 0) {
         Log("INFO", "Subscribed to prediction/trajectories (ID: " + std::to_string(pred_sub_id) + ")");
@@ -222,27 +205,10 @@ void VisualizerServer::StartThreads() {
         Log("ERROR", "Failed to subscribe to prediction/trajectories");
     }
 
-    int64_t map_sub_id = middleware.subscribe("visualizer/map", [this](const simple_middleware::Message& msg) {
-        static int recv_count = 0;
-        recv_count++;
-        // 总是打印前几次，然后每10次打印一次
-        if (recv_count <= 5 || recv_count % 10 == 0) {
-            Log("INFO", "Visualizer: Received visualizer/map message #" + std::to_string(recv_count) 
-                + ", size=" + std::to_string(msg.data.size()) + " bytes");
-            // 打印前200个字符用于调试
-            if (msg.data.size() > 0) {
-                std::string preview = msg.data.substr(0, std::min(200UL, msg.data.size()));
-                Log("DEBUG", "Map message preview: " + preview + "...");
-                // 检查是否包含关键字段
-                if (msg.data.find("\"lanes\"") == std::string::npos) {
-                    Log("WARN", "Map message does not contain 'lanes' field!");
-                } else {
-                    Log("DEBUG", "Map message contains 'lanes' field");
-                }
-            } else {
-                Log("WARN", "Map message is empty!");
-            }
-        }
+    int64_t map_sub_id = middleware.subscribe(simple_middleware::topics::kMap, [this](const simple_middleware::Message& msg) {
+        LOG_EVERY_N(INFO, "VisualizerServer", 10) << "Received visualizer/map message, size=" << msg.data.size()
+            << " bytes";
+        LOG_IF(WARN, "VisualizerServer", msg.data.empty()) << "Map message is empty!";
         this->OnMiddlewareMessage(msg); 
     });
     if (map_sub_id >= 0) {
@@ -251,30 +217,27 @@ void VisualizerServer::StartThreads() {
         Log("ERROR", "Failed to subscribe to visualizer/map");
     }
 
-    middleware.subscribe("system/status", [this](const simple_middleware::Message& msg) {
+    middleware.subscribe(simple_middleware::topics::kSystemStatus, [this](const simple_middleware::Message& msg) {
         this->OnSystemStatus(msg);
     });
     
-    middleware.subscribe("sensor/camera/front", [this](const simple_middleware::Message& msg) {
-        static int recv_count = 0;
-        if (recv_count++ % 30 == 0) {
-            Log("DEBUG", "Visualizer: Received sensor/camera/front message, size=" + std::to_string(msg.data.size()));
-        }
-        this->OnCameraData(msg);
+    middleware.subscribe(display_camera_->topic(), [this](const senseauto::demo::CameraFrame& frame) {
+        LOG_EVERY_N(DEBUG, "VisualizerServer", 30) << "Received " << display_camera_->topic_name
+            << " message, image_size=" << frame.raw_image().size();
+        this->OnCameraData(frame);
     });
 
-    int64_t chunk_sub_id = middleware.subscribe("sensor/camera/front/chunk", [this](const simple_middleware::Message& msg) {
+    int64_t chunk_sub_id = middleware.subscribe(display_camera_->chunk_topic(), [this](const simple_middleware::Message& msg) {
         this->OnCameraChunk(msg);
     });
     if (chunk_sub_id >= 0) {
-        Log("INFO", "Subscribed to sensor/camera/front/chunk (ID: " + std::to_string(chunk_sub_id) + ")");
+        Log("INFO", "Subscribed to " + display_camera_->chunk_topic_name + " (ID: " + std::to_string(chunk_sub_id) + ")");
     } else {
-        Log("ERROR", "Failed to subscribe to sensor/camera/front/chunk");
+        Log("ERROR", "Failed to subscribe to " + display_camera_->chunk_topic_name);
     }
 
-    int64_t det_sub_id = middleware.subscribe("perception/detection_2d", [this](const simple_middleware::Message& msg) {
-        Log("INFO", "Perception/detection_2d callback triggered! message size=" + std::to_string(msg.data.size()));
-        this->OnDetectionData(msg);
+    int64_t det_sub_id = middleware.subscribe(simple_middleware::topics::kDetection2D, [this](const senseauto::demo::Detection2DArray& dets) {
+        this->OnDetectionData(dets);
     });
     if (det_sub_id >= 0) {
         Log("INFO", "Subscribed to perception/detection_2d (ID: " + std::to_string(det_sub_id) + ")");
@@ -291,45 +254,11 @@ void VisualizerServer::StartThreads() {
 void VisualizerServer::OnMiddlewareMessage(const simple_middleware::Message& msg) {
     if (!running_) return;
     
-    // 添加调试日志（仅对地图数据，避免日志过多）
-    static int map_msg_count = 0;
-    static int other_msg_count = 0;
-    
-    // 通过消息内容判断是否是地图数据（包含 "type":"map_data"）
-    if (msg.data.find("\"type\"") != std::string::npos && 
-        msg.data.find("\"map_data\"") != std::string::npos) {
-        map_msg_count++;
-        // 总是打印前几次，然后每10次打印一次
-        if (map_msg_count <= 5 || map_msg_count % 10 == 0) {
-            Log("INFO", "OnMiddlewareMessage: Received map data #" + std::to_string(map_msg_count) 
-                + ", size=" + std::to_string(msg.data.size()) + " bytes");
-            // 打印JSON预览用于调试
-            if (map_msg_count <= 3 && msg.data.size() > 0) {
-                std::string preview = msg.data.substr(0, std::min(300UL, msg.data.size()));
-                Log("DEBUG", "Map JSON preview: " + preview + "...");
-                // 检查是否包含lanes字段
-                if (msg.data.find("\"lanes\"") == std::string::npos) {
-                    Log("WARN", "Map data does not contain 'lanes' field!");
-                } else {
-                    Log("DEBUG", "Map data contains 'lanes' field");
-                }
-            }
-        }
-    } else {
-        if (other_msg_count++ % 100 == 0) {
-            // 其他消息只偶尔打印
-        }
-    }
-    
     // 推送到队列
     msg_queue_.Push(msg.data);
     
     // 添加调试：记录推送
-    static int push_count = 0;
-    push_count++;
-    if (push_count % 100 == 0) {
-        Log("DEBUG", "OnMiddlewareMessage: Pushed " + std::to_string(push_count) + " messages to queue");
-    }
+    LOG_EVERY_N(DEBUG, "VisualizerServer", 100) << "OnMiddlewareMessage: Pushed 100 more messages to queue";
 }
 
 void VisualizerServer::OnSystemStatus(const simple_middleware::Message& msg) {
@@ -358,40 +287,31 @@ void VisualizerServer::OnSystemStatus(const simple_middleware::Message& msg) {
 void VisualizerServer::ConsumeLoop() {
     Log("INFO", "Consumer thread running");
     std::string data;
-    static int msg_count = 0;
-    static int map_msg_count = 0;
+    uint64_t msg_count = 0;
     while (running_) {
         if (msg_queue_.Pop(data)) {
             if (!running_) break;
             
-            // 检查是否是地图数据
-            if (data.find("\"type\"") != std::string::npos && 
-                data.find("\"map_data\"") != std::string::npos) {
-                if (map_msg_count++ % 10 == 0 || map_msg_count == 1) {
-                    Log("INFO", "ConsumeLoop: Broadcasting map_data, size=" + std::to_string(data.size()) + " bytes");
-                    // 打印JSON预览
-                    std::string preview = data.substr(0, std::min(200UL, data.size()));
-                    Log("DEBUG", "Map data preview: " + preview + "...");
-                }
-            }
-            
-            // 检查是否是预测轨迹数据
-            if (data.find("\"type\"") != std::string::npos && 
-                data.find("\"prediction_trajectories\"") != std::string::npos) {
-                static int pred_msg_count = 0;
-                if (pred_msg_count++ % 10 == 0 || pred_msg_count == 1) {
-                    Log("INFO", "ConsumeLoop: Broadcasting prediction_trajectories, size=" + std::to_string(data.size()) + " bytes");
-                    // 打印JSON预览
-                    std::string preview = data.substr(0, std::min(200UL, data.size()));
-                    Log("DEBUG", "Prediction data preview: " + preview + "...");
+            // 检查是否是地图 / 预测轨迹数据（只用于日志，INFO 关闭时跳过）
+            if (simple_middleware::Logger::IsEnabled(simple_middleware::LogLevel::INFO) &&
+                data.find("\"type\"") != std::string::npos) {
+                if (data.find("\"map_data\"") != std::string::npos) {
+                    LOG_EVERY_N(INFO, "VisualizerServer", 10) << "ConsumeLoop: Broadcasting map_data, size="
+                        << data.size() << " bytes";
+                    LOG_EVERY_N(DEBUG, "VisualizerServer", 10) << "Map data preview: "
+                        << data.substr(0, std::min(200UL, data.size())) << "...";
+                } else if (data.find("\"prediction_trajectories\"") != std::string::npos) {
+                    LOG_EVERY_N(INFO, "VisualizerServer", 10) << "ConsumeLoop: Broadcasting prediction_trajectories, size="
+                        << data.size() << " bytes";
+                    LOG_EVERY_N(DEBUG, "VisualizerServer", 10) << "Prediction data preview: "
+                        << data.substr(0, std::min(200UL, data.size())) << "...";
                 }
             }
             
             BroadcastMessage(data);
             msg_count++;
-            if (msg_count % 100 == 0) {
-                Log("DEBUG", "ConsumeLoop: Broadcasted " + std::to_string(msg_count) + " messages");
-            }
+            LOG_IF(DEBUG, "VisualizerServer", msg_count % 100 == 0) << "ConsumeLoop: Broadcasted " << msg_count
+                << " messages";
         }
     }
     Log("INFO", "Consumer thread exited");
@@ -399,8 +319,7 @@ void VisualizerServer::ConsumeLoop() {
 
 void VisualizerServer::RenderLoop() {
     Log("INFO", "Render thread running");
-    static int render_counter = 0;
-    static int empty_counter = 0;
+    simple_middleware::Profiler::SetThreadName("Visualizer::RenderLoop");
     
     while (running_) {
         // 1Hz 频率（每秒1帧），与 Sensor 同步
@@ -410,16 +329,10 @@ void VisualizerServer::RenderLoop() {
             auto img_buffer = biz_component_.GetRenderedImage();
             if (!img_buffer.empty()) {
                 BroadcastBinaryMessage(img_buffer.data(), img_buffer.size());
-                render_counter++;
-                if (render_counter % 5 == 0 || render_counter <= 5) { // 每 5 秒或前 5 次打印
-                    Log("DEBUG", "Broadcasted image: size=" + std::to_string(img_buffer.size()) 
-                        + " bytes, total sent=" + std::to_string(render_counter));
-                }
+                LOG_EVERY_N(DEBUG, "VisualizerServer", 5) << "Broadcasted image: size=" << img_buffer.size()
+                    << " bytes";
             } else {
-                empty_counter++;
-                if (empty_counter % 5 == 0 || empty_counter <= 5) { // 每 5 秒或前 5 次打印
-                    Log("DEBUG", "GetRenderedImage returned empty buffer (count=" + std::to_string(empty_counter) + ")");
-                }
+                LOG_EVERY_N(DEBUG, "VisualizerServer", 5) << "GetRenderedImage returned empty buffer";
             }
         } catch (const std::exception& e) {
              Log("ERROR", "RenderLoop exception: " + std::string(e.what()));
@@ -431,17 +344,21 @@ void VisualizerServer::RenderLoop() {
 void VisualizerServer::HandleClientCommand(const std::string& cmd_json) {
     auto& middleware = simple_middleware::PubSubMiddleware::getInstance();
     
-    std::string err;
-    Json json = Json::parse(cmd_json, err);
-    if (!err.empty()) {
-        Log("ERROR", "Failed to parse client command JSON: " + err);
+    std::string type;
+    std::string action_str;
+    std::string node_name;
+    simple_middleware::JsonReader reader(cmd_json);
+    bool parsed = reader.forEachMember([&](std::string_view key) {
+        if (key == "type") reader.readString(&type);
+        else if (key == "action") reader.readString(&action_str);
+        else if (key == "node") reader.readString(&node_name);
+    });
+    if (!parsed) {
+        Log("ERROR", "Failed to parse client command JSON: " + reader.error());
         return; 
     }
     
-    std::string type = json["type"].string_value();
     if (type == "system_control") {
-        std::string action_str = json["action"].string_value();
-        std::string node_name = json["node"].string_value();
         
         Log("INFO", "Received System Control: " + action_str + " " + node_name);
 
@@ -456,655 +373,212 @@ void VisualizerServer::HandleClientCommand(const std::string& cmd_json) {
             cmd.set_action(simple_daemon::SystemCommand::STOP);
         }
         
-        std::string payload;
-        cmd.SerializeToString(&payload);
-        middleware.publish("system/command", payload);
+        middleware.publish(simple_middleware::topics::kSystemCommand, cmd);
         
     } else {
-        middleware.publish("visualizer/control", cmd_json);
+        middleware.publishSerialized(simple_middleware::topics::kVisualizerControl, cmd_json);
     }
 }
 
-void VisualizerServer::OnCameraData(const simple_middleware::Message& msg) {
+void VisualizerServer::OnCameraData(const senseauto::demo::CameraFrame& frame) {
     if (!running_) return;
-    senseauto::demo::CameraFrame frame;
-    if (frame.ParseFromString(msg.data)) {
-        static int frame_count = 0;
-        frame_count++;
-        if (frame_count % 5 == 0 || frame_count <= 5) {
-            Log("DEBUG", "Received camera frame #" + std::to_string(frame_count) 
-                + ": format=" + frame.image_format() 
-                + ", size=" + std::to_string(frame.raw_image().size())
-                + ", width=" + std::to_string(frame.image_width())
-                + ", height=" + std::to_string(frame.image_height()));
-        }
-        
-        if (frame.image_format() == "ppm") {
-            // 检查是否是纯 RGB 数据（不含 header）
-            // 如果数据大小正好是 width*height*3，说明是纯 RGB 数据
-            size_t expected_rgb_size = frame.image_width() * frame.image_height() * 3;
-            bool is_pure_rgb = (frame.raw_image().size() == expected_rgb_size);
-            
-            bool success = false;
-            if (is_pure_rgb) {
-                // 纯 RGB 数据，直接设置
-                success = biz_component_.UpdateCameraImageRGB(
-                    frame.raw_image(), 
-                    frame.image_width(), 
-                    frame.image_height());
-            } else {
-                // 完整 PPM 文件（含 header），使用原有方法
-                success = biz_component_.UpdateCameraImage(frame.raw_image());
-            }
-            
-            if (frame_count % 5 == 0 || frame_count <= 5) {
-                Log("DEBUG", "UpdateCameraImage result: " + std::string(success ? "success" : "failed")
-                    + ", format=" + (is_pure_rgb ? "RGB" : "PPM"));
-            }
-        } else if (frame.image_format() == "raw_gray") {
-            // 简单的将 Gray 转 RGB (R=G=B)
-            // 这里为了简单，我们假设 VisualizerComponent 能处理或者我们这里转一下
-            // 但 SimpleImage 目前只支持 PPM (RGB)。
-            // 所以我们手动构造一个假的 RGB buffer
-            std::string rgb_data;
-            rgb_data.reserve(frame.raw_image().size() * 3);
-            for (char p : frame.raw_image()) {
-                rgb_data.push_back(p);
-                rgb_data.push_back(p);
-                rgb_data.push_back(p);
-            }
-            // 还需要加上 PPM Header 才能被 FromBuffer 解析... 
-            // SimpleImage::FromBuffer 期望的是 PPM 格式
-            // 让我们别折腾这个了，只要 Sensor 路径对了就行。
-            // 或者，我们可以 hack 一下，如果 simple_image 支持 Raw RGB set
-            Log("WARN", "raw_gray format not fully supported yet");
+    LOG_EVERY_N(DEBUG, "VisualizerServer", 5) << "Received camera frame: format=" << frame.image_format()
+        << ", size=" << frame.raw_image().size() << ", width=" << frame.image_width()
+        << ", height=" << frame.image_height();
+    
+    if (frame.image_format() == "ppm") {
+        // 检查是否是纯 RGB 数据（不含 header）
+        // 如果数据大小正好是 width*height*3，说明是纯 RGB 数据
+        size_t expected_rgb_size = frame.image_width() * frame.image_height() * 3;
+        bool is_pure_rgb = (frame.raw_image().size() == expected_rgb_size);
+        
+        bool success = false;
+        if (is_pure_rgb) {
+            // 纯 RGB 数据，直接设置
+            success = biz_component_.UpdateCameraImageRGB(
+                frame.raw_image(), 
+                frame.image_width(), 
+                frame.image_height());
         } else {
-            Log("WARN", "Unknown image format: " + frame.image_format());
-        }
+            // 完整 PPM 文件（含 header），使用原有方法
+            success = biz_component_.UpdateCameraImage(frame.raw_image());
+        }
+        LOG_IF(WARN, "VisualizerServer", !success) << "UpdateCameraImage failed, format="
+            << (is_pure_rgb ? "RGB" : "PPM");
+    } else if (frame.image_format() == simple_middleware::kImageFormatDeltaRle) {
+        // 无损压缩的 RGB；图像走分片时先到的元数据帧不带图像，直接跳过
+        if (frame.raw_image().empty()) return;
+        // 解码缓冲区按线程复用（直接帧和分片重组帧可能来自不同的回调线程）
+        thread_local std::string decoded;
+        bool success = simple_middleware::ImageDecode(frame.raw_image(), frame.image_width(), frame.image_height(),
+                                                      &decoded)
+            && biz_component_.UpdateCameraImageRGB(decoded, frame.image_width(), frame.image_height());
+        if (!success) {
+            LOG_EVERY_N(WARN, "VisualizerServer", 30) << "Failed to decode " << frame.image_format() << " image: "
+                << frame.raw_image().size() << " bytes, " << frame.image_width() << "x" << frame.image_height();
+        }
+    } else if (frame.image_format() == "raw_gray") {
+        // 简单的将 Gray 转 RGB (R=G=B)
+        // 这里为了简单，我们假设 VisualizerComponent 能处理或者我们这里转一下
+        // 但 SimpleImage 目前只支持 PPM (RGB)。
+        // 所以我们手动构造一个假的 RGB buffer
+        std::string rgb_data;
+        rgb_data.reserve(frame.raw_image().size() * 3);
+        for (char p : frame.raw_image()) {
+            rgb_data.push_back(p);
+            rgb_data.push_back(p);
+            rgb_data.push_back(p);
+        }
+        // 还需要加上 PPM Header 才能被 FromBuffer 解析... 
+        // SimpleImage::FromBuffer 期望的是 PPM 格式
+        // 让我们别折腾这个了，只要 Sensor 路径对了就行。
+        // 或者，我们可以 hack 一下，如果 simple_image 支持 Raw RGB set
+        LOG_EVERY_N(WARN, "VisualizerServer", 30) << "raw_gray format not fully supported yet";
     } else {
-        static int parse_fail_count = 0;
-        if (parse_fail_count++ % 30 == 0) {
-            Log("WARN", "Failed to parse camera data (Protobuf), message size=" + std::to_string(msg.data.size()));
-        }
+        LOG_EVERY_N(WARN, "VisualizerServer", 30) << "Unknown image format: " << frame.image_format();
     }
 }
 
 void VisualizerServer::OnCameraChunk(const simple_middleware::Message& msg) {
     if (!running_) return;
-    
-    // 解析分片头：frame_id(4) + chunk_id(4) + total_chunks(4) + chunk_size(4) + chunk_data
-    if (msg.data.size() < 16) {
-        static int error_count = 0;
-        if (error_count++ % 100 == 0) {
-            Log("WARN", "Camera chunk too small: " + std::to_string(msg.data.size()) + " bytes");
-        }
-        return;
-    }
-    
-    const uint32_t* header = reinterpret_cast<const uint32_t*>(msg.data.data());
-    uint32_t frame_id = ntohl(header[0]);
-    uint32_t chunk_id = ntohl(header[1]);
-    uint32_t total_chunks = ntohl(header[2]);
-    uint32_t chunk_size = ntohl(header[3]);
-    
-    if (msg.data.size() != 16 + chunk_size) {
-        static int error_count = 0;
-        if (error_count++ % 100 == 0) {
-            Log("WARN", "Camera chunk size mismatch: expected " + std::to_string(16 + chunk_size) 
-                + ", got " + std::to_string(msg.data.size()));
-        }
-        return;
-    }
-    
-    // 提取分片数据
-    std::string chunk_data = msg.data.substr(16, chunk_size);
-    
-    // 准备重组后的完整消息（如果需要）
-    std::string full_data;
-    bool should_process = false;
-    
-    {
-        std::lock_guard<std::mutex> lock(chunk_mutex_);
-        
-        // 获取或创建分片缓冲区
-        auto& buffer = chunk_buffers_[frame_id];
-        buffer.frame_id = frame_id;
-        buffer.total_chunks = total_chunks;
-        buffer.last_update = std::chrono::steady_clock::now();
-        
-        // 确保 chunks 数组大小足够
-        if (buffer.chunks.size() < total_chunks) {
-            buffer.chunks.resize(total_chunks);
-        }
-        
-        // 存储分片数据
-        if (chunk_id < total_chunks) {
-            buffer.chunks[chunk_id] = chunk_data;
-        }
-        
-        // 检查是否所有分片都已收到
-        bool all_received = true;
-        for (size_t i = 0; i < total_chunks; ++i) {
-            if (buffer.chunks[i].empty()) {
-                all_received = false;
-                break;
-            }
-        }
-        
-        if (all_received) {
-            // 重组完整数据
-            full_data.reserve(total_chunks * chunk_data.size());
-            for (const auto& chunk : buffer.chunks) {
-                full_data += chunk;
-            }
-            
-            should_process = true;
-            
-            // 删除已重组的分片缓冲区
-            chunk_buffers_.erase(frame_id);
-        }
-        
-        // 清理超时的分片缓冲区
-        auto now = std::chrono::steady_clock::now();
-        for (auto it = chunk_buffers_.begin(); it != chunk_buffers_.end();) {
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                now - it->second.last_update).count();
-            if (elapsed > CHUNK_TIMEOUT_MS) {
-                Log("WARN", "Camera chunk timeout for frame " + std::to_string(it->first));
-                it = chunk_buffers_.erase(it);
-            } else {
-                ++it;
-            }
-        }
-    } // 锁在这里自动释放
-    
-    // 在锁外处理完整数据（避免死锁）
-    if (should_process) {
-        // 构造完整的 Message 并调用 OnCameraData
-        simple_middleware::Message full_msg("sensor/camera/front", full_data);
-        full_msg.timestamp = msg.timestamp;
-        
-        static int reassemble_count = 0;
-        if (reassemble_count++ % 30 == 0) {
-            Log("DEBUG", "Reassembled camera frame " + std::to_string(frame_id) 
-                + " from " + std::to_string(total_chunks) + " chunks, total size=" 
-                + std::to_string(full_data.size()));
-        }
-        
-        OnCameraData(full_msg);
+
+    // 分片只在接收线程上重组和解码，完整数据缓冲区与 Arena 跨帧复用
+    thread_local std::string full_data;
+    if (!camera_chunks_.add(msg.data, &full_data)) return;
+
+    LOG_EVERY_N(DEBUG, "VisualizerServer", 30) << "Reassembled camera frame, total size=" << full_data.size()
+        << ", dropped=" << camera_chunks_.droppedFrames() << ", malformed=" << camera_chunks_.malformedPackets();
+
+    chunk_arena_.reset();
+    auto* frame = chunk_arena_.create<senseauto::demo::CameraFrame>();
+    if (frame->ParseFromString(full_data)) {
+        OnCameraData(*frame);
+    } else {
+        LOG_EVERY_N(WARN, "VisualizerServer", 30) << "Failed to parse camera data (Protobuf), message size="
+            << full_data.size();
     }
 }
 
-void VisualizerServer::OnDetectionData(const simple_middleware::Message& msg) {
+void VisualizerServer::OnDetectionData(const senseauto::demo::Detection2DArray& dets) {
     if (!running_) return;
     
     try {
-        static int recv_count = 0;
-        recv_count++;
-        // 总是打印，因为检测数据频率低（1Hz），不会太多日志
-        Log("INFO", "OnDetectionData called #" + std::to_string(recv_count) + ": message size=" + std::to_string(msg.data.size()));
-        
-        senseauto::demo::Detection2DArray dets;
-        if (dets.ParseFromString(msg.data)) {
-            static int det_count = 0;
-            det_count++;
-            if (det_count % 3 == 0 || det_count <= 5) { // 每 3 帧或前 5 帧打印
-                Log("DEBUG", "Received detection data #" + std::to_string(det_count) + ": " + std::to_string(dets.boxes_size()) + " boxes");
-                
-                // 打印每个检测框的详细信息
-                for (int i = 0; i < dets.boxes_size(); ++i) {
-                    const auto& box = dets.boxes(i);
-                    Log("DEBUG", "  Detection box " + std::to_string(i) + ": x=" 
-                        + std::to_string(box.x()) + ", y=" + std::to_string(box.y())
-                        + ", w=" + std::to_string(box.width()) + ", h=" + std::to_string(box.height())
-                        + ", label=" + box.label());
-                }
-            }
-            biz_component_.UpdateDetections(dets);
-            
-            if (det_count <= 5 || det_count % 3 == 0) {
-                Log("DEBUG", "Updated detections in VisualizerComponent, total boxes=" + std::to_string(dets.boxes_size()));
-            }
-        } else {
-            static int parse_fail_count = 0;
-            parse_fail_count++;
-            if (parse_fail_count % 3 == 0 || parse_fail_count <= 5) {
-                Log("WARN", "Failed to parse detection data (Protobuf), message size=" + std::to_string(msg.data.size()));
-            }
-        }
+        // 多相机时每路一条检测结果，只叠加显示中的那一路（旧版 Perception 不带相机名）
+        if (!dets.camera_name().empty() && dets.camera_name() != display_camera_->name) return;
+        LOG_EVERY_N(DEBUG, "VisualizerServer", 10) << "Received detection data: " << dets.boxes_size() << " boxes";
+        biz_component_.UpdateDetections(dets);
     } catch (const std::exception& e) {
-        static int error_count = 0;
-        if (error_count++ % 10 == 0) {
-            Log("ERROR", "Exception in OnDetectionData: " + std::string(e.what()));
-        }
+        LOG_EVERY_N(ERROR, "VisualizerServer", 10) << "Exception in OnDetectionData: " << e.what();
     } catch (...) {
-        static int error_count = 0;
-        if (error_count++ % 10 == 0) {
-            Log("ERROR", "Unknown exception in OnDetectionData");
-        }
+        LOG_EVERY_N(ERROR, "VisualizerServer", 10) << "Unknown exception in OnDetectionData";
     }
 }
 
-void VisualizerServer::OnTrajectoryChunk(const simple_middleware::Message& msg) {
+void VisualizerServer::OnPlanningTrajectory(const senseauto::demo::Trajectory& traj) {
     if (!running_) return;
-    
-    try {
-        // 解析分片头：frame_id(4) + chunk_id(4) + total_chunks(4) + chunk_size(4) + chunk_data
-        if (msg.data.size() < 16) {
-            static int error_count = 0;
-            if (error_count++ % 100 == 0) {
-                Log("WARN", "Trajectory chunk too small: " + std::to_string(msg.data.size()) + " bytes");
-            }
-            return;
-        }
-        
-        const uint32_t* header = reinterpret_cast<const uint32_t*>(msg.data.data());
-        uint32_t frame_id = ntohl(header[0]);
-        uint32_t chunk_id = ntohl(header[1]);
-        uint32_t total_chunks = ntohl(header[2]);
-        uint32_t chunk_size = ntohl(header[3]);
-        
-        if (msg.data.size() != 16 + chunk_size) {
-            static int error_count = 0;
-            if (error_count++ % 100 == 0) {
-                Log("WARN", "Trajectory chunk size mismatch: expected " + std::to_string(16 + chunk_size) 
-                    + ", got " + std::to_string(msg.data.size()));
-            }
-            return;
-        }
-        
-        // 提取分片数据
-        std::string chunk_data = msg.data.substr(16, chunk_size);
-        
-        bool should_process = false;
-        std::string full_data;
-        
-        {
-            std::lock_guard<std::mutex> lock(chunk_mutex_);
-            
-            // 获取或创建分片缓冲区
-            auto& buffer = chunk_buffers_[frame_id];
-            buffer.frame_id = frame_id;
-            buffer.total_chunks = total_chunks;
-            buffer.last_update = std::chrono::steady_clock::now();
-            
-            // 确保 chunks 数组大小足够
-            if (buffer.chunks.size() < total_chunks) {
-                buffer.chunks.resize(total_chunks);
-            }
-            
-            // 存储分片数据
-            if (chunk_id < total_chunks) {
-                buffer.chunks[chunk_id] = chunk_data;
-            }
-            
-            // 检查是否所有分片都已收到
-            bool all_received = true;
-            for (size_t i = 0; i < total_chunks; ++i) {
-                if (buffer.chunks[i].empty()) {
-                    all_received = false;
-                    break;
-                }
-            }
-            
-            if (all_received) {
-                // 重组完整数据
-                full_data.reserve(total_chunks * chunk_data.size());
-                for (const auto& chunk : buffer.chunks) {
-                    full_data += chunk;
-                }
-                
-                should_process = true;
-                chunk_buffers_.erase(frame_id);
-            }
-            
-            // 清理超时的分片缓冲区
-            auto now = std::chrono::steady_clock::now();
-            for (auto it = chunk_buffers_.begin(); it != chunk_buffers_.end();) {
-                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    now - it->second.last_update).count();
-                if (elapsed > CHUNK_TIMEOUT_MS) {
-                    Log("WARN", "Trajectory chunk timeout for frame " + std::to_string(it->first));
-                    it = chunk_buffers_.erase(it);
-                } else {
-                    ++it;
-                }
-            }
-        }
-        
-        // 在锁外处理完整数据
-        if (should_process) {
-            static int reassemble_count = 0;
-            if (reassemble_count++ % 10 == 0) {
-                Log("DEBUG", "Reassembled trajectory frame " + std::to_string(frame_id) 
-                    + " from " + std::to_string(total_chunks) + " chunks, total size=" 
-                    + std::to_string(full_data.size()));
-            }
-            
-            // 构造完整的 Message 并转发给前端
-            simple_middleware::Message full_msg("planning/trajectory", full_data);
-            full_msg.timestamp = msg.timestamp;
-            OnMiddlewareMessage(full_msg);
-        }
-    } catch (const std::exception& e) {
-        static int error_count = 0;
-        if (error_count++ % 10 == 0) {
-            Log("ERROR", "Exception in OnTrajectoryChunk: " + std::string(e.what()));
-        }
-    } catch (...) {
-        static int error_count = 0;
-        if (error_count++ % 10 == 0) {
-            Log("ERROR", "Unknown exception in OnTrajectoryChunk");
-        }
+
+    // 前端按 type 分发，这里转成浏览器使用的 JSON（不要带 frame_id 字段，否则会被当成帧数据）
+    thread_local std::string json_data;
+    json_data.clear();
+    simple_middleware::JsonWriter w(&json_data);
+    w.beginObject();
+    w.field("type", "planning_trajectory");
+    w.field("timestamp", traj.timestamp());
+    w.key("trajectory");
+    w.beginArray();
+    for (const auto& pt : traj.points()) {
+        w.beginObject();
+        w.field("x", pt.x());
+        w.field("y", pt.y());
+        w.field("speed", pt.speed());
+        w.endObject();
     }
+    w.endArray();
+    w.endObject();
+    msg_queue_.Push(json_data);
 }
 
 void VisualizerServer::OnMapChunk(const simple_middleware::Message& msg) {
     if (!running_) return;
     
     try {
-        // 解析分片头：frame_id(4) + chunk_id(4) + total_chunks(4) + chunk_size(4) + chunk_data
-        if (msg.data.size() < 16) {
-            static int error_count = 0;
-            if (error_count++ % 100 == 0) {
-                Log("WARN", "Map chunk too small: " + std::to_string(msg.data.size()) + " bytes");
-            }
-            return;
-        }
-        
-        const uint32_t* header = reinterpret_cast<const uint32_t*>(msg.data.data());
-        uint32_t frame_id = ntohl(header[0]);
-        uint32_t chunk_id = ntohl(header[1]);
-        uint32_t total_chunks = ntohl(header[2]);
-        uint32_t chunk_size = ntohl(header[3]);
-        
-        if (msg.data.size() != 16 + chunk_size) {
-            static int error_count = 0;
-            if (error_count++ % 100 == 0) {
-                Log("WARN", "Map chunk size mismatch: expected " + std::to_string(16 + chunk_size) 
-                    + ", got " + std::to_string(msg.data.size()));
-            }
-            return;
-        }
-        
-        // 提取分片数据
-        std::string chunk_data = msg.data.substr(16, chunk_size);
-        
-        bool should_process = false;
         std::string full_data;
-        
-        {
-            std::lock_guard<std::mutex> lock(chunk_mutex_);
-            
-            // 获取或创建分片缓冲区（使用frame_id + 0x80000000来区分地图数据和轨迹数据）
-            uint32_t map_frame_id = frame_id | 0x80000000;
-            auto& buffer = chunk_buffers_[map_frame_id];
-            buffer.frame_id = frame_id;
-            buffer.total_chunks = total_chunks;
-            buffer.last_update = std::chrono::steady_clock::now();
-            
-            // 确保 chunks 数组大小足够
-            if (buffer.chunks.size() < total_chunks) {
-                buffer.chunks.resize(total_chunks);
-            }
-            
-            // 存储分片数据
-            if (chunk_id < total_chunks) {
-                buffer.chunks[chunk_id] = chunk_data;
-            }
-            
-            // 检查是否所有分片都已收到
-            bool all_received = true;
-            for (size_t i = 0; i < total_chunks; ++i) {
-                if (buffer.chunks[i].empty()) {
-                    all_received = false;
-                    break;
-                }
-            }
-            
-            if (all_received) {
-                // 重组完整数据
-                full_data.reserve(total_chunks * chunk_data.size());
-                for (const auto& chunk : buffer.chunks) {
-                    full_data += chunk;
-                }
-                
-                should_process = true;
-                chunk_buffers_.erase(map_frame_id);
-            }
-            
-            // 清理超时的分片缓冲区
-            auto now = std::chrono::steady_clock::now();
-            for (auto it = chunk_buffers_.begin(); it != chunk_buffers_.end();) {
-                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    now - it->second.last_update).count();
-                if (elapsed > CHUNK_TIMEOUT_MS) {
-                    Log("WARN", "Map chunk timeout for frame " + std::to_string(it->first));
-                    it = chunk_buffers_.erase(it);
-                } else {
-                    ++it;
-                }
-            }
-        }
-        
-        // 在锁外处理完整数据
-        if (should_process) {
-            static int reassemble_count = 0;
-            if (reassemble_count++ % 10 == 0) {
-                Log("DEBUG", "Reassembled map data frame " + std::to_string(frame_id) 
-                    + " from " + std::to_string(total_chunks) + " chunks, total size=" 
-                    + std::to_string(full_data.size()));
-            }
-            
-            // 构造完整的 Message 并转发给前端
-            simple_middleware::Message full_msg("visualizer/map", full_data);
-            full_msg.timestamp = msg.timestamp;
-            OnMiddlewareMessage(full_msg);
-        }
-    } catch (const std::exception& e) {
-        static int error_count = 0;
-        if (error_count++ % 10 == 0) {
-            Log("ERROR", "Exception in OnMapChunk: " + std::string(e.what()));
-        }
-    } catch (...) {
-        static int error_count = 0;
-        if (error_count++ % 10 == 0) {
-            Log("ERROR", "Unknown exception in OnMapChunk");
-        }
-    }
-}
+        if (!map_chunks_.add(msg.data, &full_data)) return;
 
-void VisualizerServer::OnPredictionChunk(const simple_middleware::Message& msg) {
-    if (!running_) return;
-    
-    try {
-        // 解析分片头：frame_id(4) + chunk_id(4) + total_chunks(4) + chunk_size(4) + chunk_data
-        if (msg.data.size() < 16) {
-            static int error_count = 0;
-            if (error_count++ % 100 == 0) {
-                Log("WARN", "Prediction chunk too small: " + std::to_string(msg.data.size()) + " bytes");
-            }
-            return;
-        }
-        
-        const uint32_t* header = reinterpret_cast<const uint32_t*>(msg.data.data());
-        uint32_t frame_id = ntohl(header[0]);
-        uint32_t chunk_id = ntohl(header[1]);
-        uint32_t total_chunks = ntohl(header[2]);
-        uint32_t chunk_size = ntohl(header[3]);
-        
-        if (msg.data.size() != 16 + chunk_size) {
-            static int error_count = 0;
-            if (error_count++ % 100 == 0) {
-                Log("WARN", "Prediction chunk size mismatch: expected " + std::to_string(16 + chunk_size) 
-                    + ", got " + std::to_string(msg.data.size()));
-            }
-            return;
-        }
-        
-        // 提取分片数据
-        std::string chunk_data = msg.data.substr(16, chunk_size);
-        
-        bool should_process = false;
-        std::string full_data;
-        
-        {
-            std::lock_guard<std::mutex> lock(chunk_mutex_);
-            
-            // 获取或创建分片缓冲区（使用frame_id + 0x40000000来区分预测数据和轨迹数据）
-            uint32_t pred_frame_id = frame_id | 0x40000000;
-            auto& buffer = chunk_buffers_[pred_frame_id];
-            buffer.frame_id = frame_id;
-            buffer.total_chunks = total_chunks;
-            buffer.last_update = std::chrono::steady_clock::now();
-            
-            // 确保 chunks 数组大小足够
-            if (buffer.chunks.size() < total_chunks) {
-                buffer.chunks.resize(total_chunks);
-            }
-            
-            // 存储分片数据
-            if (chunk_id < total_chunks) {
-                buffer.chunks[chunk_id] = chunk_data;
-            }
-            
-            // 检查是否所有分片都已收到
-            bool all_received = true;
-            for (size_t i = 0; i < total_chunks; ++i) {
-                if (buffer.chunks[i].empty()) {
-                    all_received = false;
-                    break;
-                }
-            }
-            
-            if (all_received) {
-                // 重组完整数据
-                full_data.reserve(total_chunks * chunk_data.size());
-                for (const auto& chunk : buffer.chunks) {
-                    full_data += chunk;
-                }
-                
-                should_process = true;
-                chunk_buffers_.erase(pred_frame_id);
-            }
-            
-            // 清理超时的分片缓冲区
-            auto now = std::chrono::steady_clock::now();
-            for (auto it = chunk_buffers_.begin(); it != chunk_buffers_.end();) {
-                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    now - it->second.last_update).count();
-                if (elapsed > CHUNK_TIMEOUT_MS) {
-                    Log("WARN", "Prediction chunk timeout for frame " + std::to_string(it->first));
-                    it = chunk_buffers_.erase(it);
-                } else {
-                    ++it;
-                }
-            }
-        }
-        
-        // 在锁外处理完整数据
-        if (should_process) {
-            static int reassemble_count = 0;
-            if (reassemble_count++ % 10 == 0) {
-                Log("DEBUG", "Reassembled prediction data frame " + std::to_string(frame_id) 
-                    + " from " + std::to_string(total_chunks) + " chunks, total size=" 
-                    + std::to_string(full_data.size()));
-            }
-            
-            // 构造完整的 Message 并调用 OnPredictionTrajectories
-            simple_middleware::Message full_msg("prediction/trajectories", full_data);
-            full_msg.timestamp = msg.timestamp;
-            OnPredictionTrajectories(full_msg);
-        }
+        LOG_EVERY_N(DEBUG, "VisualizerServer", 10) << "Reassembled map data, total size=" << full_data.size()
+            << ", dropped=" << map_chunks_.droppedFrames() << ", malformed=" << map_chunks_.malformedPackets();
+
+        // 构造完整的 Message 并转发给前端
+        simple_middleware::Message full_msg(simple_middleware::topics::kMap.str(), full_data);
+        full_msg.timestamp = msg.timestamp;
+        OnMiddlewareMessage(full_msg);
     } catch (const std::exception& e) {
-        static int error_count = 0;
-        if (error_count++ % 10 == 0) {
-            Log("ERROR", "Exception in OnPredictionChunk: " + std::string(e.what()));
-        }
+        LOG_EVERY_N(ERROR, "VisualizerServer", 10) << "Exception in OnMapChunk: " << e.what();
     } catch (...) {
-        static int error_count = 0;
-        if (error_count++ % 10 == 0) {
-            Log("ERROR", "Unknown exception in OnPredictionChunk");
-        }
+        LOG_EVERY_N(ERROR, "VisualizerServer", 10) << "Unknown exception in OnMapChunk";
     }
 }
 
-void VisualizerServer::OnPredictionTrajectories(const simple_middleware::Message& msg) {
+void VisualizerServer::OnPredictionTrajectories(const senseauto::demo::PredictionArray& prediction) {
     if (!running_) return;
     
     try {
-        std::string err;
-        Json json = Json::parse(msg.data, err);
-        if (!err.empty()) {
-            static int parse_fail_count = 0;
-            if (parse_fail_count++ % 10 == 0) {
-                Log("WARN", "Failed to parse prediction/trajectories JSON: " + err);
-            }
+        // 线上只有量化的运动模型参数，这里解包后按建议步长采样成前端绘制用的轨迹点
+        thread_local std::vector<prediction_model::PredictedObstacle> obstacles;
+        if (!prediction_model::Decode(prediction, &obstacles)) {
+            LOG_EVERY_N(WARN, "VisualizerServer", 10) << "Malformed prediction/trajectories: array sizes differ";
             return;
         }
-        
-        // 验证消息类型
-        if (json["type"].string_value() != "prediction_trajectories") {
-            return;
-        }
-        
-        // 构造发送给前端的消息格式
-        Json::array obstacles_array;
-        if (json["obstacles"].is_array()) {
-            for (const auto& obs : json["obstacles"].array_items()) {
-                Json::array trajectory_array;
-                if (obs["trajectory"].is_array()) {
-                    for (const auto& pt : obs["trajectory"].array_items()) {
-                        trajectory_array.push_back(Json::object{
-                            {"x", pt["x"].number_value()},
-                            {"y", pt["y"].number_value()},
-                            {"time_offset", pt["time_offset"].number_value()},
-                            {"confidence", pt["confidence"].number_value()}
-                        });
-                    }
-                }
-                
-                obstacles_array.push_back(Json::object{
-                    {"id", obs["id"].int_value()},
-                    {"current_position", obs["current_position"]},
-                    {"velocity", obs["velocity"]},
-                    {"trajectory", Json(trajectory_array)}
-                });
-            }
-        }
-        
-        Json prediction_msg = Json::object{
-            {"type", "prediction_trajectories"},
-            {"timestamp", json["timestamp"].number_value()},
-            {"obstacles", Json(obstacles_array)}
-        };
+        thread_local std::string prediction_str;
+        prediction_str.clear();
+        simple_middleware::JsonWriter w(&prediction_str);
+        w.beginObject();
+        w.field("type", "prediction_trajectories");
+        w.field("timestamp", prediction.timestamp());
+        w.key("obstacles");
+        w.beginArray();
+        const double time_step = prediction.time_step();
+        const int steps = time_step > 0.0 ? static_cast<int>(prediction.horizon() / time_step + 1e-6) : 0;
+        for (const auto& obs : obstacles) {
+            double vx = obs.vx;
+            double vy = obs.vy;
+            w.beginObject();
+            w.field("id", obs.id);
+            w.key("current_position");
+            w.beginObject();
+            w.field("x", obs.x);
+            w.field("y", obs.y);
+            w.endObject();
+            w.key("velocity");
+            w.beginObject();
+            w.field("vx", vx);
+            w.field("vy", vy);
+            w.field("speed", std::sqrt(vx * vx + vy * vy));
+            w.endObject();
+            w.key("trajectory");
+            w.beginArray();
+            for (int i = 1; i <= steps; ++i) {
+                prediction_model::PredictedPoint pt = prediction_model::Evaluate(obs, i * time_step);
+                w.beginObject();
+                w.field("x", pt.x);
+                w.field("y", pt.y);
+                w.field("time_offset", pt.time_offset);
+                w.field("confidence", pt.confidence);
+                w.endObject();
+            }
+            w.endArray();
+            w.endObject();
+        }
+        w.endArray();
+        w.endObject();
         
         // 发送给前端
-        std::string prediction_str = prediction_msg.dump();
         msg_queue_.Push(prediction_str);
-        
-        static int pub_count = 0;
-        pub_count++;
-        // 总是打印前几次，然后每10次打印一次
-        if (pub_count <= 5 || pub_count % 10 == 0) {
-            Log("INFO", "OnPredictionTrajectories: Published prediction trajectories #" + std::to_string(pub_count)
-                + " for " + std::to_string(obstacles_array.size()) + " obstacles, json_size=" 
-                + std::to_string(prediction_str.size()) + " bytes");
-            // 打印JSON预览用于调试
-            if (pub_count <= 3 && prediction_str.size() > 0) {
-                std::string preview = prediction_str.substr(0, std::min(200UL, prediction_str.size()));
-                Log("DEBUG", "Prediction JSON preview: " + preview + "...");
-            }
-        }
+        LOG_EVERY_N(DEBUG, "VisualizerServer", 10) << "Published prediction trajectories for " << obstacles.size()
+            << " obstacles, json_size=" << prediction_str.size() << " bytes";
     } catch (const std::exception& e) {
-        static int error_count = 0;
-        if (error_count++ % 10 == 0) {
-            Log("ERROR", "Exception in OnPredictionTrajectories: " + std::string(e.what()));
-        }
+        LOG_EVERY_N(ERROR, "VisualizerServer", 10) << "Exception in OnPredictionTrajectories: " << e.what();
     } catch (...) {
-        static int error_count = 0;
-        if (error_count++ % 10 == 0) {
-            Log("ERROR", "Unknown exception in OnPredictionTrajectories");
-        }
+        LOG_EVERY_N(ERROR, "VisualizerServer", 10) << "Unknown exception in OnPredictionTrajectories";
     }
 }
@@ -2,7 +2,12 @@
 
 #include "CivetServer.h"
 #include <simple_middleware/pub_sub_middleware.hpp>
+#include <simple_middleware/topics.hpp>
 #include <simple_middleware/status_reporter.hpp>
+#include <simple_middleware/message_arena.hpp>
+#include <simple_middleware/chunked_transport.hpp>
+#include <simple_middleware/camera_topics.hpp>
+#include <simple_middleware/image_codec.hpp>
 #include "../common/thread_safe_queue.hpp" // 引入队列
 #include <json11.hpp>
 #include <memory>
@@ -50,13 +55,12 @@ private:
     // 中间件消息回调
     void OnMiddlewareMessage(const simple_middleware::Message& msg);
     void OnSystemStatus(const simple_middleware::Message& msg);
-    void OnCameraData(const simple_middleware::Message& msg); // New
+    void OnCameraData(const senseauto::demo::CameraFrame& frame); // New
     void OnCameraChunk(const simple_middleware::Message& msg);
-    void OnTrajectoryChunk(const simple_middleware::Message& msg); // New: 处理分片数据
+    void OnPlanningTrajectory(const senseauto::demo::Trajectory& traj);
     void OnMapChunk(const simple_middleware::Message& msg); // New: 处理地图数据分片
-    void OnPredictionChunk(const simple_middleware::Message& msg); // New: 处理预测轨迹分片
-    void OnDetectionData(const simple_middleware::Message& msg); // New
-    void OnPredictionTrajectories(const simple_middleware::Message& msg); // New: 处理预测轨迹
+    void OnDetectionData(const senseauto::demo::Detection2DArray& dets); // New
+    void OnPredictionTrajectories(const senseauto::demo::PredictionArray& prediction); // 参数化预测 -> 前端轨迹点
 
 private:
     std::unique_ptr<CivetServer> civet_server_;
@@ -80,14 +84,10 @@ private:
     
     const std::string document_root_ = "./www";
     
-    // 分片重组相关
-    struct ChunkBuffer {
-        uint32_t frame_id;
-        uint32_t total_chunks;
-        std::vector<std::string> chunks; // 存储每个分片的数据
-        std::chrono::steady_clock::time_point last_update;
-    };
-    std::unordered_map<uint32_t, ChunkBuffer> chunk_buffers_; // frame_id -> ChunkBuffer
-    std::mutex chunk_mutex_;
-    static constexpr int CHUNK_TIMEOUT_MS = 1000; // 分片超时时间（毫秒）
+    std::unique_ptr<simple_middleware::CameraTopics> display_camera_; // 前端显示的相机
+
+    // 分片重组（相机帧 / 地图 JSON 走不同的话题，各自一个重组器，超时的不完整帧由重组器丢弃并计数）
+    simple_middleware::ChunkAssembler camera_chunks_;
+    simple_middleware::ChunkAssembler map_chunks_;
+    simple_middleware::MessageArena chunk_arena_{128 * 1024}; // 重组后相机帧的解码 Arena
 };
@@ -2,6 +2,7 @@
 #include <common_msgs/visualizer_data.pb.h>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 #include <thread>
 
 using namespace simple_middleware;
@@ -21,12 +22,41 @@ void SystemMonitor::Init() {
     };
 
     // 订阅业务主题
-    middleware.subscribe("visualizer/data", callback);
-    middleware.subscribe("visualizer/control", callback);
-    middleware.subscribe("planning/trajectory", callback);
+    middleware.subscribe(simple_middleware::topics::kGroundTruth, callback);
+    middleware.subscribe(simple_middleware::topics::kEgoState, callback);
+    middleware.subscribe(simple_middleware::topics::kGroundTruthObstacles, callback);
+    middleware.subscribe(simple_middleware::topics::kVisualizerControl, callback);
+    middleware.subscribe(simple_middleware::topics::kPlanningTrajectory, callback);
     
     // 订阅系统状态 (来自 Daemon)
-    middleware.subscribe("system/status", callback);
+    middleware.subscribe(simple_middleware::topics::kSystemStatus, callback);
+
+    // 订阅各节点上报的中间件统计
+    middleware.subscribe(simple_middleware::topics::kTopicStats, [this](const senseauto::demo::NodeTopicStats& stats) {
+        this->OnTopicStats(stats);
+    });
+
+    // 订阅各节点上报的周期循环时序
+    middleware.subscribe(simple_middleware::topics::kLoopStats, [this](const senseauto::demo::NodeLoopStats& stats) {
+        this->OnLoopStats(stats);
+    });
+}
+
+void SystemMonitor::OnTopicStats(const senseauto::demo::NodeTopicStats& stats) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& info = node_topic_stats_[stats.node_name()];
+    // 同一快照可能经本地分发和网络各收到一次，时间戳不变时忽略
+    if (info.current.timestamp() == stats.timestamp()) return;
+    info.previous = std::move(info.current);
+    info.current = stats;
+    info.last_seen = std::chrono::system_clock::now();
+}
+
+void SystemMonitor::OnLoopStats(const senseauto::demo::NodeLoopStats& stats) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& info = node_loop_stats_[stats.node_name()];
+    info.stats = stats;
+    info.last_seen = std::chrono::system_clock::now();
 }
 
 void SystemMonitor::Run(MonitorMode mode) {
@@ -57,7 +87,7 @@ void SystemMonitor::OnMessage(const Message& msg) {
         stat.window_start = now;
     }
 
-    if (msg.topic == "system/status") {
+    if (msg.topic == simple_middleware::topics::kSystemStatus.name) {
         simple_daemon::SystemStatus sys_status;
         if (sys_status.ParseFromString(msg.data)) {
             for (const auto& node : sys_status.nodes()) {
@@ -66,7 +96,7 @@ void SystemMonitor::OnMessage(const Message& msg) {
         }
     }
     // 解析车辆数据
-    else if (msg.topic == "visualizer/data") {
+    else if (msg.topic == simple_middleware::topics::kGroundTruth.name) {
         senseauto::demo::FrameData frame;
         if (frame.ParseFromString(msg.data)) {
             vehicle_data_.has_data = true;
@@ -83,10 +113,10 @@ void SystemMonitor::OnMessage(const Message& msg) {
             }
         }
     }
-    else if (msg.topic == "planning/trajectory") {
-        senseauto::demo::FrameData traj;
+    else if (msg.topic == simple_middleware::topics::kPlanningTrajectory.name) {
+        senseauto::demo::Trajectory traj;
         if (traj.ParseFromString(msg.data)) {
-            vehicle_data_.trajectory_points = traj.trajectory_size();
+            vehicle_data_.trajectory_points = traj.points_size();
         }
     }
 }
@@ -157,6 +187,8 @@ void SystemMonitor::PrintStats(MonitorMode mode) {
                 }
             }
             std::cout << std::endl;
+            PrintLoopStats(now);
+            std::cout << std::endl;
         }
 
         // 3. 网络流量面板 (Topic Status)
@@ -179,9 +211,12 @@ void SystemMonitor::PrintStats(MonitorMode mode) {
                 if (duration > 5000) status = "OFFLINE";
                 
                 // 简单的 Hz 诊断告警
-                if (topic == "visualizer/data" && status == "ACTIVE" && stat.current_hz < 5.0f) {
+                if (topic == simple_middleware::topics::kGroundTruth.name && status == "ACTIVE" && stat.current_hz < 5.0f) {
                     status = "\033[33mLOW FPS\033[0m"; // Yellow Warning
                 }
+                if (topic == simple_middleware::topics::kEgoState.name && status == "ACTIVE" && stat.current_hz < 50.0f) {
+                    status = "\033[33mLOW FPS\033[0m"; // 自车状态应与物理仿真同频 (100Hz)
+                }
 
                 std::cout << std::left << std::setw(25) << topic 
                           << std::setw(10) << std::fixed << std::setprecision(1) << stat.current_hz
@@ -191,9 +226,156 @@ void SystemMonitor::PrintStats(MonitorMode mode) {
             }
         }
         
+        // 4. 中间件统计面板 (各节点上报)
+        if (mode == MonitorMode::ALL || mode == MonitorMode::TOPIC_STATUS) {
+            std::cout << std::endl;
+            PrintMiddlewareStats(now);
+        }
+        
         std::cout << "----------------------------------------------------------------" << std::endl;
         std::cout << "Press Ctrl+C to exit." << std::endl;
 
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
 }
+
+void SystemMonitor::PrintMiddlewareStats(std::chrono::system_clock::time_point now) {
+    std::cout << ">>> Middleware Stats (Reported by Nodes)" << std::endl;
+    if (node_topic_stats_.empty()) {
+        std::cout << "(No middleware stats received)" << std::endl;
+        return;
+    }
+
+    std::cout << std::left << std::setw(18) << "NODE"
+              << std::setw(30) << "TOPIC"
+              << std::setw(9) << "OUT/s"
+              << std::setw(9) << "IN/s"
+              << std::setw(10) << "KB/s"
+              << std::setw(8) << "FRAG/s"
+              << std::setw(8) << "SENDERR"
+              << std::setw(8) << "DECERR"
+              << std::setw(12) << "DISP(us)"
+              << std::setw(11) << "CBp99(us)"
+              << std::setw(11) << "CBMAX(us)"
+              << "OVERBUDGET" << std::endl;
+
+    for (const auto& pair : node_topic_stats_) {
+        const auto& info = pair.second;
+        auto age_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - info.last_seen).count();
+        if (age_ms > 5000) {
+            std::cout << std::left << std::setw(18) << pair.first << "\033[33mSTALE\033[0m" << std::endl;
+            continue;
+        }
+
+        // 与上一次快照差分计算速率
+        double dt = (info.current.timestamp() - info.previous.timestamp()) / 1000.0;
+        std::map<std::string, const senseauto::demo::TopicStatistics*> prev_topics;
+        for (const auto& topic : info.previous.topics()) {
+            prev_topics[topic.topic()] = &topic;
+        }
+
+        for (const auto& topic : info.current.topics()) {
+            auto it = prev_topics.find(topic.topic());
+            const senseauto::demo::TopicStatistics* prev = (it != prev_topics.end()) ? it->second : nullptr;
+            auto rate = [&](uint64_t cur, uint64_t old) {
+                return (prev && dt > 0) ? (cur - old) / dt : 0.0;
+            };
+            double out_hz = rate(topic.msgs_out(), prev ? prev->msgs_out() : 0);
+            double in_hz = rate(topic.msgs_in(), prev ? prev->msgs_in() : 0);
+            double kbps = rate(topic.bytes_out() + topic.bytes_in(),
+                               prev ? prev->bytes_out() + prev->bytes_in() : 0) / 1024.0;
+            double frag_hz = rate(topic.fragments_out(), prev ? prev->fragments_out() : 0);
+            double disp_avg_us = topic.dispatch_count() > 0
+                ? topic.dispatch_ns_total() / 1000.0 / topic.dispatch_count() : 0.0;
+
+            std::cout << std::left << std::setw(18) << pair.first
+                      << std::setw(30) << topic.topic()
+                      << std::setw(9) << std::fixed << std::setprecision(1) << out_hz
+                      << std::setw(9) << in_hz
+                      << std::setw(10) << kbps
+                      << std::setw(8) << frag_hz
+                      << std::setw(8) << topic.send_drops()
+                      << std::setw(8) << topic.decode_errors()
+                      << std::setw(12) << disp_avg_us
+                      << std::setw(11) << topic.callback_ns_p99() / 1000.0
+                      << std::setw(11) << topic.callback_ns_max() / 1000.0
+                      << (topic.callback_over_budget() > 0 ? "\033[33m" : "") << topic.callback_over_budget()
+                      << (topic.callback_over_budget() > 0 ? "\033[0m" : "") << std::endl;
+        }
+        if (info.current.kernel_drops() > 0) {
+            std::cout << "  \033[33mkernel drops: " << info.current.kernel_drops()
+                      << " (rcvbuf=" << info.current.rcvbuf_bytes() << ")\033[0m" << std::endl;
+        }
+    }
+}
+
+void SystemMonitor::PrintLoopStats(std::chrono::system_clock::time_point now) {
+    std::cout << ">>> Loop Timing (Reported by Nodes)" << std::endl;
+    if (node_loop_stats_.empty()) {
+        std::cout << "(No loop stats received)" << std::endl;
+        return;
+    }
+
+    std::cout << std::left << std::setw(18) << "NODE"
+              << std::setw(12) << "LOOP"
+              << std::setw(13) << "HZ(TARGET)"
+              << std::setw(24) << "PERIOD p50/p99/max(ms)"
+              << std::setw(13) << "JITTER(ms)"
+              << std::setw(13) << "EXECp99(ms)"
+              << std::setw(10) << "OVERRUN"
+              << std::setw(7) << "LATE"
+              << std::setw(10) << "ALLOC/IT"
+              << "%CPU" << std::endl;
+
+    auto ms = [](uint64_t us) { return us / 1000.0; };
+    for (const auto& pair : node_loop_stats_) {
+        const auto& info = pair.second;
+        auto age_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - info.last_seen).count();
+        if (age_ms > 5000) {
+            std::cout << std::left << std::setw(18) << pair.first << "\033[33mSTALE\033[0m" << std::endl;
+            continue;
+        }
+
+        for (const auto& loop : info.stats.loops()) {
+            double target_hz = loop.period_us() > 0 ? 1e6 / loop.period_us() : 0.0;
+            std::ostringstream rate;
+            rate << std::fixed << std::setprecision(1) << loop.rate_hz() << "(" << std::setprecision(0) << target_hz << ")";
+            // 分配计数需要节点以 SIMPLE_TRACK_ALLOCATIONS=1 编译，否则显示 "-"
+            std::ostringstream allocs;
+            if (info.stats.alloc_tracking()) {
+                allocs << std::fixed << std::setprecision(1) << loop.allocs_per_cycle();
+            } else {
+                allocs << "-";
+            }
+            std::ostringstream period;
+            period << std::fixed << std::setprecision(1) << ms(loop.interval_p50_us()) << "/"
+                   << ms(loop.interval_p99_us()) << "/" << ms(loop.interval_max_us());
+
+            // 实测频率低于目标 90% 或窗口内有丢拍时标黄
+            bool missing = loop.late_cycles() > 0 || loop.rate_hz() < target_hz * 0.9;
+            std::cout << std::left << std::setw(18) << pair.first
+                      << std::setw(12) << loop.name()
+                      << (missing ? "\033[33m" : "") << std::setw(13) << rate.str() << (missing ? "\033[0m" : "")
+                      << std::setw(24) << period.str()
+                      << std::setw(13) << std::fixed << std::setprecision(2) << ms(loop.jitter_p99_us())
+                      << std::setw(13) << ms(loop.exec_p99_us())
+                      << std::setw(10) << loop.overruns()
+                      << std::setw(7) << loop.late_cycles()
+                      << std::setw(10) << allocs.str()
+                      << std::setprecision(1) << loop.cpu_percent() << std::endl;
+        }
+        std::cout << "  process %CPU: " << std::fixed << std::setprecision(1) << info.stats.process_cpu_percent();
+        // 占用最高的非循环线程（中间件接收、上报等）
+        const senseauto::demo::ThreadCpuUsage* busiest = nullptr;
+        for (const auto& thread : info.stats.threads()) {
+            if (thread.loop().empty() && (!busiest || thread.cpu_percent() > busiest->cpu_percent())) {
+                busiest = &thread;
+            }
+        }
+        if (busiest) {
+            std::cout << "   busiest other thread: " << busiest->name() << "[" << busiest->tid() << "] "
+                      << busiest->cpu_percent() << "%";
+        }
+        std::cout << std::endl;
+    }
+}
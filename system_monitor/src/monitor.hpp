@@ -1,7 +1,9 @@
 #pragma once
 
 #include <simple_middleware/pub_sub_middleware.hpp>
+#include <simple_middleware/topics.hpp>
 #include <common_msgs/daemon.pb.h>
+#include <common_msgs/system_status.pb.h>
 #include <chrono>
 #include <string>
 #include <map>
@@ -16,8 +18,8 @@ enum class MonitorMode {
     TOPIC_STATUS
 };
 
-// 流量统计信息
-struct TopicStats {
+// 流量统计信息（Monitor 自己订阅统计）
+struct TopicTrafficStats {
     uint64_t count = 0;
     uint64_t bytes = 0;
     std::chrono::system_clock::time_point last_msg_time;
@@ -34,6 +36,19 @@ struct NodeStatusInfo {
     std::chrono::system_clock::time_point last_seen;
 };
 
+// 节点上报的中间件统计（保留最近两次快照，用于差分计算速率）
+struct NodeTopicStatsInfo {
+    senseauto::demo::NodeTopicStats current;
+    senseauto::demo::NodeTopicStats previous;
+    std::chrono::system_clock::time_point last_seen;
+};
+
+// 节点上报的周期循环时序（窗口值，直接显示最近一次）
+struct NodeLoopStatsInfo {
+    senseauto::demo::NodeLoopStats stats;
+    std::chrono::system_clock::time_point last_seen;
+};
+
 // 车辆数据
 struct VehicleData {
     bool has_data = false;
@@ -56,13 +71,19 @@ public:
 
 private:
     void OnMessage(const simple_middleware::Message& msg);
+    void OnTopicStats(const senseauto::demo::NodeTopicStats& stats);
+    void OnLoopStats(const senseauto::demo::NodeLoopStats& stats);
     void PrintStats(MonitorMode mode);
+    void PrintMiddlewareStats(std::chrono::system_clock::time_point now);
+    void PrintLoopStats(std::chrono::system_clock::time_point now);
     std::string StateToString(bool is_running);
 
     // 成员变量
     std::mutex mutex_;
-    std::map<std::string, TopicStats> topic_stats_;
+    std::map<std::string, TopicTrafficStats> topic_stats_;
     std::map<std::string, NodeStatusInfo> node_stats_;
+    std::map<std::string, NodeTopicStatsInfo> node_topic_stats_;
+    std::map<std::string, NodeLoopStatsInfo> node_loop_stats_;
     VehicleData vehicle_data_;
     
     std::atomic<bool> running_;